@@ -1,6 +1,7 @@
 #include "application.h"
 
 #include "timer.h"
+#include "thread_pool.h"
 #include "ui/window.h"
 #include "graph/graph.h"
 
@@ -24,6 +25,7 @@ namespace cru {
         window_manager_ = std::make_unique<ui::WindowManager>();
         graph_manager_ = std::make_unique<graph::GraphManager>();
         timer_manager_ = std::make_unique<TimerManager>();
+        thread_pool_ = std::make_unique<ThreadPool>();
     }
 
     Application::~Application()
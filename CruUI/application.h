@@ -19,6 +19,7 @@ namespace cru
     }
 
     class TimerManager;
+    class ThreadPool;
 
     class Application : public Object
     {
@@ -54,6 +55,11 @@ namespace cru
             return timer_manager_.get();
         }
 
+        ThreadPool* GetThreadPool() const
+        {
+            return thread_pool_.get();
+        }
+
         HINSTANCE GetInstanceHandle() const
         {
             return h_instance_;
@@ -67,6 +73,7 @@ namespace cru
         std::unique_ptr<ui::WindowManager> window_manager_;
         std::unique_ptr<graph::GraphManager> graph_manager_;
         std::unique_ptr<TimerManager> timer_manager_;
+        std::unique_ptr<ThreadPool> thread_pool_;
     };
 
 
@@ -2,11 +2,19 @@
 
 #include "global_macros.h"
 
+#ifdef CRU_STD_STRING
+#include <string>
+#else
 #include <folly/String.h>
+#endif
 
 namespace cru
 {
+#ifdef CRU_STD_STRING
+	using String = std::basic_string<wchar_t>;
+#else
 	using String = folly::basic_fbstring<wchar_t>;
+#endif
 
 	class Object
 	{
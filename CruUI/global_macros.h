@@ -1,3 +1,10 @@
 #pragma once
 
 #define GLOG_NO_ABBREVIATED_SEVERITIES
+
+//Define CRU_HEADLESS to build without the system apis, so layout, offscreen
+//rendering, tests and benchmarks build on other platforms. Windows have no
+//handles then and are only laid out and rendered on request.
+
+//Define CRU_STD_STRING to use std::basic_string as String where folly is
+//missing.
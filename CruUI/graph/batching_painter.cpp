@@ -0,0 +1,300 @@
+#include "batching_painter.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace cru
+{
+    namespace graph
+    {
+        inline bool IsIntersectedHelperFunc(const ui::Rect& left, const ui::Rect& right)
+        {
+            // rects sharing an edge don't overlap.
+            return !left.Intersect(right).IsEmpty();
+        }
+
+        void AppendRectangleHelperFunc(Path& target_path, const ui::Rect& rect, const ui::Matrix& transform)
+        {
+            ui::Point corners[] = {
+                transform.TransformPoint(ui::Point(rect.left, rect.top)),
+                transform.TransformPoint(ui::Point(rect.GetRight(), rect.top)),
+                transform.TransformPoint(ui::Point(rect.GetRight(), rect.GetBottom())),
+                transform.TransformPoint(ui::Point(rect.left, rect.GetBottom()))
+            };
+            // a mirroring transform winds it the other way; wound the same
+            // way, overlapping rects fill their union with the non-zero rule.
+            if (transform.m11 * transform.m22 - transform.m12 * transform.m21 < 0.0f)
+                std::swap(corners[1], corners[3]);
+
+            target_path.MoveTo(corners[0]);
+            target_path.LineTo(corners[1]);
+            target_path.LineTo(corners[2]);
+            target_path.LineTo(corners[3]);
+            target_path.Close();
+        }
+
+        void AppendPathHelperFunc(Path& target_path, const Path& path, const ui::Matrix& transform)
+        {
+            // an affine transform of the points is the transform of the curves.
+            auto point = path.GetPoints().cbegin();
+            const auto next_point = [&transform, &point] {
+                return transform.TransformPoint(*point++);
+            };
+            for (const auto verb : path.GetVerbs())
+            {
+                switch (verb)
+                {
+                case Path::Verb::Move:
+                    target_path.MoveTo(next_point());
+                    break;
+                case Path::Verb::Line:
+                    target_path.LineTo(next_point());
+                    break;
+                case Path::Verb::Quadratic:
+                {
+                    const auto control = next_point();
+                    target_path.QuadraticTo(control, next_point());
+                    break;
+                }
+                case Path::Verb::Cubic:
+                {
+                    const auto control1 = next_point();
+                    const auto control2 = next_point();
+                    target_path.CubicTo(control1, control2, next_point());
+                    break;
+                }
+                case Path::Verb::Close:
+                    target_path.Close();
+                    break;
+                }
+            }
+        }
+
+        BatchingPainter::BatchingPainter(Painter* target)
+            : target_(target), target_transform_(target->GetTransform())
+        {
+
+        }
+
+        void BatchingPainter::Flush()
+        {
+            for (const auto& batch : batches_)
+            {
+                SubmitBatch(batch);
+                statistics_.submission_count++;
+            }
+            batches_.clear();
+        }
+
+        void BatchingPainter::FillRectangle(const ui::Rect& rect, const Brush& brush)
+        {
+            if (brush.GetType() != BrushType::Solid)
+            {
+                PrepareTarget();
+                statistics_.primitive_count++;
+                statistics_.submission_count++;
+                target_->FillRectangle(rect, brush);
+                return;
+            }
+
+            const auto& color = brush.GetColor();
+            AddFill(color, FillRule::NonZero, transform_.TransformBounds(rect), color.a >= 1.0f, Fill{ FillKind::Rectangle, transform_, rect, 0.0f, 0.0f, nullptr });
+        }
+
+        void BatchingPainter::StrokeRectangle(const ui::Rect& rect, const Brush& brush, const float width)
+        {
+            PrepareTarget();
+            statistics_.primitive_count++;
+            statistics_.submission_count++;
+            target_->StrokeRectangle(rect, brush, width);
+        }
+
+        void BatchingPainter::FillRoundedRectangle(const ui::Rect& rect, const float radius_x, const float radius_y, const Brush& brush)
+        {
+            if (brush.GetType() != BrushType::Solid)
+            {
+                PrepareTarget();
+                statistics_.primitive_count++;
+                statistics_.submission_count++;
+                target_->FillRoundedRectangle(rect, radius_x, radius_y, brush);
+                return;
+            }
+
+            AddFill(brush.GetColor(), FillRule::NonZero, transform_.TransformBounds(rect), false, Fill{ FillKind::RoundedRectangle, transform_, rect, radius_x, radius_y, nullptr });
+        }
+
+        void BatchingPainter::StrokeRoundedRectangle(const ui::Rect& rect, const float radius_x, const float radius_y, const Brush& brush, const float width)
+        {
+            PrepareTarget();
+            statistics_.primitive_count++;
+            statistics_.submission_count++;
+            target_->StrokeRoundedRectangle(rect, radius_x, radius_y, brush, width);
+        }
+
+        void BatchingPainter::FillPath(const Path& path, const Brush& brush)
+        {
+            // a gradient in target coordinates would need its transform.
+            if (brush.GetType() != BrushType::Solid)
+            {
+                PrepareTarget();
+                statistics_.primitive_count++;
+                statistics_.submission_count++;
+                target_->FillPath(path, brush);
+                return;
+            }
+
+            if (path.IsEmpty())
+                return;
+
+            AddFill(brush.GetColor(), path.GetFillRule(), transform_.TransformBounds(path.GetBounds()), false, Fill{ FillKind::Path, transform_, ui::Rect(), 0.0f, 0.0f, &path });
+        }
+
+        void BatchingPainter::Clear(const Color& color)
+        {
+            PrepareTarget();
+            statistics_.submission_count++;
+            target_->Clear(color);
+        }
+
+        void BatchingPainter::PushClip(const ui::Rect& rect)
+        {
+            PrepareTarget();
+            statistics_.submission_count++;
+            target_->PushClip(rect);
+        }
+
+        void BatchingPainter::PopClip()
+        {
+            PrepareTarget();
+            statistics_.submission_count++;
+            target_->PopClip();
+        }
+
+        std::shared_ptr<Layer> BatchingPainter::CreateLayer(const ui::Size& size)
+        {
+            return target_->CreateLayer(size);
+        }
+
+        void BatchingPainter::PaintLayer(Layer& layer, const std::function<void(Painter&)>& action)
+        {
+            target_->PaintLayer(layer, [&action](Painter& layer_painter) {
+                BatchingPainter painter(&layer_painter);
+                action(painter);
+                painter.Flush();
+            });
+        }
+
+        void BatchingPainter::DrawLayer(const Layer& layer, const ui::Point& point)
+        {
+            PrepareTarget();
+            statistics_.submission_count++;
+            target_->DrawLayer(layer, point);
+        }
+
+        bool BatchingPainter::CanDrawLayer(const Layer& layer) const
+        {
+            return target_->CanDrawLayer(layer);
+        }
+
+        void BatchingPainter::AddFill(const Color& color, const FillRule fill_rule, const ui::Rect& bounds, bool is_union_safe, const Fill& fill)
+        {
+            statistics_.primitive_count++;
+            if (color.a <= 0.0f)
+                return;
+
+            const auto append_fill = [](Path& target_path, const Fill& fill, const Path* path) {
+                switch (fill.kind)
+                {
+                case FillKind::Rectangle:
+                    AppendRectangleHelperFunc(target_path, fill.rect, fill.transform);
+                    break;
+                case FillKind::RoundedRectangle:
+                {
+                    Path rounded_path;
+                    rounded_path.AddRoundedRectangle(fill.rect, fill.radius_x, fill.radius_y);
+                    AppendPathHelperFunc(target_path, rounded_path, fill.transform);
+                    break;
+                }
+                case FillKind::Path:
+                    AppendPathHelperFunc(target_path, *path, fill.transform);
+                    break;
+                }
+            };
+
+            const auto look_back_end = batches_.size() > max_look_back ? batches_.size() - max_look_back : 0;
+            for (auto i = batches_.size(); i > look_back_end; i--)
+            {
+                auto& batch = batches_[i - 1];
+                if (batch.color == color && batch.fill_rule == fill_rule && static_cast<int>(batch.fill_bounds.size()) < max_batch_size)
+                {
+                    const auto can_merge = (is_union_safe && batch.is_union_safe) ||
+                        std::none_of(batch.fill_bounds.cbegin(), batch.fill_bounds.cend(), [&bounds](const ui::Rect& fill_bounds) {
+                            return IsIntersectedHelperFunc(fill_bounds, bounds);
+                        });
+                    if (can_merge)
+                    {
+                        if (batch.fill_bounds.size() == 1)
+                        {
+                            batch.path.SetFillRule(fill_rule);
+                            append_fill(batch.path, batch.first_fill, &batch.first_path);
+                        }
+                        append_fill(batch.path, fill, fill.path);
+                        batch.bounds = batch.bounds.Union(bounds);
+                        batch.fill_bounds.push_back(bounds);
+                        batch.is_union_safe = batch.is_union_safe && is_union_safe;
+                        statistics_.batched_primitive_count++;
+                        return;
+                    }
+                }
+                // it can't be moved below a batch it overlaps.
+                if (IsIntersectedHelperFunc(batch.bounds, bounds))
+                    break;
+            }
+
+            // the path is only appended when another fill joins.
+            Batch batch{ color, fill_rule, fill, fill.path == nullptr ? Path() : *fill.path, Path(), bounds, { bounds }, is_union_safe };
+            batch.first_fill.path = nullptr;
+            batches_.push_back(std::move(batch));
+        }
+
+        void BatchingPainter::SubmitBatch(const Batch& batch)
+        {
+            if (batch.fill_bounds.size() > 1)
+            {
+                SetTargetTransform(ui::Matrix::Identity());
+                target_->FillTransientPath(batch.path, batch.color);
+                return;
+            }
+
+            const auto& fill = batch.first_fill;
+            SetTargetTransform(fill.transform);
+            switch (fill.kind)
+            {
+            case FillKind::Rectangle:
+                target_->FillRectangle(fill.rect, batch.color);
+                break;
+            case FillKind::RoundedRectangle:
+                target_->FillRoundedRectangle(fill.rect, fill.radius_x, fill.radius_y, batch.color);
+                break;
+            case FillKind::Path:
+                target_->FillPath(batch.first_path, batch.color);
+                break;
+            }
+        }
+
+        void BatchingPainter::PrepareTarget()
+        {
+            Flush();
+            SetTargetTransform(transform_);
+        }
+
+        void BatchingPainter::SetTargetTransform(const ui::Matrix& matrix)
+        {
+            if (target_transform_ == matrix)
+                return;
+            target_transform_ = matrix;
+            target_->SetTransform(matrix);
+            statistics_.transform_change_count++;
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <vector>
+
+#include "painter.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //Counters of a batching painter since it was created.
+        struct BatchStatistics
+        {
+            //Count of fills drawn with the painter.
+            int primitive_count = 0;
+            //Count of fills merged into a batch of earlier fills.
+            int batched_primitive_count = 0;
+            //Count of commands sent to the target, including the ones that
+            //are not fills.
+            int submission_count = 0;
+            //Count of transform changes sent to the target.
+            int transform_change_count = 0;
+        };
+
+        //A painter between drawing code and a backend painter that merges
+        //fills of the same solid color into one path in target coordinates,
+        //so many small shapes become few fills and transform changes.
+        //
+        //A batch of one fill is sent as it was drawn, so the target can use
+        //a native shape or a geometry cached by its path. A merged path is
+        //sent by "FillTransientPath", as it is built anew every frame.
+        //
+        //A fill joins an earlier batch of its color only if no batch after
+        //that one overlaps it, so the result is as if drawn in order. Fills
+        //overlapping other fills of a batch only join it if both are opaque
+        //rects, whose union is the same however they are drawn. Other
+        //commands flush the batches and are sent as they are.
+        class BatchingPainter : public Painter
+        {
+        public:
+            //Batches this far back from the last one are tried for a fill.
+            static constexpr int max_look_back = 8;
+            //A batch holds at most this count of fills.
+            static constexpr int max_batch_size = 1024;
+
+        public:
+            //"target" must outlive the painter.
+            explicit BatchingPainter(Painter* target);
+            BatchingPainter(const BatchingPainter& other) = delete;
+            BatchingPainter(BatchingPainter&& other) = delete;
+            BatchingPainter& operator=(const BatchingPainter& other) = delete;
+            BatchingPainter& operator=(BatchingPainter&& other) = delete;
+            //The batches left are not sent, so "Flush" must be invoked.
+            ~BatchingPainter() override = default;
+
+            Painter* GetTarget() const
+            {
+                return target_;
+            }
+
+            //Send the batches to the target.
+            void Flush();
+
+            const BatchStatistics& GetStatistics() const
+            {
+                return statistics_;
+            }
+
+            ui::Matrix GetTransform() override
+            {
+                return transform_;
+            }
+
+            //The transform is only sent with commands that are not batched.
+            void SetTransform(const ui::Matrix& matrix) override
+            {
+                transform_ = matrix;
+            }
+
+            void FillRectangle(const ui::Rect& rect, const Brush& brush) override;
+            void StrokeRectangle(const ui::Rect& rect, const Brush& brush, float width) override;
+            void FillRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush) override;
+            void StrokeRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush, float width) override;
+            void FillPath(const Path& path, const Brush& brush) override;
+            void Clear(const Color& color) override;
+            void PushClip(const ui::Rect& rect) override;
+            void PopClip() override;
+
+            std::shared_ptr<Layer> CreateLayer(const ui::Size& size) override;
+            //The layer is painted through another batching painter.
+            void PaintLayer(Layer& layer, const std::function<void(Painter&)>& action) override;
+            void DrawLayer(const Layer& layer, const ui::Point& point) override;
+            bool CanDrawLayer(const Layer& layer) const override;
+
+        private:
+            enum class FillKind
+            {
+                Rectangle,
+                RoundedRectangle,
+                Path
+            };
+
+            //A fill as it was drawn.
+            struct Fill
+            {
+                FillKind kind;
+                ui::Matrix transform;
+                ui::Rect rect;
+                float radius_x;
+                float radius_y;
+                //The path of a path fill. It is only valid during "AddFill".
+                const Path* path;
+            };
+
+            struct Batch
+            {
+                Color color;
+                FillRule fill_rule;
+                //The first fill, sent as it is if no other joins the batch.
+                Fill first_fill;
+                //A copy of the path of the first fill if it is a path fill.
+                Path first_path;
+                //The fills in target coordinates, built when a second one joins.
+                Path path;
+                ui::Rect bounds;
+                //Bounds of each fill, to find overlaps.
+                std::vector<ui::Rect> fill_bounds;
+                //True if the fills are all opaque rects.
+                bool is_union_safe;
+            };
+
+            //Add a fill with "bounds" in target coordinates. "is_union_safe"
+            //tells that it is an opaque rect.
+            void AddFill(const Color& color, FillRule fill_rule, const ui::Rect& bounds, bool is_union_safe, const Fill& fill);
+
+            //Send a batch to the target.
+            void SubmitBatch(const Batch& batch);
+
+            //Flush the batches and send the transform before a command that
+            //is not batched.
+            void PrepareTarget();
+            void SetTargetTransform(const ui::Matrix& matrix);
+
+        private:
+            Painter* target_;
+            ui::Matrix transform_ = ui::Matrix::Identity();
+            //The transform last sent to the target.
+            ui::Matrix target_transform_;
+            std::vector<Batch> batches_;
+            BatchStatistics statistics_{};
+        };
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "painter.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //Pack a color into a premultiplied BGRA pixel, which is 0xAARRGGBB
+        //as a 32-bit integer, so it is the bytes B, G, R, A in memory on
+        //little-endian machines.
+        inline std::uint32_t PackPremultipliedColor(const Color& color)
+        {
+            const auto clamp = [](const float value) {
+                return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+            };
+            const auto a = clamp(color.a);
+            const auto to_byte = [](const float value) {
+                return static_cast<std::uint32_t>(value * 255.0f + 0.5f);
+            };
+            return to_byte(a) << 24 | to_byte(clamp(color.r) * a) << 16 | to_byte(clamp(color.g) * a) << 8 | to_byte(clamp(color.b) * a);
+        }
+
+        //A buffer of premultiplied BGRA pixels in memory, rows top to bottom
+        //without padding. It is a value type.
+        class Bitmap
+        {
+        public:
+            Bitmap() = default;
+            //All pixels are transparent at first.
+            Bitmap(const int width, const int height) : width_(width), height_(height)
+            {
+                if (width < 0 || height < 0)
+                    throw std::invalid_argument("Bitmap size can't be negative.");
+                pixels_.resize(static_cast<std::size_t>(width) * height);
+            }
+            Bitmap(const Bitmap& other) = default;
+            Bitmap(Bitmap&& other) = default;
+            Bitmap& operator=(const Bitmap& other) = default;
+            Bitmap& operator=(Bitmap&& other) = default;
+            ~Bitmap() = default;
+
+            int GetWidth() const
+            {
+                return width_;
+            }
+
+            int GetHeight() const
+            {
+                return height_;
+            }
+
+            std::uint32_t* GetRow(const int y)
+            {
+                return pixels_.data() + static_cast<std::size_t>(y) * width_;
+            }
+
+            const std::uint32_t* GetRow(const int y) const
+            {
+                return pixels_.data() + static_cast<std::size_t>(y) * width_;
+            }
+
+            std::uint32_t GetPixel(const int x, const int y) const
+            {
+                return GetRow(y)[x];
+            }
+
+            void SetPixel(const int x, const int y, const std::uint32_t pixel)
+            {
+                GetRow(y)[x] = pixel;
+            }
+
+            void Fill(const std::uint32_t pixel)
+            {
+                std::fill(pixels_.begin(), pixels_.end(), pixel);
+            }
+
+            const std::vector<std::uint32_t>& GetPixels() const
+            {
+                return pixels_;
+            }
+
+            friend bool operator == (const Bitmap& left, const Bitmap& right)
+            {
+                return left.width_ == right.width_ && left.height_ == right.height_ && left.pixels_ == right.pixels_;
+            }
+
+        private:
+            int width_ = 0;
+            int height_ = 0;
+            std::vector<std::uint32_t> pixels_;
+        };
+
+        inline bool operator != (const Bitmap& left, const Bitmap& right)
+        {
+            return !(left == right);
+        }
+    }
+}
@@ -0,0 +1,260 @@
+#include "d2d_painter.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "exception.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        inline D2D1_RECT_F ConvertRectHelperFunc(const ui::Rect& rect)
+        {
+            return D2D1::RectF(rect.left, rect.top, rect.GetRight(), rect.GetBottom());
+        }
+
+        D2DLayer::D2DLayer(Microsoft::WRL::ComPtr<ID2D1Bitmap1> bitmap, const ui::Size& size, const std::size_t byte_size)
+            : bitmap_(std::move(bitmap)), size_(size), byte_size_(byte_size)
+        {
+
+        }
+
+        inline const D2DLayer& CastLayerHelperFunc(const Layer& layer)
+        {
+            const auto d2d_layer = dynamic_cast<const D2DLayer*>(&layer);
+            if (d2d_layer == nullptr)
+                throw std::invalid_argument("The layer is not created by a d2d painter.");
+            return *d2d_layer;
+        }
+
+        D2DPainter::D2DPainter(ID2D1DeviceContext* device_context, D2DResourceCache* resource_cache)
+            : device_context_(device_context), resource_cache_(resource_cache)
+        {
+            device_context_->SetTransform(D2D1::Matrix3x2F::Identity());
+        }
+
+        void D2DPainter::SetTransform(const ui::Matrix& matrix)
+        {
+            transform_ = matrix;
+            device_context_->SetTransform(D2D1::Matrix3x2F(matrix.m11, matrix.m12, matrix.m21, matrix.m22, matrix.dx, matrix.dy));
+        }
+
+        void D2DPainter::FillRectangle(const ui::Rect& rect, const Brush& brush)
+        {
+            device_context_->FillRectangle(ConvertRectHelperFunc(rect), GetBrush(brush));
+        }
+
+        void D2DPainter::StrokeRectangle(const ui::Rect& rect, const Brush& brush, const float width)
+        {
+            device_context_->DrawRectangle(ConvertRectHelperFunc(rect), GetBrush(brush), width);
+        }
+
+        void D2DPainter::FillRoundedRectangle(const ui::Rect& rect, const float radius_x, const float radius_y, const Brush& brush)
+        {
+            device_context_->FillRoundedRectangle(D2D1::RoundedRect(ConvertRectHelperFunc(rect), radius_x, radius_y), GetBrush(brush));
+        }
+
+        void D2DPainter::StrokeRoundedRectangle(const ui::Rect& rect, const float radius_x, const float radius_y, const Brush& brush, const float width)
+        {
+            device_context_->DrawRoundedRectangle(D2D1::RoundedRect(ConvertRectHelperFunc(rect), radius_x, radius_y), GetBrush(brush), width);
+        }
+
+        void D2DPainter::FillPath(const Path& path, const Brush& brush)
+        {
+            if (resource_cache_ == nullptr)
+            {
+                FillTransientPath(path, brush);
+                return;
+            }
+            const auto geometry = resource_cache_->GetGeometry(path, [this, &path] {
+                return CreateGeometry(path);
+            });
+            device_context_->FillGeometry(geometry.Get(), GetBrush(brush));
+        }
+
+        void D2DPainter::FillTransientPath(const Path& path, const Brush& brush)
+        {
+            device_context_->FillGeometry(CreateGeometry(path).Get(), GetBrush(brush));
+        }
+
+
+        void D2DPainter::Clear(const Color& color)
+        {
+            device_context_->Clear(D2D1::ColorF(color.r, color.g, color.b, color.a));
+        }
+
+        void D2DPainter::PushClip(const ui::Rect& rect)
+        {
+            device_context_->PushAxisAlignedClip(ConvertRectHelperFunc(rect), D2D1_ANTIALIAS_MODE_PER_PRIMITIVE);
+        }
+
+        void D2DPainter::PopClip()
+        {
+            device_context_->PopAxisAlignedClip();
+        }
+
+        std::shared_ptr<Layer> D2DPainter::CreateLayer(const ui::Size& size)
+        {
+            float dpi_x, dpi_y;
+            device_context_->GetDpi(&dpi_x, &dpi_y);
+            const auto width = static_cast<UINT32>(std::max(std::ceil(size.width * dpi_x / 96.0f), 0.0f));
+            const auto height = static_cast<UINT32>(std::max(std::ceil(size.height * dpi_y / 96.0f), 0.0f));
+            if (width == 0 || height == 0)
+                return nullptr;
+
+            const auto properties = D2D1::BitmapProperties1(
+                D2D1_BITMAP_OPTIONS_TARGET,
+                D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+                dpi_x, dpi_y
+            );
+            Microsoft::WRL::ComPtr<ID2D1Bitmap1> bitmap;
+            ThrowIfFailed(device_context_->CreateBitmap(D2D1::SizeU(width, height), nullptr, 0, &properties, &bitmap));
+            // the size is whole pixels, so the layer is drawn without scaling.
+            return std::make_shared<D2DLayer>(std::move(bitmap), ui::Size(width * 96.0f / dpi_x, height * 96.0f / dpi_y),
+                static_cast<std::size_t>(width) * height * 4);
+        }
+
+        void D2DPainter::PaintLayer(Layer& layer, const std::function<void(Painter&)>& action)
+        {
+            const auto& d2d_layer = CastLayerHelperFunc(layer);
+
+            Microsoft::WRL::ComPtr<ID2D1Device> device;
+            device_context_->GetDevice(&device);
+            Microsoft::WRL::ComPtr<ID2D1DeviceContext> layer_context;
+            ThrowIfFailed(device->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE, &layer_context));
+
+            float dpi_x, dpi_y;
+            device_context_->GetDpi(&dpi_x, &dpi_y);
+            layer_context->SetDpi(dpi_x, dpi_y);
+            layer_context->SetTarget(d2d_layer.GetBitmap());
+            layer_context->BeginDraw();
+            layer_context->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
+            {
+                D2DPainter painter(layer_context.Get(), resource_cache_);
+                action(painter);
+            }
+            ThrowIfFailed(layer_context->EndDraw());
+        }
+
+        void D2DPainter::DrawLayer(const Layer& layer, const ui::Point& point)
+        {
+            const auto& d2d_layer = CastLayerHelperFunc(layer);
+            const auto size = d2d_layer.GetSize();
+            const auto destination = D2D1::RectF(point.x, point.y, point.x + size.width, point.y + size.height);
+            device_context_->DrawBitmap(d2d_layer.GetBitmap(), &destination, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+        }
+
+        bool D2DPainter::CanDrawLayer(const Layer& layer) const
+        {
+            return dynamic_cast<const D2DLayer*>(&layer) != nullptr;
+        }
+
+        ID2D1Brush* D2DPainter::GetBrush(const Brush& brush)
+        {
+            if (resource_cache_ != nullptr)
+            {
+                // kept until the next command, in case the cache drops it.
+                brush_ = resource_cache_->GetBrush(brush, [this, &brush] {
+                    return CreateBrush(brush);
+                });
+                return brush_.Get();
+            }
+
+            if (brush.GetType() == BrushType::Solid)
+            {
+                const auto& color = brush.GetColor();
+                const auto d2d_color = D2D1::ColorF(color.r, color.g, color.b, color.a);
+                if (solid_color_brush_ == nullptr)
+                    ThrowIfFailed(device_context_->CreateSolidColorBrush(d2d_color, &solid_color_brush_));
+                else
+                    solid_color_brush_->SetColor(d2d_color);
+                return solid_color_brush_.Get();
+            }
+
+            brush_ = CreateBrush(brush);
+            return brush_.Get();
+        }
+
+        Microsoft::WRL::ComPtr<ID2D1Brush> D2DPainter::CreateBrush(const Brush& brush) const
+        {
+            if (brush.GetType() == BrushType::Solid)
+            {
+                const auto& color = brush.GetColor();
+                Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> solid_color_brush;
+                ThrowIfFailed(device_context_->CreateSolidColorBrush(D2D1::ColorF(color.r, color.g, color.b, color.a), &solid_color_brush));
+                return solid_color_brush;
+            }
+
+            std::vector<D2D1_GRADIENT_STOP> stops;
+            for (const auto& stop : brush.GetStops())
+                stops.push_back(D2D1::GradientStop(stop.position, D2D1::ColorF(stop.color.r, stop.color.g, stop.color.b, stop.color.a)));
+            Microsoft::WRL::ComPtr<ID2D1GradientStopCollection> stop_collection;
+            ThrowIfFailed(device_context_->CreateGradientStopCollection(stops.data(), static_cast<UINT32>(stops.size()), &stop_collection));
+
+            const auto properties = D2D1::LinearGradientBrushProperties(
+                D2D1::Point2F(brush.GetStart().x, brush.GetStart().y),
+                D2D1::Point2F(brush.GetEnd().x, brush.GetEnd().y)
+            );
+            Microsoft::WRL::ComPtr<ID2D1LinearGradientBrush> linear_gradient_brush;
+            ThrowIfFailed(device_context_->CreateLinearGradientBrush(properties, stop_collection.Get(), &linear_gradient_brush));
+            return linear_gradient_brush;
+        }
+
+        Microsoft::WRL::ComPtr<ID2D1PathGeometry> D2DPainter::CreateGeometry(const Path& path) const
+        {
+            Microsoft::WRL::ComPtr<ID2D1Factory> factory;
+            device_context_->GetFactory(&factory);
+
+            Microsoft::WRL::ComPtr<ID2D1PathGeometry> geometry;
+            ThrowIfFailed(factory->CreatePathGeometry(&geometry));
+            Microsoft::WRL::ComPtr<ID2D1GeometrySink> sink;
+            ThrowIfFailed(geometry->Open(&sink));
+            sink->SetFillMode(path.GetFillRule() == FillRule::NonZero ? D2D1_FILL_MODE_WINDING : D2D1_FILL_MODE_ALTERNATE);
+
+            const auto convert_point = [](const ui::Point& point) {
+                return D2D1::Point2F(point.x, point.y);
+            };
+
+            auto is_figure_open = false;
+            auto point = path.GetPoints().cbegin();
+            for (const auto verb : path.GetVerbs())
+            {
+                switch (verb)
+                {
+                case Path::Verb::Move:
+                    if (is_figure_open)
+                        sink->EndFigure(D2D1_FIGURE_END_OPEN);
+                    sink->BeginFigure(convert_point(*point++), D2D1_FIGURE_BEGIN_FILLED);
+                    is_figure_open = true;
+                    break;
+                case Path::Verb::Line:
+                    sink->AddLine(convert_point(*point++));
+                    break;
+                case Path::Verb::Quadratic:
+                {
+                    const auto control = convert_point(*point++);
+                    sink->AddQuadraticBezier(D2D1::QuadraticBezierSegment(control, convert_point(*point++)));
+                    break;
+                }
+                case Path::Verb::Cubic:
+                {
+                    const auto control1 = convert_point(*point++);
+                    const auto control2 = convert_point(*point++);
+                    sink->AddBezier(D2D1::BezierSegment(control1, control2, convert_point(*point++)));
+                    break;
+                }
+                case Path::Verb::Close:
+                    sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+                    is_figure_open = false;
+                    break;
+                }
+            }
+            if (is_figure_open)
+                sink->EndFigure(D2D1_FIGURE_END_OPEN);
+            ThrowIfFailed(sink->Close());
+
+            return geometry;
+        }
+    }
+}
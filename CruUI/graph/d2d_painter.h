@@ -0,0 +1,112 @@
+#pragma once
+
+#include "system_headers.h"
+#include <vector>
+
+#include "painter.h"
+#include "resource_cache.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //A layer of a d2d painter. It is a target bitmap of the device, so it
+        //is lost with the device.
+        class D2DLayer : public Layer
+        {
+        public:
+            //"size" is in dips.
+            D2DLayer(Microsoft::WRL::ComPtr<ID2D1Bitmap1> bitmap, const ui::Size& size, std::size_t byte_size);
+            D2DLayer(const D2DLayer& other) = delete;
+            D2DLayer(D2DLayer&& other) = delete;
+            D2DLayer& operator=(const D2DLayer& other) = delete;
+            D2DLayer& operator=(D2DLayer&& other) = delete;
+            ~D2DLayer() override = default;
+
+            ID2D1Bitmap1* GetBitmap() const
+            {
+                return bitmap_.Get();
+            }
+
+            ui::Size GetSize() const override
+            {
+                return size_;
+            }
+
+            std::size_t GetByteSize() const override
+            {
+                return byte_size_;
+            }
+
+        private:
+            Microsoft::WRL::ComPtr<ID2D1Bitmap1> bitmap_;
+            ui::Size size_;
+            std::size_t byte_size_;
+        };
+
+        //Brushes and path geometries of a d2d device.
+        using D2DResourceCache = ResourceCache<Microsoft::WRL::ComPtr<ID2D1Brush>, Microsoft::WRL::ComPtr<ID2D1PathGeometry>>;
+
+        //A painter drawing with a d2d device context. It only lives for a
+        //frame, between "BeginDraw" and "EndDraw" of the device context.
+        class D2DPainter : public Painter
+        {
+        public:
+            //The transform of "device_context" is reset to identity. Brushes
+            //and geometries are taken from "resource_cache" of the device if
+            //it is not null, otherwise they are created per command.
+            explicit D2DPainter(ID2D1DeviceContext* device_context, D2DResourceCache* resource_cache = nullptr);
+            D2DPainter(const D2DPainter& other) = delete;
+            D2DPainter(D2DPainter&& other) = delete;
+            D2DPainter& operator=(const D2DPainter& other) = delete;
+            D2DPainter& operator=(D2DPainter&& other) = delete;
+            ~D2DPainter() override = default;
+
+            ID2D1DeviceContext* GetDeviceContext() const
+            {
+                return device_context_;
+            }
+
+            ui::Matrix GetTransform() override
+            {
+                return transform_;
+            }
+
+            void SetTransform(const ui::Matrix& matrix) override;
+            void FillRectangle(const ui::Rect& rect, const Brush& brush) override;
+            void StrokeRectangle(const ui::Rect& rect, const Brush& brush, float width) override;
+            void FillRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush) override;
+            void StrokeRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush, float width) override;
+            //The geometry is taken from the resource cache.
+            void FillPath(const Path& path, const Brush& brush) override;
+            void FillTransientPath(const Path& path, const Brush& brush) override;
+            void Clear(const Color& color) override;
+            void PushClip(const ui::Rect& rect) override;
+            void PopClip() override;
+
+            //Layers are painted by another device context of the same device,
+            //so it works between "BeginDraw" and "EndDraw" with clips pushed.
+            std::shared_ptr<Layer> CreateLayer(const ui::Size& size) override;
+            void PaintLayer(Layer& layer, const std::function<void(Painter&)>& action) override;
+            void DrawLayer(const Layer& layer, const ui::Point& point) override;
+            bool CanDrawLayer(const Layer& layer) const override;
+
+        private:
+            //Get a d2d brush for "brush", valid until the next command.
+            //Without a resource cache, one solid color brush is shared by all
+            //commands and gradient brushes are created per command.
+            ID2D1Brush* GetBrush(const Brush& brush);
+
+            Microsoft::WRL::ComPtr<ID2D1Brush> CreateBrush(const Brush& brush) const;
+            Microsoft::WRL::ComPtr<ID2D1PathGeometry> CreateGeometry(const Path& path) const;
+
+        private:
+            ID2D1DeviceContext* device_context_;
+            D2DResourceCache* resource_cache_;
+            // kept so that it is never read back from the device context.
+            ui::Matrix transform_ = ui::Matrix::Identity();
+            Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> solid_color_brush_;
+            Microsoft::WRL::ComPtr<ID2D1Brush> brush_;
+        };
+    }
+}
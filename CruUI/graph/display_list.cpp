@@ -0,0 +1,356 @@
+#include "display_list.h"
+
+#include <cstring>
+
+namespace cru
+{
+    namespace graph
+    {
+        class DisplayList::Reader
+        {
+        public:
+            explicit Reader(const std::vector<Word>& words) : current_(words.data()), end_(words.data() + words.size()) { }
+
+            bool IsEnd() const
+            {
+                return current_ == end_;
+            }
+
+            Command ReadCommand()
+            {
+                return static_cast<Command>(*current_++);
+            }
+
+            float ReadFloat()
+            {
+                float value;
+                std::memcpy(&value, current_++, sizeof(float));
+                return value;
+            }
+
+            ui::Rect ReadRect()
+            {
+                const auto left = ReadFloat();
+                const auto top = ReadFloat();
+                const auto width = ReadFloat();
+                const auto height = ReadFloat();
+                return ui::Rect(left, top, width, height);
+            }
+
+            Color ReadColor()
+            {
+                const auto r = ReadFloat();
+                const auto g = ReadFloat();
+                const auto b = ReadFloat();
+                const auto a = ReadFloat();
+                return Color(r, g, b, a);
+            }
+
+            ui::Point ReadPoint()
+            {
+                const auto x = ReadFloat();
+                const auto y = ReadFloat();
+                return ui::Point(x, y);
+            }
+
+            Word ReadWord()
+            {
+                return *current_++;
+            }
+
+            Brush ReadBrush()
+            {
+                if (static_cast<BrushType>(ReadWord()) == BrushType::Solid)
+                    return Brush(ReadColor());
+
+                const auto start = ReadPoint();
+                const auto end = ReadPoint();
+                std::vector<GradientStop> stops(ReadWord());
+                for (auto& stop : stops)
+                {
+                    stop.position = ReadFloat();
+                    stop.color = ReadColor();
+                }
+                return Brush::LinearGradient(start, end, std::move(stops));
+            }
+
+            Path ReadPath()
+            {
+                Path path;
+                path.SetFillRule(static_cast<FillRule>(ReadWord()));
+                const auto verb_count = ReadWord();
+                for (Word i = 0; i < verb_count; i++)
+                {
+                    switch (static_cast<Path::Verb>(ReadWord()))
+                    {
+                    case Path::Verb::Move:
+                        path.MoveTo(ReadPoint());
+                        break;
+                    case Path::Verb::Line:
+                        path.LineTo(ReadPoint());
+                        break;
+                    case Path::Verb::Quadratic:
+                    {
+                        const auto control = ReadPoint();
+                        path.QuadraticTo(control, ReadPoint());
+                        break;
+                    }
+                    case Path::Verb::Cubic:
+                    {
+                        const auto control1 = ReadPoint();
+                        const auto control2 = ReadPoint();
+                        path.CubicTo(control1, control2, ReadPoint());
+                        break;
+                    }
+                    case Path::Verb::Close:
+                        path.Close();
+                        break;
+                    }
+                }
+                return path;
+            }
+
+            ui::Matrix ReadMatrix()
+            {
+                ui::Matrix matrix;
+                matrix.m11 = ReadFloat();
+                matrix.m12 = ReadFloat();
+                matrix.m21 = ReadFloat();
+                matrix.m22 = ReadFloat();
+                matrix.dx = ReadFloat();
+                matrix.dy = ReadFloat();
+                return matrix;
+            }
+
+        private:
+            const Word* current_;
+            const Word* end_;
+        };
+
+        void DisplayList::Replay(Painter& painter) const
+        {
+            const auto base_transform = painter.GetTransform();
+            auto is_transform_changed = false;
+
+            Reader reader(words_);
+            while (!reader.IsEnd())
+            {
+                switch (reader.ReadCommand())
+                {
+                case Command::SetTransform:
+                    painter.SetTransform(reader.ReadMatrix() * base_transform);
+                    is_transform_changed = true;
+                    break;
+                case Command::FillRectangle:
+                {
+                    const auto rect = reader.ReadRect();
+                    painter.FillRectangle(rect, reader.ReadBrush());
+                    break;
+                }
+                case Command::StrokeRectangle:
+                {
+                    const auto rect = reader.ReadRect();
+                    const auto brush = reader.ReadBrush();
+                    painter.StrokeRectangle(rect, brush, reader.ReadFloat());
+                    break;
+                }
+                case Command::FillRoundedRectangle:
+                {
+                    const auto rect = reader.ReadRect();
+                    const auto radius_x = reader.ReadFloat();
+                    const auto radius_y = reader.ReadFloat();
+                    painter.FillRoundedRectangle(rect, radius_x, radius_y, reader.ReadBrush());
+                    break;
+                }
+                case Command::StrokeRoundedRectangle:
+                {
+                    const auto rect = reader.ReadRect();
+                    const auto radius_x = reader.ReadFloat();
+                    const auto radius_y = reader.ReadFloat();
+                    const auto brush = reader.ReadBrush();
+                    painter.StrokeRoundedRectangle(rect, radius_x, radius_y, brush, reader.ReadFloat());
+                    break;
+                }
+                case Command::FillPath:
+                {
+                    const auto path = reader.ReadPath();
+                    painter.FillPath(path, reader.ReadBrush());
+                    break;
+                }
+                case Command::Clear:
+                    painter.Clear(reader.ReadColor());
+                    break;
+                case Command::PushClip:
+                    painter.PushClip(reader.ReadRect());
+                    break;
+                case Command::PopClip:
+                    painter.PopClip();
+                    break;
+                }
+            }
+
+            if (is_transform_changed)
+                painter.SetTransform(base_transform);
+        }
+
+        void DisplayList::Clear()
+        {
+            words_.clear();
+            command_count_ = 0;
+            transform_ = ui::Matrix::Identity();
+        }
+
+        void DisplayList::SetTransform(const ui::Matrix& matrix)
+        {
+            transform_ = matrix;
+            WriteCommand(Command::SetTransform);
+            WriteFloat(matrix.m11);
+            WriteFloat(matrix.m12);
+            WriteFloat(matrix.m21);
+            WriteFloat(matrix.m22);
+            WriteFloat(matrix.dx);
+            WriteFloat(matrix.dy);
+        }
+
+        void DisplayList::FillRectangle(const ui::Rect& rect, const Brush& brush)
+        {
+            WriteCommand(Command::FillRectangle);
+            WriteRect(rect);
+            WriteBrush(brush);
+        }
+
+        void DisplayList::StrokeRectangle(const ui::Rect& rect, const Brush& brush, const float width)
+        {
+            WriteCommand(Command::StrokeRectangle);
+            WriteRect(rect);
+            WriteBrush(brush);
+            WriteFloat(width);
+        }
+
+        void DisplayList::FillRoundedRectangle(const ui::Rect& rect, const float radius_x, const float radius_y, const Brush& brush)
+        {
+            WriteCommand(Command::FillRoundedRectangle);
+            WriteRect(rect);
+            WriteFloat(radius_x);
+            WriteFloat(radius_y);
+            WriteBrush(brush);
+        }
+
+        void DisplayList::StrokeRoundedRectangle(const ui::Rect& rect, const float radius_x, const float radius_y, const Brush& brush, const float width)
+        {
+            WriteCommand(Command::StrokeRoundedRectangle);
+            WriteRect(rect);
+            WriteFloat(radius_x);
+            WriteFloat(radius_y);
+            WriteBrush(brush);
+            WriteFloat(width);
+        }
+
+        void DisplayList::FillPath(const Path& path, const Brush& brush)
+        {
+            WriteCommand(Command::FillPath);
+            WritePath(path);
+            WriteBrush(brush);
+        }
+
+        void DisplayList::Clear(const Color& color)
+        {
+            WriteCommand(Command::Clear);
+            WriteColor(color);
+        }
+
+        void DisplayList::PushClip(const ui::Rect& rect)
+        {
+            WriteCommand(Command::PushClip);
+            WriteRect(rect);
+        }
+
+        void DisplayList::PopClip()
+        {
+            WriteCommand(Command::PopClip);
+        }
+
+        void DisplayList::WriteCommand(const Command command)
+        {
+            words_.push_back(static_cast<Word>(command));
+            command_count_++;
+        }
+
+        void DisplayList::WriteFloat(const float value)
+        {
+            Word word;
+            std::memcpy(&word, &value, sizeof(Word));
+            words_.push_back(word);
+        }
+
+        void DisplayList::WriteRect(const ui::Rect& rect)
+        {
+            WriteFloat(rect.left);
+            WriteFloat(rect.top);
+            WriteFloat(rect.width);
+            WriteFloat(rect.height);
+        }
+
+        void DisplayList::WriteColor(const Color& color)
+        {
+            WriteFloat(color.r);
+            WriteFloat(color.g);
+            WriteFloat(color.b);
+            WriteFloat(color.a);
+        }
+
+        void DisplayList::WritePoint(const ui::Point& point)
+        {
+            WriteFloat(point.x);
+            WriteFloat(point.y);
+        }
+
+        void DisplayList::WriteBrush(const Brush& brush)
+        {
+            words_.push_back(static_cast<Word>(brush.GetType()));
+            if (brush.GetType() == BrushType::Solid)
+            {
+                WriteColor(brush.GetColor());
+                return;
+            }
+
+            WritePoint(brush.GetStart());
+            WritePoint(brush.GetEnd());
+            words_.push_back(static_cast<Word>(brush.GetStops().size()));
+            for (const auto& stop : brush.GetStops())
+            {
+                WriteFloat(stop.position);
+                WriteColor(stop.color);
+            }
+        }
+
+        void DisplayList::WritePath(const Path& path)
+        {
+            words_.push_back(static_cast<Word>(path.GetFillRule()));
+            words_.push_back(static_cast<Word>(path.GetVerbs().size()));
+            auto point = path.GetPoints().cbegin();
+            for (const auto verb : path.GetVerbs())
+            {
+                words_.push_back(static_cast<Word>(verb));
+                switch (verb)
+                {
+                case Path::Verb::Move:
+                case Path::Verb::Line:
+                    WritePoint(*point++);
+                    break;
+                case Path::Verb::Quadratic:
+                    WritePoint(*point++);
+                    WritePoint(*point++);
+                    break;
+                case Path::Verb::Cubic:
+                    WritePoint(*point++);
+                    WritePoint(*point++);
+                    WritePoint(*point++);
+                    break;
+                case Path::Verb::Close:
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "painter.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //Drawing commands recorded into a compact buffer to be replayed
+        //later. It is a painter itself, so drawing code doesn't know whether
+        //it draws now or is recorded.
+        //
+        //Transforms are recorded relative to the transform of the painter at
+        //the start of "Replay", so a list can be replayed anywhere.
+        class DisplayList : public Painter
+        {
+        public:
+            DisplayList() = default;
+            DisplayList(const DisplayList& other) = delete;
+            DisplayList(DisplayList&& other) = delete;
+            DisplayList& operator=(const DisplayList& other) = delete;
+            DisplayList& operator=(DisplayList&& other) = delete;
+            ~DisplayList() override = default;
+
+            //Send the commands to "painter". Its transform is restored at the end.
+            void Replay(Painter& painter) const;
+
+            //Remove all commands but keep the memory for the next recording.
+            void Clear();
+
+            bool IsEmpty() const
+            {
+                return command_count_ == 0;
+            }
+
+            int GetCommandCount() const
+            {
+                return command_count_;
+            }
+
+            //Get the size of the recorded commands in bytes.
+            std::size_t GetByteSize() const
+            {
+                return words_.size() * sizeof(Word);
+            }
+
+            //Return true if both lists have the same commands.
+            bool IsSameAs(const DisplayList& other) const
+            {
+                return words_ == other.words_;
+            }
+
+            //Get the transform set by the last recorded "SetTransform".
+            ui::Matrix GetTransform() override
+            {
+                return transform_;
+            }
+
+            void SetTransform(const ui::Matrix& matrix) override;
+            void FillRectangle(const ui::Rect& rect, const Brush& brush) override;
+            void StrokeRectangle(const ui::Rect& rect, const Brush& brush, float width) override;
+            void FillRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush) override;
+            void StrokeRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush, float width) override;
+            void FillPath(const Path& path, const Brush& brush) override;
+            void Clear(const Color& color) override;
+            void PushClip(const ui::Rect& rect) override;
+            void PopClip() override;
+
+        private:
+            using Word = std::uint32_t;
+
+            enum class Command : Word
+            {
+                SetTransform,
+                FillRectangle,
+                StrokeRectangle,
+                FillRoundedRectangle,
+                StrokeRoundedRectangle,
+                FillPath,
+                Clear,
+                PushClip,
+                PopClip
+            };
+
+            class Reader;
+
+            void WriteCommand(Command command);
+            void WriteFloat(float value);
+            void WriteRect(const ui::Rect& rect);
+            void WriteColor(const Color& color);
+            void WritePoint(const ui::Point& point);
+            void WriteBrush(const Brush& brush);
+            void WritePath(const Path& path);
+
+        private:
+            //A command word followed by its arguments, each a word.
+            std::vector<Word> words_;
+            int command_count_ = 0;
+            ui::Matrix transform_ = ui::Matrix::Identity();
+        };
+    }
+}
@@ -0,0 +1,562 @@
+#include "glyph_atlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "bitmap.h"
+#include "path.h"
+#include "software_painter.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //Stands for no target pixel. It is finite, so parabolas can be compared.
+        constexpr float far_distance = 1e20f;
+
+        //Squared distance of each cell of "f" to the nearest cell, where "f"
+        //is 0 on targets and "far_distance" elsewhere, by the lower envelope
+        //of parabolas of Felzenszwalb and Huttenlocher.
+        inline void DistanceTransformHelperFunc(const float* f, float* d, const int n, int* v, float* z)
+        {
+            auto k = 0;
+            v[0] = 0;
+            z[0] = -std::numeric_limits<float>::infinity();
+            z[1] = std::numeric_limits<float>::infinity();
+            for (auto q = 1; q < n; q++)
+            {
+                auto s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * (q - v[k]));
+                while (k > 0 && s <= z[k])
+                {
+                    k--;
+                    s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * (q - v[k]));
+                }
+                k++;
+                v[k] = q;
+                z[k] = s;
+                z[k + 1] = std::numeric_limits<float>::infinity();
+            }
+            k = 0;
+            for (auto q = 0; q < n; q++)
+            {
+                while (z[k + 1] < q)
+                    k++;
+                d[q] = static_cast<float>((q - v[k]) * (q - v[k])) + f[v[k]];
+            }
+        }
+
+        //Squared distance of each pixel to the nearest pixel where "is_target"
+        //is true, transformed by rows and then by columns.
+        inline std::vector<float> DistanceFieldHelperFunc(const std::vector<bool>& is_target, const int width, const int height)
+        {
+            const auto size = std::max(width, height);
+            std::vector<float> f(size), d(size), z(size + 2);
+            std::vector<int> v(size);
+            std::vector<float> field(is_target.size());
+            for (auto i = 0; i < static_cast<int>(field.size()); i++)
+                field[i] = is_target[i] ? 0.0f : far_distance;
+
+            for (auto y = 0; y < height; y++)
+            {
+                std::copy_n(field.begin() + y * width, width, f.begin());
+                DistanceTransformHelperFunc(f.data(), d.data(), width, v.data(), z.data());
+                std::copy_n(d.begin(), width, field.begin() + y * width);
+            }
+            for (auto x = 0; x < width; x++)
+            {
+                for (auto y = 0; y < height; y++)
+                    f[y] = field[y * width + x];
+                DistanceTransformHelperFunc(f.data(), d.data(), height, v.data(), z.data());
+                for (auto y = 0; y < height; y++)
+                    field[y * width + x] = d[y];
+            }
+            return field;
+        }
+
+        GlyphImage MakeSignedDistanceField(const GlyphImage& coverage, const int spread)
+        {
+            if (spread <= 0)
+                throw std::invalid_argument("Spread of a distance field must be positive.");
+
+            GlyphImage field;
+            field.width = coverage.width + spread * 2;
+            field.height = coverage.height + spread * 2;
+            field.origin_x = coverage.origin_x - spread;
+            field.origin_y = coverage.origin_y - spread;
+            const auto pixel_count = static_cast<std::size_t>(field.width) * field.height;
+
+            std::vector<bool> is_inside(pixel_count);
+            for (auto y = 0; y < coverage.height; y++)
+                for (auto x = 0; x < coverage.width; x++)
+                    is_inside[(y + spread) * field.width + x + spread] = coverage.pixels[y * coverage.width + x] >= 128;
+            std::vector<bool> is_outside(pixel_count);
+            std::transform(is_inside.begin(), is_inside.end(), is_outside.begin(), [](const bool inside) { return !inside; });
+
+            const auto distance_to_inside = DistanceFieldHelperFunc(is_inside, field.width, field.height);
+            const auto distance_to_outside = DistanceFieldHelperFunc(is_outside, field.width, field.height);
+
+            // the outline is half a pixel away from the centers on both sides.
+            field.pixels.resize(pixel_count);
+            for (std::size_t i = 0; i < pixel_count; i++)
+            {
+                const auto distance = is_inside[i]
+                    ? std::sqrt(distance_to_outside[i]) - 0.5f
+                    : 0.5f - std::sqrt(distance_to_inside[i]);
+                const auto value = 128.0f + distance * 127.0f / spread;
+                field.pixels[i] = static_cast<std::uint8_t>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+            }
+            return field;
+        }
+
+        GlyphImage StubGlyphRasterizer::Rasterize(const std::uint32_t font_id, const std::uint32_t glyph_index, const float size)
+        {
+            GlyphImage image;
+            if (!(size > 0.0f))
+                return image;
+
+            const auto width = size * (0.3f + 0.1f * (glyph_index % 5));
+            const auto height = size * 0.7f;
+            const auto stroke = size * (0.08f + 0.02f * (font_id % 3));
+            image.width = static_cast<int>(std::ceil(width));
+            image.height = static_cast<int>(std::ceil(height));
+            image.origin_x = static_cast<int>(std::round(size * 0.05f));
+            image.origin_y = -image.height;
+
+            Bitmap bitmap(image.width, image.height);
+            {
+                Path path;
+                path.SetFillRule(FillRule::EvenOdd);
+                path.AddRectangle(ui::Rect(0.0f, 0.0f, width, height));
+                path.AddRectangle(ui::Rect(stroke, stroke, width - stroke * 2.0f, height - stroke * 2.0f));
+                SoftwarePainter painter(&bitmap);
+                painter.FillPath(path, Color(1.0f, 1.0f, 1.0f));
+            }
+            // the color is opaque, so the alpha is the coverage.
+            image.pixels.resize(bitmap.GetPixels().size());
+            std::transform(bitmap.GetPixels().begin(), bitmap.GetPixels().end(), image.pixels.begin(), [](const std::uint32_t pixel) {
+                return static_cast<std::uint8_t>(pixel >> 24);
+            });
+            return image;
+        }
+
+        //An open addressing map from keys to locations, written by one thread
+        //at a time and read by any without locks. Every slot is a seqlock: a
+        //writer makes the sequence odd while it changes the words, and a
+        //reader retries if the sequence was odd or changed while it read.
+        class GlyphAtlas::Table
+        {
+        public:
+            enum State : std::uint64_t
+            {
+                Empty,
+                Full,
+                Removed
+            };
+
+            struct Entry
+            {
+                std::uint64_t state;
+                std::uint64_t key[2];
+                std::uint64_t value[2];
+            };
+
+        public:
+            explicit Table(const int capacity) : capacity_(capacity), slots_(new Slot[capacity]) { }
+
+            int GetCapacity() const
+            {
+                return capacity_;
+            }
+
+            int GetCount() const
+            {
+                return count_;
+            }
+
+            std::size_t GetByteSize() const
+            {
+                return sizeof(Table) + sizeof(Slot) * static_cast<std::size_t>(capacity_);
+            }
+
+            //Count of slots that end a probe later, full or removed.
+            int GetUsedCount() const
+            {
+                return used_count_;
+            }
+
+            bool Find(const std::uint64_t key0, const std::uint64_t key1, Entry& entry) const
+            {
+                auto index = Hash(key0, key1) & (capacity_ - 1);
+                for (auto i = 0; i < capacity_; i++)
+                {
+                    entry = Read(slots_[index]);
+                    if (entry.state == Empty)
+                        return false;
+                    if (entry.state == Full && entry.key[0] == key0 && entry.key[1] == key1)
+                        return true;
+                    index = (index + 1) & (capacity_ - 1);
+                }
+                return false;
+            }
+
+            //Add an entry whose key is not in the table.
+            void Insert(const Entry& entry)
+            {
+                auto index = Hash(entry.key[0], entry.key[1]) & (capacity_ - 1);
+                while (true)
+                {
+                    const auto state = slots_[index].words[0].load(std::memory_order_relaxed);
+                    if (state != Full)
+                    {
+                        if (state == Empty)
+                            used_count_++;
+                        count_++;
+                        Write(slots_[index], entry);
+                        return;
+                    }
+                    index = (index + 1) & (capacity_ - 1);
+                }
+            }
+
+            //Remove the entries "predicate" returns true for.
+            template <typename Predicate>
+            void RemoveIf(Predicate&& predicate)
+            {
+                for (auto i = 0; i < capacity_; i++)
+                {
+                    const auto entry = Read(slots_[i]);
+                    if (entry.state == Full && predicate(entry))
+                    {
+                        Write(slots_[i], Entry{ Removed, { entry.key[0], entry.key[1] }, { 0, 0 } });
+                        count_--;
+                    }
+                }
+            }
+
+            //Insert the entries into "table".
+            void CopyTo(Table& table) const
+            {
+                for (auto i = 0; i < capacity_; i++)
+                {
+                    const auto entry = Read(slots_[i]);
+                    if (entry.state == Full)
+                        table.Insert(entry);
+                }
+            }
+
+        private:
+            struct Slot
+            {
+                std::atomic<std::uint32_t> sequence{ 0 };
+                //The state, the key and the value of "Entry".
+                std::atomic<std::uint64_t> words[5] = {};
+            };
+
+            static std::size_t Hash(const std::uint64_t key0, const std::uint64_t key1)
+            {
+                // the finalizer of splitmix64.
+                auto hash = key0 ^ (key1 * 0x9E3779B97F4A7C15ull);
+                hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+                hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+                return static_cast<std::size_t>(hash ^ (hash >> 31));
+            }
+
+            static Entry Read(const Slot& slot)
+            {
+                while (true)
+                {
+                    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+                    if (sequence & 1)
+                        continue;
+                    Entry entry;
+                    entry.state = slot.words[0].load(std::memory_order_relaxed);
+                    entry.key[0] = slot.words[1].load(std::memory_order_relaxed);
+                    entry.key[1] = slot.words[2].load(std::memory_order_relaxed);
+                    entry.value[0] = slot.words[3].load(std::memory_order_relaxed);
+                    entry.value[1] = slot.words[4].load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+                        return entry;
+                }
+            }
+
+            static void Write(Slot& slot, const Entry& entry)
+            {
+                const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+                slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.words[0].store(entry.state, std::memory_order_relaxed);
+                slot.words[1].store(entry.key[0], std::memory_order_relaxed);
+                slot.words[2].store(entry.key[1], std::memory_order_relaxed);
+                slot.words[3].store(entry.value[0], std::memory_order_relaxed);
+                slot.words[4].store(entry.value[1], std::memory_order_relaxed);
+                slot.sequence.store(sequence + 2, std::memory_order_release);
+            }
+
+        private:
+            int capacity_;
+            std::unique_ptr<Slot[]> slots_;
+            int count_ = 0;
+            int used_count_ = 0;
+        };
+
+        struct GlyphAtlas::PageState
+        {
+            GlyphAtlasPage page;
+            //Null until the first glyph is packed into the page.
+            std::unique_ptr<SkylinePacker> packer;
+            //Increased when the page is evicted, so locations of the glyphs
+            //on it found in a stale table are rejected.
+            std::atomic<std::uint32_t> generation{ 0 };
+            std::atomic<std::uint64_t> last_used_frame{ 0 };
+        };
+
+        //Generations are stored in 24 bits of an entry.
+        constexpr std::uint32_t generation_mask = 0xFFFFFF;
+        constexpr int min_table_capacity = 256;
+
+        inline void PackKeyHelperFunc(const GlyphKey& key, std::uint64_t& key0, std::uint64_t& key1)
+        {
+            key0 = static_cast<std::uint64_t>(key.font_id) << 32 | key.glyph_index;
+            // sizes are normalized to quarters of a pixel.
+            key1 = static_cast<std::uint64_t>(key.mode) << 32 | static_cast<std::uint32_t>(key.size * 4.0f);
+        }
+
+        inline void PackLocationHelperFunc(const GlyphLocation& location, const std::uint32_t generation, std::uint64_t& value0, std::uint64_t& value1)
+        {
+            value0 = static_cast<std::uint64_t>(location.rect.x) | static_cast<std::uint64_t>(location.rect.y) << 16 |
+                static_cast<std::uint64_t>(location.rect.width) << 32 | static_cast<std::uint64_t>(location.rect.height) << 48;
+            value1 = static_cast<std::uint64_t>(location.page) | static_cast<std::uint64_t>(generation & generation_mask) << 8 |
+                static_cast<std::uint64_t>(static_cast<std::uint16_t>(location.origin_x)) << 32 |
+                static_cast<std::uint64_t>(static_cast<std::uint16_t>(location.origin_y)) << 48;
+        }
+
+        inline GlyphLocation UnpackLocationHelperFunc(const std::uint64_t value0, const std::uint64_t value1)
+        {
+            GlyphLocation location;
+            location.rect.x = static_cast<int>(value0 & 0xFFFF);
+            location.rect.y = static_cast<int>(value0 >> 16 & 0xFFFF);
+            location.rect.width = static_cast<int>(value0 >> 32 & 0xFFFF);
+            location.rect.height = static_cast<int>(value0 >> 48);
+            location.page = static_cast<int>(value1 & 0xFF);
+            location.origin_x = static_cast<std::int16_t>(value1 >> 32 & 0xFFFF);
+            location.origin_y = static_cast<std::int16_t>(value1 >> 48);
+            return location;
+        }
+
+        GlyphAtlas::GlyphAtlas(GlyphRasterizer* rasterizer, const int page_size, const int max_page_count)
+            : rasterizer_(rasterizer), page_size_(page_size), max_page_count_(max_page_count)
+        {
+            if (rasterizer == nullptr)
+                throw std::invalid_argument("Glyph rasterizer can't be null.");
+            // locations are packed into 16 bits for coordinates and 8 for pages.
+            if (page_size <= 0 || page_size > 0xFFFF)
+                throw std::invalid_argument("Atlas page size must be in (0, 65535].");
+            if (max_page_count <= 0 || max_page_count > 0xFF)
+                throw std::invalid_argument("Atlas page count must be in (0, 255].");
+
+            pages_.reset(new PageState[max_page_count]);
+            tables_.push_back(std::make_unique<Table>(min_table_capacity));
+            table_.store(tables_.back().get(), std::memory_order_release);
+        }
+
+        GlyphAtlas::~GlyphAtlas() = default;
+
+        void GlyphAtlas::BeginFrame()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frame_.fetch_add(1, std::memory_order_relaxed);
+            // no reader of the last frame is left, so only the current table is.
+            tables_.erase(tables_.begin(), tables_.end() - 1);
+        }
+
+        bool GlyphAtlas::Find(const GlyphKey& key, GlyphLocation& location) const
+        {
+            auto normalized_key = key;
+            NormalizeKey(normalized_key);
+            std::uint64_t key0, key1;
+            PackKeyHelperFunc(normalized_key, key0, key1);
+
+            Table::Entry entry;
+            if (!table_.load(std::memory_order_acquire)->Find(key0, key1, entry))
+                return false;
+            const auto found_location = UnpackLocationHelperFunc(entry.value[0], entry.value[1]);
+            auto& page_state = pages_[found_location.page];
+            const auto generation = static_cast<std::uint32_t>(entry.value[1] >> 8) & generation_mask;
+            if ((page_state.generation.load(std::memory_order_acquire) & generation_mask) != generation)
+                return false;
+
+            page_state.last_used_frame.store(frame_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            location = found_location;
+            return true;
+        }
+
+        bool GlyphAtlas::Get(const GlyphKey& key, GlyphLocation& location)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (Find(key, location))
+                return true;
+
+            auto normalized_key = key;
+            NormalizeKey(normalized_key);
+            const auto is_signed_distance = normalized_key.mode == GlyphMode::SignedDistance;
+            auto image = rasterizer_->Rasterize(normalized_key.font_id, normalized_key.glyph_index,
+                is_signed_distance ? signed_distance_size : normalized_key.size);
+            if (is_signed_distance && image.width > 0 && image.height > 0)
+                image = MakeSignedDistanceField(image, signed_distance_spread);
+            statistics_.rasterized_count++;
+
+            GlyphLocation new_location;
+            new_location.origin_x = image.origin_x;
+            new_location.origin_y = image.origin_y;
+            // a blank glyph, like a space, takes no room but is still cached.
+            if (image.width > 0 && image.height > 0)
+            {
+                PackedRect rect;
+                const auto page_index = Pack(image.width + padding, image.height + padding, rect);
+                if (page_index < 0)
+                {
+                    statistics_.failed_count++;
+                    return false;
+                }
+                new_location.page = page_index;
+                new_location.rect = PackedRect{ rect.x, rect.y, image.width, image.height };
+
+                auto& page = pages_[page_index].page;
+                for (auto y = 0; y < image.height; y++)
+                    std::copy_n(image.pixels.begin() + y * image.width, image.width,
+                        page.pixels.begin() + (rect.y + y) * page.width + rect.x);
+
+                auto& dirty_rect = page.dirty_rect;
+                if (dirty_rect.width == 0)
+                    dirty_rect = new_location.rect;
+                else
+                {
+                    const auto right = std::max(dirty_rect.x + dirty_rect.width, rect.x + image.width);
+                    const auto bottom = std::max(dirty_rect.y + dirty_rect.height, rect.y + image.height);
+                    dirty_rect.x = std::min(dirty_rect.x, rect.x);
+                    dirty_rect.y = std::min(dirty_rect.y, rect.y);
+                    dirty_rect.width = right - dirty_rect.x;
+                    dirty_rect.height = bottom - dirty_rect.y;
+                }
+            }
+
+            auto& page_state = pages_[new_location.page];
+            page_state.last_used_frame.store(frame_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+            Table::Entry entry{ Table::Full, { 0, 0 }, { 0, 0 } };
+            PackKeyHelperFunc(normalized_key, entry.key[0], entry.key[1]);
+            PackLocationHelperFunc(new_location, page_state.generation.load(std::memory_order_relaxed), entry.value[0], entry.value[1]);
+
+            // the table is at most half used, so probes stay short. A larger
+            // one is filled and published, and the old one is kept for readers.
+            auto table = table_.load(std::memory_order_relaxed);
+            if ((table->GetUsedCount() + 1) * 2 > table->GetCapacity())
+            {
+                auto capacity = min_table_capacity;
+                while (capacity < (table->GetCount() + 1) * 4)
+                    capacity *= 2;
+                tables_.push_back(std::make_unique<Table>(capacity));
+                table->CopyTo(*tables_.back());
+                table = tables_.back().get();
+                table_.store(table, std::memory_order_release);
+            }
+            table->Insert(entry);
+
+            location = new_location;
+            return true;
+        }
+
+        const GlyphAtlasPage& GlyphAtlas::GetPage(const int index) const
+        {
+            if (index < 0 || index >= max_page_count_)
+                throw std::invalid_argument("Atlas page index is out of range.");
+            return pages_[index].page;
+        }
+
+        void GlyphAtlas::ClearDirtyRect(const int index)
+        {
+            if (index < 0 || index >= max_page_count_)
+                throw std::invalid_argument("Atlas page index is out of range.");
+            std::lock_guard<std::mutex> lock(mutex_);
+            pages_[index].page.dirty_rect = PackedRect();
+        }
+
+        GlyphAtlasStatistics GlyphAtlas::GetStatistics() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto statistics = statistics_;
+            statistics.glyph_count = table_.load(std::memory_order_relaxed)->GetCount();
+            statistics.table_count = static_cast<int>(tables_.size());
+            for (const auto& table : tables_)
+                statistics.table_byte_size += table->GetByteSize();
+            statistics.page_count = static_cast<int>(std::count_if(pages_.get(), pages_.get() + max_page_count_, [](const PageState& page_state) {
+                return page_state.packer != nullptr;
+            }));
+            return statistics;
+        }
+
+        void GlyphAtlas::NormalizeKey(GlyphKey& key)
+        {
+            if (key.mode == GlyphMode::SignedDistance)
+                key.size = 0.0f;
+            else
+                key.size = std::round(std::max(key.size, 0.0f) * 4.0f) / 4.0f;
+        }
+
+        int GlyphAtlas::Pack(const int width, const int height, PackedRect& rect)
+        {
+            if (width > page_size_ || height > page_size_)
+                return -1;
+
+            for (auto i = 0; i < max_page_count_; i++)
+            {
+                auto& page_state = pages_[i];
+                if (page_state.packer == nullptr)
+                {
+                    page_state.page.width = page_size_;
+                    page_state.page.height = page_size_;
+                    page_state.page.pixels.assign(static_cast<std::size_t>(page_size_) * page_size_, 0);
+                    page_state.packer = std::make_unique<SkylinePacker>(page_size_, page_size_);
+                }
+                if (page_state.packer->Pack(width, height, rect))
+                    return i;
+            }
+
+            // glyphs on pages used in this frame may still be drawn.
+            const auto frame = frame_.load(std::memory_order_relaxed);
+            auto victim = -1;
+            auto victim_frame = frame;
+            for (auto i = 0; i < max_page_count_; i++)
+            {
+                const auto last_used_frame = pages_[i].last_used_frame.load(std::memory_order_relaxed);
+                if (last_used_frame < victim_frame)
+                {
+                    victim = i;
+                    victim_frame = last_used_frame;
+                }
+            }
+            if (victim < 0)
+                return -1;
+
+            EvictPage(victim);
+            return pages_[victim].packer->Pack(width, height, rect) ? victim : -1;
+        }
+
+        void GlyphAtlas::EvictPage(const int index)
+        {
+            auto& page_state = pages_[index];
+            page_state.generation.fetch_add(1, std::memory_order_release);
+            table_.load(std::memory_order_relaxed)->RemoveIf([index](const Table::Entry& entry) {
+                return static_cast<int>(entry.value[1] & 0xFF) == index;
+            });
+
+            std::fill(page_state.page.pixels.begin(), page_state.page.pixels.end(), static_cast<std::uint8_t>(0));
+            page_state.page.dirty_rect = PackedRect{ 0, 0, page_size_, page_size_ };
+            page_state.packer->Reset();
+            statistics_.evicted_page_count++;
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "base.h"
+#include "skyline_packer.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //An 8-bit single channel image of a glyph, rows top to bottom without
+        //padding.
+        struct GlyphImage
+        {
+            int width = 0;
+            int height = 0;
+            //Offset of the top-left pixel from the pen position on the baseline.
+            int origin_x = 0;
+            int origin_y = 0;
+            std::vector<std::uint8_t> pixels;
+        };
+
+        //Turn the coverage of a glyph into a signed distance field whose
+        //pixels are 128 on the outline and change by 127 over "spread"
+        //pixels, larger inside. The image grows by "spread" on each side.
+        //Such a glyph can be drawn sharp at any scale by a threshold.
+        GlyphImage MakeSignedDistanceField(const GlyphImage& coverage, int spread);
+
+        //Rasterizes glyphs of fonts into coverage images. It is the only part
+        //of the glyph cache that depends on a font engine.
+        class GlyphRasterizer : public Object
+        {
+        public:
+            GlyphRasterizer() = default;
+            GlyphRasterizer(const GlyphRasterizer& other) = delete;
+            GlyphRasterizer(GlyphRasterizer&& other) = delete;
+            GlyphRasterizer& operator=(const GlyphRasterizer& other) = delete;
+            GlyphRasterizer& operator=(GlyphRasterizer&& other) = delete;
+            ~GlyphRasterizer() override = default;
+
+            //Rasterize a glyph at "size" pixels per em. It may be called from
+            //any thread, but never from two at once.
+            virtual GlyphImage Rasterize(std::uint32_t font_id, std::uint32_t glyph_index, float size) = 0;
+        };
+
+        //A rasterizer drawing every glyph as a box ring whose width depends
+        //on the glyph index, so glyph caching is deterministic without fonts.
+        class StubGlyphRasterizer : public GlyphRasterizer
+        {
+        public:
+            StubGlyphRasterizer() = default;
+            StubGlyphRasterizer(const StubGlyphRasterizer& other) = delete;
+            StubGlyphRasterizer(StubGlyphRasterizer&& other) = delete;
+            StubGlyphRasterizer& operator=(const StubGlyphRasterizer& other) = delete;
+            StubGlyphRasterizer& operator=(StubGlyphRasterizer&& other) = delete;
+            ~StubGlyphRasterizer() override = default;
+
+            GlyphImage Rasterize(std::uint32_t font_id, std::uint32_t glyph_index, float size) override;
+        };
+
+        enum class GlyphMode
+        {
+            //Coverage at the requested size.
+            Coverage,
+            //A signed distance field at a fixed size, scaled when drawn.
+            SignedDistance
+        };
+
+        struct GlyphKey
+        {
+            std::uint32_t font_id = 0;
+            std::uint32_t glyph_index = 0;
+            //Pixels per em. It is ignored by "SignedDistance".
+            float size = 0.0f;
+            GlyphMode mode = GlyphMode::Coverage;
+        };
+
+        //Where a glyph is in the atlas.
+        struct GlyphLocation
+        {
+            int page = 0;
+            PackedRect rect;
+            //Offset of the top-left pixel from the pen position on the baseline.
+            int origin_x = 0;
+            int origin_y = 0;
+        };
+
+        //A texture of an atlas. Backends upload the dirty rect before drawing
+        //the glyphs on it.
+        struct GlyphAtlasPage
+        {
+            int width = 0;
+            int height = 0;
+            std::vector<std::uint8_t> pixels;
+            //Rect changed since "ClearDirtyRect", empty if none.
+            PackedRect dirty_rect;
+        };
+
+        struct GlyphAtlasStatistics
+        {
+            int glyph_count = 0;
+            int page_count = 0;
+            int rasterized_count = 0;
+            int evicted_page_count = 0;
+            //Glyphs that didn't fit even after evicting.
+            int failed_count = 0;
+            //Lookup tables kept, the current one and the ones replaced in
+            //this frame.
+            int table_count = 0;
+            std::size_t table_byte_size = 0;
+        };
+
+        //A cache that rasterizes each glyph once and packs it into pages of
+        //8-bit texture, coverage or signed distance. When the pages are full
+        //the least recently used page is cleared as a whole, which keeps the
+        //packing simple and the texture uploads large.
+        //
+        //"Find" takes no lock and can run on any thread, for example when
+        //shaping runs in parallel, but must not span a "BeginFrame", which
+        //frees the lookup tables replaced in the frame before. "Get",
+        //"BeginFrame" and the pages are for the thread that renders.
+        class GlyphAtlas : public Object
+        {
+        public:
+            static constexpr int default_page_size = 1024;
+            static constexpr int default_max_page_count = 4;
+            //Signed distance fields are rasterized at this size in pixels.
+            static constexpr float signed_distance_size = 32.0f;
+            static constexpr int signed_distance_spread = 4;
+            //Glyphs are apart by this many pixels, so sampling doesn't bleed.
+            static constexpr int padding = 1;
+
+        public:
+            //"rasterizer" must outlive the atlas.
+            explicit GlyphAtlas(GlyphRasterizer* rasterizer, int page_size = default_page_size, int max_page_count = default_max_page_count);
+            GlyphAtlas(const GlyphAtlas& other) = delete;
+            GlyphAtlas(GlyphAtlas&& other) = delete;
+            GlyphAtlas& operator=(const GlyphAtlas& other) = delete;
+            GlyphAtlas& operator=(GlyphAtlas&& other) = delete;
+            ~GlyphAtlas() override;
+
+            //Start a frame. Pages used in the current frame are never evicted.
+            //No "Find" may run during it.
+            void BeginFrame();
+
+            //Find a cached glyph without locking. Return false if it is not
+            //cached or was evicted.
+            bool Find(const GlyphKey& key, GlyphLocation& location) const;
+
+            //Find a glyph, rasterizing and packing it if missing. Return false
+            //if it can't be cached, because it is larger than a page or all
+            //pages are used in this frame.
+            bool Get(const GlyphKey& key, GlyphLocation& location);
+
+            int GetMaxPageCount() const
+            {
+                return max_page_count_;
+            }
+
+            //The page is empty before any glyph is packed into it.
+            const GlyphAtlasPage& GetPage(int index) const;
+
+            void ClearDirtyRect(int index);
+
+            GlyphAtlasStatistics GetStatistics() const;
+
+        private:
+            class Table;
+            struct PageState;
+
+            static void NormalizeKey(GlyphKey& key);
+
+            //Find room for a rect, evicting a page if needed. Return the
+            //page index or -1.
+            int Pack(int width, int height, PackedRect& rect);
+
+            void EvictPage(int index);
+
+        private:
+            GlyphRasterizer* rasterizer_;
+            int page_size_;
+            int max_page_count_;
+
+            std::unique_ptr<PageState[]> pages_;
+            std::atomic<Table*> table_;
+            //The last is the current one. Replaced tables are kept until the
+            //next frame, as a reader may still probe them.
+            std::vector<std::unique_ptr<Table>> tables_;
+            std::atomic<std::uint64_t> frame_{ 1 };
+
+            //Serializes "Get" with other writers.
+            mutable std::mutex mutex_;
+            GlyphAtlasStatistics statistics_;
+        };
+    }
+}
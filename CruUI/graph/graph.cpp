@@ -23,7 +23,7 @@ namespace cru {
             swap_chain_desc.SampleDesc.Count = 1;                // don't use multi-sampling
             swap_chain_desc.SampleDesc.Quality = 0;
             swap_chain_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-            swap_chain_desc.BufferCount = 2;                     // use double buffering to enable flip
+            swap_chain_desc.BufferCount = buffer_count;          // use double buffering to enable flip
             swap_chain_desc.Scaling = DXGI_SCALING_NONE;
             swap_chain_desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL; // all apps must use this SwapEffect
             swap_chain_desc.Flags = 0;
@@ -86,6 +86,22 @@ namespace cru {
             );
         }
 
+        void WindowRenderTarget::Present(const std::vector<RECT>& dirty_rects)
+		{
+            if (dirty_rects.empty())
+            {
+                Present();
+                return;
+            }
+
+            DXGI_PRESENT_PARAMETERS parameters = { 0 };
+            parameters.DirtyRectsCount = static_cast<UINT>(dirty_rects.size());
+            parameters.pDirtyRects = const_cast<RECT*>(dirty_rects.data());
+            ThrowIfFailed(
+                dxgi_swap_chain_->Present1(1, 0, &parameters)
+            );
+        }
+
         void WindowRenderTarget::CreateTargetBitmap()
 		{
             // Direct2D needs the dxgi version of the backbuffer surface pointer.
@@ -2,8 +2,10 @@
 
 #include "system_headers.h"
 #include <memory>
+#include <vector>
 
 #include "base.h"
+#include "graph/d2d_painter.h"
 
 
 namespace cru
@@ -15,6 +17,11 @@ namespace cru
         //Represents a window render target.
         class WindowRenderTarget : public Object
 		{
+        public:
+            //Count of buffers in the swap chain. The content of a buffer is
+            //from this count of frames ago when it is drawn again.
+            static constexpr int buffer_count = 2;
+
         public:
             WindowRenderTarget(GraphManager* graph_manager, HWND hwnd);
             WindowRenderTarget(const WindowRenderTarget& other) = delete;
@@ -48,6 +55,10 @@ namespace cru
             //Present the data of the underlying buffer to the window.
             void Present();
 
+            //Present only "dirty_rects" in pixel. The rest of the buffer must
+            //be the same as the last presented one.
+            void Present(const std::vector<RECT>& dirty_rects);
+
         private:
             void CreateTargetBitmap();
 
@@ -94,6 +105,13 @@ namespace cru
                 return dxgi_factory_;
             }
 
+            //Get the brushes and geometries shared by all windows, which
+            //draw with the same device context.
+            D2DResourceCache* GetResourceCache()
+            {
+                return &resource_cache_;
+            }
+
             //Create a window render target with the HWND.
             std::shared_ptr<WindowRenderTarget> CreateWindowRenderTarget(HWND hwnd);
 
@@ -111,6 +129,7 @@ namespace cru
             Microsoft::WRL::ComPtr<ID2D1DeviceContext> d2d1_device_context_;
             Microsoft::WRL::ComPtr<IDXGIFactory2> dxgi_factory_;
             Microsoft::WRL::ComPtr<IDWriteFactory> dwrite_factory_;
+            D2DResourceCache resource_cache_;
         };
 
         int DipToPixelX(float dip_x);
@@ -0,0 +1,117 @@
+#include "image_compare.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
+#if defined(CRU_IMAGE_COMPARE_SCALAR)
+#define CRU_IMAGE_COMPARE_KERNEL_SCALAR
+#elif defined(__AVX2__)
+#define CRU_IMAGE_COMPARE_KERNEL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CRU_IMAGE_COMPARE_KERNEL_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CRU_IMAGE_COMPARE_KERNEL_NEON
+#include <arm_neon.h>
+#else
+#define CRU_IMAGE_COMPARE_KERNEL_SCALAR
+#endif
+
+namespace cru
+{
+    namespace graph
+    {
+        //Count of set bits of a 4-bit mask.
+        constexpr int nibble_bit_counts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+        //Compare "count" pixels and add the result to "difference".
+        inline void ComparePixelsHelperFunc(const std::uint32_t* left, const std::uint32_t* right, const int count,
+            const int tolerance, ImageDifference& difference)
+        {
+            auto i = 0;
+            auto different_count = 0;
+            auto max_difference = 0;
+            // lanes hold the channel differences, and a pixel differs if a
+            // channel is still nonzero after the tolerance is subtracted.
+#if defined(CRU_IMAGE_COMPARE_KERNEL_AVX2)
+            const auto vector_tolerance = _mm256_set1_epi8(static_cast<char>(tolerance));
+            auto vector_max = _mm256_setzero_si256();
+            for (; i + 8 <= count; i += 8)
+            {
+                const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+                const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+                const auto channel_difference = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+                vector_max = _mm256_max_epu8(vector_max, channel_difference);
+                const auto same = _mm256_cmpeq_epi32(_mm256_subs_epu8(channel_difference, vector_tolerance), _mm256_setzero_si256());
+                const auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(same));
+                different_count += 8 - nibble_bit_counts[mask & 0xF] - nibble_bit_counts[mask >> 4];
+            }
+            alignas(32) std::uint8_t max_bytes[32];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(max_bytes), vector_max);
+            max_difference = *std::max_element(max_bytes, max_bytes + 32);
+#elif defined(CRU_IMAGE_COMPARE_KERNEL_SSE2)
+            const auto vector_tolerance = _mm_set1_epi8(static_cast<char>(tolerance));
+            auto vector_max = _mm_setzero_si128();
+            for (; i + 4 <= count; i += 4)
+            {
+                const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+                const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+                const auto channel_difference = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+                vector_max = _mm_max_epu8(vector_max, channel_difference);
+                const auto same = _mm_cmpeq_epi32(_mm_subs_epu8(channel_difference, vector_tolerance), _mm_setzero_si128());
+                different_count += 4 - nibble_bit_counts[_mm_movemask_ps(_mm_castsi128_ps(same))];
+            }
+            alignas(16) std::uint8_t max_bytes[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(max_bytes), vector_max);
+            max_difference = *std::max_element(max_bytes, max_bytes + 16);
+#elif defined(CRU_IMAGE_COMPARE_KERNEL_NEON)
+            const auto vector_tolerance = vdupq_n_u8(static_cast<std::uint8_t>(tolerance));
+            auto vector_max = vdupq_n_u8(0);
+            auto vector_count = vdupq_n_u32(0);
+            for (; i + 4 <= count; i += 4)
+            {
+                const auto a = vreinterpretq_u8_u32(vld1q_u32(left + i));
+                const auto b = vreinterpretq_u8_u32(vld1q_u32(right + i));
+                const auto channel_difference = vabdq_u8(a, b);
+                vector_max = vmaxq_u8(vector_max, channel_difference);
+                const auto over = vreinterpretq_u32_u8(vqsubq_u8(channel_difference, vector_tolerance));
+                vector_count = vaddq_u32(vector_count, vshrq_n_u32(vtstq_u32(over, over), 31));
+            }
+            different_count = static_cast<int>(vaddvq_u32(vector_count));
+            max_difference = vmaxvq_u8(vector_max);
+#endif
+            for (; i < count; i++)
+            {
+                auto is_different = false;
+                for (auto shift = 0; shift < 32; shift += 8)
+                {
+                    const auto channel_difference = std::abs(static_cast<int>((left[i] >> shift) & 0xFF) - static_cast<int>((right[i] >> shift) & 0xFF));
+                    max_difference = std::max(max_difference, channel_difference);
+                    is_different = is_different || channel_difference > tolerance;
+                }
+                if (is_different)
+                    different_count++;
+            }
+
+            difference.different_pixel_count += different_count;
+            difference.max_channel_difference = std::max(difference.max_channel_difference, max_difference);
+        }
+
+        ImageDifference CompareBitmaps(const Bitmap& left, const Bitmap& right, const int tolerance)
+        {
+            if (left.GetWidth() != right.GetWidth() || left.GetHeight() != right.GetHeight())
+                throw std::invalid_argument("Bitmaps to compare must have the same size.");
+
+            // rows have no padding, so the pixels are compared in one run.
+            ImageDifference difference;
+            const auto& left_pixels = left.GetPixels();
+            const auto& right_pixels = right.GetPixels();
+            ComparePixelsHelperFunc(left_pixels.data(), right_pixels.data(), static_cast<int>(left_pixels.size()),
+                std::min(std::max(tolerance, 0), 255), difference);
+            return difference;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "bitmap.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //Result of comparing two bitmaps.
+        struct ImageDifference
+        {
+            //Count of pixels with a channel differing more than the tolerance.
+            int different_pixel_count = 0;
+            //Largest difference of a channel over all pixels, 0 to 255.
+            int max_channel_difference = 0;
+
+            bool IsSame() const
+            {
+                return different_pixel_count == 0;
+            }
+        };
+
+        //Compare two bitmaps of the same size channel by channel. A pixel is
+        //counted different if any of its channels differs by more than
+        //"tolerance", so anti-aliasing noise can be ignored in pixel tests.
+        //It runs 16 bytes at a time with sse2 or neon where available.
+        //Throw std::invalid_argument if the sizes differ.
+        ImageDifference CompareBitmaps(const Bitmap& left, const Bitmap& right, int tolerance = 0);
+    }
+}
@@ -0,0 +1,506 @@
+#include "line_break.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "line_break_table.h"
+
+#if defined(CRU_LINE_BREAK_SCALAR)
+#define CRU_LINE_BREAK_KERNEL_SCALAR
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CRU_LINE_BREAK_KERNEL_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CRU_LINE_BREAK_KERNEL_NEON
+#include <arm_neon.h>
+#else
+#define CRU_LINE_BREAK_KERNEL_SCALAR
+#endif
+
+namespace cru
+{
+    namespace graph
+    {
+        //Set on OP and CP that LB30 doesn't apply to, and on ID that LB30b does.
+        constexpr std::uint8_t exception_flag = 0x40;
+        constexpr std::uint8_t class_mask = 0x3F;
+        //Pair tables are indexed by a class with the flag.
+        constexpr int pair_table_size = 128;
+
+        inline std::uint8_t GetClassValueHelperFunc(const std::uint32_t code_point)
+        {
+            constexpr auto block_mask = (1u << line_break_block_shift) - 1;
+            if (code_point < 0x40000)
+                return line_break_blocks[line_break_block_indices[code_point >> line_break_block_shift] << line_break_block_shift | (code_point & block_mask)];
+            if (code_point >= 0xE0000 && code_point < 0xE1000)
+                return line_break_blocks[line_break_block_indices[(0x40000 + code_point - 0xE0000) >> line_break_block_shift] << line_break_block_shift | (code_point & block_mask)];
+            return static_cast<std::uint8_t>(LineBreakClass::AL);
+        }
+
+        LineBreakClass GetLineBreakClass(const std::uint32_t code_point)
+        {
+            return static_cast<LineBreakClass>(GetClassValueHelperFunc(code_point) & class_mask);
+        }
+
+        //Pairs of classes with no break between them, "before" in rows and
+        //"after" in bits.
+        struct PairTable
+        {
+            std::uint64_t no_break[pair_table_size][2];
+            std::uint64_t decided[pair_table_size][2];
+
+            bool IsNoBreak(const std::uint8_t before, const std::uint8_t after) const
+            {
+                return (no_break[before][after >> 6] >> (after & 63) & 1) != 0;
+            }
+        };
+
+        //A set of classes, each matching with and without the flag.
+        using ClassList = std::initializer_list<LineBreakClass>;
+
+        inline void SetPairHelperFunc(PairTable& table, const int before, const int after, const bool is_no_break)
+        {
+            const auto bit = std::uint64_t(1) << (after & 63);
+            if (table.decided[before][after >> 6] & bit)
+                return;
+            table.decided[before][after >> 6] |= bit;
+            if (is_no_break)
+                table.no_break[before][after >> 6] |= bit;
+        }
+
+        //Decide the pairs of "before" and "after" that are not decided yet
+        //by rules of higher precedence. An empty list matches all. Classes
+        //with the flag match only if it is in the flag mask.
+        inline void SetPairsHelperFunc(PairTable& table, const ClassList before, const ClassList after, const bool is_no_break,
+            const std::uint8_t before_flag_mask = exception_flag, const std::uint8_t after_flag_mask = exception_flag)
+        {
+            const auto matches = [](const ClassList list, const int value, const std::uint8_t flag_mask) {
+                if ((value & exception_flag) & ~flag_mask)
+                    return false;
+                if (list.size() == 0)
+                    return true;
+                return std::find(list.begin(), list.end(), static_cast<LineBreakClass>(value & class_mask)) != list.end();
+            };
+            for (auto b = 0; b < pair_table_size; b++)
+                if (matches(before, b, before_flag_mask))
+                    for (auto a = 0; a < pair_table_size; a++)
+                        if (matches(after, a, after_flag_mask))
+                            SetPairHelperFunc(table, b, a, is_no_break);
+        }
+
+        //Rules LB11 to LB13, which hold after spaces too.
+        inline PairTable MakeBeforeSpacesTableHelperFunc()
+        {
+            using C = LineBreakClass;
+            PairTable table{};
+            SetPairsHelperFunc(table, {}, { C::WJ }, true);
+            SetPairsHelperFunc(table, { C::WJ }, {}, true);
+            SetPairsHelperFunc(table, { C::GL }, {}, true);
+            for (auto b = 0; b <= static_cast<int>(C::RI); b++)
+            {
+                const auto before = static_cast<C>(b);
+                if (before != C::SP && before != C::BA && before != C::HY)
+                    SetPairsHelperFunc(table, { before }, { C::GL }, true);
+            }
+            SetPairsHelperFunc(table, {}, { C::CL, C::CP, C::EX, C::IS, C::SY }, true);
+            return table;
+        }
+
+        //Rules LB19 to LB30b that only look at a pair, in the order of
+        //precedence. LB21a and LB30a look further back and are not here.
+        inline PairTable MakeAfterSpacesTableHelperFunc()
+        {
+            using C = LineBreakClass;
+            PairTable table{};
+            SetPairsHelperFunc(table, {}, { C::QU }, true);
+            SetPairsHelperFunc(table, { C::QU }, {}, true);
+            SetPairsHelperFunc(table, {}, { C::CB }, false);
+            SetPairsHelperFunc(table, { C::CB }, {}, false);
+            SetPairsHelperFunc(table, {}, { C::BA, C::HY, C::NS }, true);
+            SetPairsHelperFunc(table, { C::BB }, {}, true);
+            SetPairsHelperFunc(table, { C::SY }, { C::HL }, true);
+            SetPairsHelperFunc(table, {}, { C::IN }, true);
+            SetPairsHelperFunc(table, { C::AL, C::HL }, { C::NU }, true);
+            SetPairsHelperFunc(table, { C::NU }, { C::AL, C::HL }, true);
+            SetPairsHelperFunc(table, { C::PR }, { C::ID, C::EB, C::EM }, true);
+            SetPairsHelperFunc(table, { C::ID, C::EB, C::EM }, { C::PO }, true);
+            SetPairsHelperFunc(table, { C::PR, C::PO }, { C::AL, C::HL }, true);
+            SetPairsHelperFunc(table, { C::AL, C::HL }, { C::PR, C::PO }, true);
+            SetPairsHelperFunc(table, { C::CL, C::CP, C::NU }, { C::PO, C::PR }, true);
+            SetPairsHelperFunc(table, { C::PO, C::PR }, { C::OP, C::NU }, true);
+            SetPairsHelperFunc(table, { C::HY, C::IS, C::NU, C::SY }, { C::NU }, true);
+            SetPairsHelperFunc(table, { C::JL }, { C::JL, C::JV, C::H2, C::H3 }, true);
+            SetPairsHelperFunc(table, { C::JV, C::H2 }, { C::JV, C::JT }, true);
+            SetPairsHelperFunc(table, { C::JT, C::H3 }, { C::JT }, true);
+            SetPairsHelperFunc(table, { C::JL, C::JV, C::JT, C::H2, C::H3 }, { C::PO }, true);
+            SetPairsHelperFunc(table, { C::PR }, { C::JL, C::JV, C::JT, C::H2, C::H3 }, true);
+            SetPairsHelperFunc(table, { C::AL, C::HL }, { C::AL, C::HL }, true);
+            SetPairsHelperFunc(table, { C::IS }, { C::AL, C::HL }, true);
+            // east asian wide brackets have the flag and are left out.
+            SetPairsHelperFunc(table, { C::AL, C::HL, C::NU }, { C::OP }, true, exception_flag, 0);
+            SetPairsHelperFunc(table, { C::CP }, { C::AL, C::HL, C::NU }, true, 0, exception_flag);
+            SetPairsHelperFunc(table, { C::EB }, { C::EM }, true);
+            // unassigned pictographs are ID with the flag.
+            SetPairHelperFunc(table, static_cast<int>(C::ID) | exception_flag, static_cast<int>(C::EM), true);
+            return table;
+        }
+
+        struct PairTables
+        {
+            PairTable before_spaces;
+            PairTable after_spaces;
+        };
+
+        inline const PairTables& GetPairTablesHelperFunc()
+        {
+            static const PairTables tables{ MakeBeforeSpacesTableHelperFunc(), MakeAfterSpacesTableHelperFunc() };
+            return tables;
+        }
+
+        inline bool IsClassHelperFunc(const std::uint8_t value, const LineBreakClass line_break_class)
+        {
+            return (value & class_mask) == static_cast<std::uint8_t>(line_break_class);
+        }
+
+        //What the rules need to know about the text before a position.
+        struct BreakState
+        {
+            //Class of the last character, with the flag, after LB9 and LB10.
+            std::uint8_t previous;
+            //Class of the last character that is not a space, for LB8 and
+            //LB14 to LB17.
+            std::uint8_t before_spaces;
+            //Count of regional indicators at the end, for LB30a.
+            int regional_indicator_count;
+            //The last character is HY or BA after HL, for LB21a.
+            bool is_hebrew_hyphen;
+            //The last code point is ZWJ, for LB8a.
+            bool is_after_zwj;
+        };
+
+        //Make the state after a character whose class is enough to know it,
+        //or return false. Scanning can start after such a character.
+        inline bool MakeLocalStateHelperFunc(const std::uint8_t value, BreakState& state)
+        {
+            using C = LineBreakClass;
+            for (const auto line_break_class : { C::CM, C::ZWJ, C::SP, C::HY, C::BA, C::RI })
+                if (IsClassHelperFunc(value, line_break_class))
+                    return false;
+            state = BreakState{ value, value, 0, false, false };
+            return true;
+        }
+
+        //Decide the break before a character of class "value" and update
+        //"state" to after it. "is_start" is true for the first one, which is
+        //never broken before.
+        inline LineBreakKind BreakHelperFunc(BreakState& state, std::uint8_t value, const bool is_start)
+        {
+            using C = LineBreakClass;
+            const auto& tables = GetPairTablesHelperFunc();
+            const auto previous = state.previous;
+            const auto is_zwj = IsClassHelperFunc(value, C::ZWJ);
+
+            auto kind = LineBreakKind::Allowed;
+            auto is_attached = false;
+            if (is_start)
+                kind = LineBreakKind::None;
+            // LB4, LB5
+            else if (IsClassHelperFunc(previous, C::CR) && IsClassHelperFunc(value, C::LF))
+                kind = LineBreakKind::None;
+            else if (IsClassHelperFunc(previous, C::BK) || IsClassHelperFunc(previous, C::CR) || IsClassHelperFunc(previous, C::LF) || IsClassHelperFunc(previous, C::NL))
+                kind = LineBreakKind::Mandatory;
+            // LB6, LB7
+            else if (IsClassHelperFunc(value, C::BK) || IsClassHelperFunc(value, C::CR) || IsClassHelperFunc(value, C::LF) ||
+                IsClassHelperFunc(value, C::NL) || IsClassHelperFunc(value, C::SP) || IsClassHelperFunc(value, C::ZW))
+                kind = LineBreakKind::None;
+            // LB8
+            else if (IsClassHelperFunc(state.before_spaces, C::ZW))
+                kind = LineBreakKind::Allowed;
+            // LB8a
+            else if (state.is_after_zwj)
+            {
+                kind = LineBreakKind::None;
+                is_attached = (IsClassHelperFunc(value, C::CM) || is_zwj) && !IsClassHelperFunc(previous, C::SP);
+            }
+            // LB9, marks take the class of what they follow.
+            else if ((IsClassHelperFunc(value, C::CM) || is_zwj) && !IsClassHelperFunc(previous, C::SP))
+            {
+                kind = LineBreakKind::None;
+                is_attached = true;
+            }
+            else
+            {
+                // LB10
+                if (IsClassHelperFunc(value, C::CM) || is_zwj)
+                    value = static_cast<std::uint8_t>(C::AL);
+
+                const auto before_spaces = state.before_spaces;
+                if (tables.before_spaces.IsNoBreak(previous, value))
+                    kind = LineBreakKind::None;
+                // LB14 to LB17
+                else if (IsClassHelperFunc(before_spaces, C::OP) ||
+                    (IsClassHelperFunc(before_spaces, C::QU) && IsClassHelperFunc(value, C::OP)) ||
+                    ((IsClassHelperFunc(before_spaces, C::CL) || IsClassHelperFunc(before_spaces, C::CP)) && IsClassHelperFunc(value, C::NS)) ||
+                    (IsClassHelperFunc(before_spaces, C::B2) && IsClassHelperFunc(value, C::B2)))
+                    kind = LineBreakKind::None;
+                // LB18
+                else if (IsClassHelperFunc(previous, C::SP))
+                    kind = LineBreakKind::Allowed;
+                else if (tables.after_spaces.IsNoBreak(previous, value))
+                    kind = LineBreakKind::None;
+                // LB20 is the only rule breaking before LB21a and LB30a.
+                else if (!IsClassHelperFunc(previous, C::CB) && !IsClassHelperFunc(value, C::CB) &&
+                    (state.is_hebrew_hyphen || (IsClassHelperFunc(previous, C::RI) && IsClassHelperFunc(value, C::RI) && state.regional_indicator_count % 2 == 1)))
+                    kind = LineBreakKind::None;
+            }
+
+            state.is_after_zwj = is_zwj;
+            if (is_attached)
+                return kind;
+            // LB10 also for marks after hard breaks and zero width spaces.
+            if (IsClassHelperFunc(value, C::CM) || is_zwj)
+                value = static_cast<std::uint8_t>(C::AL);
+
+            state.is_hebrew_hyphen = (IsClassHelperFunc(value, C::HY) || IsClassHelperFunc(value, C::BA)) && IsClassHelperFunc(previous, C::HL) && !is_start;
+            state.regional_indicator_count = IsClassHelperFunc(value, C::RI) ? (IsClassHelperFunc(previous, C::RI) && !is_start ? state.regional_indicator_count + 1 : 1) : 0;
+            state.previous = value;
+            if (!IsClassHelperFunc(value, C::SP))
+                state.before_spaces = value;
+            return kind;
+        }
+
+        //Decode the code point at "index" and return the count of its code units.
+        inline int DecodeHelperFunc(const String& text, const int index, std::uint32_t& code_point)
+        {
+            code_point = static_cast<std::uint32_t>(text[index]);
+            if (sizeof(wchar_t) == 2 && code_point >= 0xD800 && code_point < 0xDC00 && index + 1 < static_cast<int>(text.size()))
+            {
+                const auto low = static_cast<std::uint32_t>(text[index + 1]);
+                if (low >= 0xDC00 && low < 0xE000)
+                {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                    return 2;
+                }
+            }
+            return 1;
+        }
+
+        //Return the index of the first code unit of the code point ending
+        //right before "end".
+        inline int GetCodePointBeginHelperFunc(const String& text, const int end)
+        {
+            if (sizeof(wchar_t) == 2 && end >= 2)
+            {
+                const auto low = static_cast<std::uint32_t>(text[end - 1]);
+                const auto high = static_cast<std::uint32_t>(text[end - 2]);
+                if (low >= 0xDC00 && low < 0xE000 && high >= 0xD800 && high < 0xDC00)
+                    return end - 2;
+            }
+            return end - 1;
+        }
+
+        //Return true if the code unit is an ASCII or Latin-1 letter or digit,
+        //all of which are AL or NU.
+        inline bool IsAlphanumericHelperFunc(const wchar_t c)
+        {
+            const auto value = static_cast<std::uint32_t>(c);
+            const auto lower = value | 0x20;
+            return lower - L'a' < 26 || value - L'0' < 10 || (lower - 0xE0 < 0x20 && lower != 0xF7) || value == 0xAA || value == 0xB5 || value == 0xBA;
+        }
+
+        //Return the length of the run of code units from "begin" that are
+        //ASCII or Latin-1 letters or digits, between which lines never break.
+        inline int GetAlphanumericRunLengthHelperFunc(const wchar_t* begin, const wchar_t* end)
+        {
+            // most words are shorter than two vectors, so vectors only go on
+            // after the first few code units.
+            auto current = begin;
+            constexpr auto scalar_count = static_cast<int>(32 / sizeof(wchar_t));
+            for (const auto scalar_end = end - current > scalar_count ? current + scalar_count : end; current != scalar_end; current++)
+                if (!IsAlphanumericHelperFunc(*current))
+                    return static_cast<int>(current - begin);
+#if defined(CRU_LINE_BREAK_KERNEL_SSE2)
+            constexpr auto lane_count = static_cast<int>(16 / sizeof(wchar_t));
+            while (end - current >= lane_count)
+            {
+                const auto units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+                __m128i is_alphanumeric;
+                if (sizeof(wchar_t) == 2)
+                {
+                    // unsigned "x - low <= high - low" is "subs(x - low, high - low) == 0".
+                    const auto lower = _mm_or_si128(units, _mm_set1_epi16(0x20));
+                    const auto zero = _mm_setzero_si128();
+                    const auto is_letter = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(lower, _mm_set1_epi16(L'a')), _mm_set1_epi16(25)), zero);
+                    const auto is_digit = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(units, _mm_set1_epi16(L'0')), _mm_set1_epi16(9)), zero);
+                    const auto is_latin = _mm_andnot_si128(_mm_cmpeq_epi16(lower, _mm_set1_epi16(0xF7)),
+                        _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(lower, _mm_set1_epi16(0xE0)), _mm_set1_epi16(0x1F)), zero));
+                    is_alphanumeric = _mm_or_si128(_mm_or_si128(is_letter, is_digit), is_latin);
+                }
+                else
+                {
+                    // code points are positive as 32-bit integers, so signed compares work.
+                    const auto in_range = [](const __m128i value, const int low, const int high) {
+                        return _mm_and_si128(_mm_cmpgt_epi32(value, _mm_set1_epi32(low - 1)), _mm_cmplt_epi32(value, _mm_set1_epi32(high + 1)));
+                    };
+                    const auto lower = _mm_or_si128(units, _mm_set1_epi32(0x20));
+                    const auto is_latin = _mm_andnot_si128(_mm_cmpeq_epi32(lower, _mm_set1_epi32(0xF7)), in_range(lower, 0xE0, 0xFF));
+                    is_alphanumeric = _mm_or_si128(_mm_or_si128(in_range(lower, L'a', L'z'), in_range(units, L'0', L'9')), is_latin);
+                }
+                if (_mm_movemask_epi8(is_alphanumeric) != 0xFFFF)
+                    break;
+                current += lane_count;
+            }
+#elif defined(CRU_LINE_BREAK_KERNEL_NEON)
+            if (sizeof(wchar_t) == 2)
+            {
+                const auto data = reinterpret_cast<const std::uint16_t*>(begin);
+                for (; end - current >= 8; current += 8)
+                {
+                    const auto units = vld1q_u16(data + (current - begin));
+                    const auto lower = vorrq_u16(units, vdupq_n_u16(0x20));
+                    const auto is_letter = vcleq_u16(vsubq_u16(lower, vdupq_n_u16(L'a')), vdupq_n_u16(25));
+                    const auto is_digit = vcleq_u16(vsubq_u16(units, vdupq_n_u16(L'0')), vdupq_n_u16(9));
+                    const auto is_latin = vbicq_u16(vcleq_u16(vsubq_u16(lower, vdupq_n_u16(0xE0)), vdupq_n_u16(0x1F)), vceqq_u16(lower, vdupq_n_u16(0xF7)));
+                    if (vminvq_u16(vorrq_u16(vorrq_u16(is_letter, is_digit), is_latin)) != 0xFFFF)
+                        break;
+                }
+            }
+            else
+            {
+                const auto data = reinterpret_cast<const std::uint32_t*>(begin);
+                for (; end - current >= 4; current += 4)
+                {
+                    const auto units = vld1q_u32(data + (current - begin));
+                    const auto lower = vorrq_u32(units, vdupq_n_u32(0x20));
+                    const auto is_letter = vcleq_u32(vsubq_u32(lower, vdupq_n_u32(L'a')), vdupq_n_u32(25));
+                    const auto is_digit = vcleq_u32(vsubq_u32(units, vdupq_n_u32(L'0')), vdupq_n_u32(9));
+                    const auto is_latin = vbicq_u32(vcleq_u32(vsubq_u32(lower, vdupq_n_u32(0xE0)), vdupq_n_u32(0x1F)), vceqq_u32(lower, vdupq_n_u32(0xF7)));
+                    if (vminvq_u32(vorrq_u32(vorrq_u32(is_letter, is_digit), is_latin)) != 0xFFFFFFFF)
+                        break;
+                }
+            }
+#endif
+            while (current != end && IsAlphanumericHelperFunc(*current))
+                current++;
+            return static_cast<int>(current - begin);
+        }
+
+        //Decide the breaks before the code points from "index" with "state"
+        //being the one before it, until "end" or until "stop" returns true
+        //for the index after a code point and its class. Return the index
+        //scanning stopped at.
+        template <typename Stop>
+        int ScanHelperFunc(const String& text, int index, const int end, BreakState& state, bool is_start, std::vector<LineBreakKind>& breaks, Stop&& stop)
+        {
+            using C = LineBreakClass;
+            const auto data = text.data();
+            while (index < end)
+            {
+                // letters and digits after a letter or digit never break.
+                if ((IsClassHelperFunc(state.previous, C::AL) || IsClassHelperFunc(state.previous, C::NU)) && !state.is_after_zwj && !is_start)
+                {
+                    // a space between words is LB7 before it and LB18 after it.
+                    if (data[index] == L' ' && index + 1 < end && IsAlphanumericHelperFunc(data[index + 1]))
+                    {
+                        breaks[index] = LineBreakKind::None;
+                        breaks[index + 1] = LineBreakKind::Allowed;
+                        const auto value = static_cast<std::uint8_t>(static_cast<std::uint32_t>(data[index + 1]) - L'0' < 10 ? C::NU : C::AL);
+                        state = BreakState{ value, value, 0, false, false };
+                        index += 2;
+                        if (stop(index, value))
+                            return index;
+                        continue;
+                    }
+                    const auto length = GetAlphanumericRunLengthHelperFunc(data + index, data + end);
+                    if (length > 0)
+                    {
+                        std::fill(breaks.begin() + index, breaks.begin() + index + length, LineBreakKind::None);
+                        const auto last = static_cast<std::uint32_t>(data[index + length - 1]);
+                        const auto value = static_cast<std::uint8_t>(last - L'0' < 10 ? C::NU : C::AL);
+                        state = BreakState{ value, value, 0, false, false };
+                        index += length;
+                        if (stop(index, value))
+                            return index;
+                        continue;
+                    }
+                }
+
+                std::uint32_t code_point;
+                const auto length = DecodeHelperFunc(text, index, code_point);
+                const auto value = GetClassValueHelperFunc(code_point);
+                breaks[index] = BreakHelperFunc(state, value, is_start);
+                if (length == 2)
+                    breaks[index + 1] = LineBreakKind::None;
+                is_start = false;
+                index += length;
+                if (stop(index, value))
+                    return index;
+            }
+            return index;
+        }
+
+        void FindLineBreaks(const String& text, std::vector<LineBreakKind>& breaks)
+        {
+            const auto size = static_cast<int>(text.size());
+            breaks.resize(size + 1);
+            BreakState state{};
+            ScanHelperFunc(text, 0, size, state, true, breaks, [](int, std::uint8_t) {
+                return false;
+            });
+            // LB3
+            breaks[size] = LineBreakKind::Mandatory;
+        }
+
+        int UpdateLineBreaks(const String& text, const int begin, const int removed_count, const int inserted_count, std::vector<LineBreakKind>& breaks)
+        {
+            const auto size = static_cast<int>(text.size());
+            if (begin < 0 || removed_count < 0 || inserted_count < 0 || begin + inserted_count > size ||
+                static_cast<int>(breaks.size()) != size - inserted_count + removed_count + 1)
+                throw std::invalid_argument("Edit of the text doesn't match the breaks.");
+
+            // the breaks after the edit move with the text.
+            const auto old_end = begin + removed_count;
+            const auto new_end = begin + inserted_count;
+            if (inserted_count > removed_count)
+                breaks.insert(breaks.begin() + old_end, inserted_count - removed_count, LineBreakKind::None);
+            else
+                breaks.erase(breaks.begin() + new_end, breaks.begin() + old_end);
+
+            // scanning starts after a code point whose class alone gives the
+            // state, so the breaks before it can't change.
+            auto start = begin;
+            BreakState state{};
+            auto is_start = true;
+            while (start > 0)
+            {
+                const auto previous_begin = GetCodePointBeginHelperFunc(text, start);
+                std::uint32_t code_point;
+                DecodeHelperFunc(text, previous_begin, code_point);
+                if (MakeLocalStateHelperFunc(GetClassValueHelperFunc(code_point), state))
+                {
+                    is_start = false;
+                    break;
+                }
+                start = previous_begin;
+            }
+
+            // after the edit such a code point gives the old state again, so
+            // the breaks from there on don't change.
+            const auto end = ScanHelperFunc(text, start, size, state, is_start, breaks, [new_end](const int index, const std::uint8_t value) {
+                BreakState local_state;
+                return index > new_end && MakeLocalStateHelperFunc(value, local_state);
+            });
+            if (end < size)
+            {
+                // the break before the next code point depends on the state only.
+                std::uint32_t code_point;
+                DecodeHelperFunc(text, end, code_point);
+                BreakState next_state = state;
+                breaks[end] = BreakHelperFunc(next_state, GetClassValueHelperFunc(code_point), false);
+            }
+            breaks[size] = LineBreakKind::Mandatory;
+            return end - start;
+        }
+    }
+}
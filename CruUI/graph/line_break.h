@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "base.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //Line breaking classes of Unicode Standard Annex #14, after the
+        //resolution of rule LB1: AI, SG and XX are AL, SA is CM or AL by the
+        //general category, and CJ is NS.
+        enum class LineBreakClass : std::uint8_t
+        {
+            BK, CR, LF, NL, CM, ZWJ, WJ, ZW, GL, SP,
+            B2, BA, BB, HY, CB, CL, CP, EX, IN, NS,
+            OP, QU, IS, NU, PO, PR, SY, AL, HL, EB,
+            EM, H2, H3, ID, JL, JV, JT, RI
+        };
+
+        //Get the class of a code point by the tables of Unicode 15.0.
+        LineBreakClass GetLineBreakClass(std::uint32_t code_point);
+
+        enum class LineBreakKind : std::uint8_t
+        {
+            //Lines can't break here.
+            None,
+            //Lines may break here when they are too long.
+            Allowed,
+            //A line always ends here, after a line feed for example.
+            Mandatory
+        };
+
+        //Find where lines may break in "text" by the default rules of
+        //Unicode Standard Annex #14, replacing the content of "breaks" with
+        //"text.size() + 1" kinds, where the kind at "i" is for the break
+        //before the code unit at "i". The one at the end is always
+        //"Mandatory". Code units are utf-16 where wchar_t is 16 bits and
+        //utf-32 otherwise.
+        //Runs of ASCII and Latin-1 letters and digits, which never break
+        //inside, are skipped with sse2 or neon where available.
+        void FindLineBreaks(const String& text, std::vector<LineBreakKind>& breaks);
+
+        //Update "breaks" of a text after the code units in [begin, begin +
+        //removed_count) were replaced by "inserted_count" ones, where "text"
+        //is the new text. Only the code units around the edit whose breaks
+        //may change are scanned, from the last one before the edit that
+        //doesn't depend on earlier text to the first such one after it.
+        //Return the count of code units scanned.
+        int UpdateLineBreaks(const String& text, int begin, int removed_count, int inserted_count, std::vector<LineBreakKind>& breaks);
+    }
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "base.h"
+#include "ui/ui_base.h"
+#include "ui/matrix.h"
+#include "path.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        struct Color
+        {
+            constexpr Color() = default;
+            constexpr Color(const float r, const float g, const float b, const float a = 1.0f)
+                : r(r), g(g), b(b), a(a) { }
+
+            //Make a color from "0xRRGGBB".
+            static constexpr Color FromRgb(const std::uint32_t rgb, const float a = 1.0f)
+            {
+                return Color(
+                    static_cast<float>((rgb >> 16) & 0xFF) / 255.0f,
+                    static_cast<float>((rgb >> 8) & 0xFF) / 255.0f,
+                    static_cast<float>(rgb & 0xFF) / 255.0f,
+                    a
+                );
+            }
+
+            float r = 0.0f;
+            float g = 0.0f;
+            float b = 0.0f;
+            float a = 1.0f;
+        };
+
+        constexpr bool operator == (const Color& left, const Color& right)
+        {
+            return left.r == right.r && left.g == right.g && left.b == right.b && left.a == right.a;
+        }
+
+        constexpr bool operator != (const Color& left, const Color& right)
+        {
+            return !(left == right);
+        }
+
+        struct GradientStop
+        {
+            //Position in [0, 1] along the gradient.
+            float position;
+            Color color;
+        };
+
+        inline bool operator == (const GradientStop& left, const GradientStop& right)
+        {
+            return left.position == right.position && left.color == right.color;
+        }
+
+        enum class BrushType
+        {
+            Solid,
+            LinearGradient
+        };
+
+        //What a shape is filled with. It is a value type, and a color
+        //converts to a solid brush.
+        class Brush
+        {
+        public:
+            Brush(const Color& color = Color()) : type_(BrushType::Solid), color_(color) { }
+
+            //Make a gradient along the line from "start" to "end", in the
+            //coordinates of the shape. Colors beyond the ends extend the
+            //first and last stops. "stops" should be sorted by position.
+            static Brush LinearGradient(const ui::Point& start, const ui::Point& end, std::vector<GradientStop> stops)
+            {
+                Brush brush;
+                brush.type_ = BrushType::LinearGradient;
+                brush.start_ = start;
+                brush.end_ = end;
+                brush.stops_ = std::move(stops);
+                return brush;
+            }
+
+            BrushType GetType() const
+            {
+                return type_;
+            }
+
+            //Get the color of a solid brush.
+            const Color& GetColor() const
+            {
+                return color_;
+            }
+
+            const ui::Point& GetStart() const
+            {
+                return start_;
+            }
+
+            const ui::Point& GetEnd() const
+            {
+                return end_;
+            }
+
+            const std::vector<GradientStop>& GetStops() const
+            {
+                return stops_;
+            }
+
+            friend bool operator == (const Brush& left, const Brush& right)
+            {
+                if (left.type_ != right.type_)
+                    return false;
+                if (left.type_ == BrushType::Solid)
+                    return left.color_ == right.color_;
+                return left.start_ == right.start_ && left.end_ == right.end_ && left.stops_ == right.stops_;
+            }
+
+        private:
+            BrushType type_;
+            Color color_;
+            ui::Point start_{};
+            ui::Point end_{};
+            std::vector<GradientStop> stops_;
+        };
+
+        inline bool operator != (const Brush& left, const Brush& right)
+        {
+            return !(left == right);
+        }
+
+        //Content drawn offscreen by a painter. It outlives the painter and
+        //can be drawn by later painters of the same kind.
+        class Layer : public Object
+        {
+        public:
+            Layer() = default;
+            Layer(const Layer& other) = delete;
+            Layer(Layer&& other) = delete;
+            Layer& operator=(const Layer& other) = delete;
+            Layer& operator=(Layer&& other) = delete;
+            ~Layer() override = default;
+
+            //Get the size in units of the painter.
+            virtual ui::Size GetSize() const = 0;
+
+            //Get the memory the content takes in bytes.
+            virtual std::size_t GetByteSize() const = 0;
+        };
+
+        //The target of drawing commands, independent of any graphics api.
+        //Coordinates are transformed by the current transform.
+        class Painter : public Object
+        {
+        public:
+            Painter() = default;
+            Painter(const Painter& other) = delete;
+            Painter(Painter&& other) = delete;
+            Painter& operator=(const Painter& other) = delete;
+            Painter& operator=(Painter&& other) = delete;
+            ~Painter() override = default;
+
+            virtual ui::Matrix GetTransform() = 0;
+            virtual void SetTransform(const ui::Matrix& matrix) = 0;
+
+            virtual void FillRectangle(const ui::Rect& rect, const Brush& brush) = 0;
+            virtual void StrokeRectangle(const ui::Rect& rect, const Brush& brush, float width) = 0;
+            virtual void FillRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush) = 0;
+            virtual void StrokeRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush, float width) = 0;
+            virtual void FillPath(const Path& path, const Brush& brush) = 0;
+
+            //Fill a path drawn only once, such as one built for a frame, so a
+            //painter keeping resources by path doesn't keep it. It is filled
+            //as "FillPath" by default.
+            virtual void FillTransientPath(const Path& path, const Brush& brush)
+            {
+                FillPath(path, brush);
+            }
+
+            //Replace everything in the clip with the color.
+            virtual void Clear(const Color& color) = 0;
+
+            //Clip later commands to the rect until the matching "PopClip". The
+            //rect is transformed by the transform when pushed, and with a
+            //rotation the clip is the bounds of the transformed rect.
+            virtual void PushClip(const ui::Rect& rect) = 0;
+            virtual void PopClip() = 0;
+
+            //Create a transparent layer of at least "size". Return null if the
+            //painter doesn't support layers, which is the default.
+            virtual std::shared_ptr<Layer> CreateLayer(const ui::Size& size)
+            {
+                return nullptr;
+            }
+
+            //Draw into "layer", created by a painter of the same kind, with
+            //"action". The painter passed to it has the origin at the lefttop
+            //of the layer.
+            virtual void PaintLayer(Layer& layer, const std::function<void(Painter&)>& action) { }
+
+            //Draw "layer", created by a painter of the same kind, with its
+            //lefttop at "point" under the transform and the clips.
+            virtual void DrawLayer(const Layer& layer, const ui::Point& point) { }
+
+            //Return true if "layer" is created by a painter of the same kind,
+            //so it can be drawn. It is false by default.
+            virtual bool CanDrawLayer(const Layer& layer) const
+            {
+                return false;
+            }
+        };
+
+        //A painter that discards commands and only counts them, for running
+        //drawing code headless.
+        class NullPainter : public Painter
+        {
+        public:
+            NullPainter() = default;
+            NullPainter(const NullPainter& other) = delete;
+            NullPainter(NullPainter&& other) = delete;
+            NullPainter& operator=(const NullPainter& other) = delete;
+            NullPainter& operator=(NullPainter&& other) = delete;
+            ~NullPainter() override = default;
+
+            //Get the count of commands other than transform changes.
+            int GetCommandCount() const
+            {
+                return command_count_;
+            }
+
+            int GetClipDepth() const
+            {
+                return clip_depth_;
+            }
+
+            ui::Matrix GetTransform() override
+            {
+                return transform_;
+            }
+
+            void SetTransform(const ui::Matrix& matrix) override
+            {
+                transform_ = matrix;
+            }
+
+            void FillRectangle(const ui::Rect& rect, const Brush& brush) override
+            {
+                command_count_++;
+            }
+
+            void StrokeRectangle(const ui::Rect& rect, const Brush& brush, float width) override
+            {
+                command_count_++;
+            }
+
+            void FillRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush) override
+            {
+                command_count_++;
+            }
+
+            void StrokeRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush, float width) override
+            {
+                command_count_++;
+            }
+
+            void FillPath(const Path& path, const Brush& brush) override
+            {
+                command_count_++;
+            }
+
+            void Clear(const Color& color) override
+            {
+                command_count_++;
+            }
+
+            void PushClip(const ui::Rect& rect) override
+            {
+                command_count_++;
+                clip_depth_++;
+            }
+
+            void PopClip() override
+            {
+                command_count_++;
+                clip_depth_--;
+            }
+
+        private:
+            ui::Matrix transform_ = ui::Matrix::Identity();
+            int command_count_ = 0;
+            int clip_depth_ = 0;
+        };
+    }
+}
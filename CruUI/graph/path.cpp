@@ -0,0 +1,186 @@
+#include "path.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cru
+{
+    namespace graph
+    {
+        // the control point distance that makes a cubic bezier closest to a quarter of a circle.
+        constexpr float quarter_circle_kappa = 0.5522847498f;
+
+        inline int GetSegmentCountHelperFunc(const float deviation, const float tolerance)
+        {
+            // the flattening error of n segments is about deviation / (8 * n * n).
+            const auto count = std::ceil(std::sqrt(deviation / (8.0f * tolerance)));
+            return static_cast<int>(std::min(std::max(count, 1.0f), 256.0f));
+        }
+
+        inline float GetLengthHelperFunc(const ui::Point& vector)
+        {
+            return std::sqrt(vector.x * vector.x + vector.y * vector.y);
+        }
+
+        void Path::MoveTo(const ui::Point& point)
+        {
+            verbs_.push_back(Verb::Move);
+            points_.push_back(point);
+            figure_start_ = point;
+            is_figure_open_ = true;
+        }
+
+        void Path::LineTo(const ui::Point& point)
+        {
+            EnsureFigure();
+            verbs_.push_back(Verb::Line);
+            points_.push_back(point);
+        }
+
+        void Path::QuadraticTo(const ui::Point& control, const ui::Point& end)
+        {
+            EnsureFigure();
+            verbs_.push_back(Verb::Quadratic);
+            points_.push_back(control);
+            points_.push_back(end);
+        }
+
+        void Path::CubicTo(const ui::Point& control1, const ui::Point& control2, const ui::Point& end)
+        {
+            EnsureFigure();
+            verbs_.push_back(Verb::Cubic);
+            points_.push_back(control1);
+            points_.push_back(control2);
+            points_.push_back(end);
+        }
+
+        void Path::Close()
+        {
+            if (!is_figure_open_)
+                return;
+            verbs_.push_back(Verb::Close);
+            is_figure_open_ = false;
+        }
+
+        void Path::AddRectangle(const ui::Rect& rect)
+        {
+            MoveTo(ui::Point(rect.left, rect.top));
+            LineTo(ui::Point(rect.GetRight(), rect.top));
+            LineTo(ui::Point(rect.GetRight(), rect.GetBottom()));
+            LineTo(ui::Point(rect.left, rect.GetBottom()));
+            Close();
+        }
+
+        void Path::AddRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y)
+        {
+            radius_x = std::min(std::max(radius_x, 0.0f), rect.width / 2.0f);
+            radius_y = std::min(std::max(radius_y, 0.0f), rect.height / 2.0f);
+            if (radius_x == 0.0f || radius_y == 0.0f)
+            {
+                AddRectangle(rect);
+                return;
+            }
+
+            const auto left = rect.left, top = rect.top, right = rect.GetRight(), bottom = rect.GetBottom();
+            const auto kx = radius_x * quarter_circle_kappa, ky = radius_y * quarter_circle_kappa;
+
+            MoveTo(ui::Point(left + radius_x, top));
+            LineTo(ui::Point(right - radius_x, top));
+            CubicTo(ui::Point(right - radius_x + kx, top), ui::Point(right, top + radius_y - ky), ui::Point(right, top + radius_y));
+            LineTo(ui::Point(right, bottom - radius_y));
+            CubicTo(ui::Point(right, bottom - radius_y + ky), ui::Point(right - radius_x + kx, bottom), ui::Point(right - radius_x, bottom));
+            LineTo(ui::Point(left + radius_x, bottom));
+            CubicTo(ui::Point(left + radius_x - kx, bottom), ui::Point(left, bottom - radius_y + ky), ui::Point(left, bottom - radius_y));
+            LineTo(ui::Point(left, top + radius_y));
+            CubicTo(ui::Point(left, top + radius_y - ky), ui::Point(left + radius_x - kx, top), ui::Point(left + radius_x, top));
+            Close();
+        }
+
+        ui::Rect Path::GetBounds() const
+        {
+            if (points_.empty())
+                return ui::Rect();
+
+            auto left = points_.front().x, top = points_.front().y;
+            auto right = left, bottom = top;
+            for (const auto& point : points_)
+            {
+                left = std::min(left, point.x);
+                top = std::min(top, point.y);
+                right = std::max(right, point.x);
+                bottom = std::max(bottom, point.y);
+            }
+            return ui::Rect::FromVertices(left, top, right, bottom);
+        }
+
+        std::vector<std::vector<ui::Point>> Path::Flatten(const ui::Matrix& matrix, const float tolerance) const
+        {
+            std::vector<std::vector<ui::Point>> polygons;
+            auto point = points_.cbegin();
+            for (const auto verb : verbs_)
+            {
+                switch (verb)
+                {
+                case Verb::Move:
+                    polygons.emplace_back();
+                    polygons.back().push_back(matrix.TransformPoint(*point++));
+                    break;
+                case Verb::Line:
+                    polygons.back().push_back(matrix.TransformPoint(*point++));
+                    break;
+                case Verb::Quadratic:
+                {
+                    auto& polygon = polygons.back();
+                    const auto p0 = polygon.back();
+                    const auto p1 = matrix.TransformPoint(*point++);
+                    const auto p2 = matrix.TransformPoint(*point++);
+                    const auto count = GetSegmentCountHelperFunc(2.0f * GetLengthHelperFunc(p0 - p1 * 2.0f + p2), tolerance);
+                    for (auto i = 1; i <= count; i++)
+                    {
+                        const auto t = static_cast<float>(i) / count;
+                        const auto u = 1.0f - t;
+                        polygon.push_back(p0 * (u * u) + p1 * (2.0f * u * t) + p2 * (t * t));
+                    }
+                    break;
+                }
+                case Verb::Cubic:
+                {
+                    auto& polygon = polygons.back();
+                    const auto p0 = polygon.back();
+                    const auto p1 = matrix.TransformPoint(*point++);
+                    const auto p2 = matrix.TransformPoint(*point++);
+                    const auto p3 = matrix.TransformPoint(*point++);
+                    const auto deviation = 6.0f * std::max(
+                        GetLengthHelperFunc(p0 - p1 * 2.0f + p2),
+                        GetLengthHelperFunc(p1 - p2 * 2.0f + p3)
+                    );
+                    const auto count = GetSegmentCountHelperFunc(deviation, tolerance);
+                    for (auto i = 1; i <= count; i++)
+                    {
+                        const auto t = static_cast<float>(i) / count;
+                        const auto u = 1.0f - t;
+                        polygon.push_back(p0 * (u * u * u) + p1 * (3.0f * u * u * t) + p2 * (3.0f * u * t * t) + p3 * (t * t * t));
+                    }
+                    break;
+                }
+                case Verb::Close:
+                    break;
+                }
+            }
+            return polygons;
+        }
+
+        bool operator == (const Path& left, const Path& right)
+        {
+            return left.fill_rule_ == right.fill_rule_ && left.verbs_ == right.verbs_ &&
+                std::equal(left.points_.cbegin(), left.points_.cend(), right.points_.cbegin(), right.points_.cend());
+        }
+
+        void Path::EnsureFigure()
+        {
+            // a closed figure ends where it started.
+            if (!is_figure_open_)
+                MoveTo(figure_start_);
+        }
+    }
+}
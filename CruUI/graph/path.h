@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ui/ui_base.h"
+#include "ui/matrix.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //How the inside of a shape with crossing figures is decided.
+        enum class FillRule
+        {
+            //Inside if figures wind around the point a non-zero count of times.
+            NonZero,
+            //Inside if a ray from the point crosses figures an odd count of times.
+            EvenOdd
+        };
+
+        //A shape made of figures of lines and bezier curves. It is a value
+        //type.
+        class Path
+        {
+        public:
+            enum class Verb : std::uint8_t
+            {
+                //Takes 1 point.
+                Move,
+                //Takes 1 point.
+                Line,
+                //Takes 2 points: the control point and the end.
+                Quadratic,
+                //Takes 3 points: two control points and the end.
+                Cubic,
+                //Takes no point.
+                Close
+            };
+
+        public:
+            Path() = default;
+            Path(const Path& other) = default;
+            Path(Path&& other) = default;
+            Path& operator=(const Path& other) = default;
+            Path& operator=(Path&& other) = default;
+            ~Path() = default;
+
+            FillRule GetFillRule() const
+            {
+                return fill_rule_;
+            }
+
+            void SetFillRule(const FillRule fill_rule)
+            {
+                fill_rule_ = fill_rule;
+            }
+
+            //Start a new figure at "point".
+            void MoveTo(const ui::Point& point);
+            //The functions below start a figure at zero if none is started.
+            void LineTo(const ui::Point& point);
+            void QuadraticTo(const ui::Point& control, const ui::Point& end);
+            void CubicTo(const ui::Point& control1, const ui::Point& control2, const ui::Point& end);
+            //Close the current figure with a line to its start.
+            void Close();
+
+            //Add a closed figure of the rect, clockwise.
+            void AddRectangle(const ui::Rect& rect);
+            //Add a closed figure of the rect with elliptic corners, clockwise.
+            //Radii are limited to half of the size.
+            void AddRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y);
+
+            bool IsEmpty() const
+            {
+                return verbs_.empty();
+            }
+
+            const std::vector<Verb>& GetVerbs() const
+            {
+                return verbs_;
+            }
+
+            const std::vector<ui::Point>& GetPoints() const
+            {
+                return points_;
+            }
+
+            //Get the bounds of all points including control points, which
+            //contain the shape.
+            ui::Rect GetBounds() const;
+
+            //Transform the path by "matrix" and replace curves with lines at
+            //most "tolerance" away from them. Each figure becomes a polygon,
+            //implicitly closed.
+            std::vector<std::vector<ui::Point>> Flatten(const ui::Matrix& matrix, float tolerance) const;
+
+            friend bool operator == (const Path& left, const Path& right);
+
+        private:
+            void EnsureFigure();
+
+        private:
+            std::vector<Verb> verbs_;
+            std::vector<ui::Point> points_;
+            FillRule fill_rule_ = FillRule::NonZero;
+            ui::Point figure_start_ = ui::Point::zero;
+            bool is_figure_open_ = false;
+        };
+
+        bool operator == (const Path& left, const Path& right);
+
+        inline bool operator != (const Path& left, const Path& right)
+        {
+            return !(left == right);
+        }
+    }
+}
@@ -0,0 +1,379 @@
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace cru
+{
+    namespace graph
+    {
+        //Scale every channel of a pixel by "scale" / 256.
+        inline std::uint32_t ScalePixelHelperFunc(const std::uint32_t pixel, const std::uint32_t scale)
+        {
+            // two channels are scaled in one multiplication.
+            const auto rb = ((pixel & 0x00FF00FFu) * scale >> 8) & 0x00FF00FFu;
+            const auto ag = ((pixel >> 8) & 0x00FF00FFu) * scale & 0xFF00FF00u;
+            return rb | ag;
+        }
+
+        inline Color LerpColorHelperFunc(const Color& left, const Color& right, const float t)
+        {
+            return Color(
+                left.r + (right.r - left.r) * t,
+                left.g + (right.g - left.g) * t,
+                left.b + (right.b - left.b) * t,
+                left.a + (right.a - left.a) * t
+            );
+        }
+
+        inline Color GetGradientColorHelperFunc(const std::vector<GradientStop>& stops, const float position)
+        {
+            if (position <= stops.front().position)
+                return stops.front().color;
+            for (decltype(stops.size()) i = 1; i < stops.size(); i++)
+            {
+                const auto& stop = stops[i];
+                if (position < stop.position)
+                {
+                    const auto& previous = stops[i - 1];
+                    return LerpColorHelperFunc(previous.color, stop.color, (position - previous.position) / (stop.position - previous.position));
+                }
+            }
+            return stops.back().color;
+        }
+
+        PixelPaint::PixelPaint(const Brush& brush, const ui::Matrix& matrix)
+        {
+            if (brush.GetType() == BrushType::Solid)
+            {
+                solid_color_ = PackPremultipliedColor(brush.GetColor());
+                is_visible_ = solid_color_ >> 24 != 0;
+                return;
+            }
+
+            const auto& stops = brush.GetStops();
+            const auto inverse = matrix.GetInverse();
+            if (stops.empty() || !inverse.has_value())
+            {
+                is_visible_ = false;
+                return;
+            }
+
+            const auto start = brush.GetStart();
+            const auto direction = brush.GetEnd() - start;
+            const auto length_square = direction.x * direction.x + direction.y * direction.y;
+            if (length_square == 0.0f)
+            {
+                solid_color_ = PackPremultipliedColor(stops.back().color);
+                is_visible_ = solid_color_ >> 24 != 0;
+                return;
+            }
+
+            is_solid_ = false;
+            gradient_colors_.resize(256);
+            auto alpha = 0u;
+            for (auto i = 0; i < 256; i++)
+            {
+                gradient_colors_[i] = PackPremultipliedColor(GetGradientColorHelperFunc(stops, i / 255.0f));
+                alpha |= gradient_colors_[i] >> 24;
+            }
+            is_visible_ = alpha != 0;
+
+            // project the pixel center, mapped back to brush coordinates, on the gradient line.
+            const auto& m = inverse.value();
+            const auto origin = m.TransformPoint(ui::Point(0.5f, 0.5f)) - start;
+            t0_ = (origin.x * direction.x + origin.y * direction.y) / length_square;
+            tx_ = (m.m11 * direction.x + m.m12 * direction.y) / length_square;
+            ty_ = (m.m21 * direction.x + m.m22 * direction.y) / length_square;
+        }
+
+        PixelPaint::PixelPaint(std::shared_ptr<const Bitmap> image, const ui::Matrix& matrix)
+            : is_solid_(false), image_(std::move(image))
+        {
+            const auto inverse = matrix.GetInverse();
+            if (image_ == nullptr || image_->GetWidth() == 0 || image_->GetHeight() == 0 || !inverse.has_value())
+            {
+                is_visible_ = false;
+                is_solid_ = true;
+                image_ = nullptr;
+                return;
+            }
+
+            const auto& m = inverse.value();
+            const auto origin = m.TransformPoint(ui::Point(0.5f, 0.5f));
+            u0_ = origin.x;
+            ux_ = m.m11;
+            uy_ = m.m21;
+            v0_ = origin.y;
+            vx_ = m.m12;
+            vy_ = m.m22;
+        }
+
+        void PixelPaint::GetRow(const int x, const int y, const int count, std::uint32_t* colors) const
+        {
+            if (is_solid_)
+            {
+                std::fill(colors, colors + count, solid_color_);
+                return;
+            }
+
+            if (image_ != nullptr)
+            {
+                const auto width = image_->GetWidth();
+                const auto height = image_->GetHeight();
+                const auto row_u = u0_ + uy_ * static_cast<float>(y);
+                const auto row_v = v0_ + vy_ * static_cast<float>(y);
+                for (auto i = 0; i < count; i++)
+                {
+                    const auto u = std::floor(row_u + ux_ * static_cast<float>(x + i));
+                    const auto v = std::floor(row_v + vx_ * static_cast<float>(x + i));
+                    // out of the image is transparent.
+                    colors[i] = u >= 0.0f && v >= 0.0f && u < static_cast<float>(width) && v < static_cast<float>(height)
+                        ? image_->GetPixel(static_cast<int>(u), static_cast<int>(v)) : 0;
+                }
+                return;
+            }
+
+            const auto row_t = t0_ + ty_ * static_cast<float>(y);
+            for (auto i = 0; i < count; i++)
+            {
+                const auto t = row_t + tx_ * static_cast<float>(x + i);
+                const auto index = static_cast<int>(std::min(std::max(t * 255.0f + 0.5f, 0.0f), 255.0f));
+                colors[i] = gradient_colors_[index];
+            }
+        }
+
+        void EdgeList::Reset()
+        {
+            edges_.clear();
+            is_sorted_ = true;
+        }
+
+        void EdgeList::AddPolygon(const std::vector<ui::Point>& polygon)
+        {
+            AddPolygon(polygon.data(), static_cast<int>(polygon.size()));
+        }
+
+        void EdgeList::AddPolygon(const ui::Point* points, const int count)
+        {
+            for (auto i = 0; i < count; i++)
+            {
+                const auto& p0 = points[i];
+                const auto& p1 = points[i + 1 == count ? 0 : i + 1];
+                // horizontal edges don't cross any scanline.
+                if (p0.y == p1.y || !std::isfinite(p0.x) || !std::isfinite(p0.y) || !std::isfinite(p1.x) || !std::isfinite(p1.y))
+                    continue;
+
+                const auto& upper = p0.y < p1.y ? p0 : p1;
+                const auto& lower = p0.y < p1.y ? p1 : p0;
+                Edge edge;
+                edge.top = upper.y;
+                edge.bottom = lower.y;
+                edge.x = upper.x;
+                edge.slope = (lower.x - upper.x) / (lower.y - upper.y);
+                edge.left = std::min(p0.x, p1.x);
+                edge.winding = p0.y < p1.y ? 1 : -1;
+                edge.max_bottom = edge.bottom;
+
+                if (edges_.empty())
+                {
+                    left_ = std::min(p0.x, p1.x);
+                    right_ = std::max(p0.x, p1.x);
+                    top_ = edge.top;
+                    bottom_ = edge.bottom;
+                }
+                else
+                {
+                    left_ = std::min(left_, std::min(p0.x, p1.x));
+                    right_ = std::max(right_, std::max(p0.x, p1.x));
+                    top_ = std::min(top_, edge.top);
+                    bottom_ = std::max(bottom_, edge.bottom);
+                }
+                edges_.push_back(edge);
+                is_sorted_ = false;
+            }
+        }
+
+        ui::Rect EdgeList::GetBounds() const
+        {
+            if (edges_.empty())
+                return ui::Rect();
+            return ui::Rect::FromVertices(left_, top_, right_, bottom_);
+        }
+
+        void EdgeList::Sort()
+        {
+            if (is_sorted_)
+                return;
+            std::stable_sort(edges_.begin(), edges_.end(), [](const Edge& left, const Edge& right) {
+                return left.top < right.top;
+            });
+            auto max_bottom = edges_.front().bottom;
+            for (auto& edge : edges_)
+            {
+                max_bottom = std::max(max_bottom, edge.bottom);
+                edge.max_bottom = max_bottom;
+            }
+            is_sorted_ = true;
+        }
+
+        void Rasterizer::Fill(const EdgeList& edge_list, Bitmap& bitmap, const ui::Rect& clip, const FillRule fill_rule, const PixelPaint& paint, const CompositeMode mode)
+        {
+            if (!edge_list.IsSorted())
+                throw std::invalid_argument("Edges must be sorted before filling.");
+
+            const auto& edges = edge_list.edges_;
+            if (edges.empty() || (!paint.IsVisible() && mode == CompositeMode::SourceOver))
+                return;
+
+            const auto clip_left = std::max(clip.left, 0.0f);
+            const auto clip_top = std::max(clip.top, 0.0f);
+            const auto clip_right = std::min(clip.GetRight(), static_cast<float>(bitmap.GetWidth()));
+            const auto clip_bottom = std::min(clip.GetBottom(), static_cast<float>(bitmap.GetHeight()));
+            const auto area_top = std::max(edge_list.top_, clip_top);
+            const auto area_bottom = std::min(edge_list.bottom_, clip_bottom);
+            if (clip_left >= clip_right || area_top >= area_bottom || edge_list.left_ >= clip_right || edge_list.right_ <= clip_left)
+                return;
+
+            // spans are clamped to the clip, not to the shape, so a pixel's
+            // coverage doesn't depend on which part of the bitmap is filled.
+            clip_left_fixed_ = static_cast<int>(std::floor(clip_left * 256.0f + 0.5f));
+            clip_right_fixed_ = static_cast<int>(std::floor(clip_right * 256.0f + 0.5f));
+            const auto x_begin = clip_left_fixed_ >> 8;
+            const auto x_end = (clip_right_fixed_ + 255) >> 8;
+            const auto y_begin = static_cast<int>(std::floor(area_top));
+            const auto y_end = static_cast<int>(std::ceil(area_bottom));
+            const auto count = x_end - x_begin;
+
+            cover_.assign(count + 1, 0);
+            cover_delta_.assign(count + 1, 0);
+            colors_.resize(count);
+            active_edges_.clear();
+
+            const auto is_inside = [fill_rule](const int winding) {
+                return fill_rule == FillRule::NonZero ? winding != 0 : (winding & 1) != 0;
+            };
+
+            // edges all ending above the first row are never active, which
+            // saves scanning them again for every tile below a tall shape.
+            decltype(edges.size()) next_edge = std::partition_point(edges.cbegin(), edges.cend(), [y_begin](const Edge& edge) {
+                return edge.max_bottom <= static_cast<float>(y_begin);
+            }) - edges.cbegin();
+            for (auto y = y_begin; y < y_end; y++)
+            {
+                const auto row_top = static_cast<float>(y);
+                const auto row_bottom = static_cast<float>(y + 1);
+                while (next_edge < edges.size() && edges[next_edge].top < row_bottom)
+                {
+                    // edges right of the clip are dropped, and a span still
+                    // open at the end of a sub-scanline is closed at the clip.
+                    const auto& edge = edges[next_edge];
+                    if (edge.bottom > row_top && edge.left < clip_right + 1.0f)
+                        active_edges_.push_back(&edge);
+                    next_edge++;
+                }
+                active_edges_.erase(std::remove_if(active_edges_.begin(), active_edges_.end(), [row_top](const Edge* edge) {
+                    return edge->bottom <= row_top;
+                }), active_edges_.end());
+                if (active_edges_.empty())
+                    continue;
+
+                touched_begin_ = count;
+                touched_end_ = 0;
+                for (auto s = 0; s < sub_scanline_count; s++)
+                {
+                    const auto sample_y = row_top + (static_cast<float>(s) + 0.5f) / sub_scanline_count;
+                    if (sample_y < clip_top || sample_y >= clip_bottom)
+                        continue;
+
+                    crossings_.clear();
+                    for (const auto edge : active_edges_)
+                        if (edge->top <= sample_y && sample_y < edge->bottom)
+                            crossings_.push_back(Crossing{ edge->x + (sample_y - edge->top) * edge->slope, edge->winding });
+                    if (crossings_.empty())
+                        continue;
+
+                    std::sort(crossings_.begin(), crossings_.end(), [](const Crossing& left, const Crossing& right) {
+                        return left.x < right.x;
+                    });
+
+                    auto winding = 0;
+                    auto span_left = 0.0f;
+                    for (const auto& crossing : crossings_)
+                    {
+                        const auto was_inside = is_inside(winding);
+                        winding += crossing.winding;
+                        const auto now_inside = is_inside(winding);
+                        if (!was_inside && now_inside)
+                            span_left = crossing.x;
+                        else if (was_inside && !now_inside)
+                            AddSpan(span_left, crossing.x, x_begin);
+                    }
+                    if (is_inside(winding))
+                        AddSpan(span_left, clip_right, x_begin);
+                }
+                if (touched_begin_ >= touched_end_)
+                    continue;
+
+                const auto touched_count = touched_end_ - touched_begin_;
+                paint.GetRow(x_begin + touched_begin_, y, touched_count, colors_.data() + touched_begin_);
+                auto pixel = bitmap.GetRow(y) + x_begin;
+                auto run = 0;
+                for (auto i = touched_begin_; i < touched_end_; i++)
+                {
+                    run += cover_delta_[i];
+                    const auto cover = run + cover_[i];
+                    cover_delta_[i] = 0;
+                    cover_[i] = 0;
+                    if (cover <= 0)
+                        continue;
+
+                    // 16 sub-scanlines of 256 each make 4096 for a full pixel.
+                    const auto coverage = static_cast<std::uint32_t>(std::min((cover + 8) >> 4, 256));
+                    const auto source = colors_[i];
+                    if (mode == CompositeMode::Source)
+                        pixel[i] = ScalePixelHelperFunc(source, coverage) + ScalePixelHelperFunc(pixel[i], 256 - coverage);
+                    else if (coverage == 256 && source >> 24 == 0xFF)
+                        pixel[i] = source;
+                    else
+                    {
+                        const auto scaled = ScalePixelHelperFunc(source, coverage);
+                        pixel[i] = scaled + ScalePixelHelperFunc(pixel[i], 256 - (scaled >> 24));
+                    }
+                }
+                cover_delta_[touched_end_] = 0;
+                cover_[touched_end_] = 0;
+            }
+        }
+
+        void Rasterizer::AddSpan(float left, float right, const int x_begin)
+        {
+            const auto clip_left = static_cast<float>(clip_left_fixed_) / 256.0f;
+            const auto clip_right = static_cast<float>(clip_right_fixed_) / 256.0f;
+            left = std::min(std::max(left, clip_left), clip_right);
+            right = std::min(std::max(right, clip_left), clip_right);
+
+            const auto left_fixed = static_cast<int>(std::floor(left * 256.0f + 0.5f));
+            const auto right_fixed = static_cast<int>(std::floor(right * 256.0f + 0.5f));
+            if (left_fixed >= right_fixed)
+                return;
+
+            const auto left_index = (left_fixed >> 8) - x_begin;
+            const auto right_index = (right_fixed >> 8) - x_begin;
+            touched_begin_ = std::min(touched_begin_, left_index);
+            // the pixel of the right end is touched even if it gets no coverage.
+            touched_end_ = std::max(touched_end_, std::min(right_index + 1, static_cast<int>(cover_.size()) - 1));
+            if (left_index == right_index)
+            {
+                cover_[left_index] += right_fixed - left_fixed;
+                return;
+            }
+
+            cover_[left_index] += 256 - (left_fixed & 0xFF);
+            cover_delta_[left_index + 1] += 256;
+            cover_delta_[right_index] -= 256;
+            cover_[right_index] += right_fixed & 0xFF;
+        }
+    }
+}
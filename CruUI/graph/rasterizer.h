@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bitmap.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //How covered pixels are combined with the pixels in the bitmap.
+        enum class CompositeMode
+        {
+            //Blend over the pixels.
+            SourceOver,
+            //Replace the pixels, blending only partly covered ones.
+            Source
+        };
+
+        //A brush resolved for filling pixels.
+        class PixelPaint
+        {
+        public:
+            //"matrix" maps the coordinates of the brush to pixels.
+            PixelPaint(const Brush& brush, const ui::Matrix& matrix);
+            //Paint the nearest pixels of "image". "matrix" maps pixels of the
+            //image to pixels of the target.
+            PixelPaint(std::shared_ptr<const Bitmap> image, const ui::Matrix& matrix);
+
+            //Return false if nothing would be drawn.
+            bool IsVisible() const
+            {
+                return is_visible_;
+            }
+
+            //Get the premultiplied colors at the centers of "count" pixels
+            //from (x, y).
+            void GetRow(int x, int y, int count, std::uint32_t* colors) const;
+
+        private:
+            bool is_visible_ = true;
+            bool is_solid_ = true;
+            std::uint32_t solid_color_ = 0;
+            //The gradient position of a pixel center is "t0 + tx * x + ty * y".
+            float t0_ = 0.0f;
+            float tx_ = 0.0f;
+            float ty_ = 0.0f;
+            //Colors at 256 positions of the gradient.
+            std::vector<std::uint32_t> gradient_colors_;
+            //The image pixel of a pixel center is "u0 + ux * x + uy * y" and
+            //"v0 + vx * x + vy * y".
+            std::shared_ptr<const Bitmap> image_;
+            float u0_ = 0.0f, ux_ = 0.0f, uy_ = 0.0f;
+            float v0_ = 0.0f, vx_ = 0.0f, vy_ = 0.0f;
+        };
+
+        //Edges of closed polygons in pixel coordinates, to be filled by a
+        //rasterizer. It is a value type, and filling doesn't change it, so
+        //one list can be filled by many threads.
+        class EdgeList
+        {
+            friend class Rasterizer;
+        public:
+            EdgeList() = default;
+            EdgeList(const EdgeList& other) = default;
+            EdgeList(EdgeList&& other) = default;
+            EdgeList& operator=(const EdgeList& other) = default;
+            EdgeList& operator=(EdgeList&& other) = default;
+            ~EdgeList() = default;
+
+            //Remove all edges but keep the memory.
+            void Reset();
+
+            void AddPolygon(const std::vector<ui::Point>& polygon);
+            void AddPolygon(const ui::Point* points, int count);
+
+            bool IsEmpty() const
+            {
+                return edges_.empty();
+            }
+
+            //Get the bounds of the edges.
+            ui::Rect GetBounds() const;
+
+            //Sort the edges from top to bottom, which filling requires.
+            void Sort();
+
+            bool IsSorted() const
+            {
+                return is_sorted_;
+            }
+
+        private:
+            struct Edge
+            {
+                float top;
+                float bottom;
+                //The x at "top".
+                float x;
+                float slope;
+                float left;
+                //1 if the edge goes down, -1 if it goes up.
+                int winding;
+                //The greatest bottom of this edge and the edges before it
+                //once sorted.
+                float max_bottom;
+            };
+
+        private:
+            std::vector<Edge> edges_;
+            float left_ = 0.0f, top_ = 0.0f, right_ = 0.0f, bottom_ = 0.0f;
+            bool is_sorted_ = true;
+        };
+
+        //Fills polygons into a bitmap with anti-aliasing. It only holds
+        //scratch memory, so every thread filling needs its own.
+        //
+        //Coverage is exact horizontally and sampled on 16 sub-scanlines
+        //vertically, and is accumulated in integers, so a pixel gets the
+        //same value however the bitmap is split into clips with integer
+        //bounds.
+        class Rasterizer
+        {
+        public:
+            static constexpr int sub_scanline_count = 16;
+
+        public:
+            Rasterizer() = default;
+            Rasterizer(const Rasterizer& other) = delete;
+            Rasterizer(Rasterizer&& other) = delete;
+            Rasterizer& operator=(const Rasterizer& other) = delete;
+            Rasterizer& operator=(Rasterizer&& other) = delete;
+            ~Rasterizer() = default;
+
+            //Fill the inside of "edges" within "clip", which is in pixels and
+            //may be fractional. "edges" must be sorted.
+            void Fill(const EdgeList& edges, Bitmap& bitmap, const ui::Rect& clip, FillRule fill_rule, const PixelPaint& paint,
+                CompositeMode mode = CompositeMode::SourceOver);
+
+        private:
+            using Edge = EdgeList::Edge;
+
+            struct Crossing
+            {
+                float x;
+                int winding;
+            };
+
+            void AddSpan(float left, float right, int x_begin);
+
+        private:
+            // scratch memory of "Fill".
+            std::vector<const Edge*> active_edges_;
+            std::vector<Crossing> crossings_;
+            //Coverage of single pixels, and differences of coverage of the
+            //full pixels between span ends.
+            std::vector<int> cover_;
+            std::vector<int> cover_delta_;
+            std::vector<std::uint32_t> colors_;
+            //Range of pixels in the row that spans touched.
+            int touched_begin_ = 0;
+            int touched_end_ = 0;
+            int clip_left_fixed_ = 0;
+            int clip_right_fixed_ = 0;
+        };
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include "lru_cache.h"
+#include "painter.h"
+#include "path.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        inline std::size_t HashCombine(const std::size_t seed, const std::size_t value)
+        {
+            return seed ^ (value + 0x9E3779B9u + (seed << 6) + (seed >> 2));
+        }
+
+        inline std::size_t HashColor(const Color& color)
+        {
+            const std::hash<float> hash_float;
+            auto hash = hash_float(color.r);
+            hash = HashCombine(hash, hash_float(color.g));
+            hash = HashCombine(hash, hash_float(color.b));
+            return HashCombine(hash, hash_float(color.a));
+        }
+
+        struct BrushHash
+        {
+            std::size_t operator()(const Brush& brush) const
+            {
+                const std::hash<float> hash_float;
+                auto hash = static_cast<std::size_t>(brush.GetType());
+                if (brush.GetType() == BrushType::Solid)
+                    return HashCombine(hash, HashColor(brush.GetColor()));
+                hash = HashCombine(hash, hash_float(brush.GetStart().x));
+                hash = HashCombine(hash, hash_float(brush.GetStart().y));
+                hash = HashCombine(hash, hash_float(brush.GetEnd().x));
+                hash = HashCombine(hash, hash_float(brush.GetEnd().y));
+                for (const auto& stop : brush.GetStops())
+                {
+                    hash = HashCombine(hash, hash_float(stop.position));
+                    hash = HashCombine(hash, HashColor(stop.color));
+                }
+                return hash;
+            }
+        };
+
+        struct PathHash
+        {
+            std::size_t operator()(const Path& path) const
+            {
+                const std::hash<float> hash_float;
+                auto hash = static_cast<std::size_t>(path.GetFillRule());
+                for (const auto verb : path.GetVerbs())
+                    hash = HashCombine(hash, static_cast<std::size_t>(verb));
+                for (const auto& point : path.GetPoints())
+                {
+                    hash = HashCombine(hash, hash_float(point.x));
+                    hash = HashCombine(hash, hash_float(point.y));
+                }
+                return hash;
+            }
+        };
+
+        //Counters of a resource cache since the frame began.
+        struct ResourceCacheStatistics
+        {
+            CacheStatistics brushes;
+            CacheStatistics geometries;
+        };
+
+        //Resources of a graphics backend created once per value describing
+        //them, brushes by "Brush" and geometries by "Path", and shared by all
+        //painters of the device. Each kind keeps at most a count of the most
+        //recently used ones.
+        //Resources are opaque handles to it.
+        template <typename BrushResource, typename GeometryResource>
+        class ResourceCache : public Object
+        {
+        public:
+            static constexpr int default_brush_capacity = 1024;
+            static constexpr int default_geometry_capacity = 256;
+
+        public:
+            explicit ResourceCache(const int brush_capacity = default_brush_capacity, const int geometry_capacity = default_geometry_capacity)
+                : brushes_(brush_capacity), geometries_(geometry_capacity) { }
+            ResourceCache(const ResourceCache& other) = delete;
+            ResourceCache(ResourceCache&& other) = delete;
+            ResourceCache& operator=(const ResourceCache& other) = delete;
+            ResourceCache& operator=(ResourceCache&& other) = delete;
+            ~ResourceCache() override = default;
+
+            //Get the resource of "brush", created by "create" if missing.
+            template <typename Create>
+            BrushResource GetBrush(const Brush& brush, Create&& create)
+            {
+                return Get(brushes_, brush, std::forward<Create>(create));
+            }
+
+            //Get the resource of "path", created by "create" if missing.
+            template <typename Create>
+            GeometryResource GetGeometry(const Path& path, Create&& create)
+            {
+                return Get(geometries_, path, std::forward<Create>(create));
+            }
+
+            int GetBrushCount() const
+            {
+                return brushes_.GetCount();
+            }
+
+            int GetGeometryCount() const
+            {
+                return geometries_.GetCount();
+            }
+
+            //Drop all resources, for example when the device is lost.
+            void Clear()
+            {
+                brushes_.Clear();
+                geometries_.Clear();
+            }
+
+            //Start counting the hits and misses of a frame.
+            void BeginFrame()
+            {
+                brushes_.ResetStatistics();
+                geometries_.ResetStatistics();
+            }
+
+            ResourceCacheStatistics GetFrameStatistics() const
+            {
+                return ResourceCacheStatistics{ brushes_.GetStatistics(), geometries_.GetStatistics() };
+            }
+
+        private:
+            template <typename Cache, typename Key, typename Create>
+            static auto Get(Cache& cache, const Key& key, Create&& create) -> decltype(create())
+            {
+                if (const auto resource = cache.Find(key))
+                    return *resource;
+                auto resource = create();
+                // every resource costs one, so the budget is a count.
+                cache.Add(key, resource, 1);
+                return resource;
+            }
+
+        private:
+            LruCache<Brush, BrushResource, BrushHash> brushes_;
+            LruCache<Path, GeometryResource, PathHash> geometries_;
+        };
+    }
+}
@@ -0,0 +1,100 @@
+#include "skyline_packer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace cru
+{
+    namespace graph
+    {
+        SkylinePacker::SkylinePacker(const int width, const int height)
+            : width_(width), height_(height)
+        {
+            if (width <= 0 || height <= 0)
+                throw std::invalid_argument("Packer size must be positive.");
+            Reset();
+        }
+
+        bool SkylinePacker::Pack(const int width, const int height, PackedRect& rect)
+        {
+            if (width <= 0 || height <= 0)
+                throw std::invalid_argument("Packed rect size must be positive.");
+
+            auto best_index = -1;
+            auto best_bottom = height_ + 1;
+            auto best_width = 0;
+            for (auto i = 0; i < static_cast<int>(skyline_.size()); i++)
+            {
+                const auto y = GetFitY(i, width);
+                if (y < 0 || y + height > height_)
+                    continue;
+                // the narrower segment wastes less of the row on ties.
+                if (y + height < best_bottom || (y + height == best_bottom && skyline_[i].width < best_width))
+                {
+                    best_index = i;
+                    best_bottom = y + height;
+                    best_width = skyline_[i].width;
+                }
+            }
+            if (best_index < 0)
+                return false;
+
+            rect = PackedRect{ skyline_[best_index].x, best_bottom - height, width, height };
+
+            // the new segment covers the ones under the rect, which are then
+            // cut or removed.
+            const auto right = rect.x + width;
+            skyline_.insert(skyline_.begin() + best_index, Segment{ rect.x, best_bottom, width });
+            auto i = best_index + 1;
+            while (i < static_cast<int>(skyline_.size()) && skyline_[i].x < right)
+            {
+                auto& segment = skyline_[i];
+                const auto segment_right = segment.x + segment.width;
+                if (segment_right <= right)
+                {
+                    used_area_ += static_cast<long long>(segment.width) * (best_bottom - segment.y);
+                    skyline_.erase(skyline_.begin() + i);
+                    continue;
+                }
+                used_area_ += static_cast<long long>(right - segment.x) * (best_bottom - segment.y);
+                segment.width = segment_right - right;
+                segment.x = right;
+                break;
+            }
+
+            // neighbors at the same height are merged to keep the list short.
+            for (auto j = 0; j + 1 < static_cast<int>(skyline_.size());)
+            {
+                if (skyline_[j].y == skyline_[j + 1].y)
+                {
+                    skyline_[j].width += skyline_[j + 1].width;
+                    skyline_.erase(skyline_.begin() + j + 1);
+                }
+                else
+                    j++;
+            }
+            return true;
+        }
+
+        void SkylinePacker::Reset()
+        {
+            skyline_.clear();
+            skyline_.push_back(Segment{ 0, 0, width_ });
+            used_area_ = 0;
+        }
+
+        int SkylinePacker::GetFitY(const int index, const int width) const
+        {
+            if (skyline_[index].x + width > width_)
+                return -1;
+            auto y = 0;
+            auto remaining_width = width;
+            for (auto i = index; remaining_width > 0; i++)
+            {
+                y = std::max(y, skyline_[i].y);
+                remaining_width -= skyline_[i].width;
+            }
+            return y;
+        }
+    }
+}
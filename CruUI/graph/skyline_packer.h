@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+namespace cru
+{
+    namespace graph
+    {
+        //A rect of whole pixels in a texture.
+        struct PackedRect
+        {
+            int x = 0;
+            int y = 0;
+            int width = 0;
+            int height = 0;
+        };
+
+        //Packs rects into a texture of fixed size by the skyline bottom-left
+        //rule: the top edge of the used area is kept as a list of segments,
+        //and a rect goes where its bottom is lowest. It suits glyphs, which
+        //are similar in height, and never moves packed rects.
+        class SkylinePacker
+        {
+        public:
+            SkylinePacker(int width, int height);
+            SkylinePacker(const SkylinePacker& other) = default;
+            SkylinePacker(SkylinePacker&& other) = default;
+            SkylinePacker& operator=(const SkylinePacker& other) = default;
+            SkylinePacker& operator=(SkylinePacker&& other) = default;
+            ~SkylinePacker() = default;
+
+            int GetWidth() const
+            {
+                return width_;
+            }
+
+            int GetHeight() const
+            {
+                return height_;
+            }
+
+            //Get the count of pixels under the skyline, used or wasted.
+            long long GetUsedArea() const
+            {
+                return used_area_;
+            }
+
+            //Find room for a rect of the size and reserve it. Return false if
+            //there is no room left.
+            bool Pack(int width, int height, PackedRect& rect);
+
+            //Free all the rects.
+            void Reset();
+
+        private:
+            struct Segment
+            {
+                int x;
+                int y;
+                int width;
+            };
+
+            //Return the lowest y a rect of "width" can be put at from the
+            //segment at "index", or -1 if it goes out of the texture.
+            int GetFitY(int index, int width) const;
+
+        private:
+            int width_;
+            int height_;
+            //Sorted by x, covering the width without gaps.
+            std::vector<Segment> skyline_;
+            long long used_area_ = 0;
+        };
+    }
+}
@@ -0,0 +1,162 @@
+#include "software_painter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace cru
+{
+    namespace graph
+    {
+        SoftwareLayer::SoftwareLayer(const int width, const int height)
+            : bitmap_(std::make_shared<Bitmap>(width, height))
+        {
+
+        }
+
+        ui::Size SoftwareLayer::GetSize() const
+        {
+            return ui::Size(static_cast<float>(bitmap_->GetWidth()), static_cast<float>(bitmap_->GetHeight()));
+        }
+
+        std::size_t SoftwareLayer::GetByteSize() const
+        {
+            return bitmap_->GetPixels().size() * sizeof(std::uint32_t);
+        }
+
+        inline const SoftwareLayer& CastLayerHelperFunc(const Layer& layer)
+        {
+            const auto software_layer = dynamic_cast<const SoftwareLayer*>(&layer);
+            if (software_layer == nullptr)
+                throw std::invalid_argument("The layer is not created by a software painter.");
+            return *software_layer;
+        }
+
+        SoftwarePainter::SoftwarePainter(Bitmap* bitmap)
+            : bitmap_(bitmap)
+        {
+            clips_.push_back(ui::Rect(0.0f, 0.0f, static_cast<float>(bitmap->GetWidth()), static_cast<float>(bitmap->GetHeight())));
+        }
+
+        void SoftwarePainter::FillRectangle(const ui::Rect& rect, const Brush& brush)
+        {
+            AddRectangle(rect);
+            FillShape(FillRule::NonZero, brush);
+        }
+
+        void SoftwarePainter::StrokeRectangle(const ui::Rect& rect, const Brush& brush, const float width)
+        {
+            // the stroke is centered on the outline.
+            const auto half = width / 2.0f;
+            AddRectangle(ui::Rect(rect.left - half, rect.top - half, rect.width + width, rect.height + width));
+            if (rect.width > width && rect.height > width)
+                AddRectangle(ui::Rect(rect.left + half, rect.top + half, rect.width - width, rect.height - width));
+            FillShape(FillRule::EvenOdd, brush);
+        }
+
+        void SoftwarePainter::FillRoundedRectangle(const ui::Rect& rect, const float radius_x, const float radius_y, const Brush& brush)
+        {
+            Path path;
+            path.AddRoundedRectangle(rect, radius_x, radius_y);
+            FillPath(path, brush);
+        }
+
+        void SoftwarePainter::StrokeRoundedRectangle(const ui::Rect& rect, const float radius_x, const float radius_y, const Brush& brush, const float width)
+        {
+            const auto half = width / 2.0f;
+            Path path;
+            path.SetFillRule(FillRule::EvenOdd);
+            path.AddRoundedRectangle(ui::Rect(rect.left - half, rect.top - half, rect.width + width, rect.height + width), radius_x + half, radius_y + half);
+            if (rect.width > width && rect.height > width)
+                path.AddRoundedRectangle(ui::Rect(rect.left + half, rect.top + half, rect.width - width, rect.height - width),
+                    std::max(radius_x - half, 0.0f), std::max(radius_y - half, 0.0f));
+            FillPath(path, brush);
+        }
+
+        void SoftwarePainter::FillPath(const Path& path, const Brush& brush)
+        {
+            for (const auto& polygon : path.Flatten(transform_, flatten_tolerance))
+                edges_.AddPolygon(polygon);
+            FillShape(path.GetFillRule(), brush);
+        }
+
+        void SoftwarePainter::Clear(const Color& color)
+        {
+            const auto clip = GetClip();
+            const ui::Point corners[] = {
+                ui::Point(clip.left, clip.top),
+                ui::Point(clip.GetRight(), clip.top),
+                ui::Point(clip.GetRight(), clip.GetBottom()),
+                ui::Point(clip.left, clip.GetBottom())
+            };
+            edges_.AddPolygon(corners, 4);
+            FillEdges(edges_, clip, FillRule::NonZero, PixelPaint(color, ui::Matrix::Identity()), CompositeMode::Source);
+            edges_.Reset();
+        }
+
+        void SoftwarePainter::PushClip(const ui::Rect& rect)
+        {
+            clips_.push_back(GetClip().Intersect(transform_.TransformBounds(rect)));
+        }
+
+        void SoftwarePainter::PopClip()
+        {
+            // the bottom one is never popped.
+            if (clips_.size() > 1)
+                clips_.pop_back();
+        }
+
+        std::shared_ptr<Layer> SoftwarePainter::CreateLayer(const ui::Size& size)
+        {
+            const auto width = static_cast<int>(std::ceil(size.width));
+            const auto height = static_cast<int>(std::ceil(size.height));
+            if (width <= 0 || height <= 0)
+                return nullptr;
+            return std::make_shared<SoftwareLayer>(width, height);
+        }
+
+        void SoftwarePainter::PaintLayer(Layer& layer, const std::function<void(Painter&)>& action)
+        {
+            // the layer is filled at once even by derived painters, since
+            // nothing else draws into it.
+            SoftwarePainter painter(CastLayerHelperFunc(layer).GetBitmap().get());
+            action(painter);
+        }
+
+        void SoftwarePainter::DrawLayer(const Layer& layer, const ui::Point& point)
+        {
+            const auto& bitmap = CastLayerHelperFunc(layer).GetBitmap();
+            AddRectangle(ui::Rect(point, layer.GetSize()));
+            FillEdges(edges_, GetClip(), FillRule::NonZero, PixelPaint(bitmap, ui::Matrix::Translation(point) * transform_), CompositeMode::SourceOver);
+            edges_.Reset();
+        }
+
+        bool SoftwarePainter::CanDrawLayer(const Layer& layer) const
+        {
+            return dynamic_cast<const SoftwareLayer*>(&layer) != nullptr;
+        }
+
+        void SoftwarePainter::AddRectangle(const ui::Rect& rect)
+        {
+            const ui::Point corners[] = {
+                transform_.TransformPoint(ui::Point(rect.left, rect.top)),
+                transform_.TransformPoint(ui::Point(rect.GetRight(), rect.top)),
+                transform_.TransformPoint(ui::Point(rect.GetRight(), rect.GetBottom())),
+                transform_.TransformPoint(ui::Point(rect.left, rect.GetBottom()))
+            };
+            edges_.AddPolygon(corners, 4);
+        }
+
+        void SoftwarePainter::FillShape(const FillRule fill_rule, const Brush& brush, const CompositeMode mode)
+        {
+            FillEdges(edges_, GetClip(), fill_rule, PixelPaint(brush, transform_), mode);
+            edges_.Reset();
+        }
+
+        void SoftwarePainter::FillEdges(EdgeList& edges, const ui::Rect& clip, const FillRule fill_rule, const PixelPaint& paint, const CompositeMode mode)
+        {
+            edges.Sort();
+            rasterizer_.Fill(edges, *bitmap_, clip, fill_rule, paint, mode);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "painter.h"
+#include "bitmap.h"
+#include "rasterizer.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        //A layer of a software painter. It is a bitmap, and one unit is one
+        //pixel.
+        class SoftwareLayer : public Layer
+        {
+        public:
+            SoftwareLayer(int width, int height);
+            SoftwareLayer(const SoftwareLayer& other) = delete;
+            SoftwareLayer(SoftwareLayer&& other) = delete;
+            SoftwareLayer& operator=(const SoftwareLayer& other) = delete;
+            SoftwareLayer& operator=(SoftwareLayer&& other) = delete;
+            ~SoftwareLayer() override = default;
+
+            //The bitmap is shared, so painters that fill later can keep it
+            //alive after the layer is gone.
+            const std::shared_ptr<Bitmap>& GetBitmap() const
+            {
+                return bitmap_;
+            }
+
+            ui::Size GetSize() const override;
+            std::size_t GetByteSize() const override;
+
+        private:
+            std::shared_ptr<Bitmap> bitmap_;
+        };
+
+        //A painter drawing into a bitmap on the cpu, with anti-aliasing.
+        //One unit is one pixel before the transform.
+        class SoftwarePainter : public Painter
+        {
+        public:
+            //Curves are replaced by lines at most this far away in pixels.
+            static constexpr float flatten_tolerance = 0.1f;
+
+        public:
+            //"bitmap" must outlive the painter.
+            explicit SoftwarePainter(Bitmap* bitmap);
+            SoftwarePainter(const SoftwarePainter& other) = delete;
+            SoftwarePainter(SoftwarePainter&& other) = delete;
+            SoftwarePainter& operator=(const SoftwarePainter& other) = delete;
+            SoftwarePainter& operator=(SoftwarePainter&& other) = delete;
+            ~SoftwarePainter() override = default;
+
+            Bitmap* GetBitmap() const
+            {
+                return bitmap_;
+            }
+
+            ui::Matrix GetTransform() override
+            {
+                return transform_;
+            }
+
+            void SetTransform(const ui::Matrix& matrix) override
+            {
+                transform_ = matrix;
+            }
+
+            void FillRectangle(const ui::Rect& rect, const Brush& brush) override;
+            void StrokeRectangle(const ui::Rect& rect, const Brush& brush, float width) override;
+            void FillRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush) override;
+            void StrokeRoundedRectangle(const ui::Rect& rect, float radius_x, float radius_y, const Brush& brush, float width) override;
+            void FillPath(const Path& path, const Brush& brush) override;
+            void Clear(const Color& color) override;
+            void PushClip(const ui::Rect& rect) override;
+            void PopClip() override;
+
+            std::shared_ptr<Layer> CreateLayer(const ui::Size& size) override;
+            void PaintLayer(Layer& layer, const std::function<void(Painter&)>& action) override;
+            void DrawLayer(const Layer& layer, const ui::Point& point) override;
+            bool CanDrawLayer(const Layer& layer) const override;
+
+        protected:
+            //Fill "edges" in pixels within "clip", which is in pixels too.
+            //Derived painters may take "edges" to fill them later.
+            virtual void FillEdges(EdgeList& edges, const ui::Rect& clip, FillRule fill_rule, const PixelPaint& paint, CompositeMode mode);
+
+        private:
+            //Get the clip in pixels.
+            ui::Rect GetClip() const
+            {
+                return clips_.back();
+            }
+
+            void AddRectangle(const ui::Rect& rect);
+            void FillShape(FillRule fill_rule, const Brush& brush, CompositeMode mode = CompositeMode::SourceOver);
+
+        private:
+            Bitmap* bitmap_;
+            ui::Matrix transform_ = ui::Matrix::Identity();
+            //The bottom one is the whole bitmap.
+            std::vector<ui::Rect> clips_;
+            EdgeList edges_;
+            Rasterizer rasterizer_;
+        };
+    }
+}
@@ -0,0 +1,246 @@
+#include "text_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "resource_cache.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        inline bool IsWhiteSpaceHelperFunc(const wchar_t c)
+        {
+            return c == L' ' || c == L'\t' || c == L'\r' || c == L'\n';
+        }
+
+        //Return true if lines always break after the code unit. All such
+        //code points are single code units.
+        inline bool IsHardBreakHelperFunc(const wchar_t c)
+        {
+            const auto line_break_class = GetLineBreakClass(static_cast<std::uint32_t>(c));
+            return line_break_class == LineBreakClass::BK || line_break_class == LineBreakClass::CR ||
+                line_break_class == LineBreakClass::LF || line_break_class == LineBreakClass::NL;
+        }
+
+        FontMetrics StubTextShaper::GetMetrics(const TextFormat& format)
+        {
+            FontMetrics metrics;
+            metrics.ascent = format.size * 0.9f;
+            metrics.line_height = format.size * 1.2f;
+            return metrics;
+        }
+
+        void StubTextShaper::Shape(const String& text, const TextFormat& format, std::vector<ShapedGlyph>& glyphs)
+        {
+            glyphs.clear();
+            for (auto i = 0; i < static_cast<int>(text.size());)
+            {
+                ShapedGlyph glyph;
+                glyph.text_index = i;
+                auto code_point = static_cast<std::uint32_t>(text[i++]);
+                // utf-16 has surrogate pairs where wchar_t is 16 bits.
+                if (sizeof(wchar_t) == 2 && code_point >= 0xD800 && code_point < 0xDC00 && i < static_cast<int>(text.size()) &&
+                    text[i] >= 0xDC00 && text[i] < 0xE000)
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (static_cast<std::uint32_t>(text[i++]) - 0xDC00);
+                glyph.glyph_index = code_point;
+
+                if (code_point == L' ')
+                    glyph.advance = format.size * 0.3f;
+                else if (code_point == L'\t')
+                    glyph.advance = format.size * 1.2f;
+                else if (code_point == L'\r' || code_point == L'\n')
+                    glyph.advance = 0.0f;
+                else
+                    glyph.advance = format.size * (0.4f + 0.1f * (code_point % 5));
+                glyphs.push_back(glyph);
+            }
+        }
+
+        TextLayout::TextLayout(std::shared_ptr<const ShapedText> shaped_text, const float max_width)
+            : shaped_text_(std::move(shaped_text))
+        {
+            if (shaped_text_ == nullptr)
+                throw std::invalid_argument("Shaped text can't be null.");
+            if (std::isnan(max_width))
+                throw std::invalid_argument("Max width of a text layout can't be NaN.");
+
+            const auto& text = shaped_text_->text;
+            const auto& glyphs = shaped_text_->glyphs;
+            const auto& breaks = shaped_text_->breaks;
+            if (breaks.size() != text.size() + 1)
+                throw std::invalid_argument("Line breaks of shaped text don't match its text.");
+            const auto glyph_count = static_cast<int>(glyphs.size());
+            min_valid_width_ = -std::numeric_limits<float>::infinity();
+            max_valid_width_ = std::numeric_limits<float>::infinity();
+
+            // lines are filled with segments between breaks, each a word with
+            // the white space after it, which only counts if another segment
+            // follows.
+            auto line_begin = 0;
+            auto line_width = 0.0f;
+            auto line_trimmed_width = 0.0f;
+            auto line_segment_count = 0;
+            auto segment_begin = 0;
+            auto segment_width = 0.0f;
+            auto segment_trimmed_width = 0.0f;
+
+            const auto end_line = [&](const int end) {
+                TextLine line;
+                line.glyph_begin = line_begin;
+                line.glyph_end = end;
+                line.width = line_trimmed_width;
+                lines_.push_back(line);
+                // a single segment stays alone however narrow the width is.
+                if (line_segment_count > 1)
+                    min_valid_width_ = std::max(min_valid_width_, line_trimmed_width);
+                line_begin = end;
+                line_width = 0.0f;
+                line_trimmed_width = 0.0f;
+                line_segment_count = 0;
+            };
+
+            const auto add_segment = [&](const int end, const bool is_line_end) {
+                if (line_segment_count > 0)
+                {
+                    const auto joined_width = line_width + segment_trimmed_width;
+                    if (joined_width > max_width)
+                    {
+                        // any width from this one on would keep the segment.
+                        max_valid_width_ = std::min(max_valid_width_, joined_width);
+                        end_line(segment_begin);
+                    }
+                }
+                line_trimmed_width = line_width + segment_trimmed_width;
+                line_width += segment_width;
+                line_segment_count++;
+                if (is_line_end)
+                    end_line(end);
+                segment_begin = end;
+                segment_width = 0.0f;
+                segment_trimmed_width = 0.0f;
+            };
+
+            for (auto i = 0; i < glyph_count; i++)
+            {
+                const auto text_index = glyphs[i].text_index;
+                // breaks inside a glyph are ignored.
+                if (i > segment_begin && breaks[text_index] != LineBreakKind::None)
+                    add_segment(i, breaks[text_index] == LineBreakKind::Mandatory);
+                segment_width += glyphs[i].advance;
+                if (!IsWhiteSpaceHelperFunc(text[text_index]))
+                    segment_trimmed_width = segment_width;
+            }
+            if (segment_begin < glyph_count)
+                add_segment(glyph_count, IsHardBreakHelperFunc(text[glyphs.back().text_index]));
+            // empty text and text ending with a line feed end with an empty line.
+            end_line(glyph_count);
+
+            glyph_x_.resize(glyphs.size());
+            const auto& metrics = shaped_text_->metrics;
+            auto top = 0.0f;
+            for (auto& line : lines_)
+            {
+                auto x = 0.0f;
+                for (auto i = line.glyph_begin; i < line.glyph_end; i++)
+                {
+                    glyph_x_[i] = x;
+                    x += glyphs[i].advance;
+                }
+                line.top = top;
+                line.baseline = top + metrics.ascent;
+                top += metrics.line_height;
+                size_.width = std::max(size_.width, line.width);
+            }
+            size_.height = top;
+        }
+
+        std::size_t TextLayout::GetByteSize() const
+        {
+            return sizeof(TextLayout) + lines_.capacity() * sizeof(TextLine) + glyph_x_.capacity() * sizeof(float);
+        }
+
+        TextLayoutCache::Key TextLayoutCache::MakeKey(const String& text, const TextFormat& format)
+        {
+            auto hash = std::hash<String>()(text);
+            hash = HashCombine(hash, std::hash<std::uint32_t>()(format.font_id));
+            hash = HashCombine(hash, std::hash<float>()(format.size));
+            return Key{ &text, format, hash };
+        }
+
+        TextLayoutCache::TextLayoutCache(TextShaper* shaper, const std::size_t budget)
+            : shaper_(shaper), cache_(budget)
+        {
+            if (shaper == nullptr)
+                throw std::invalid_argument("Text shaper can't be null.");
+        }
+
+        std::shared_ptr<const TextLayout> TextLayoutCache::GetLayout(const String& text, const TextFormat& format, const float max_width)
+        {
+            auto key = MakeKey(text, format);
+            Entry entry;
+            if (const auto cached_entry = cache_.Find(key))
+            {
+                auto& layouts = cached_entry->layouts;
+                const auto layout = std::find_if(layouts.begin(), layouts.end(), [max_width](const std::shared_ptr<const TextLayout>& layout) {
+                    return layout->IsValidForWidth(max_width);
+                });
+                if (layout != layouts.end())
+                {
+                    std::rotate(layouts.begin(), layout, layout + 1);
+                    statistics_.hit_count++;
+                    return layouts.front();
+                }
+                entry = std::move(*cached_entry);
+                statistics_.relayout_count++;
+            }
+            else
+            {
+                auto shaped_text = std::make_shared<ShapedText>();
+                shaped_text->text = text;
+                shaped_text->format = format;
+                shaped_text->metrics = shaper_->GetMetrics(format);
+                shaper_->Shape(text, format, shaped_text->glyphs);
+                FindLineBreaks(text, shaped_text->breaks);
+                entry.shaped_text = std::move(shaped_text);
+                statistics_.miss_count++;
+            }
+
+            auto layout = std::make_shared<const TextLayout>(entry.shaped_text, max_width);
+            entry.layouts.insert(entry.layouts.begin(), layout);
+            if (static_cast<int>(entry.layouts.size()) > max_width_count)
+                entry.layouts.pop_back();
+            // the cost changed, so the entry is added again. The key is
+            // moved to the text of the entry, which lives as long as it.
+            const auto byte_size = GetByteSize(entry);
+            key.text = &entry.shaped_text->text;
+            cache_.Add(key, std::move(entry), byte_size);
+            return layout;
+        }
+
+        TextLayoutCacheStatistics TextLayoutCache::GetStatistics() const
+        {
+            auto statistics = statistics_;
+            statistics.eviction_count = cache_.GetStatistics().eviction_count;
+            return statistics;
+        }
+
+        void TextLayoutCache::ResetStatistics()
+        {
+            statistics_ = TextLayoutCacheStatistics();
+            cache_.ResetStatistics();
+        }
+
+        std::size_t TextLayoutCache::GetByteSize(const Entry& entry)
+        {
+            const auto& shaped_text = *entry.shaped_text;
+            auto byte_size = sizeof(Key) + sizeof(Entry) + sizeof(ShapedText) + shaped_text.text.size() * sizeof(wchar_t) +
+                shaped_text.glyphs.capacity() * sizeof(ShapedGlyph) + shaped_text.breaks.capacity() * sizeof(LineBreakKind);
+            for (const auto& layout : entry.layouts)
+                byte_size += layout->GetByteSize();
+            return byte_size;
+        }
+    }
+}
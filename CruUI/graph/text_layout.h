@@ -0,0 +1,283 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "base.h"
+#include "line_break.h"
+#include "lru_cache.h"
+#include "ui/ui_base.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        struct TextFormat
+        {
+            std::uint32_t font_id = 0;
+            //Pixels per em.
+            float size = 0.0f;
+        };
+
+        inline bool operator == (const TextFormat& left, const TextFormat& right)
+        {
+            return left.font_id == right.font_id && left.size == right.size;
+        }
+
+        inline bool operator != (const TextFormat& left, const TextFormat& right)
+        {
+            return !(left == right);
+        }
+
+        struct FontMetrics
+        {
+            //Distance from the top of a line to the baseline.
+            float ascent = 0.0f;
+            float line_height = 0.0f;
+        };
+
+        struct ShapedGlyph
+        {
+            std::uint32_t glyph_index = 0;
+            //Index of the first code unit of the text the glyph shows.
+            int text_index = 0;
+            float advance = 0.0f;
+        };
+
+        //Turns text into glyphs of a font. It is the only part of text layout
+        //that depends on a font engine.
+        class TextShaper : public Object
+        {
+        public:
+            TextShaper() = default;
+            TextShaper(const TextShaper& other) = delete;
+            TextShaper(TextShaper&& other) = delete;
+            TextShaper& operator=(const TextShaper& other) = delete;
+            TextShaper& operator=(TextShaper&& other) = delete;
+            ~TextShaper() override = default;
+
+            virtual FontMetrics GetMetrics(const TextFormat& format) = 0;
+
+            //Shape "text" into glyphs in the order of the text, replacing the
+            //content of "glyphs".
+            virtual void Shape(const String& text, const TextFormat& format, std::vector<ShapedGlyph>& glyphs) = 0;
+        };
+
+        //A shaper mapping every code point to the glyph of the same index,
+        //with advances that depend only on it, so text layout is
+        //deterministic without fonts. The glyphs match the ones of
+        //"StubGlyphRasterizer".
+        class StubTextShaper : public TextShaper
+        {
+        public:
+            StubTextShaper() = default;
+            StubTextShaper(const StubTextShaper& other) = delete;
+            StubTextShaper(StubTextShaper&& other) = delete;
+            StubTextShaper& operator=(const StubTextShaper& other) = delete;
+            StubTextShaper& operator=(StubTextShaper&& other) = delete;
+            ~StubTextShaper() override = default;
+
+            FontMetrics GetMetrics(const TextFormat& format) override;
+            void Shape(const String& text, const TextFormat& format, std::vector<ShapedGlyph>& glyphs) override;
+        };
+
+        //Text shaped in a format, which doesn't depend on the width it is
+        //laid out in.
+        struct ShapedText
+        {
+            String text;
+            TextFormat format;
+            FontMetrics metrics;
+            std::vector<ShapedGlyph> glyphs;
+            //Breaks before the code units, as "FindLineBreaks" gives them.
+            std::vector<LineBreakKind> breaks;
+        };
+
+        struct TextLine
+        {
+            //Range of the glyphs of the line.
+            int glyph_begin = 0;
+            int glyph_end = 0;
+            //Width without the trailing white space.
+            float width = 0.0f;
+            float top = 0.0f;
+            float baseline = 0.0f;
+        };
+
+        //Shaped text broken into lines no wider than a width where possible.
+        //Lines are filled greedily and broken where the breaks of the shaped
+        //text allow, always at mandatory ones; a word wider than the width
+        //gets a line of its own.
+        //
+        //The same lines are what any width in [GetMinValidWidth(),
+        //GetMaxValidWidth()) gives, and infinite width too if that is
+        //infinite, so a layout is reused when only the width changes within
+        //that range.
+        class TextLayout : public Object
+        {
+        public:
+            //"max_width" may be infinite for a single line per paragraph.
+            TextLayout(std::shared_ptr<const ShapedText> shaped_text, float max_width);
+            TextLayout(const TextLayout& other) = delete;
+            TextLayout(TextLayout&& other) = delete;
+            TextLayout& operator=(const TextLayout& other) = delete;
+            TextLayout& operator=(TextLayout&& other) = delete;
+            ~TextLayout() override = default;
+
+            const ShapedText& GetShapedText() const
+            {
+                return *shaped_text_;
+            }
+
+            const std::vector<TextLine>& GetLines() const
+            {
+                return lines_;
+            }
+
+            //Get the x of a glyph relative to the start of its line.
+            float GetGlyphX(const int index) const
+            {
+                return glyph_x_[index];
+            }
+
+            //Get the size of the text, the widest line by the lines' height.
+            ui::Size GetSize() const
+            {
+                return size_;
+            }
+
+            float GetMinValidWidth() const
+            {
+                return min_valid_width_;
+            }
+
+            float GetMaxValidWidth() const
+            {
+                return max_valid_width_;
+            }
+
+            bool IsValidForWidth(const float max_width) const
+            {
+                return max_width >= min_valid_width_ && (max_width < max_valid_width_ || max_valid_width_ == std::numeric_limits<float>::infinity());
+            }
+
+            //Get the bytes of the lines and positions, without the shaped text.
+            std::size_t GetByteSize() const;
+
+        private:
+            std::shared_ptr<const ShapedText> shaped_text_;
+            std::vector<TextLine> lines_;
+            std::vector<float> glyph_x_;
+            ui::Size size_ = ui::Size::zero;
+            float min_valid_width_ = 0.0f;
+            float max_valid_width_ = 0.0f;
+        };
+
+        struct TextLayoutCacheStatistics
+        {
+            //Layouts reused, for the same width or another within the range.
+            int hit_count = 0;
+            //Layouts broken again from cached shaped text.
+            int relayout_count = 0;
+            //Texts shaped and broken.
+            int miss_count = 0;
+            int eviction_count = 0;
+        };
+
+        //A cache of text layouts keyed by the text, the font, the size and
+        //the width, so measuring unchanged text is a lookup. Shaped text is
+        //kept per text and format with its layouts for the last few widths,
+        //so a new width only breaks lines again. Entries are dropped least
+        //recently used first to stay within a budget of bytes.
+        //It is not thread-safe.
+        class TextLayoutCache : public Object
+        {
+        public:
+            static constexpr std::size_t default_budget = 8 * 1024 * 1024;
+            //Layouts kept per text and format.
+            static constexpr int max_width_count = 4;
+
+        public:
+            //"shaper" must outlive the cache.
+            explicit TextLayoutCache(TextShaper* shaper, std::size_t budget = default_budget);
+            TextLayoutCache(const TextLayoutCache& other) = delete;
+            TextLayoutCache(TextLayoutCache&& other) = delete;
+            TextLayoutCache& operator=(const TextLayoutCache& other) = delete;
+            TextLayoutCache& operator=(TextLayoutCache&& other) = delete;
+            ~TextLayoutCache() override = default;
+
+            //Get the layout of "text" in "format" broken in "max_width". The
+            //layout stays valid after it is dropped from the cache.
+            std::shared_ptr<const TextLayout> GetLayout(const String& text, const TextFormat& format, float max_width);
+
+            std::size_t GetBudget() const
+            {
+                return cache_.GetBudget();
+            }
+
+            void SetBudget(const std::size_t budget)
+            {
+                cache_.SetBudget(budget);
+            }
+
+            //Get the bytes of all entries.
+            std::size_t GetByteSize() const
+            {
+                return cache_.GetCost();
+            }
+
+            void Clear()
+            {
+                cache_.Clear();
+            }
+
+            TextLayoutCacheStatistics GetStatistics() const;
+
+            void ResetStatistics();
+
+        private:
+            //A key points to the text instead of holding it: the text
+            //looked up, or the text of the shaped text of its entry once
+            //cached. So a lookup copies nothing, and the hash is computed
+            //once for it.
+            struct Key
+            {
+                const String* text;
+                TextFormat format;
+                std::size_t hash;
+
+                bool operator == (const Key& other) const
+                {
+                    return hash == other.hash && format == other.format && *text == *other.text;
+                }
+            };
+
+            struct KeyHash
+            {
+                std::size_t operator()(const Key& key) const
+                {
+                    return key.hash;
+                }
+            };
+
+            static Key MakeKey(const String& text, const TextFormat& format);
+
+            struct Entry
+            {
+                std::shared_ptr<const ShapedText> shaped_text;
+                //The most recently used first.
+                std::vector<std::shared_ptr<const TextLayout>> layouts;
+            };
+
+            static std::size_t GetByteSize(const Entry& entry);
+
+        private:
+            TextShaper* shaper_;
+            LruCache<Key, Entry, KeyHash> cache_;
+            TextLayoutCacheStatistics statistics_;
+        };
+    }
+}
@@ -0,0 +1,104 @@
+#include "tiled_painter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#include "thread_pool.h"
+
+namespace cru
+{
+    namespace graph
+    {
+        TiledPainter::TiledPainter(Bitmap* bitmap, ThreadPool* thread_pool, const int tile_size)
+            : SoftwarePainter(bitmap), thread_pool_(thread_pool), tile_size_(tile_size)
+        {
+            if (tile_size <= 0)
+                throw std::invalid_argument("Tile size must be positive.");
+            column_count_ = (bitmap->GetWidth() + tile_size - 1) / tile_size;
+            row_count_ = (bitmap->GetHeight() + tile_size - 1) / tile_size;
+            bins_.resize(static_cast<std::size_t>(column_count_) * row_count_);
+        }
+
+        void TiledPainter::Flush()
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            TileStatistics statistics;
+            statistics.tile_count = static_cast<int>(bins_.size());
+            statistics.rasterized_tile_count = static_cast<int>(touched_tiles_.size());
+            statistics.command_count = static_cast<int>(commands_.size());
+            for (const auto tile : touched_tiles_)
+                statistics.binned_command_count += static_cast<int>(bins_[tile].size());
+
+            const auto fill_tile = [this](const int i) {
+                const auto tile = touched_tiles_[i];
+                const auto tile_rect = GetTileRect(tile);
+                Rasterizer rasterizer;
+                for (const auto index : bins_[tile])
+                {
+                    const auto& command = commands_[index];
+                    rasterizer.Fill(command.edges, *GetBitmap(), command.clip.Intersect(tile_rect), command.fill_rule, command.paint, command.mode);
+                }
+            };
+
+            const auto tile_count = static_cast<int>(touched_tiles_.size());
+            if (thread_pool_ != nullptr)
+                thread_pool_->ParallelFor(tile_count, fill_tile);
+            else
+                for (auto i = 0; i < tile_count; i++)
+                    fill_tile(i);
+
+            for (const auto tile : touched_tiles_)
+                bins_[tile].clear();
+            touched_tiles_.clear();
+            commands_.clear();
+
+            statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            last_statistics_ = statistics;
+        }
+
+        void TiledPainter::FillEdges(EdgeList& edges, const ui::Rect& clip, const FillRule fill_rule, const PixelPaint& paint, const CompositeMode mode)
+        {
+            if (edges.IsEmpty() || (!paint.IsVisible() && mode == CompositeMode::SourceOver))
+                return;
+
+            const auto bounds = edges.GetBounds().Intersect(clip);
+            if (bounds.width <= 0.0f || bounds.height <= 0.0f)
+                return;
+
+            // a tile out of the bounds is never changed by the shape, so the
+            // bounds are only widened a pixel against rounding.
+            const auto tile_size = static_cast<float>(tile_size_);
+            const auto column_begin = std::max(static_cast<int>(std::floor((bounds.left - 1.0f) / tile_size)), 0);
+            const auto column_end = std::min(static_cast<int>(std::floor((bounds.GetRight() + 1.0f) / tile_size)) + 1, column_count_);
+            const auto row_begin = std::max(static_cast<int>(std::floor((bounds.top - 1.0f) / tile_size)), 0);
+            const auto row_end = std::min(static_cast<int>(std::floor((bounds.GetBottom() + 1.0f) / tile_size)) + 1, row_count_);
+            if (column_begin >= column_end || row_begin >= row_end)
+                return;
+
+            edges.Sort();
+            const auto index = static_cast<int>(commands_.size());
+            commands_.push_back(Command{ std::move(edges), clip, fill_rule, paint, mode });
+
+            for (auto row = row_begin; row < row_end; row++)
+                for (auto column = column_begin; column < column_end; column++)
+                {
+                    const auto tile = row * column_count_ + column;
+                    auto& bin = bins_[tile];
+                    if (bin.empty())
+                        touched_tiles_.push_back(tile);
+                    bin.push_back(index);
+                }
+        }
+
+        ui::Rect TiledPainter::GetTileRect(const int index) const
+        {
+            const auto column = index % column_count_;
+            const auto row = index / column_count_;
+            return ui::Rect(static_cast<float>(column * tile_size_), static_cast<float>(row * tile_size_),
+                static_cast<float>(tile_size_), static_cast<float>(tile_size_));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+
+#include "software_painter.h"
+
+namespace cru
+{
+    class ThreadPool;
+
+    namespace graph
+    {
+        //Statistics of a flush of a tiled painter.
+        struct TileStatistics
+        {
+            //Count of tiles in the bitmap.
+            int tile_count = 0;
+            //Count of tiles filled, which are the ones any shape touches.
+            int rasterized_tile_count = 0;
+            //Count of shapes painted.
+            int command_count = 0;
+            //Count of shapes filled summed over tiles.
+            int binned_command_count = 0;
+            double seconds = 0.0;
+        };
+
+        //A software painter that bins shapes into square tiles of the bitmap
+        //and fills the tiles on a thread pool when flushed.
+        //
+        //A tile fills its shapes in the painting order clipped to its integer
+        //bounds, so the bitmap is the same byte for byte whatever the count of
+        //threads. Tiles no shape touches, for example ones out of the clips
+        //of the damage, are not filled at all and keep their pixels.
+        class TiledPainter : public SoftwarePainter
+        {
+        public:
+            static constexpr int default_tile_size = 128;
+
+        public:
+            //"bitmap" and "thread_pool" must outlive the painter. If
+            //"thread_pool" is null, tiles are filled on the calling thread.
+            TiledPainter(Bitmap* bitmap, ThreadPool* thread_pool, int tile_size = default_tile_size);
+            TiledPainter(const TiledPainter& other) = delete;
+            TiledPainter(TiledPainter&& other) = delete;
+            TiledPainter& operator=(const TiledPainter& other) = delete;
+            TiledPainter& operator=(TiledPainter&& other) = delete;
+            ~TiledPainter() override = default;
+
+            int GetTileSize() const
+            {
+                return tile_size_;
+            }
+
+            int GetTileColumnCount() const
+            {
+                return column_count_;
+            }
+
+            int GetTileRowCount() const
+            {
+                return row_count_;
+            }
+
+            //Fill the shapes painted since the last flush into the bitmap
+            //and forget them. Nothing is drawn before it is invoked.
+            void Flush();
+
+            //Get the statistics of the last flush.
+            const TileStatistics& GetLastFlushStatistics() const
+            {
+                return last_statistics_;
+            }
+
+        protected:
+            void FillEdges(EdgeList& edges, const ui::Rect& clip, FillRule fill_rule, const PixelPaint& paint, CompositeMode mode) override;
+
+        private:
+            struct Command
+            {
+                EdgeList edges;
+                ui::Rect clip;
+                FillRule fill_rule;
+                PixelPaint paint;
+                CompositeMode mode;
+            };
+
+            ui::Rect GetTileRect(int index) const;
+
+        private:
+            ThreadPool* thread_pool_;
+            int tile_size_;
+            int column_count_;
+            int row_count_;
+
+            std::vector<Command> commands_;
+            //Indices of the commands touching each tile, in painting order.
+            std::vector<std::vector<int>> bins_;
+            //Indices of the tiles with a non-empty bin.
+            std::vector<int> touched_tiles_;
+
+            TileStatistics last_statistics_{};
+        };
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "base.h"
+
+namespace cru
+{
+    //Counters of a cache since it was created or the counters were reset.
+    struct CacheStatistics
+    {
+        int hit_count = 0;
+        int miss_count = 0;
+        //Count of values dropped to stay within the budget.
+        int eviction_count = 0;
+    };
+
+    //A map that keeps values within a budget of cost, such as bytes, and
+    //drops the least recently used ones to make room.
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    class LruCache : public Object
+    {
+    public:
+        explicit LruCache(const std::size_t budget) : budget_(budget) { }
+        LruCache(const LruCache& other) = delete;
+        LruCache(LruCache&& other) = delete;
+        LruCache& operator=(const LruCache& other) = delete;
+        LruCache& operator=(LruCache&& other) = delete;
+        ~LruCache() override = default;
+
+        std::size_t GetBudget() const
+        {
+            return budget_;
+        }
+
+        //Set the budget and drop values beyond it.
+        void SetBudget(const std::size_t budget)
+        {
+            budget_ = budget;
+            EvictTo(budget);
+        }
+
+        //Get the cost of all values.
+        std::size_t GetCost() const
+        {
+            return cost_;
+        }
+
+        int GetCount() const
+        {
+            return static_cast<int>(index_.size());
+        }
+
+        //Return the value of "key" and mark it the most recently used, or
+        //null if it is not cached. It counts a hit or a miss. The pointer is
+        //valid until the value is dropped.
+        Value* Find(const Key& key)
+        {
+            const auto find_result = index_.find(key);
+            if (find_result == index_.end())
+            {
+                statistics_.miss_count++;
+                return nullptr;
+            }
+            statistics_.hit_count++;
+            entries_.splice(entries_.begin(), entries_, find_result->second);
+            return std::addressof(find_result->second->value);
+        }
+
+        //Cache "value" of "key", replacing the old one, and drop the least
+        //recently used values beyond the budget. A value costing more than
+        //the whole budget is not cached, and false is returned.
+        bool Add(const Key& key, Value value, const std::size_t cost)
+        {
+            Remove(key);
+            if (cost > budget_)
+                return false;
+            EvictTo(budget_ - cost);
+            entries_.push_front(Entry{ key, std::move(value), cost });
+            index_.emplace(key, entries_.begin());
+            cost_ += cost;
+            return true;
+        }
+
+        //Drop the value of "key". Return false if it is not cached.
+        bool Remove(const Key& key)
+        {
+            const auto find_result = index_.find(key);
+            if (find_result == index_.end())
+                return false;
+            cost_ -= find_result->second->cost;
+            entries_.erase(find_result->second);
+            index_.erase(find_result);
+            return true;
+        }
+
+        void Clear()
+        {
+            entries_.clear();
+            index_.clear();
+            cost_ = 0;
+        }
+
+        const CacheStatistics& GetStatistics() const
+        {
+            return statistics_;
+        }
+
+        void ResetStatistics()
+        {
+            statistics_ = CacheStatistics();
+        }
+
+    private:
+        struct Entry
+        {
+            Key key;
+            Value value;
+            std::size_t cost;
+        };
+
+        void EvictTo(const std::size_t cost)
+        {
+            while (cost_ > cost)
+            {
+                const auto& entry = entries_.back();
+                cost_ -= entry.cost;
+                index_.erase(entry.key);
+                entries_.pop_back();
+                statistics_.eviction_count++;
+            }
+        }
+
+    private:
+        //The most recently used at the front.
+        std::list<Entry> entries_;
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+        std::size_t budget_;
+        std::size_t cost_ = 0;
+        CacheStatistics statistics_{};
+    };
+}
@@ -0,0 +1,366 @@
+#include "string_util.h"
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+
+#if defined(CRU_STRING_SCALAR)
+#define CRU_STRING_KERNEL_SCALAR
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CRU_STRING_KERNEL_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CRU_STRING_KERNEL_NEON
+#include <arm_neon.h>
+#else
+#define CRU_STRING_KERNEL_SCALAR
+#endif
+
+namespace cru
+{
+    //ASCII in a row after other code points before blocks are tried again.
+    constexpr int scalar_ascii_count = 8;
+
+    //Widen the ASCII bytes from "current" to code units 16 at a time, and
+    //return where the first block with other bytes starts.
+    inline const std::uint8_t* WidenAsciiHelperFunc(const std::uint8_t* current, const std::uint8_t* end, wchar_t*& output)
+    {
+#if defined(CRU_STRING_KERNEL_SSE2)
+        const auto zero = _mm_setzero_si128();
+        for (; end - current >= 16; current += 16, output += 16)
+        {
+            const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+            if (_mm_movemask_epi8(bytes) != 0)
+                break;
+            const auto low = _mm_unpacklo_epi8(bytes, zero);
+            const auto high = _mm_unpackhi_epi8(bytes, zero);
+            const auto units = reinterpret_cast<__m128i*>(output);
+            if (sizeof(wchar_t) == 2)
+            {
+                _mm_storeu_si128(units, low);
+                _mm_storeu_si128(units + 1, high);
+            }
+            else
+            {
+                _mm_storeu_si128(units, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128(units + 1, _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128(units + 2, _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128(units + 3, _mm_unpackhi_epi16(high, zero));
+            }
+        }
+#elif defined(CRU_STRING_KERNEL_NEON)
+        for (; end - current >= 16; current += 16, output += 16)
+        {
+            const auto bytes = vld1q_u8(current);
+            if (vmaxvq_u8(bytes) >= 0x80)
+                break;
+            const auto low = vmovl_u8(vget_low_u8(bytes));
+            const auto high = vmovl_u8(vget_high_u8(bytes));
+            if (sizeof(wchar_t) == 2)
+            {
+                const auto units = reinterpret_cast<std::uint16_t*>(output);
+                vst1q_u16(units, low);
+                vst1q_u16(units + 8, high);
+            }
+            else
+            {
+                const auto units = reinterpret_cast<std::uint32_t*>(output);
+                vst1q_u32(units, vmovl_u16(vget_low_u16(low)));
+                vst1q_u32(units + 4, vmovl_u16(vget_high_u16(low)));
+                vst1q_u32(units + 8, vmovl_u16(vget_low_u16(high)));
+                vst1q_u32(units + 12, vmovl_u16(vget_high_u16(high)));
+            }
+        }
+#endif
+        return current;
+    }
+
+    //Narrow the ASCII code units from "current" to bytes 16 at a time, and
+    //return where the first block with other code units starts.
+    inline const wchar_t* NarrowAsciiHelperFunc(const wchar_t* current, const wchar_t* end, char*& output)
+    {
+#if defined(CRU_STRING_KERNEL_SSE2)
+        const auto zero = _mm_setzero_si128();
+        for (; end - current >= 16; current += 16, output += 16)
+        {
+            const auto units = reinterpret_cast<const __m128i*>(current);
+            __m128i low, high;
+            if (sizeof(wchar_t) == 2)
+            {
+                low = _mm_loadu_si128(units);
+                high = _mm_loadu_si128(units + 1);
+                const auto is_ascii = _mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(low, high), _mm_set1_epi16(-0x80)), zero);
+                if (_mm_movemask_epi8(is_ascii) != 0xFFFF)
+                    break;
+            }
+            else
+            {
+                const auto a = _mm_loadu_si128(units);
+                const auto b = _mm_loadu_si128(units + 1);
+                const auto c = _mm_loadu_si128(units + 2);
+                const auto d = _mm_loadu_si128(units + 3);
+                const auto is_ascii = _mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(-0x80)), zero);
+                if (_mm_movemask_epi8(is_ascii) != 0xFFFF)
+                    break;
+                // values below 0x80 pass the signed saturation unchanged.
+                low = _mm_packs_epi32(a, b);
+                high = _mm_packs_epi32(c, d);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(low, high));
+        }
+#elif defined(CRU_STRING_KERNEL_NEON)
+        for (; end - current >= 16; current += 16, output += 16)
+        {
+            uint16x8_t low, high;
+            if (sizeof(wchar_t) == 2)
+            {
+                const auto units = reinterpret_cast<const std::uint16_t*>(current);
+                low = vld1q_u16(units);
+                high = vld1q_u16(units + 8);
+                if (vmaxvq_u16(vorrq_u16(low, high)) >= 0x80)
+                    break;
+            }
+            else
+            {
+                const auto units = reinterpret_cast<const std::uint32_t*>(current);
+                const auto a = vld1q_u32(units);
+                const auto b = vld1q_u32(units + 4);
+                const auto c = vld1q_u32(units + 8);
+                const auto d = vld1q_u32(units + 12);
+                if (vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d))) >= 0x80)
+                    break;
+                low = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+                high = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+            }
+            vst1q_u8(reinterpret_cast<std::uint8_t*>(output), vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+        }
+#endif
+        return current;
+    }
+
+    inline bool IsContinuationHelperFunc(const std::uint8_t byte)
+    {
+        return (byte & 0xC0) == 0x80;
+    }
+
+    //Decode utf-8 into "output", which has room for a code unit per byte.
+    //Return the end of the code units written, or null if it isn't valid.
+    inline wchar_t* DecodeUtf8HelperFunc(const std::uint8_t* current, const std::uint8_t* end, wchar_t* output)
+    {
+        while (current != end)
+        {
+            current = WidenAsciiHelperFunc(current, end, output);
+            // other sequences are decoded one by one until a few ASCII bytes
+            // in a row, so short words between them don't try a block each.
+            auto ascii_count = 0;
+            while (current != end && ascii_count < scalar_ascii_count)
+            {
+                const auto lead = *current;
+                std::uint32_t code_point;
+                if (lead < 0x80)
+                {
+                    *output++ = static_cast<wchar_t>(lead);
+                    current++;
+                    ascii_count++;
+                    continue;
+                }
+                ascii_count = 0;
+                if (lead < 0xC2)
+                    return nullptr;
+                if (lead < 0xE0)
+                {
+                    if (end - current < 2 || !IsContinuationHelperFunc(current[1]))
+                        return nullptr;
+                    code_point = (lead & 0x1Fu) << 6 | (current[1] & 0x3Fu);
+                    current += 2;
+                }
+                else if (lead < 0xF0)
+                {
+                    // E0 would be overlong below A0, and ED a surrogate from A0.
+                    if (end - current < 3 || !IsContinuationHelperFunc(current[1]) || !IsContinuationHelperFunc(current[2]) ||
+                        (lead == 0xE0 && current[1] < 0xA0) || (lead == 0xED && current[1] >= 0xA0))
+                        return nullptr;
+                    code_point = (lead & 0x0Fu) << 12 | (current[1] & 0x3Fu) << 6 | (current[2] & 0x3Fu);
+                    current += 3;
+                }
+                else if (lead < 0xF5)
+                {
+                    // F0 would be overlong below 90, and F4 past 10FFFF from 90.
+                    if (end - current < 4 || !IsContinuationHelperFunc(current[1]) || !IsContinuationHelperFunc(current[2]) ||
+                        !IsContinuationHelperFunc(current[3]) || (lead == 0xF0 && current[1] < 0x90) || (lead == 0xF4 && current[1] >= 0x90))
+                        return nullptr;
+                    code_point = (lead & 0x07u) << 18 | (current[1] & 0x3Fu) << 12 | (current[2] & 0x3Fu) << 6 | (current[3] & 0x3Fu);
+                    current += 4;
+                }
+                else
+                    return nullptr;
+
+                if (sizeof(wchar_t) == 2 && code_point >= 0x10000)
+                {
+                    *output++ = static_cast<wchar_t>(0xD800 + ((code_point - 0x10000) >> 10));
+                    *output++ = static_cast<wchar_t>(0xDC00 + (code_point & 0x3FF));
+                }
+                else
+                    *output++ = static_cast<wchar_t>(code_point);
+            }
+        }
+        return output;
+    }
+
+    //Encode code units into "output", which has room for 3 bytes per code
+    //unit where wchar_t is 16 bits and 4 otherwise. Return the end of the
+    //bytes written, or null if a code unit isn't valid.
+    inline char* EncodeUtf8HelperFunc(const wchar_t* current, const wchar_t* end, char* output)
+    {
+        while (current != end)
+        {
+            current = NarrowAsciiHelperFunc(current, end, output);
+            auto ascii_count = 0;
+            while (current != end && ascii_count < scalar_ascii_count)
+            {
+                auto code_point = static_cast<std::uint32_t>(*current++);
+                if (code_point < 0x80)
+                {
+                    *output++ = static_cast<char>(code_point);
+                    ascii_count++;
+                    continue;
+                }
+                ascii_count = 0;
+                if (code_point < 0x800)
+                {
+                    *output++ = static_cast<char>(0xC0 | code_point >> 6);
+                    *output++ = static_cast<char>(0x80 | (code_point & 0x3F));
+                }
+                else
+                {
+                    if (code_point >= 0xD800 && code_point < 0xE000)
+                    {
+                        if (sizeof(wchar_t) != 2 || code_point >= 0xDC00 || current == end)
+                            return nullptr;
+                        const auto low = static_cast<std::uint32_t>(*current);
+                        if (low < 0xDC00 || low >= 0xE000)
+                            return nullptr;
+                        current++;
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    else if (code_point > 0x10FFFF)
+                        return nullptr;
+
+                    if (code_point < 0x10000)
+                        *output++ = static_cast<char>(0xE0 | code_point >> 12);
+                    else
+                    {
+                        *output++ = static_cast<char>(0xF0 | code_point >> 18);
+                        *output++ = static_cast<char>(0x80 | (code_point >> 12 & 0x3F));
+                    }
+                    *output++ = static_cast<char>(0x80 | (code_point >> 6 & 0x3F));
+                    *output++ = static_cast<char>(0x80 | (code_point & 0x3F));
+                }
+            }
+        }
+        return output;
+    }
+
+    String Utf8ToString(const char* data, const std::size_t size)
+    {
+        if (size == 0)
+            return String();
+        // a byte never gives more than a code unit.
+        String result(size, L'\0');
+        const auto begin = reinterpret_cast<const std::uint8_t*>(data);
+        const auto end = DecodeUtf8HelperFunc(begin, begin + size, &result[0]);
+        if (end == nullptr)
+            throw std::invalid_argument("Text isn't valid utf-8.");
+        result.resize(end - &result[0]);
+        return result;
+    }
+
+    std::string StringToUtf8(const String& text)
+    {
+        if (text.empty())
+            return std::string();
+        std::string result(text.size() * (sizeof(wchar_t) == 2 ? 3 : 4), '\0');
+        const auto end = EncodeUtf8HelperFunc(text.data(), text.data() + text.size(), &result[0]);
+        if (end == nullptr)
+            throw std::invalid_argument("Text has a code unit that isn't valid.");
+        result.resize(end - &result[0]);
+        return result;
+    }
+
+    //Strings are spread over shards by hash, so threads interning different
+    //strings rarely wait on each other.
+    class InternTable
+    {
+    public:
+        static constexpr int shard_count = 16;
+
+        static InternTable& GetInstance()
+        {
+            static InternTable instance;
+            return instance;
+        }
+
+        const String* GetEmpty() const
+        {
+            return &empty_;
+        }
+
+        const String* Intern(const String& text)
+        {
+            if (text.empty())
+                return &empty_;
+            const auto hash = std::hash<String>()(text);
+            // the high bits pick the shard, as the sets use the low ones.
+            auto& shard = shards_[hash / (std::numeric_limits<std::size_t>::max() / shard_count + 1)];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            // elements of a node-based set never move.
+            return &*shard.texts.insert(text).first;
+        }
+
+        std::size_t GetCount()
+        {
+            std::size_t count = 0;
+            for (auto& shard : shards_)
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                count += shard.texts.size();
+            }
+            return count;
+        }
+
+    private:
+        struct Shard
+        {
+            std::mutex mutex;
+            std::unordered_set<String> texts;
+        };
+
+        const String empty_;
+        Shard shards_[shard_count];
+    };
+
+    InternedString::InternedString()
+        : text_(InternTable::GetInstance().GetEmpty())
+    {
+
+    }
+
+    InternedString::InternedString(const String& text)
+        : text_(InternTable::GetInstance().Intern(text))
+    {
+
+    }
+
+    InternedString::InternedString(const wchar_t* text)
+        : text_(InternTable::GetInstance().Intern(String(text)))
+    {
+
+    }
+
+    std::size_t InternedString::GetCount()
+    {
+        return InternTable::GetInstance().GetCount();
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "base.h"
+
+namespace cru
+{
+    //Convert utf-8 to a string of utf-16 where wchar_t is 16 bits and utf-32
+    //otherwise. Throw std::invalid_argument if it isn't valid utf-8, which
+    //includes overlong forms, surrogates and truncated sequences.
+    //Runs of ASCII are converted 16 bytes at a time with sse2 or neon where
+    //available.
+    String Utf8ToString(const char* data, std::size_t size);
+
+    inline String Utf8ToString(const std::string& text)
+    {
+        return Utf8ToString(text.data(), text.size());
+    }
+
+    //Convert a string to utf-8. Throw std::invalid_argument if it has an
+    //unpaired surrogate or a code unit that isn't a code point.
+    std::string StringToUtf8(const String& text);
+
+    //A string stored once per content in a process-wide table, so copies
+    //are a pointer and compare and hash by it. Interned strings are never
+    //freed, so it is for a bounded set of strings, like identifiers and
+    //style keys, compared far more often than created.
+    //It is thread-safe.
+    class InternedString
+    {
+    public:
+        //The empty string.
+        InternedString();
+        explicit InternedString(const String& text);
+        explicit InternedString(const wchar_t* text);
+
+        const String& Get() const
+        {
+            return *text_;
+        }
+
+        bool IsEmpty() const
+        {
+            return text_->empty();
+        }
+
+        bool operator == (const InternedString& other) const
+        {
+            return text_ == other.text_;
+        }
+
+        bool operator != (const InternedString& other) const
+        {
+            return text_ != other.text_;
+        }
+
+        //Get the count of distinct non-empty strings interned so far.
+        static std::size_t GetCount();
+
+    private:
+        const String* text_;
+    };
+}
+
+namespace std
+{
+    template <>
+    struct hash<cru::InternedString>
+    {
+        std::size_t operator()(const cru::InternedString& text) const
+        {
+            return std::hash<const void*>()(&text.Get());
+        }
+    };
+}
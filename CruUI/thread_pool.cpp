@@ -0,0 +1,132 @@
+#include "thread_pool.h"
+
+namespace cru
+{
+    namespace
+    {
+        thread_local bool is_in_parallel_for = false;
+    }
+
+    int ThreadPool::GetDefaultThreadCount()
+    {
+        const auto count = static_cast<int>(std::thread::hardware_concurrency());
+        return count > 0 ? count : 1;
+    }
+
+    ThreadPool::ThreadPool(const int thread_count)
+    {
+        for (auto i = 1; i < thread_count; i++)
+            threads_.emplace_back([this] { WorkerMain(); });
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        job_condition_.notify_all();
+        for (auto& thread : threads_)
+            thread.join();
+    }
+
+    void ThreadPool::ParallelFor(const int count, const std::function<void(int)>& action)
+    {
+        if (count <= 0)
+            return;
+
+        if (is_in_parallel_for || threads_.empty() || count == 1)
+        {
+            for (auto i = 0; i < count; i++)
+                action(i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+        Job job;
+        job.action = &action;
+        job.count = count;
+        job.next_index = 0;
+        job.done_count = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            job_generation_++;
+        }
+        job_condition_.notify_all();
+
+        RunJob(&job);
+
+        {
+            // the job lives on this stack, so wait until no worker touches it.
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_condition_.wait(lock, [this, &job] {
+                return job.done_count.load() == job.count && active_worker_count_ == 0;
+            });
+            job_ = nullptr;
+        }
+
+        if (job.exception)
+            std::rethrow_exception(job.exception);
+    }
+
+    bool ThreadPool::IsInParallelFor()
+    {
+        return is_in_parallel_for;
+    }
+
+    void ThreadPool::WorkerMain()
+    {
+        unsigned long long seen_generation = 0;
+        while (true)
+        {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                job_condition_.wait(lock, [this, seen_generation] {
+                    return stopping_ || job_generation_ != seen_generation;
+                });
+                if (stopping_)
+                    return;
+                seen_generation = job_generation_;
+                job = job_;
+                if (job == nullptr) // woke up after the job was finished.
+                    continue;
+                active_worker_count_++;
+            }
+
+            RunJob(job);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                active_worker_count_--;
+            }
+            done_condition_.notify_all();
+        }
+    }
+
+    void ThreadPool::RunJob(Job* job)
+    {
+        is_in_parallel_for = true;
+        while (true)
+        {
+            const auto index = job->next_index.fetch_add(1);
+            if (index >= job->count)
+                break;
+            try
+            {
+                (*job->action)(index);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(job->exception_mutex);
+                if (!job->exception)
+                    job->exception = std::current_exception();
+            }
+            job->done_count.fetch_add(1);
+        }
+        is_in_parallel_for = false;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <vector>
+
+#include "base.h"
+
+namespace cru
+{
+    //A fixed set of worker threads that run data-parallel loops.
+    class ThreadPool : public Object
+    {
+    public:
+        //Return the count of hardware threads, at least 1.
+        static int GetDefaultThreadCount();
+
+    public:
+        //"thread_count" includes the calling thread, so "thread_count - 1"
+        //workers are created.
+        explicit ThreadPool(int thread_count = GetDefaultThreadCount());
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool(ThreadPool&& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+        ThreadPool& operator=(ThreadPool&& other) = delete;
+        ~ThreadPool() override;
+
+        //Get the count of threads that run a loop, including the calling thread.
+        int GetThreadCount() const
+        {
+            return static_cast<int>(threads_.size()) + 1;
+        }
+
+        //Invoke "action" for every index in [0, count) on the workers and the
+        //calling thread, and return when all are done. Indices are handed out
+        //dynamically, so "action" must only write state owned by its index.
+        //The first exception thrown by "action" is rethrown here.
+        //If invoked from inside a loop, it runs sequentially on the calling
+        //thread, so nested loops never wait on each other.
+        void ParallelFor(int count, const std::function<void(int)>& action);
+
+        //Return true if the calling thread is running a loop of any pool.
+        static bool IsInParallelFor();
+
+    private:
+        struct Job
+        {
+            const std::function<void(int)>* action;
+            int count;
+            std::atomic<int> next_index;
+            std::atomic<int> done_count;
+            std::exception_ptr exception;
+            std::mutex exception_mutex;
+        };
+
+        void WorkerMain();
+        void RunJob(Job* job);
+
+    private:
+        std::vector<std::thread> threads_;
+
+        //Only one loop runs at a time.
+        std::mutex run_mutex_;
+
+        std::mutex mutex_;
+        std::condition_variable job_condition_;
+        std::condition_variable done_condition_;
+        Job* job_ = nullptr;
+        unsigned long long job_generation_ = 0;
+        int active_worker_count_ = 0;
+        bool stopping_ = false;
+    };
+}
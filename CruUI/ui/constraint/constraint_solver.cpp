@@ -0,0 +1,714 @@
+#include "constraint_solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace constraint
+        {
+            Expression operator + (const Expression& left, const Expression& right)
+            {
+                auto terms = left.terms;
+                terms.insert(terms.cend(), right.terms.cbegin(), right.terms.cend());
+                return Expression(std::move(terms), left.constant + right.constant);
+            }
+
+            Expression operator - (const Expression& left, const Expression& right)
+            {
+                return left + -right;
+            }
+
+            Expression operator - (const Expression& expression)
+            {
+                return expression * -1.0;
+            }
+
+            Expression operator * (const Expression& expression, const double coefficient)
+            {
+                auto terms = expression.terms;
+                for (auto& term : terms)
+                    term.coefficient *= coefficient;
+                return Expression(std::move(terms), expression.constant * coefficient);
+            }
+
+            Expression operator * (const double coefficient, const Expression& expression)
+            {
+                return expression * coefficient;
+            }
+
+            Expression operator / (const Expression& expression, const double denominator)
+            {
+                return expression * (1.0 / denominator);
+            }
+
+            inline double ClipStrengthHelperFunc(const double value)
+            {
+                return std::max(0.0, std::min(strength::required, value));
+            }
+
+            Constraint::Constraint(const Expression& expression, const RelationalOperator op, const double strength)
+                : data_(std::make_shared<const Data>(Data{ expression, op, ClipStrengthHelperFunc(strength) }))
+            {
+
+            }
+
+            Constraint::Constraint(const Constraint& other, const double strength)
+                : Constraint(other.GetExpression(), other.GetOperator(), strength)
+            {
+
+            }
+
+            Constraint operator == (const Expression& left, const Expression& right)
+            {
+                return Constraint(left - right, RelationalOperator::Equal);
+            }
+
+            Constraint operator <= (const Expression& left, const Expression& right)
+            {
+                return Constraint(left - right, RelationalOperator::LessOrEqual);
+            }
+
+            Constraint operator >= (const Expression& left, const Expression& right)
+            {
+                return Constraint(left - right, RelationalOperator::GreaterOrEqual);
+            }
+
+            Constraint operator | (const Constraint& constraint, const double strength)
+            {
+                return Constraint(constraint, strength);
+            }
+
+            inline bool IsNearZeroHelperFunc(const double value)
+            {
+                return std::abs(value) < 1.0e-8;
+            }
+
+
+            // A row of the tableau: basic symbol = constant + sum(coefficient * symbol).
+            // Cells are kept in a vector sorted by symbol, which is much faster
+            // than a tree for the merges done by substitution.
+            class Solver::Row
+            {
+            public:
+                using Cell = std::pair<Symbol, double>;
+
+                explicit Row(const double constant = 0.0) : constant_(constant) { }
+
+                double GetConstant() const
+                {
+                    return constant_;
+                }
+
+                const std::vector<Cell>& GetCells() const
+                {
+                    return cells_;
+                }
+
+                // Return the new constant.
+                double Add(const double value)
+                {
+                    return constant_ += value;
+                }
+
+                void Insert(const Symbol symbol, const double coefficient = 1.0)
+                {
+                    const auto i = LowerBound(symbol);
+                    if (i != cells_.end() && i->first == symbol)
+                    {
+                        i->second += coefficient;
+                        if (IsNearZeroHelperFunc(i->second))
+                            cells_.erase(i);
+                    }
+                    else if (!IsNearZeroHelperFunc(coefficient))
+                    {
+                        cells_.insert(i, Cell(symbol, coefficient));
+                    }
+                }
+
+                void Insert(const Row& row, const double coefficient = 1.0)
+                {
+                    constant_ += row.constant_ * coefficient;
+
+                    // merge the two sorted cell lists.
+                    std::vector<Cell> merged;
+                    merged.reserve(cells_.size() + row.cells_.size());
+                    auto left = cells_.cbegin();
+                    auto right = row.cells_.cbegin();
+                    while (left != cells_.cend() || right != row.cells_.cend())
+                    {
+                        if (right == row.cells_.cend() || (left != cells_.cend() && left->first < right->first))
+                        {
+                            merged.push_back(*left++);
+                        }
+                        else if (left == cells_.cend() || right->first < left->first)
+                        {
+                            const auto value = right->second * coefficient;
+                            if (!IsNearZeroHelperFunc(value))
+                                merged.emplace_back(right->first, value);
+                            ++right;
+                        }
+                        else
+                        {
+                            const auto value = left->second + right->second * coefficient;
+                            if (!IsNearZeroHelperFunc(value))
+                                merged.emplace_back(left->first, value);
+                            ++left;
+                            ++right;
+                        }
+                    }
+                    cells_.swap(merged);
+                }
+
+                void Remove(const Symbol symbol)
+                {
+                    const auto i = LowerBound(symbol);
+                    if (i != cells_.end() && i->first == symbol)
+                        cells_.erase(i);
+                }
+
+                void ReverseSign()
+                {
+                    constant_ = -constant_;
+                    for (auto& cell : cells_)
+                        cell.second = -cell.second;
+                }
+
+                // Solve the row for "symbol", which must be in the row.
+                void SolveFor(const Symbol symbol)
+                {
+                    const auto i = LowerBound(symbol);
+                    const auto coefficient = -1.0 / i->second;
+                    cells_.erase(i);
+                    constant_ *= coefficient;
+                    for (auto& cell : cells_)
+                        cell.second *= coefficient;
+                }
+
+                // Solve the row of "lhs" for "rhs".
+                void SolveFor(const Symbol lhs, const Symbol rhs)
+                {
+                    Insert(lhs, -1.0);
+                    SolveFor(rhs);
+                }
+
+                double GetCoefficientFor(const Symbol symbol) const
+                {
+                    const auto i = std::lower_bound(cells_.cbegin(), cells_.cend(), symbol,
+                        [](const Cell& cell, const Symbol s) { return cell.first < s; });
+                    return i != cells_.cend() && i->first == symbol ? i->second : 0.0;
+                }
+
+                void Substitute(const Symbol symbol, const Row& row)
+                {
+                    const auto i = LowerBound(symbol);
+                    if (i == cells_.end() || !(i->first == symbol))
+                        return;
+                    const auto coefficient = i->second;
+                    cells_.erase(i);
+                    Insert(row, coefficient);
+                }
+
+            private:
+                std::vector<Cell>::iterator LowerBound(const Symbol symbol)
+                {
+                    return std::lower_bound(cells_.begin(), cells_.end(), symbol,
+                        [](const Cell& cell, const Symbol s) { return cell.first < s; });
+                }
+
+            private:
+                std::vector<Cell> cells_;
+                double constant_;
+            };
+
+
+            Solver::Solver()
+                : objective_(std::make_unique<Row>())
+            {
+
+            }
+
+            Solver::~Solver() = default;
+
+            void Solver::AddConstraint(const Constraint& constraint)
+            {
+                if (constraints_.count(constraint) != 0)
+                    throw std::invalid_argument("The constraint is already added.");
+
+                // Create a row with a subject chosen from the constraint if
+                // possible, otherwise add it with an artificial variable to
+                // find a feasible subject.
+                Tag tag;
+                auto row = CreateRow(constraint, tag);
+                auto subject = ChooseSubject(*row, tag);
+
+                if (!subject.IsValid())
+                {
+                    const auto all_dummies = std::all_of(row->GetCells().cbegin(), row->GetCells().cend(),
+                        [](const Row::Cell& cell) { return cell.first.type == SymbolType::Dummy; });
+                    if (all_dummies)
+                    {
+                        if (!IsNearZeroHelperFunc(row->GetConstant()))
+                            throw UnsatisfiableConstraintError();
+                        subject = tag.marker;
+                    }
+                }
+
+                if (!subject.IsValid())
+                {
+                    if (!AddWithArtificialVariable(*row))
+                        throw UnsatisfiableConstraintError();
+                }
+                else
+                {
+                    row->SolveFor(subject);
+                    Substitute(subject, *row);
+                    rows_[subject] = std::move(row);
+                }
+
+                constraints_.emplace(constraint, tag);
+
+                Optimize(*objective_);
+            }
+
+            void Solver::RemoveConstraint(const Constraint& constraint)
+            {
+                const auto find_result = constraints_.find(constraint);
+                if (find_result == constraints_.cend())
+                    throw std::invalid_argument("The constraint is not added.");
+
+                const auto tag = find_result->second;
+                constraints_.erase(find_result);
+
+                // Remove the error effects from the objective before pivoting,
+                // or substitution into the objective goes wrong.
+                RemoveConstraintEffects(constraint, tag);
+
+                // If the marker is basic, simply drop the row. Otherwise pivot
+                // the marker into the basis and then drop the row.
+                const auto row_iter = rows_.find(tag.marker);
+                if (row_iter != rows_.cend())
+                {
+                    rows_.erase(row_iter);
+                }
+                else
+                {
+                    const auto leaving_iter = GetMarkerLeavingRow(tag.marker);
+                    if (leaving_iter == rows_.cend())
+                        throw std::logic_error("Failed to find the leaving row.");
+
+                    const auto leaving = leaving_iter->first;
+                    auto row = std::move(leaving_iter->second);
+                    rows_.erase(leaving_iter);
+                    row->SolveFor(leaving, tag.marker);
+                    Substitute(tag.marker, *row);
+                }
+
+                Optimize(*objective_);
+            }
+
+            bool Solver::HasConstraint(const Constraint& constraint) const
+            {
+                return constraints_.count(constraint) != 0;
+            }
+
+            void Solver::AddEditVariable(const Variable& variable, const double strength)
+            {
+                if (edits_.count(variable) != 0)
+                    throw std::invalid_argument("The variable is already editable.");
+
+                const auto clipped_strength = ClipStrengthHelperFunc(strength);
+                if (clipped_strength == strength::required)
+                    throw std::invalid_argument("An edit variable can't be required.");
+
+                const Constraint constraint(Expression(variable), RelationalOperator::Equal, clipped_strength);
+                AddConstraint(constraint);
+                edits_.emplace(variable, EditInfo{ constraints_.at(constraint), constraint, 0.0 });
+            }
+
+            void Solver::RemoveEditVariable(const Variable& variable)
+            {
+                const auto find_result = edits_.find(variable);
+                if (find_result == edits_.cend())
+                    throw std::invalid_argument("The variable is not editable.");
+
+                RemoveConstraint(find_result->second.constraint);
+                edits_.erase(find_result);
+            }
+
+            bool Solver::HasEditVariable(const Variable& variable) const
+            {
+                return edits_.count(variable) != 0;
+            }
+
+            void Solver::SuggestValue(const Variable& variable, const double value)
+            {
+                const auto find_result = edits_.find(variable);
+                if (find_result == edits_.cend())
+                    throw std::invalid_argument("The variable is not editable.");
+
+                auto& info = find_result->second;
+                const auto delta = value - info.constant;
+                info.constant = value;
+
+                // If the positive error variable is basic, only its row changes.
+                auto row_iter = rows_.find(info.tag.marker);
+                if (row_iter != rows_.cend())
+                {
+                    if (row_iter->second->Add(-delta) < 0.0)
+                        infeasible_rows_.push_back(row_iter->first);
+                    DualOptimize();
+                    return;
+                }
+
+                // If the negative error variable is basic, only its row changes.
+                row_iter = rows_.find(info.tag.other);
+                if (row_iter != rows_.cend())
+                {
+                    if (row_iter->second->Add(delta) < 0.0)
+                        infeasible_rows_.push_back(row_iter->first);
+                    DualOptimize();
+                    return;
+                }
+
+                // Otherwise update each row where the error variables exist.
+                for (auto& row : rows_)
+                {
+                    const auto coefficient = row.second->GetCoefficientFor(info.tag.marker);
+                    if (coefficient != 0.0 && row.second->Add(delta * coefficient) < 0.0 &&
+                        row.first.type != SymbolType::External)
+                        infeasible_rows_.push_back(row.first);
+                }
+                DualOptimize();
+            }
+
+            void Solver::UpdateVariables()
+            {
+                for (auto& variable : variables_)
+                {
+                    const auto row_iter = rows_.find(variable.second);
+                    *variable.first.data_ = row_iter == rows_.cend() ? 0.0 : row_iter->second->GetConstant();
+                }
+            }
+
+            Solver::Symbol Solver::CreateSymbol(const SymbolType type)
+            {
+                return Symbol(next_symbol_id_++, type);
+            }
+
+            Solver::Symbol Solver::GetVariableSymbol(const Variable& variable)
+            {
+                const auto find_result = variables_.find(variable);
+                if (find_result != variables_.cend())
+                    return find_result->second;
+                const auto symbol = CreateSymbol(SymbolType::External);
+                variables_.emplace(variable, symbol);
+                return symbol;
+            }
+
+            std::unique_ptr<Solver::Row> Solver::CreateRow(const Constraint& constraint, Tag& tag)
+            {
+                const auto& expression = constraint.GetExpression();
+                auto row = std::make_unique<Row>(expression.constant);
+
+                // Substitute the current basic variables into the row.
+                for (const auto& term : expression.terms)
+                {
+                    if (IsNearZeroHelperFunc(term.coefficient))
+                        continue;
+                    const auto symbol = GetVariableSymbol(term.variable);
+                    const auto row_iter = rows_.find(symbol);
+                    if (row_iter != rows_.cend())
+                        row->Insert(*row_iter->second, term.coefficient);
+                    else
+                        row->Insert(symbol, term.coefficient);
+                }
+
+                const auto strength = constraint.GetStrength();
+                switch (constraint.GetOperator())
+                {
+                case RelationalOperator::LessOrEqual:
+                case RelationalOperator::GreaterOrEqual:
+                {
+                    const auto coefficient = constraint.GetOperator() == RelationalOperator::LessOrEqual ? 1.0 : -1.0;
+                    const auto slack = CreateSymbol(SymbolType::Slack);
+                    tag.marker = slack;
+                    row->Insert(slack, coefficient);
+                    if (strength < strength::required)
+                    {
+                        const auto error = CreateSymbol(SymbolType::Error);
+                        tag.other = error;
+                        row->Insert(error, -coefficient);
+                        objective_->Insert(error, strength);
+                    }
+                    break;
+                }
+                case RelationalOperator::Equal:
+                {
+                    if (strength < strength::required)
+                    {
+                        const auto error_plus = CreateSymbol(SymbolType::Error);
+                        const auto error_minus = CreateSymbol(SymbolType::Error);
+                        tag.marker = error_plus;
+                        tag.other = error_minus;
+                        row->Insert(error_plus, -1.0);
+                        row->Insert(error_minus, 1.0);
+                        objective_->Insert(error_plus, strength);
+                        objective_->Insert(error_minus, strength);
+                    }
+                    else
+                    {
+                        const auto dummy = CreateSymbol(SymbolType::Dummy);
+                        tag.marker = dummy;
+                        row->Insert(dummy);
+                    }
+                    break;
+                }
+                }
+
+                // The constant of a row must be non-negative.
+                if (row->GetConstant() < 0.0)
+                    row->ReverseSign();
+
+                return row;
+            }
+
+            Solver::Symbol Solver::ChooseSubject(const Row& row, const Tag& tag)
+            {
+                for (const auto& cell : row.GetCells())
+                    if (cell.first.type == SymbolType::External)
+                        return cell.first;
+                if (tag.marker.IsPivotable() && row.GetCoefficientFor(tag.marker) < 0.0)
+                    return tag.marker;
+                if (tag.other.IsPivotable() && row.GetCoefficientFor(tag.other) < 0.0)
+                    return tag.other;
+                return Symbol();
+            }
+
+            bool Solver::AddWithArtificialVariable(const Row& row)
+            {
+                // Minimize an artificial variable standing for the row.
+                const auto artificial_symbol = CreateSymbol(SymbolType::Slack);
+                rows_[artificial_symbol] = std::make_unique<Row>(row);
+                artificial_ = std::make_unique<Row>(row);
+                Optimize(*artificial_);
+                const auto success = IsNearZeroHelperFunc(artificial_->GetConstant());
+                artificial_.reset();
+
+                // If the artificial variable is basic, pivot it out.
+                const auto row_iter = rows_.find(artificial_symbol);
+                if (!success && row_iter != rows_.cend())
+                {
+                    // it can't reach zero, so it is basic. Pivoting it out would
+                    // force the row on the others, so the row is dropped; the
+                    // pivots before kept the other rows feasible but maybe not
+                    // optimal.
+                    rows_.erase(row_iter);
+                    Optimize(*objective_);
+                    return false;
+                }
+                if (row_iter != rows_.cend())
+                {
+                    auto basic_row = std::move(row_iter->second);
+                    rows_.erase(row_iter);
+                    if (basic_row->GetCells().empty())
+                        return success;
+                    const auto entering = GetAnyPivotableSymbol(*basic_row);
+                    if (!entering.IsValid())
+                        return false;
+                    basic_row->SolveFor(artificial_symbol, entering);
+                    Substitute(entering, *basic_row);
+                    rows_[entering] = std::move(basic_row);
+                }
+
+                // Remove the artificial variable from the tableau.
+                for (auto& r : rows_)
+                    r.second->Remove(artificial_symbol);
+                objective_->Remove(artificial_symbol);
+                return success;
+            }
+
+            void Solver::Pivot(std::unique_ptr<Row> row, const Symbol leaving, const Symbol entering)
+            {
+                pivot_count_++;
+                row->SolveFor(leaving, entering);
+                Substitute(entering, *row);
+                rows_[entering] = std::move(row);
+            }
+
+            void Solver::Substitute(const Symbol symbol, const Row& row)
+            {
+                for (auto& r : rows_)
+                {
+                    r.second->Substitute(symbol, row);
+                    if (r.first.type != SymbolType::External && r.second->GetConstant() < 0.0)
+                        infeasible_rows_.push_back(r.first);
+                }
+                objective_->Substitute(symbol, row);
+                if (artificial_)
+                    artificial_->Substitute(symbol, row);
+            }
+
+            void Solver::Optimize(Row& objective)
+            {
+                while (true)
+                {
+                    const auto entering = GetEnteringSymbol(objective);
+                    if (!entering.IsValid())
+                        return;
+
+                    const auto row_iter = GetLeavingRow(entering);
+                    if (row_iter == rows_.cend())
+                        throw std::logic_error("The objective is unbounded.");
+
+                    const auto leaving = row_iter->first;
+                    auto row = std::move(row_iter->second);
+                    rows_.erase(row_iter);
+                    Pivot(std::move(row), leaving, entering);
+                }
+            }
+
+            void Solver::DualOptimize()
+            {
+                while (!infeasible_rows_.empty())
+                {
+                    const auto leaving = infeasible_rows_.back();
+                    infeasible_rows_.pop_back();
+
+                    const auto row_iter = rows_.find(leaving);
+                    if (row_iter == rows_.cend() || IsNearZeroHelperFunc(row_iter->second->GetConstant()) ||
+                        row_iter->second->GetConstant() >= 0.0)
+                        continue;
+
+                    const auto entering = GetDualEnteringSymbol(*row_iter->second);
+                    if (!entering.IsValid())
+                        throw std::logic_error("Dual optimize failed.");
+
+                    auto row = std::move(row_iter->second);
+                    rows_.erase(row_iter);
+                    Pivot(std::move(row), leaving, entering);
+                }
+            }
+
+            Solver::Symbol Solver::GetEnteringSymbol(const Row& objective)
+            {
+                for (const auto& cell : objective.GetCells())
+                    if (cell.first.type != SymbolType::Dummy && cell.second < 0.0)
+                        return cell.first;
+                return Symbol();
+            }
+
+            Solver::Symbol Solver::GetDualEnteringSymbol(const Row& row) const
+            {
+                Symbol entering;
+                auto ratio = std::numeric_limits<double>::max();
+                for (const auto& cell : row.GetCells())
+                {
+                    if (cell.second > 0.0 && cell.first.type != SymbolType::Dummy)
+                    {
+                        const auto r = objective_->GetCoefficientFor(cell.first) / cell.second;
+                        if (r < ratio)
+                        {
+                            ratio = r;
+                            entering = cell.first;
+                        }
+                    }
+                }
+                return entering;
+            }
+
+            Solver::Symbol Solver::GetAnyPivotableSymbol(const Row& row)
+            {
+                for (const auto& cell : row.GetCells())
+                    if (cell.first.IsPivotable())
+                        return cell.first;
+                return Symbol();
+            }
+
+            Solver::RowMap::iterator Solver::GetLeavingRow(const Symbol entering)
+            {
+                auto ratio = std::numeric_limits<double>::max();
+                auto found = rows_.end();
+                for (auto i = rows_.begin(); i != rows_.end(); ++i)
+                {
+                    if (i->first.type == SymbolType::External)
+                        continue;
+                    const auto coefficient = i->second->GetCoefficientFor(entering);
+                    if (coefficient < 0.0)
+                    {
+                        const auto r = -i->second->GetConstant() / coefficient;
+                        if (r < ratio)
+                        {
+                            ratio = r;
+                            found = i;
+                        }
+                    }
+                }
+                return found;
+            }
+
+            Solver::RowMap::iterator Solver::GetMarkerLeavingRow(const Symbol marker)
+            {
+                const auto max = std::numeric_limits<double>::max();
+                auto r1 = max;
+                auto r2 = max;
+                auto first = rows_.end();
+                auto second = rows_.end();
+                auto third = rows_.end();
+                for (auto i = rows_.begin(); i != rows_.end(); ++i)
+                {
+                    const auto coefficient = i->second->GetCoefficientFor(marker);
+                    if (coefficient == 0.0)
+                        continue;
+                    if (i->first.type == SymbolType::External)
+                    {
+                        third = i;
+                    }
+                    else if (coefficient < 0.0)
+                    {
+                        const auto r = -i->second->GetConstant() / coefficient;
+                        if (r < r1)
+                        {
+                            r1 = r;
+                            first = i;
+                        }
+                    }
+                    else
+                    {
+                        const auto r = i->second->GetConstant() / coefficient;
+                        if (r < r2)
+                        {
+                            r2 = r;
+                            second = i;
+                        }
+                    }
+                }
+                if (first != rows_.end())
+                    return first;
+                if (second != rows_.end())
+                    return second;
+                return third;
+            }
+
+            void Solver::RemoveConstraintEffects(const Constraint& constraint, const Tag& tag)
+            {
+                if (tag.marker.type == SymbolType::Error)
+                    RemoveMarkerEffects(tag.marker, constraint.GetStrength());
+                if (tag.other.type == SymbolType::Error)
+                    RemoveMarkerEffects(tag.other, constraint.GetStrength());
+            }
+
+            void Solver::RemoveMarkerEffects(const Symbol marker, const double strength)
+            {
+                const auto row_iter = rows_.find(marker);
+                if (row_iter != rows_.cend())
+                    objective_->Insert(*row_iter->second, -strength);
+                else
+                    objective_->Insert(marker, -strength);
+            }
+        }
+    }
+}
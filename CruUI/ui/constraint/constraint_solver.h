@@ -0,0 +1,276 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace constraint
+        {
+            //A variable of linear constraints. It is a handle, so copies refer
+            //to the same variable.
+            class Variable final
+            {
+                friend class Solver;
+            public:
+                Variable() : data_(std::make_shared<double>(0.0)) { }
+                Variable(const Variable& other) = default;
+                Variable(Variable&& other) = default;
+                Variable& operator=(const Variable& other) = default;
+                Variable& operator=(Variable&& other) = default;
+                ~Variable() = default;
+
+                //Get the value from the last "Solver::UpdateVariables".
+                double GetValue() const
+                {
+                    return *data_;
+                }
+
+                //Return true if both handles refer to the same variable.
+                bool IsSame(const Variable& other) const
+                {
+                    return data_ == other.data_;
+                }
+
+                //Ordering by identity for associative containers.
+                struct Less
+                {
+                    bool operator()(const Variable& left, const Variable& right) const
+                    {
+                        return left.data_ < right.data_;
+                    }
+                };
+
+            private:
+                std::shared_ptr<double> data_;
+            };
+
+            struct Term final
+            {
+                Term(const Variable& variable, const double coefficient = 1.0)
+                    : variable(variable), coefficient(coefficient) { }
+
+                Variable variable;
+                double coefficient;
+            };
+
+            //A linear expression: sum of terms plus a constant.
+            struct Expression final
+            {
+                Expression(const double constant = 0.0) : constant(constant) { }
+                Expression(const Variable& variable) : terms{ Term(variable) }, constant(0.0) { }
+                Expression(const Term& term) : terms{ term }, constant(0.0) { }
+                Expression(std::vector<Term> terms, const double constant)
+                    : terms(std::move(terms)), constant(constant) { }
+
+                std::vector<Term> terms;
+                double constant;
+            };
+
+            Expression operator + (const Expression& left, const Expression& right);
+            Expression operator - (const Expression& left, const Expression& right);
+            Expression operator - (const Expression& expression);
+            Expression operator * (const Expression& expression, double coefficient);
+            Expression operator * (double coefficient, const Expression& expression);
+            Expression operator / (const Expression& expression, double denominator);
+
+            namespace strength
+            {
+                constexpr double weak = 1.0;
+                constexpr double medium = 1e3;
+                constexpr double strong = 1e6;
+                constexpr double required = 1e9;
+            }
+
+            enum class RelationalOperator
+            {
+                LessOrEqual,
+                Equal,
+                GreaterOrEqual
+            };
+
+            //A linear constraint "expression op 0" with a strength. It is a
+            //handle, so copies refer to the same constraint.
+            class Constraint final
+            {
+            public:
+                Constraint(const Expression& expression, RelationalOperator op, double strength = strength::required);
+                //Copy the constraint with another strength.
+                Constraint(const Constraint& other, double strength);
+                Constraint(const Constraint& other) = default;
+                Constraint(Constraint&& other) = default;
+                Constraint& operator=(const Constraint& other) = default;
+                Constraint& operator=(Constraint&& other) = default;
+                ~Constraint() = default;
+
+                const Expression& GetExpression() const
+                {
+                    return data_->expression;
+                }
+
+                RelationalOperator GetOperator() const
+                {
+                    return data_->op;
+                }
+
+                double GetStrength() const
+                {
+                    return data_->strength;
+                }
+
+                struct Less
+                {
+                    bool operator()(const Constraint& left, const Constraint& right) const
+                    {
+                        return left.data_ < right.data_;
+                    }
+                };
+
+            private:
+                struct Data
+                {
+                    Expression expression;
+                    RelationalOperator op;
+                    double strength;
+                };
+
+                std::shared_ptr<const Data> data_;
+            };
+
+            Constraint operator == (const Expression& left, const Expression& right);
+            Constraint operator <= (const Expression& left, const Expression& right);
+            Constraint operator >= (const Expression& left, const Expression& right);
+            //Give the constraint a strength, such as "x >= 0 | strength::weak".
+            Constraint operator | (const Constraint& constraint, double strength);
+
+            //Thrown when a required constraint conflicts with the others.
+            class UnsatisfiableConstraintError : public std::runtime_error
+            {
+            public:
+                UnsatisfiableConstraintError() : std::runtime_error("The constraint can't be satisfied.") { }
+            };
+
+            //An incremental Cassowary solver. Constraints and edit variables can
+            //be added and removed at any time, and suggesting a value to an edit
+            //variable only re-optimizes the rows it affects with dual simplex.
+            class Solver final
+            {
+            public:
+                Solver();
+                Solver(const Solver& other) = delete;
+                Solver(Solver&& other) = delete;
+                Solver& operator=(const Solver& other) = delete;
+                Solver& operator=(Solver&& other) = delete;
+                ~Solver();
+
+                //Add a constraint. Throw "UnsatisfiableConstraintError" if it is
+                //required and conflicts with other required constraints, and
+                //then the solution still satisfies the others.
+                void AddConstraint(const Constraint& constraint);
+
+                void RemoveConstraint(const Constraint& constraint);
+
+                bool HasConstraint(const Constraint& constraint) const;
+
+                //Make a variable editable with a non-required strength.
+                void AddEditVariable(const Variable& variable, double strength);
+
+                void RemoveEditVariable(const Variable& variable);
+
+                bool HasEditVariable(const Variable& variable) const;
+
+                //Suggest a value for an edit variable.
+                void SuggestValue(const Variable& variable, double value);
+
+                //Write the solution to the variables.
+                void UpdateVariables();
+
+                int GetConstraintCount() const
+                {
+                    return static_cast<int>(constraints_.size());
+                }
+
+                //Get the count of pivots since the solver was created. It shows
+                //how much work an edit took.
+                long long GetPivotCount() const
+                {
+                    return pivot_count_;
+                }
+
+            private:
+                enum class SymbolType
+                {
+                    Invalid,
+                    External,
+                    Slack,
+                    Error,
+                    Dummy
+                };
+
+                struct Symbol
+                {
+                    Symbol() : id(0), type(SymbolType::Invalid) { }
+                    Symbol(const unsigned long long id, const SymbolType type) : id(id), type(type) { }
+
+                    bool IsValid() const { return type != SymbolType::Invalid; }
+                    bool IsPivotable() const { return type == SymbolType::Slack || type == SymbolType::Error; }
+
+                    bool operator < (const Symbol& other) const { return id < other.id; }
+                    bool operator == (const Symbol& other) const { return id == other.id; }
+
+                    unsigned long long id;
+                    SymbolType type;
+                };
+
+                class Row;
+
+                struct Tag
+                {
+                    Symbol marker;
+                    Symbol other;
+                };
+
+                struct EditInfo
+                {
+                    Tag tag;
+                    Constraint constraint;
+                    double constant;
+                };
+
+                using RowMap = std::map<Symbol, std::unique_ptr<Row>>;
+
+                Symbol CreateSymbol(SymbolType type);
+                Symbol GetVariableSymbol(const Variable& variable);
+                std::unique_ptr<Row> CreateRow(const Constraint& constraint, Tag& tag);
+                static Symbol ChooseSubject(const Row& row, const Tag& tag);
+                bool AddWithArtificialVariable(const Row& row);
+                void Pivot(std::unique_ptr<Row> row, Symbol leaving, Symbol entering);
+                void Substitute(Symbol symbol, const Row& row);
+                void Optimize(Row& objective);
+                void DualOptimize();
+                static Symbol GetEnteringSymbol(const Row& objective);
+                Symbol GetDualEnteringSymbol(const Row& row) const;
+                static Symbol GetAnyPivotableSymbol(const Row& row);
+                RowMap::iterator GetLeavingRow(Symbol entering);
+                RowMap::iterator GetMarkerLeavingRow(Symbol marker);
+                void RemoveConstraintEffects(const Constraint& constraint, const Tag& tag);
+                void RemoveMarkerEffects(Symbol marker, double strength);
+
+            private:
+                std::map<Constraint, Tag, Constraint::Less> constraints_;
+                std::map<Variable, Symbol, Variable::Less> variables_;
+                std::map<Variable, EditInfo, Variable::Less> edits_;
+                RowMap rows_;
+                std::vector<Symbol> infeasible_rows_;
+                std::unique_ptr<Row> objective_;
+                std::unique_ptr<Row> artificial_;
+                unsigned long long next_symbol_id_ = 1;
+                long long pivot_count_ = 0;
+            };
+        }
+    }
+}
@@ -0,0 +1,933 @@
+#include "control.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <typeinfo>
+
+#include "window.h"
+#include "thread_pool.h"
+#include "layout_params_pool.h"
+
+namespace cru {
+    namespace ui {
+        using namespace events;
+
+        Control::Control() :
+            window_(nullptr),
+            parent_(nullptr),
+            children_(),
+            subtree_size_(1),
+            position_(Point::zero),
+            size_(Size::zero),
+            transform_(),
+            is_clip_to_bounds_(false),
+            is_subtree_bounds_invalid_(true),
+            subtree_bounds_(),
+            is_opaque_(false),
+            is_cached_as_layer_(false),
+            is_occluded_(false),
+            is_subtree_occluded_(false),
+            position_cache_(),
+            display_list_(),
+            is_display_list_invalid_(true),
+            is_mouse_inside_(false),
+            layout_params_(nullptr),
+            desired_size_(Size::zero),
+            is_measure_invalid_(true),
+            is_layout_invalid_(true),
+            last_measure_available_size_(std::nullopt),
+            last_layout_rect_(std::nullopt)
+        {
+            BasicLayoutParams layout_params;
+            layout_params.size.width.mode = MeasureMode::Content;
+            layout_params.size.height.mode = MeasureMode::Content;
+            layout_params_ = LayoutParamsPool::GetInstance()->Intern(layout_params);
+        }
+
+        Control::~Control()
+        {
+
+        }
+
+        Control* Control::GetParent()
+        {
+            return this->parent_;
+        }
+
+        void Control::ForeachChild(std::function<void(Control*)> predicate)
+        {
+            for (auto child : children_)
+                predicate(child);
+        }
+
+        void Control::ForeachChild(std::function<FlowControl(Control*)> predicate)
+        {
+            for (auto child : children_)
+            {
+                if (predicate(child) == FlowControl::Break)
+                    break;
+            }
+        }
+
+        std::vector<Control*> Control::GetChildren()
+        {
+            return this->children_;
+        }
+
+        void AddChildCheck(Control* control)
+        {
+            if (control->GetParent() != nullptr)
+                throw std::invalid_argument("The control already has a parent.");
+
+            if (dynamic_cast<Window*>(control))
+                throw std::invalid_argument("Can't add a window as child.");
+        }
+
+        void Control::AddChild(Control* control)
+        {
+            AddChildCheck(control);
+
+            this->children_.push_back(control);
+
+            control->parent_ = this;
+
+            for (auto c = this; c != nullptr; c = c->parent_)
+                c->subtree_size_ += control->subtree_size_;
+
+            this->OnAddChild(control);
+
+            InvalidateSubtreeBounds();
+            InvalidateMeasure();
+        }
+
+        void Control::AddChild(Control* control, int position)
+        {
+            AddChildCheck(control);
+
+            if (position < 0 || static_cast<decltype(this->children_.size())>(position) > this->children_.size())
+                throw std::invalid_argument("The position is out of range.");
+
+            this->children_.insert(this->children_.cbegin() + position, control);
+
+            control->parent_ = this;
+
+            for (auto c = this; c != nullptr; c = c->parent_)
+                c->subtree_size_ += control->subtree_size_;
+
+            this->OnAddChild(control);
+
+            InvalidateSubtreeBounds();
+            InvalidateMeasure();
+        }
+
+        void Control::RemoveChild(Control* child)
+        {
+            const auto i = std::find(this->children_.cbegin(), this->children_.cend(), child);
+            if (i == this->children_.cend())
+                throw std::invalid_argument("The argument child is not a child of this control.");
+
+            this->children_.erase(i);
+
+            child->parent_ = nullptr;
+
+            for (auto c = this; c != nullptr; c = c->parent_)
+                c->subtree_size_ -= child->subtree_size_;
+
+            this->OnRemoveChild(child);
+
+            InvalidateSubtreeBounds();
+            InvalidateMeasure();
+        }
+
+        void Control::RemoveChild(int position)
+        {
+            if (position < 0 || static_cast<decltype(this->children_.size())>(position) >= this->children_.size())
+                throw std::invalid_argument("The position is out of range.");
+
+            const auto p = children_.cbegin() + position;
+            const auto child = *p;
+            children_.erase(p);
+
+            child->parent_ = nullptr;
+
+            for (auto c = this; c != nullptr; c = c->parent_)
+                c->subtree_size_ -= child->subtree_size_;
+
+            this->OnRemoveChild(child);
+
+            InvalidateSubtreeBounds();
+            InvalidateMeasure();
+        }
+
+        Control* Control::GetAncestor()
+        {
+            // if attached to window, the window is the ancestor.
+            if (window_)
+                return window_;
+
+            // otherwise find the ancestor
+            auto ancestor = this;
+            while (const auto parent = ancestor->GetParent())
+                ancestor = parent;
+            return ancestor;
+        }
+
+        Window * Control::GetWindow()
+        {
+            return window_;
+        }
+
+        void TraverseDescendantsInternal(Control* control,
+            const std::function<void(Control*)>& predicate)
+        {
+            predicate(control);
+            control->ForeachChild([predicate](Control* c) {
+                TraverseDescendantsInternal(c, predicate);
+            });
+        }
+
+        void Control::TraverseDescendants(
+            const std::function<void(Control*)>& predicate)
+        {
+            TraverseDescendantsInternal(this, predicate);
+        }
+
+        Point Control::GetPositionRelative()
+        {
+            return position_;
+        }
+
+        void Control::SetPositionRelative(const Point & position)
+        {
+            if (position_ == position)
+                return;
+            DamageSubtree();
+            position_ = position;
+            if (auto window = GetWindow())
+                window->GetLayoutManager()->InvalidateControlPositionCache(this);
+            //TODO: Position change notify.
+        }
+
+        Size Control::GetSize()
+        {
+            return size_;
+        }
+
+        void Control::SetSize(const Size & size)
+        {
+            // layout sets the size every pass, so only a real change records the content again.
+            if (size_ != size)
+                Repaint();
+            const auto old_size = size_;
+            size_ = size;
+            InvalidateSubtreeBounds();
+            SizeChangedEventArgs args(this, this, old_size, size);
+            OnSizeChangedCore(args);
+        }
+
+        void Control::SetTransform(const Matrix& transform)
+        {
+            if (transform_ == transform)
+                return;
+            DamageSubtree();
+            transform_ = transform;
+            if (auto window = GetWindow())
+                window->GetLayoutManager()->InvalidateControlPositionCache(this);
+        }
+
+        Matrix Control::GetLocalMatrix()
+        {
+            if (transform_.IsIdentity())
+                return Matrix::Translation(position_);
+            return transform_ * Matrix::Translation(position_);
+        }
+
+        Point Control::GetPositionAbsolute()
+        {
+            return position_cache_.lefttop_position_absolute;
+        }
+
+        Point Control::LocalToAbsolute(const Point& point)
+        {
+            return position_cache_.world_matrix.TransformPoint(point);
+        }
+
+        Point Control::AbsoluteToLocal(const Point & point)
+        {
+            // a collapsed control has no local point, and nothing is inside it.
+            if (!position_cache_.inverse_world_matrix.has_value())
+                return Point(std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::quiet_NaN());
+            return position_cache_.inverse_world_matrix->TransformPoint(point);
+        }
+
+        bool Control::IsPointInside(const Point & point)
+        {
+            auto size = GetSize();
+            return point.x >= 0.0f && point.x < size.width && point.y >= 0.0f && point.y < size.height;
+        }
+
+        void Control::Draw(graph::Painter& painter, const Rect& clip)
+        {
+            DrawInternal(painter, clip, false);
+        }
+
+        void Control::DrawSubtree(graph::Painter& painter)
+        {
+            DrawInternal(painter, GetSubtreeBounds(), true);
+        }
+
+        void Control::DrawInternal(graph::Painter& painter, const Rect& clip, const bool is_into_layer)
+        {
+            if (GetSubtreeBounds().Intersect(clip).IsEmpty())
+            {
+                if (window_ != nullptr)
+                    window_->current_draw_statistics_.culled_subtree_count++;
+                return;
+            }
+
+            if (is_subtree_occluded_ && !is_into_layer)
+            {
+                if (window_ != nullptr)
+                    window_->current_draw_statistics_.occluded_subtree_count++;
+                return;
+            }
+
+            if (is_cached_as_layer_ && !is_into_layer && DrawLayer(painter))
+                return;
+
+            // the world matrix is cached, so no matrix is read back or combined here.
+            const auto& matrix = position_cache_.world_matrix;
+            painter.SetTransform(matrix);
+
+            // children are above this control, so they may still show.
+            if (is_occluded_ && !is_into_layer)
+            {
+                if (window_ != nullptr)
+                    window_->current_draw_statistics_.occluded_count++;
+            }
+            else
+            {
+                if (window_ != nullptr)
+                    window_->current_draw_statistics_.drawn_count++;
+                if (is_display_list_invalid_)
+                {
+                    display_list_.Clear();
+                    OnDraw(display_list_);
+                    DrawEventArgs args(this, this, &display_list_);
+                    draw_event.Raise(args);
+                    is_display_list_invalid_ = false;
+                    if (window_ != nullptr)
+                        window_->current_draw_statistics_.recorded_count++;
+                }
+                display_list_.Replay(painter);
+            }
+
+            if (!is_clip_to_bounds_)
+            {
+                for (auto child : children_)
+                    child->DrawInternal(painter, clip, is_into_layer);
+                return;
+            }
+
+            // the clip is pushed in local coordinates; with a rotation it covers the bounds.
+            const auto size = GetSize();
+            painter.PushClip(Rect(Point::zero, size));
+            const auto child_clip = clip.Intersect(matrix.TransformBounds(Rect(Point::zero, size)));
+            for (auto child : children_)
+                child->DrawInternal(painter, child_clip, is_into_layer);
+            painter.PopClip();
+        }
+
+        bool Control::DrawLayer(graph::Painter& painter)
+        {
+            // a layer is composited at whole units, so only translations keep it sharp.
+            if (window_ == nullptr || !position_cache_.world_matrix.IsTranslation())
+                return false;
+
+            const auto bounds = GetSubtreeBounds();
+            const auto rect = Rect::FromVertices(std::floor(bounds.left), std::floor(bounds.top),
+                std::ceil(bounds.GetRight()), std::ceil(bounds.GetBottom()));
+            if (rect.IsEmpty())
+                return false;
+
+            auto& cache = window_->layer_cache_;
+            auto& statistics = window_->current_draw_statistics_;
+            std::shared_ptr<graph::Layer> layer;
+            // a layer painted for other bounds has the content at another
+            // offset, and one of another kind of painter can't be drawn.
+            const auto cached_layer = cache.Find(this);
+            if (cached_layer != nullptr && cached_layer->bounds == bounds && painter.CanDrawLayer(*cached_layer->layer))
+            {
+                layer = cached_layer->layer;
+                statistics.layer_hit_count++;
+            }
+            else
+            {
+                layer = painter.CreateLayer(rect.GetSize());
+                if (layer == nullptr)
+                {
+                    cache.Remove(this);
+                    return false;
+                }
+
+                // the subtree sets absolute transforms, so it is recorded and
+                // replayed moved to the origin of the layer.
+                graph::DisplayList display_list;
+                DrawInternal(display_list, rect, true);
+                painter.PaintLayer(*layer, [&display_list, &rect](graph::Painter& layer_painter) {
+                    layer_painter.SetTransform(Matrix::Translation(-rect.left, -rect.top));
+                    display_list.Replay(layer_painter);
+                });
+                cache.Add(this, CachedLayer{ bounds, layer }, layer->GetByteSize());
+                statistics.layer_miss_count++;
+            }
+
+            painter.SetTransform(Matrix::Identity());
+            painter.DrawLayer(*layer, rect.GetLeftTop());
+            return true;
+        }
+
+        void Control::SetClipToBounds(const bool clip_to_bounds)
+        {
+            if (is_clip_to_bounds_ == clip_to_bounds)
+                return;
+            DamageSubtree();
+            is_clip_to_bounds_ = clip_to_bounds;
+            InvalidateSubtreeBounds();
+        }
+
+        void Control::SetOpaque(const bool opaque)
+        {
+            if (is_opaque_ == opaque)
+                return;
+            DamageSubtree();
+            is_opaque_ = opaque;
+        }
+
+        void Control::SetCachedAsLayer(const bool cached_as_layer)
+        {
+            is_cached_as_layer_ = cached_as_layer;
+            if (!cached_as_layer && window_ != nullptr)
+                window_->layer_cache_.Remove(this);
+        }
+
+        Rect Control::GetSubtreeBounds()
+        {
+            if (!is_subtree_bounds_invalid_)
+                return subtree_bounds_;
+
+            const auto& matrix = position_cache_.world_matrix;
+            auto bounds = matrix.TransformBounds(GetDrawBounds());
+            for (auto child : children_)
+                bounds = bounds.Union(child->GetSubtreeBounds());
+            if (is_clip_to_bounds_)
+                bounds = bounds.Intersect(matrix.TransformBounds(Rect(Point::zero, GetSize())));
+
+            subtree_bounds_ = bounds;
+            is_subtree_bounds_invalid_ = false;
+            return bounds;
+        }
+
+        void Control::Repaint()
+        {
+            is_display_list_invalid_ = true;
+            DamageSubtree();
+        }
+
+        void Control::DamageSubtree()
+        {
+            if (const auto window = GetWindow())
+                window->AddControlDamage(this);
+        }
+
+        bool Control::RequestFocus()
+        {
+            auto window = GetWindow();
+            if (window == nullptr)
+                return false;
+
+            return window->RequestFocusFor(this);
+        }
+
+        bool Control::HasFocus()
+        {
+            auto window = GetWindow();
+            if (window == nullptr)
+                return false;
+
+            return window->GetFocusControl() == this;
+        }
+
+        void Control::Measure(const Size& available_size)
+        {
+            if (!is_measure_invalid_ && last_measure_available_size_ == available_size)
+                return;
+
+            if (window_ != nullptr)
+                window_->GetLayoutManager()->current_measure_count_++;
+
+            SetDesiredSize(OnMeasure(available_size));
+            last_measure_available_size_ = available_size;
+            is_measure_invalid_ = false;
+            // desired sizes of children may have changed, so rearrange them.
+            is_layout_invalid_ = true;
+        }
+
+        void Control::Layout(const Rect& rect)
+        {
+            // children are placed relative to this control, so a pure move
+            // doesn't need to rearrange them.
+            if (!is_layout_invalid_ && last_layout_rect_.has_value() && last_layout_rect_->GetSize() == rect.GetSize())
+            {
+                if (last_layout_rect_->GetLeftTop() != rect.GetLeftTop())
+                    SetPositionRelative(rect.GetLeftTop());
+                last_layout_rect_ = rect;
+                return;
+            }
+
+            if (window_ != nullptr)
+                window_->GetLayoutManager()->current_layout_count_++;
+
+            SetPositionRelative(rect.GetLeftTop());
+            SetSize(rect.GetSize());
+            OnLayout(rect);
+            last_layout_rect_ = rect;
+            is_layout_invalid_ = false;
+        }
+
+        Size Control::GetDesiredSize()
+        {
+            return desired_size_;
+        }
+
+        void Control::SetDesiredSize(const Size& desired_size)
+        {
+            desired_size_ = desired_size;
+        }
+
+        void Control::SetLayoutParams(const BasicLayoutParams& basic_layout_params)
+        {
+            layout_params_ = LayoutParamsPool::GetInstance()->Intern(basic_layout_params);
+            InvalidateMeasure();
+        }
+
+        void Control::SetLayoutParamsInternal(std::shared_ptr<const BasicLayoutParams> layout_params)
+        {
+            if (layout_params != nullptr && typeid(*layout_params) == typeid(BasicLayoutParams))
+                layout_params_ = LayoutParamsPool::GetInstance()->Intern(*layout_params);
+            else
+                layout_params_ = std::move(layout_params);
+            InvalidateMeasure();
+        }
+
+        void Control::InvalidateMeasure()
+        {
+            auto control = this;
+            control->is_measure_invalid_ = true;
+            control->is_layout_invalid_ = true;
+            while (const auto parent = control->GetParent())
+            {
+                // the parent has to measure and arrange the child again anyway,
+                // but its own size only changes if it depends on children.
+                parent->is_measure_invalid_ = true;
+                parent->is_layout_invalid_ = true;
+                parent->OnChildMeasureInvalidated(control);
+                control = parent;
+                if (!parent->IsSizeDependentOnChildren())
+                    break;
+            }
+
+            if (const auto window = GetWindow())
+                window->GetLayoutManager()->InvalidateControlLayout(control);
+        }
+
+        void Control::InvalidateLayout()
+        {
+            is_layout_invalid_ = true;
+            if (const auto window = GetWindow())
+                window->GetLayoutManager()->InvalidateControlLayout(this);
+        }
+
+        void Control::OnAddChild(Control* child)
+        {
+            if (auto window = dynamic_cast<Window*>(GetAncestor()))
+            {
+                child->TraverseDescendants([window](Control* control) {
+                    control->OnAttachToWindow(window);
+                });
+                window->RefreshControlList();
+                // the cache was relative to another tree, if any.
+                window->GetLayoutManager()->InvalidateControlPositionCache(child);
+                // nothing was drawn yet, so only the bounds after layout are damaged.
+                window->AddControlDamage(child, false);
+
+            }
+        }
+
+        void Control::OnRemoveChild(Control* child)
+        {
+            if (auto window = dynamic_cast<Window*>(GetAncestor()))
+            {
+                window->AddControlDamage(child);
+                child->TraverseDescendants([window](Control* control) {
+                    control->OnDetachToWindow(window);
+                });
+                window->RefreshControlList();
+            }
+        }
+
+        void Control::OnAttachToWindow(Window* window)
+        {
+            window_ = window;
+        }
+
+        void Control::OnDetachToWindow(Window * window)
+        {
+            window->GetLayoutManager()->OnControlDetach(this);
+            window->damaged_controls_.erase(this);
+            window->layer_cache_.Remove(this);
+            window_ = nullptr;
+        }
+
+        void Control::OnDraw(graph::Painter& painter)
+        {
+
+        }
+
+        Rect Control::GetDrawBounds()
+        {
+            return Rect(Point::zero, GetSize());
+        }
+
+        Rect Control::GetOpaqueBounds()
+        {
+            return is_opaque_ ? Rect(Point::zero, GetSize()) : Rect();
+        }
+
+        void Control::InvalidateSubtreeBounds()
+        {
+            // ancestors of an invalid control are already invalid.
+            for (auto control = this; control != nullptr && !control->is_subtree_bounds_invalid_; control = control->parent_)
+                control->is_subtree_bounds_invalid_ = true;
+        }
+
+        void Control::OnPositionChanged(PositionChangedEventArgs & args)
+        {
+
+        }
+
+        void Control::OnSizeChanged(SizeChangedEventArgs & args)
+        {
+        }
+
+        void Control::OnPositionChangedCore(PositionChangedEventArgs & args)
+        {
+            OnPositionChanged(args);
+            position_changed_event.Raise(args);
+        }
+
+        void Control::OnSizeChangedCore(SizeChangedEventArgs & args)
+        {
+            OnSizeChanged(args);
+            size_changed_event.Raise(args);
+        }
+
+        void Control::OnMouseEnter(MouseEventArgs & args)
+        {
+        }
+
+        void Control::OnMouseLeave(MouseEventArgs & args)
+        {
+        }
+
+        void Control::OnMouseMove(MouseEventArgs & args)
+        {
+        }
+
+        void Control::OnMouseDown(MouseButtonEventArgs & args)
+        {
+        }
+
+        void Control::OnMouseUp(MouseButtonEventArgs & args)
+        {
+        }
+
+        void Control::OnMouseEnterCore(MouseEventArgs & args)
+        {
+            is_mouse_inside_ = true;
+            OnMouseEnter(args);
+            mouse_enter_event.Raise(args);
+        }
+
+        void Control::OnMouseLeaveCore(MouseEventArgs & args)
+        {
+            is_mouse_inside_ = false;
+            OnMouseLeave(args);
+            mouse_leave_event.Raise(args);
+        }
+
+        void Control::OnMouseMoveCore(MouseEventArgs & args)
+        {
+            OnMouseMove(args);
+            mouse_move_event.Raise(args);
+        }
+
+        void Control::OnMouseDownCore(MouseButtonEventArgs & args)
+        {
+            OnMouseDown(args);
+            mouse_down_event.Raise(args);
+        }
+
+        void Control::OnMouseUpCore(MouseButtonEventArgs & args)
+        {
+            OnMouseUp(args);
+            mouse_up_event.Raise(args);
+        }
+
+        void Control::OnGetFocus(UiEventArgs & args)
+        {
+        }
+
+        void Control::OnLoseFocus(UiEventArgs & args)
+        {
+        }
+
+        void Control::OnGetFocusCore(UiEventArgs & args)
+        {
+            OnGetFocus(args);
+            get_focus_event.Raise(args);
+        }
+
+        void Control::OnLoseFocusCore(UiEventArgs & args)
+        {
+            OnLoseFocus(args);
+            lose_focus_event.Raise(args);
+        }
+
+        inline float MaxSizeHelperFunc(const OptionalLength max_length, float available_length)
+        {
+            return max_length.has_value() ? std::min(max_length.value(), available_length) : available_length;
+        }
+
+        inline float CoerceLengthHelperFunc(const float length, const OptionalLength min_length, const OptionalLength max_length)
+        {
+            auto result = length;
+            if (max_length.has_value())
+                result = std::min(result, max_length.value());
+            // min_size is of higher priority than max_size.
+            if (min_length.has_value())
+                result = std::max(result, min_length.value());
+            return result;
+        }
+
+        // The room offered to children in one dimension.
+        inline float ChildAvailableLengthHelperFunc(const MeasureLength& length, const float real_max_length)
+        {
+            if (length.mode == MeasureMode::Exactly)
+                return std::min(length.length, real_max_length);
+            return real_max_length;
+        }
+
+        // The final length in one dimension given the children's extent.
+        inline float MeasureLengthHelperFunc(const MeasureLength& length, const float real_max_length, const float content_length)
+        {
+            switch (length.mode)
+            {
+            case MeasureMode::Exactly:
+                return length.length;
+            case MeasureMode::Stretch:
+                // can't stretch to infinity, so fall back to content.
+                return std::isinf(real_max_length) ? content_length : real_max_length;
+            default:
+                return content_length;
+            }
+        }
+
+        // Whether "MeasureLengthHelperFunc" returns the content length.
+        inline bool IsLengthOfContentHelperFunc(const MeasureLength& length, const float real_max_length)
+        {
+            switch (length.mode)
+            {
+            case MeasureMode::Exactly:
+                return false;
+            case MeasureMode::Stretch:
+                return std::isinf(real_max_length);
+            default:
+                return true;
+            }
+        }
+
+        void Control::MeasureChildren(const Size& available_size)
+        {
+            const auto layout_manager = window_ != nullptr ? window_->GetLayoutManager() : nullptr;
+            const auto threshold = layout_manager != nullptr ? layout_manager->GetParallelMeasureThreshold() : 0;
+
+            // a clean child returns immediately, so only invalid subtrees count.
+            auto cost = 0;
+            if (threshold > 0 && children_.size() > 1 && !ThreadPool::IsInParallelFor())
+                for (auto child : children_)
+                    cost += child->is_measure_invalid_ ? child->subtree_size_ : 1;
+
+            if (threshold > 0 && cost >= threshold && layout_manager->GetThreadPool() != nullptr)
+            {
+                layout_manager->current_parallel_measure_count_++;
+                layout_manager->GetThreadPool()->ParallelFor(static_cast<int>(children_.size()), [this, &available_size](const int index) {
+                    children_[index]->Measure(available_size);
+                });
+                return;
+            }
+
+            for (auto child : children_)
+                child->Measure(available_size);
+        }
+
+        Size Control::GetContentAvailableSize(const Size& available_size)
+        {
+            const auto layout_params = GetLayoutParams();
+
+            // real_max_size is the greater one between max_size in layout_params and available_size.
+            Size real_max_size;
+            real_max_size.width = MaxSizeHelperFunc(layout_params->max_size.width, available_size.width);
+            real_max_size.height = MaxSizeHelperFunc(layout_params->max_size.height, available_size.height);
+
+            return Size(
+                ChildAvailableLengthHelperFunc(layout_params->size.width, real_max_size.width),
+                ChildAvailableLengthHelperFunc(layout_params->size.height, real_max_size.height)
+            );
+        }
+
+        Size Control::CalculateDesiredSize(const Size& available_size, const Size& content_size)
+        {
+            const auto layout_params = GetLayoutParams();
+
+            Size real_max_size;
+            real_max_size.width = MaxSizeHelperFunc(layout_params->max_size.width, available_size.width);
+            real_max_size.height = MaxSizeHelperFunc(layout_params->max_size.height, available_size.height);
+
+            return Size(
+                CoerceLengthHelperFunc(
+                    MeasureLengthHelperFunc(layout_params->size.width, real_max_size.width, content_size.width),
+                    layout_params->min_size.width, layout_params->max_size.width),
+                CoerceLengthHelperFunc(
+                    MeasureLengthHelperFunc(layout_params->size.height, real_max_size.height, content_size.height),
+                    layout_params->min_size.height, layout_params->max_size.height)
+            );
+        }
+
+        Size Control::GetChildLayoutSize(Control* child, const Size& room)
+        {
+            const auto child_layout_params = child->GetLayoutParams();
+            const auto child_desired_size = child->GetDesiredSize();
+            return Size(
+                child_layout_params->size.width.mode == MeasureMode::Stretch
+                ? CoerceLengthHelperFunc(room.width, child_layout_params->min_size.width, child_layout_params->max_size.width)
+                : child_desired_size.width,
+                child_layout_params->size.height.mode == MeasureMode::Stretch
+                ? CoerceLengthHelperFunc(room.height, child_layout_params->min_size.height, child_layout_params->max_size.height)
+                : child_desired_size.height
+            );
+        }
+
+        Size Control::OnMeasure(const Size& available_size)
+        {
+            MeasureChildren(GetContentAvailableSize(available_size));
+
+            // by default children are overlapped, so the content is the union of them.
+            Size content_size = Size::zero;
+            for (auto child : children_)
+            {
+                const auto child_desired_size = child->GetDesiredSize();
+                content_size.width = std::max(content_size.width, child_desired_size.width);
+                content_size.height = std::max(content_size.height, child_desired_size.height);
+            }
+
+            return CalculateDesiredSize(available_size, content_size);
+        }
+
+        void Control::OnLayout(const Rect& rect)
+        {
+            // stretched children fill this control, others keep their desired size.
+            for (auto child : children_)
+                child->Layout(Rect(Point::zero, GetChildLayoutSize(child, rect.GetSize())));
+        }
+
+        bool Control::IsSizeDependentOnChildren()
+        {
+            // never measured, so there is no result to keep.
+            if (!last_measure_available_size_.has_value())
+                return true;
+
+            // stretched in infinite room, the size falls back to the content.
+            const auto layout_params = GetLayoutParams();
+            const auto& available_size = *last_measure_available_size_;
+            return IsLengthOfContentHelperFunc(layout_params->size.width, MaxSizeHelperFunc(layout_params->max_size.width, available_size.width)) ||
+                IsLengthOfContentHelperFunc(layout_params->size.height, MaxSizeHelperFunc(layout_params->max_size.height, available_size.height));
+        }
+
+        void Control::OnChildMeasureInvalidated(Control* child)
+        {
+
+        }
+
+        std::list<Control*> GetAncestorList(Control* control)
+        {
+            std::list<Control*> l;
+            while (control != nullptr)
+            {
+                l.push_front(control);
+                control = control->GetParent();
+            }
+            return l;
+        }
+
+        Control* FindLowestCommonAncestor(Control * left, Control * right)
+        {
+            if (left == nullptr || right == nullptr)
+                return nullptr;
+
+            auto&& left_list = GetAncestorList(left);
+            auto&& right_list = GetAncestorList(right);
+
+            // the root is different
+            if (left_list.front() != right_list.front())
+                return nullptr;
+
+            // find the last same control or the last control (one is the other's ancestor)
+            auto left_i = left_list.cbegin();
+            auto right_i = right_list.cbegin();
+            while (true)
+            {
+                if (left_i == left_list.cend())
+                    return *(--left_i);
+                if (right_i == right_list.cend())
+                    return *(--right_i);
+                if (*left_i != *right_i)
+                    return *(--left_i);
+                ++left_i;
+                ++right_i;
+            }
+        }
+
+        Control * IsAncestorOrDescendant(Control * left, Control * right)
+        {
+            //Search up along the trunk from "left". Return if find "right".
+            auto control = left;
+            while (control != nullptr)
+            {
+                if (control == right)
+                    return control;
+                control = control->GetParent();
+            }
+            //Search up along the trunk from "right". Return if find "left".
+            control = right;
+            while (control != nullptr)
+            {
+                if (control == left)
+                    return control;
+                control = control->GetParent();
+            }
+            return nullptr;
+        }
+    }
+}
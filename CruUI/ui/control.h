@@ -0,0 +1,441 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <optional>
+
+#include "base.h"
+#include "ui_base.h"
+#include "layout_base.h"
+#include "matrix.h"
+#include "graph/display_list.h"
+#include "events/ui_event.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        class Control;
+        class Window;
+
+
+        //the position cache
+        struct ControlPositionCache
+        {
+            //The lefttop relative to the ancestor.
+            Point lefttop_position_absolute = Point::zero;
+            //Maps local points to points relative to the ancestor.
+            Matrix world_matrix;
+            //Maps points relative to the ancestor to local points. It is empty
+            //if the world matrix collapses the plane.
+            std::optional<Matrix> inverse_world_matrix = Matrix();
+        };
+
+
+        class Control : public Object
+        {
+            friend class Window;
+            friend class WindowLayoutManager;
+        protected:
+            Control();
+
+        public:
+            Control(const Control& other) = delete;
+            Control(Control&& other) = delete;
+            Control& operator=(const Control& other) = delete;
+            Control& operator=(Control&& other) = delete;
+            ~Control() override;
+
+        public:
+
+            //*************** region: tree ***************
+
+            //Get parent of control, return nullptr if it has no parent.
+            Control* GetParent();
+
+            //Traverse the children
+            void ForeachChild(std::function<void(Control*)> predicate);
+            void ForeachChild(std::function<FlowControl(Control*)> predicate);
+
+            //Return a vector of all children. This function will create a
+            //temporary copy of vector of children. If you just want to
+            //traverse all children, just call ForeachChild.
+            std::vector<Control*> GetChildren();
+
+            //Add a child at tail.
+            void AddChild(Control* control);
+
+            //Add a child before the position.
+            void AddChild(Control* control, int position);
+
+            //Remove a child.
+            void RemoveChild(Control* child);
+
+            //Remove a child at specified position.
+            void RemoveChild(int position);
+
+            //Get the ancestor of the control.
+            Control* GetAncestor();
+
+            //Get the window if attached, otherwise, return nullptr.
+            Window* GetWindow();
+
+            //Traverse the tree rooted the control.
+            void TraverseDescendants(const std::function<void(Control*)>& predicate);
+
+            //*************** region: position and size ***************
+            // Position and size part must be isolated from layout part.
+            // All the operations in this part must be done independently.
+            // And layout part must use api of this part.
+
+            //Get the lefttop relative to its parent.
+            virtual Point GetPositionRelative();
+
+            //Set the lefttop relative to its parent.
+            virtual void SetPositionRelative(const Point& position);
+
+            //Get the actual size.
+            virtual Size GetSize();
+
+            //Set the actual size directly without relayout.
+            virtual void SetSize(const Size& size);
+
+            //Get the transform of the control and its descendants. It is
+            //applied in local coordinates, so it turns around the lefttop.
+            const Matrix& GetTransform() const
+            {
+                return transform_;
+            }
+
+            //Set the transform of the control and its descendants. Layout
+            //doesn't see it.
+            void SetTransform(const Matrix& transform);
+
+            //Get the matrix from local coordinates to coordinates of the
+            //parent: the transform, then the relative position.
+            Matrix GetLocalMatrix();
+
+            //Get the matrix from local coordinates to coordinates of the
+            //ancestor. Notice that the value is cached with the position.
+            const Matrix& GetWorldMatrix() const
+            {
+                return position_cache_.world_matrix;
+            }
+
+            //Get lefttop relative to ancestor. This is only valid when
+            //attached to window. Notice that the value is cached.
+            //You can invalidate and recalculate it by calling "InvalidatePositionCache". 
+            Point GetPositionAbsolute();
+
+            //Local point to absolute point.
+            Point LocalToAbsolute(const Point& point);
+
+            //Absolute point to local point.
+            Point AbsoluteToLocal(const Point& point);
+
+            bool IsPointInside(const Point& point);
+
+
+            //*************** region: graphic ***************
+
+            //Draw this control and its child controls. Subtrees whose bounds
+            //don't intersect "clip" are skipped. "clip" is relative to the ancestor.
+            //The content is recorded once and replayed until "Repaint".
+            void Draw(graph::Painter& painter, const Rect& clip);
+
+            //Draw this control and its descendants completely, for example
+            //into an image. Neither the occlusion found in the last frame nor
+            //the cached layers are used.
+            void DrawSubtree(graph::Painter& painter);
+
+            //Return true if drawing of descendants is clipped to the rect of
+            //this control.
+            bool IsClipToBounds() const
+            {
+                return is_clip_to_bounds_;
+            }
+
+            void SetClipToBounds(bool clip_to_bounds);
+
+            //Return true if the control declares its rect opaque, so controls
+            //fully covered by it are not drawn.
+            bool IsOpaque() const
+            {
+                return is_opaque_;
+            }
+
+            void SetOpaque(bool opaque);
+
+            //Return true if the control and its descendants are drawn into a
+            //layer once and the layer is drawn while none of them changes.
+            bool IsCachedAsLayer() const
+            {
+                return is_cached_as_layer_;
+            }
+
+            //Cache the subtree as a layer, for complex subtrees that rarely
+            //change. It takes effect when the world matrix is a translation
+            //and the painter supports layers, within the memory budget of
+            //the window's layer cache.
+            void SetCachedAsLayer(bool cached_as_layer);
+
+            //Get the conservative bounds of what the control and its
+            //descendants draw, relative to the ancestor. It is cached and only
+            //recomputed on invalid paths.
+            Rect GetSubtreeBounds();
+
+            //Damage what the control and its descendants draw now and after
+            //the next layout, and record the content again in the next frame.
+            //Call it before the content changes.
+            virtual void Repaint();
+
+            //*************** region: focus ***************
+
+            bool RequestFocus();
+
+            bool HasFocus();
+
+
+            //*************** region: layout ***************
+
+            //Measure the control with the available size. It is skipped if the
+            //measure is still valid and the available size doesn't change.
+            void Measure(const Size& available_size);
+
+            //Place the control at rect relative to its parent. It is skipped if
+            //the layout is still valid and the rect doesn't change.
+            void Layout(const Rect& rect);
+
+            Size GetDesiredSize();
+
+            void SetDesiredSize(const Size& desired_size);
+
+            //Mark the measure result invalid. The invalidation is propagated up
+            //until a parent whose size doesn't depend on its children, which is
+            //then scheduled to be re-laid out by the window.
+            void InvalidateMeasure();
+
+            //Mark the arrangement of children invalid without re-measuring.
+            void InvalidateLayout();
+
+            bool IsMeasureValid() const
+            {
+                return !is_measure_invalid_;
+            }
+
+            bool IsLayoutValid() const
+            {
+                return !is_layout_invalid_;
+            }
+
+            //Layout params are immutable and may be shared among controls.
+            //To change them, set a new one.
+            template<typename TLayoutParams = BasicLayoutParams>
+            std::shared_ptr<const TLayoutParams> GetLayoutParams()
+            {
+                static_assert(std::is_base_of_v<BasicLayoutParams, TLayoutParams>, "TLayoutParams must be subclass of BasicLayoutParams.");
+                return std::static_pointer_cast<const TLayoutParams>(layout_params_);
+            }
+
+            //Plain "BasicLayoutParams" are interned in "LayoutParamsPool", so
+            //identical ones share one instance. Subclasses are kept as they are.
+            template<typename TLayoutParams = BasicLayoutParams,
+                typename = std::enable_if_t<std::is_base_of_v<BasicLayoutParams, TLayoutParams>>>
+                void SetLayoutParams(std::shared_ptr<TLayoutParams> basic_layout_params)
+            {
+                static_assert(std::is_base_of_v<BasicLayoutParams, TLayoutParams>, "TLayoutParams must be subclass of BasicLayoutParams.");
+                SetLayoutParamsInternal(std::move(basic_layout_params));
+            }
+
+            //Set a copy of the params, interned in "LayoutParamsPool".
+            void SetLayoutParams(const BasicLayoutParams& basic_layout_params);
+
+            //*************** region: events ***************
+            //Raised when mouse enter the control.
+            events::MouseEvent mouse_enter_event;
+            //Raised when mouse is leave the control.
+            events::MouseEvent mouse_leave_event;
+            //Raised when mouse is move in the control.
+            events::MouseEvent mouse_move_event;
+            //Raised when a mouse button is pressed in the control.
+            events::MouseButtonEvent mouse_down_event;
+            //Raised when a mouse button is released in the control.
+            events::MouseButtonEvent mouse_up_event;
+
+            events::UiEvent get_focus_event;
+            events::UiEvent lose_focus_event;
+
+            events::DrawEvent draw_event;
+
+            events::PositionChangedEvent position_changed_event;
+            events::SizeChangedEvent size_changed_event;
+
+        protected:
+            //Get the children without copying, for layout of panels.
+            const std::vector<Control*>& GetInternalChildren() const
+            {
+                return children_;
+            }
+
+            //Invoked when a child is added. Overrides should invoke base.
+            virtual void OnAddChild(Control* child);
+            //Invoked when a child is removed. Overrides should invoke base.
+            virtual void OnRemoveChild(Control* child);
+
+            //Invoked when the control is attached to a window. Overrides should invoke base.
+            virtual void OnAttachToWindow(Window* window);
+            //Invoked when the control is detached to a window. Overrides should invoke base.
+            virtual void OnDetachToWindow(Window* window);
+
+            //Draw the content in local coordinates. It is recorded and
+            //replayed in later frames, so it must only depend on state whose
+            //changes invoke "Repaint".
+            virtual void OnDraw(graph::Painter& painter);
+
+            //Get the local bounds of what "OnDraw" draws. It is the rect of the
+            //control by default. Override it if drawing goes out of the rect,
+            //and invoke "InvalidateSubtreeBounds" when it changes.
+            virtual Rect GetDrawBounds();
+
+            //Mark the subtree bounds of this control and its ancestors invalid.
+            void InvalidateSubtreeBounds();
+
+            //Get the local rect "OnDraw" fills with opaque content. It is the
+            //rect of the control if it is opaque, otherwise empty.
+            virtual Rect GetOpaqueBounds();
+
+
+            // For a event, the window event system will first dispatch event to core functions.
+            // Therefore for particular controls, you should do essential actions in core functions,
+            // and override version should invoke base version. The base core function
+            // in "Control" class will call corresponding non-core function and call "Raise" on
+            // event objects. So user custom actions should be done by overriding non-core function
+            // and calling the base version is optional.
+
+            //*************** region: position and size event ***************
+            virtual void OnPositionChanged(events::PositionChangedEventArgs& args);
+            virtual void OnSizeChanged(events::SizeChangedEventArgs& args);
+
+            virtual void OnPositionChangedCore(events::PositionChangedEventArgs& args);
+            virtual void OnSizeChangedCore(events::SizeChangedEventArgs& args);
+
+
+            //*************** region: mouse event ***************
+            virtual void OnMouseEnter(events::MouseEventArgs& args);
+            virtual void OnMouseLeave(events::MouseEventArgs& args);
+            virtual void OnMouseMove(events::MouseEventArgs& args);
+            virtual void OnMouseDown(events::MouseButtonEventArgs& args);
+            virtual void OnMouseUp(events::MouseButtonEventArgs& args);
+
+            virtual void OnMouseEnterCore(events::MouseEventArgs& args);
+            virtual void OnMouseLeaveCore(events::MouseEventArgs& args);
+            virtual void OnMouseMoveCore(events::MouseEventArgs& args);
+            virtual void OnMouseDownCore(events::MouseButtonEventArgs& args);
+            virtual void OnMouseUpCore(events::MouseButtonEventArgs& args);
+
+
+            //*************** region: focus event ***************
+            virtual void OnGetFocus(events::UiEventArgs& args);
+            virtual void OnLoseFocus(events::UiEventArgs& args);
+
+            virtual void OnGetFocusCore(events::UiEventArgs& args);
+            virtual void OnLoseFocusCore(events::UiEventArgs& args);
+
+            //*************** region: layout ***************
+
+            //Measure all children with the available size. When the estimated
+            //work under the children reaches the window's parallel measure
+            //threshold, they are measured on the thread pool. Each child only
+            //writes its own subtree, so the result is the same either way.
+            void MeasureChildren(const Size& available_size);
+
+            //Get the room offered to the content according to the layout params.
+            Size GetContentAvailableSize(const Size& available_size);
+
+            //Get the desired size from the size of the content according to
+            //the layout params.
+            Size CalculateDesiredSize(const Size& available_size, const Size& content_size);
+
+            //Get the size of a child placed in "room": stretched dimensions
+            //fill the room and the others keep the desired size.
+            static Size GetChildLayoutSize(Control* child, const Size& room);
+
+            virtual Size OnMeasure(const Size& available_size);
+            virtual void OnLayout(const Rect& rect);
+
+            //Return true if the desired size of this control may change when a
+            //child's desired size changes. Invalidation stops at a control
+            //returning false.
+            virtual bool IsSizeDependentOnChildren();
+
+            //Invoked on every parent marked by "InvalidateMeasure" of a
+            //descendant, with the child on the path. Panels caching results
+            //per child can use it to only redo that child.
+            virtual void OnChildMeasureInvalidated(Control* child);
+
+        private:
+            //Damage what the subtree draws without recording the content
+            //again, for changes that only move it.
+            void DamageSubtree();
+
+            //Draw as "Draw" does. Drawing into a layer uses neither the
+            //results of the occlusion pass nor cached layers.
+            void DrawInternal(graph::Painter& painter, const Rect& clip, bool is_into_layer);
+
+            //Draw the cached layer of the subtree, painting it first if it is
+            //missing. Return false if the subtree can't be drawn as a layer.
+            bool DrawLayer(graph::Painter& painter);
+
+            void SetLayoutParamsInternal(std::shared_ptr<const BasicLayoutParams> layout_params);
+
+        private:
+            Window * window_;
+
+            Control * parent_;
+            std::vector<Control*> children_;
+            //Count of controls in the tree rooted at this control.
+            int subtree_size_;
+
+            Point position_;
+            Size size_;
+            Matrix transform_;
+
+            bool is_clip_to_bounds_;
+            //Invalid bounds of a control implies invalid bounds of its ancestors.
+            bool is_subtree_bounds_invalid_;
+            Rect subtree_bounds_;
+
+            bool is_opaque_;
+            bool is_cached_as_layer_;
+            //Results of the occlusion pass of the current frame.
+            bool is_occluded_;
+            bool is_subtree_occluded_;
+
+            ControlPositionCache position_cache_;
+
+            //What "OnDraw" and "draw_event" drew the last time.
+            graph::DisplayList display_list_;
+            bool is_display_list_invalid_;
+
+            bool is_mouse_inside_;
+
+            std::shared_ptr<const BasicLayoutParams> layout_params_;
+            Size desired_size_;
+
+            bool is_measure_invalid_;
+            bool is_layout_invalid_;
+            //The arguments of last measure and layout, used to skip clean
+            //controls and to re-lay out a control from itself.
+            std::optional<Size> last_measure_available_size_;
+            std::optional<Rect> last_layout_rect_;
+        };
+
+        // Find the lowest common ancestor.
+        // Return nullptr if "left" and "right" are not in the same tree.
+        Control* FindLowestCommonAncestor(Control* left, Control* right);
+
+        // Return the ancestor if one control is the ancestor of the other one, otherwise nullptr.
+        Control* IsAncestorOrDescendant(Control* left, Control* right);
+    }
+}
@@ -0,0 +1,122 @@
+#include "constraint_panel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            using namespace constraint;
+
+            ConstraintPanel::ConstraintPanel(const double child_size_strength)
+                : child_size_strength_(child_size_strength)
+            {
+                solver_.AddEditVariable(width_, strength::strong);
+                solver_.AddEditVariable(height_, strength::strong);
+            }
+
+            const ConstraintPanel::ChildVariables& ConstraintPanel::GetChildVariables(Control* child) const
+            {
+                const auto find_result = child_variables_.find(child);
+                if (find_result == child_variables_.cend())
+                    throw std::invalid_argument("The control is not a child of the panel.");
+                return find_result->second;
+            }
+
+            void ConstraintPanel::AddConstraint(const Constraint& constraint)
+            {
+                solver_.AddConstraint(constraint);
+                InvalidateMeasure();
+            }
+
+            void ConstraintPanel::RemoveConstraint(const Constraint& constraint)
+            {
+                solver_.RemoveConstraint(constraint);
+                InvalidateMeasure();
+            }
+
+            void ConstraintPanel::OnAddChild(Control* child)
+            {
+                Control::OnAddChild(child);
+
+                const auto& variables = child_variables_[child];
+                solver_.AddEditVariable(variables.width, child_size_strength_);
+                solver_.AddEditVariable(variables.height, child_size_strength_);
+            }
+
+            void ConstraintPanel::OnRemoveChild(Control* child)
+            {
+                const auto find_result = child_variables_.find(child);
+                if (find_result != child_variables_.cend())
+                {
+                    solver_.RemoveEditVariable(find_result->second.width);
+                    solver_.RemoveEditVariable(find_result->second.height);
+                    suggested_values_.erase(find_result->second.width);
+                    suggested_values_.erase(find_result->second.height);
+                    child_variables_.erase(find_result);
+                }
+
+                Control::OnRemoveChild(child);
+            }
+
+            Size ConstraintPanel::OnMeasure(const Size& available_size)
+            {
+                // children measure their content, the solver decides the rest.
+                MeasureChildren(available_size);
+                for (const auto& pair : child_variables_)
+                {
+                    const auto desired_size = pair.first->GetDesiredSize();
+                    SuggestValue(pair.second.width, desired_size.width);
+                    SuggestValue(pair.second.height, desired_size.height);
+                }
+
+                if (!std::isinf(available_size.width))
+                    SuggestValue(width_, available_size.width);
+                if (!std::isinf(available_size.height))
+                    SuggestValue(height_, available_size.height);
+                solver_.UpdateVariables();
+
+                // the content is the bounds of the solved children.
+                Size content_size = Size::zero;
+                for (const auto& pair : child_variables_)
+                {
+                    const auto& variables = pair.second;
+                    content_size.width = std::max(content_size.width, static_cast<float>(variables.left.GetValue() + variables.width.GetValue()));
+                    content_size.height = std::max(content_size.height, static_cast<float>(variables.top.GetValue() + variables.height.GetValue()));
+                }
+
+                return CalculateDesiredSize(available_size, content_size);
+            }
+
+            void ConstraintPanel::OnLayout(const Rect& rect)
+            {
+                SuggestValue(width_, rect.width);
+                SuggestValue(height_, rect.height);
+                solver_.UpdateVariables();
+
+                for (const auto& pair : child_variables_)
+                {
+                    const auto& variables = pair.second;
+                    pair.first->Layout(Rect(
+                        static_cast<float>(variables.left.GetValue()),
+                        static_cast<float>(variables.top.GetValue()),
+                        static_cast<float>(std::max(0.0, variables.width.GetValue())),
+                        static_cast<float>(std::max(0.0, variables.height.GetValue()))
+                    ));
+                }
+            }
+
+            void ConstraintPanel::SuggestValue(const Variable& variable, const double value)
+            {
+                const auto find_result = suggested_values_.find(variable);
+                if (find_result != suggested_values_.cend() && find_result->second == value)
+                    return;
+                solver_.SuggestValue(variable, value);
+                suggested_values_[variable] = value;
+            }
+        }
+    }
+}
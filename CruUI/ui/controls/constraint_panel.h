@@ -0,0 +1,90 @@
+#pragma once
+
+#include <map>
+
+#include "ui/control.h"
+#include "ui/constraint/constraint_solver.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            //A panel that places children by linear constraints between their
+            //edges and the panel's size. The solver is incremental, so a resize
+            //only suggests new values to the edit variables of the panel size
+            //instead of solving again from scratch.
+            //
+            //Every child has "left", "top", "width" and "height" variables.
+            //"width" and "height" are edit variables following the child's
+            //desired size with "child_size_strength", so constraints stronger
+            //than that can override them. The panel size is edited with strong
+            //strength.
+            class ConstraintPanel : public Control
+            {
+            public:
+                struct ChildVariables
+                {
+                    constraint::Variable left;
+                    constraint::Variable top;
+                    constraint::Variable width;
+                    constraint::Variable height;
+                };
+
+            public:
+                explicit ConstraintPanel(double child_size_strength = constraint::strength::medium);
+                ConstraintPanel(const ConstraintPanel& other) = delete;
+                ConstraintPanel(ConstraintPanel&& other) = delete;
+                ConstraintPanel& operator=(const ConstraintPanel& other) = delete;
+                ConstraintPanel& operator=(ConstraintPanel&& other) = delete;
+                ~ConstraintPanel() override = default;
+
+                //Variables of the panel's own width and height.
+                const constraint::Variable& GetWidthVariable() const
+                {
+                    return width_;
+                }
+
+                const constraint::Variable& GetHeightVariable() const
+                {
+                    return height_;
+                }
+
+                //Get the variables of a child. Throw if it is not a child.
+                const ChildVariables& GetChildVariables(Control* child) const;
+
+                //Add a constraint and invalidate the layout.
+                void AddConstraint(const constraint::Constraint& constraint);
+
+                //Remove a constraint and invalidate the layout. Constraints on a
+                //child must be removed before the child is.
+                void RemoveConstraint(const constraint::Constraint& constraint);
+
+                constraint::Solver* GetSolver()
+                {
+                    return &solver_;
+                }
+
+            protected:
+                void OnAddChild(Control* child) override;
+                void OnRemoveChild(Control* child) override;
+
+                Size OnMeasure(const Size& available_size) override;
+                void OnLayout(const Rect& rect) override;
+
+            private:
+                //Suggest a value only if it changes, to skip dual optimization.
+                void SuggestValue(const constraint::Variable& variable, double value);
+
+            private:
+                constraint::Solver solver_;
+                double child_size_strength_;
+                constraint::Variable width_;
+                constraint::Variable height_;
+                std::map<Control*, ChildVariables> child_variables_;
+                std::map<constraint::Variable, double, constraint::Variable::Less> suggested_values_;
+            };
+        }
+    }
+}
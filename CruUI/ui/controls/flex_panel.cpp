@@ -0,0 +1,238 @@
+#include "flex_panel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            FlexPanel::FlexPanel(const Orientation direction, const FlexWrap wrap)
+                : direction_(direction), wrap_(wrap), resolved_main_size_(std::numeric_limits<float>::quiet_NaN()),
+                cross_room_(std::numeric_limits<float>::infinity())
+            {
+
+            }
+
+            void FlexPanel::SetDirection(const Orientation direction)
+            {
+                if (direction_ == direction)
+                    return;
+                direction_ = direction;
+                InvalidateMeasure();
+            }
+
+            void FlexPanel::SetWrap(const FlexWrap wrap)
+            {
+                if (wrap_ == wrap)
+                    return;
+                wrap_ = wrap;
+                InvalidateMeasure();
+            }
+
+            Size FlexPanel::OnMeasure(const Size& available_size)
+            {
+                const auto content_available_size = GetContentAvailableSize(available_size);
+                cross_room_ = GetCrossLength(content_available_size, direction_);
+                // children whose room doesn't change skip measuring in "Measure".
+                MeasureChildren(MakeSize(std::numeric_limits<float>::infinity(), cross_room_, direction_));
+
+                UpdateItemMetrics();
+                ResolveLines(GetMainLength(content_available_size, direction_));
+
+                auto main_length = 0.0f;
+                auto cross_length = 0.0f;
+                for (const auto& line : lines_)
+                {
+                    main_length = std::max(main_length, line.main_length);
+                    cross_length += line.cross_length;
+                }
+
+                return CalculateDesiredSize(available_size, MakeSize(main_length, cross_length, direction_));
+            }
+
+            void FlexPanel::OnLayout(const Rect& rect)
+            {
+                const auto& children = GetInternalChildren();
+                if (items_.size() != children.size())
+                    UpdateItemMetrics();
+
+                const auto main_size = GetMainLength(rect.GetSize(), direction_);
+                if (main_size != resolved_main_size_)
+                    ResolveLines(main_size);
+
+                // a single line fills the panel across.
+                const auto single_line = wrap_ == FlexWrap::NoWrap;
+                auto cross_offset = 0.0f;
+                for (const auto& line : lines_)
+                {
+                    const auto line_cross_length = single_line ? GetCrossLength(rect.GetSize(), direction_) : line.cross_length;
+                    auto main_offset = 0.0f;
+                    for (auto i = line.begin; i < line.end; i++)
+                    {
+                        const auto& item = items_[i];
+                        const auto child_cross_length = item.is_cross_stretch
+                            ? GetCrossLength(GetChildLayoutSize(children[i], MakeSize(item.main_length, line_cross_length, direction_)), direction_)
+                            : item.cross_length;
+                        children[i]->Layout(Rect(
+                            MakePoint(main_offset, cross_offset, direction_),
+                            MakeSize(item.main_length, child_cross_length, direction_)
+                        ));
+                        main_offset += item.main_length;
+                    }
+                    cross_offset += line_cross_length;
+                }
+            }
+
+            void FlexPanel::UpdateItemMetrics()
+            {
+                const auto& children = GetInternalChildren();
+                items_.resize(children.size());
+                for (decltype(children.size()) i = 0; i < children.size(); i++)
+                {
+                    const auto desired_size = children[i]->GetDesiredSize();
+                    const auto layout_params = children[i]->GetLayoutParams();
+                    const auto flex_layout_params = dynamic_cast<const FlexLayoutParams*>(layout_params.get());
+                    auto& item = items_[i];
+                    item.basis = GetMainLength(desired_size, direction_);
+                    item.basis_cross_length = GetCrossLength(desired_size, direction_);
+                    item.cross_length = item.basis_cross_length;
+                    item.grow = flex_layout_params != nullptr ? flex_layout_params->grow : 0.0f;
+                    item.shrink = flex_layout_params != nullptr ? flex_layout_params->shrink : 0.0f;
+                    const auto min_main_length = direction_ == Orientation::Horizontal ? layout_params->min_size.width : layout_params->min_size.height;
+                    const auto max_main_length = direction_ == Orientation::Horizontal ? layout_params->max_size.width : layout_params->max_size.height;
+                    item.min_main_length = min_main_length.has_value() ? min_main_length.value() : 0.0f;
+                    item.max_main_length = max_main_length.has_value() ? max_main_length.value() : std::numeric_limits<float>::infinity();
+                    item.is_cross_stretch = (direction_ == Orientation::Horizontal
+                        ? layout_params->size.height : layout_params->size.width).mode == MeasureMode::Stretch;
+                    item.main_length = item.basis;
+                }
+                resolved_main_size_ = std::numeric_limits<float>::quiet_NaN();
+            }
+
+            void FlexPanel::ResolveLines(const float main_size)
+            {
+                resolved_main_size_ = main_size;
+                lines_.clear();
+
+                const auto& children = GetInternalChildren();
+                const auto count = static_cast<int>(items_.size());
+                const auto can_break = wrap_ == FlexWrap::Wrap && !std::isinf(main_size);
+
+                auto begin = 0;
+                while (begin < count)
+                {
+                    // break before the first item that overflows, but keep at least one item.
+                    auto end = begin;
+                    auto total_basis = 0.0f;
+                    while (end < count)
+                    {
+                        const auto& item = items_[end];
+                        if (can_break && end > begin && total_basis + item.basis > main_size)
+                            break;
+                        total_basis += item.basis;
+                        end++;
+                    }
+
+                    FlexLine(begin, end, std::isinf(main_size) ? 0.0f : main_size - total_basis);
+
+                    auto used_length = 0.0f;
+                    auto cross_length = 0.0f;
+                    for (auto i = begin; i < end; i++)
+                    {
+                        auto& item = items_[i];
+                        // the cross length may change with the main one, as wrapped text does.
+                        if (item.main_length != item.basis)
+                        {
+                            children[i]->Measure(MakeSize(item.main_length, cross_room_, direction_));
+                            item.cross_length = GetCrossLength(children[i]->GetDesiredSize(), direction_);
+                        }
+                        else
+                            item.cross_length = item.basis_cross_length;
+                        used_length += item.main_length;
+                        cross_length = std::max(cross_length, item.cross_length);
+                    }
+
+                    lines_.push_back(LineMetrics{ begin, end, used_length, cross_length });
+                    begin = end;
+                }
+            }
+
+            void FlexPanel::FlexLine(const int begin, const int end, const float free_length)
+            {
+                // every flexible item takes "basis + level * weight" clamped to
+                // its limits, and the sum is monotone in the level. So sorting
+                // where items reach their limits and sweeping them finds the
+                // level of the free length in one pass, which is what freezing
+                // the clamped items round by round ends at.
+                flex_thresholds_.clear();
+                auto target_length = free_length;
+                for (auto i = begin; i < end; i++)
+                {
+                    auto& item = items_[i];
+                    item.main_length = item.basis;
+                    const auto weight = free_length > 0.0f ? item.grow : free_length < 0.0f ? item.shrink * item.basis : 0.0f;
+                    item.flex_weight = weight > 0.0f ? weight : 0.0f;
+                    if (item.flex_weight == 0.0f)
+                        continue;
+                    // min is of higher priority than max, as in "CoerceLengthHelperFunc".
+                    const auto max_main_length = std::max(item.min_main_length, item.max_main_length);
+                    target_length += item.basis;
+                    flex_thresholds_.push_back(FlexThreshold{ (item.min_main_length - item.basis) / item.flex_weight, i, true });
+                    if (!std::isinf(max_main_length))
+                        flex_thresholds_.push_back(FlexThreshold{ (max_main_length - item.basis) / item.flex_weight, i, false });
+                }
+                if (flex_thresholds_.empty())
+                    return;
+                std::sort(flex_thresholds_.begin(), flex_thresholds_.end(), [](const FlexThreshold& left, const FlexThreshold& right) {
+                    return left.level < right.level;
+                });
+
+                // below every threshold all items are at their min; the sum
+                // is "clamped_length + basis_sum + level * weight_sum".
+                auto clamped_length = 0.0f;
+                for (const auto& threshold : flex_thresholds_)
+                    if (threshold.is_min)
+                        clamped_length += items_[threshold.item].min_main_length;
+                auto basis_sum = 0.0f;
+                auto weight_sum = 0.0f;
+                auto level = std::numeric_limits<float>::infinity();
+                for (const auto& threshold : flex_thresholds_)
+                {
+                    if (clamped_length + basis_sum + threshold.level * weight_sum >= target_length)
+                    {
+                        level = weight_sum > 0.0f ? (target_length - clamped_length - basis_sum) / weight_sum : -std::numeric_limits<float>::infinity();
+                        break;
+                    }
+                    const auto& item = items_[threshold.item];
+                    if (threshold.is_min)
+                    {
+                        clamped_length -= item.min_main_length;
+                        basis_sum += item.basis;
+                        weight_sum += item.flex_weight;
+                    }
+                    else
+                    {
+                        clamped_length += std::max(item.min_main_length, item.max_main_length);
+                        basis_sum -= item.basis;
+                        weight_sum -= item.flex_weight;
+                    }
+                }
+                if (std::isinf(level) && level > 0.0f && weight_sum > 0.0f)
+                    level = (target_length - clamped_length - basis_sum) / weight_sum;
+
+                for (auto i = begin; i < end; i++)
+                {
+                    auto& item = items_[i];
+                    if (item.flex_weight == 0.0f)
+                        continue;
+                    const auto target = item.basis + level * item.flex_weight;
+                    item.main_length = std::max(item.min_main_length, std::min(target, item.max_main_length));
+                }
+            }
+        }
+    }
+}
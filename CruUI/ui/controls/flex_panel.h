@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+
+#include "ui/control.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            //Layout params of children of "FlexPanel". Children with plain
+            //"BasicLayoutParams" neither grow nor shrink.
+            struct FlexLayoutParams : BasicLayoutParams
+            {
+                //Share of the free room along the main axis the child takes.
+                float grow = 0.0f;
+                //Share of the lacking room the child gives up, weighted by its
+                //desired length along the main axis.
+                float shrink = 1.0f;
+            };
+
+            enum class FlexWrap
+            {
+                NoWrap,
+                Wrap
+            };
+
+            //A flexbox-like panel. Children are measured once with infinite
+            //room along the direction, then broken into lines and grown or
+            //shrunk within their min and max size. Grown or shrunk children
+            //are measured again at their final length, which gives the cross
+            //length of their line. The resolution is cached and only redone
+            //in layout if the final main size differs from the measured one.
+            class FlexPanel : public Control
+            {
+            public:
+                explicit FlexPanel(Orientation direction = Orientation::Horizontal, FlexWrap wrap = FlexWrap::NoWrap);
+                FlexPanel(const FlexPanel& other) = delete;
+                FlexPanel(FlexPanel&& other) = delete;
+                FlexPanel& operator=(const FlexPanel& other) = delete;
+                FlexPanel& operator=(FlexPanel&& other) = delete;
+                ~FlexPanel() override = default;
+
+                Orientation GetDirection() const
+                {
+                    return direction_;
+                }
+
+                void SetDirection(Orientation direction);
+
+                FlexWrap GetWrap() const
+                {
+                    return wrap_;
+                }
+
+                void SetWrap(FlexWrap wrap);
+
+            protected:
+                Size OnMeasure(const Size& available_size) override;
+                void OnLayout(const Rect& rect) override;
+
+            private:
+                struct ItemMetrics
+                {
+                    float basis;
+                    //The cross length at "basis".
+                    float basis_cross_length;
+                    //The cross length at "main_length".
+                    float cross_length;
+                    float grow;
+                    float shrink;
+                    float min_main_length;
+                    float max_main_length;
+                    bool is_cross_stretch;
+                    //The grow or shrink weight in the current line, 0 if the
+                    //item keeps its basis.
+                    float flex_weight;
+                    //The main length after growing or shrinking.
+                    float main_length;
+                };
+
+                //The level at which an item reaches its min or max length,
+                //where a level gives each item "basis + level * flex_weight".
+                struct FlexThreshold
+                {
+                    float level;
+                    int item;
+                    bool is_min;
+                };
+
+                struct LineMetrics
+                {
+                    int begin;
+                    int end;
+                    float main_length;
+                    float cross_length;
+                };
+
+                void UpdateItemMetrics();
+
+                //Break items into lines for "main_size" and resolve their main length.
+                void ResolveLines(float main_size);
+
+                //Share "free_length" among the items in [begin, end) by grow or
+                //shrink. Items clamped by their min or max length stay at it
+                //and the rest of the free length goes to the others. It takes
+                //O(n log n) of the item count.
+                void FlexLine(int begin, int end, float free_length);
+
+            private:
+                Orientation direction_;
+                FlexWrap wrap_;
+                std::vector<ItemMetrics> items_;
+                std::vector<LineMetrics> lines_;
+                //Kept to not allocate for every line.
+                std::vector<FlexThreshold> flex_thresholds_;
+                //The main size "lines_" was resolved for.
+                float resolved_main_size_;
+                //The cross room children were last measured with.
+                float cross_room_;
+            };
+        }
+    }
+}
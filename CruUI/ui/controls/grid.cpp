@@ -0,0 +1,500 @@
+#include "grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            inline void EraseIndexHelperFunc(std::vector<int>& indices, const int index)
+            {
+                const auto found = std::find(indices.begin(), indices.end(), index);
+                if (found != indices.end())
+                    indices.erase(found);
+            }
+
+            inline float GetAxisLengthHelperFunc(const Size& size, const int axis_index)
+            {
+                return axis_index == 0 ? size.width : size.height;
+            }
+
+            Grid::Grid() = default;
+
+            Grid::Grid(std::vector<GridLength> rows, std::vector<GridLength> columns)
+                : row_definitions_(std::move(rows)), column_definitions_(std::move(columns))
+            {
+
+            }
+
+            void Grid::SetRows(std::vector<GridLength> rows)
+            {
+                row_definitions_ = std::move(rows);
+                is_structure_dirty_ = true;
+                InvalidateMeasure();
+            }
+
+            void Grid::SetColumns(std::vector<GridLength> columns)
+            {
+                column_definitions_ = std::move(columns);
+                is_structure_dirty_ = true;
+                InvalidateMeasure();
+            }
+
+            float Grid::GetRowLength(const int row) const
+            {
+                return axes_[1].tracks.at(row).length;
+            }
+
+            float Grid::GetColumnLength(const int column) const
+            {
+                return axes_[0].tracks.at(column).length;
+            }
+
+            void Grid::OnAddChild(Control* child)
+            {
+                Control::OnAddChild(child);
+                is_structure_dirty_ = true;
+            }
+
+            void Grid::OnRemoveChild(Control* child)
+            {
+                Control::OnRemoveChild(child);
+                is_structure_dirty_ = true;
+            }
+
+            void Grid::OnChildMeasureInvalidated(Control* child)
+            {
+                Control::OnChildMeasureInvalidated(child);
+                if (is_structure_dirty_)
+                    return;
+                const auto found = cell_indices_.find(child);
+                if (found != cell_indices_.end())
+                    MarkCellDirty(found->second);
+            }
+
+            Size Grid::OnMeasure(const Size& available_size)
+            {
+                const auto content_available_size = GetContentAvailableSize(available_size);
+                const float available_lengths[axis_count] = { content_available_size.width, content_available_size.height };
+
+                // which tracks are auto changes, so all cells move between tracks.
+                for (auto i = 0; i < axis_count; i++)
+                {
+                    const auto is_star_as_auto = std::isinf(available_lengths[i]);
+                    if (axes_[i].is_star_as_auto != is_star_as_auto)
+                    {
+                        axes_[i].is_star_as_auto = is_star_as_auto;
+                        is_structure_dirty_ = true;
+                    }
+                }
+
+                last_measured_cell_count_ = 0;
+                last_resolved_track_count_ = 0;
+
+                if (is_structure_dirty_)
+                    RebuildCells();
+                else
+                    for (const auto index : dirty_cells_)
+                        RefreshCell(index);
+
+                // cells out of star tracks size the auto tracks, so they go first.
+                for (const auto index : dirty_cells_)
+                    if (!cells_[index].is_deferred)
+                        MeasureCell(index);
+
+                auto is_star_changed = false;
+                for (auto i = 0; i < axis_count; i++)
+                    if (ResolveAxis(i, available_lengths[i]))
+                        is_star_changed = true;
+
+                for (const auto index : deferred_cells_)
+                    if (is_star_changed || cells_[index].is_dirty)
+                        MeasureCell(index);
+
+                for (const auto index : dirty_cells_)
+                    cells_[index].is_dirty = false;
+                dirty_cells_.clear();
+
+                Size content_size;
+                content_size.width = axes_[0].tracks.back().offset + axes_[0].tracks.back().length;
+                content_size.height = axes_[1].tracks.back().offset + axes_[1].tracks.back().length;
+                return CalculateDesiredSize(available_size, content_size);
+            }
+
+            void Grid::OnLayout(const Rect& rect)
+            {
+                // never measured since the children or tracks changed.
+                if (is_structure_dirty_)
+                    return;
+
+                const float lengths[axis_count] = { rect.width, rect.height };
+                for (auto i = 0; i < axis_count; i++)
+                {
+                    auto& axis = axes_[i];
+                    if (axis.is_star_as_auto)
+                        continue;
+                    const auto first_star = ShareStarRoom(axis, lengths[i]);
+                    if (first_star != -1)
+                        UpdateOffsets(axis, first_star);
+                }
+
+                for (const auto& cell : cells_)
+                {
+                    const Point position(axes_[0].tracks[cell.start[0]].offset, axes_[1].tracks[cell.start[1]].offset);
+                    const Size room(GetCellLength(cell, 0), GetCellLength(cell, 1));
+                    cell.control->Layout(Rect(position, GetChildLayoutSize(cell.control, room)));
+                }
+            }
+
+            bool Grid::IsAutoTrack(const Axis& axis, const Track& track)
+            {
+                return track.definition.unit == GridUnit::Auto ||
+                    (track.definition.unit == GridUnit::Star && axis.is_star_as_auto);
+            }
+
+            void Grid::RebuildCells()
+            {
+                const std::vector<GridLength>* definitions[axis_count] = { &column_definitions_, &row_definitions_ };
+                for (auto i = 0; i < axis_count; i++)
+                {
+                    auto& axis = axes_[i];
+                    axis.tracks.clear();
+                    if (definitions[i]->empty())
+                        axis.tracks.resize(1);
+                    else
+                        axis.tracks.resize(definitions[i]->size());
+                    for (decltype(axis.tracks.size()) j = 0; j < axis.tracks.size(); j++)
+                    {
+                        auto& track = axis.tracks[j];
+                        track.definition = definitions[i]->empty() ? GridLength::Star() : (*definitions[i])[j];
+                        if (track.definition.unit == GridUnit::Fixed)
+                            track.length = track.definition.value;
+                    }
+                    axis.star_room = std::numeric_limits<float>::quiet_NaN();
+                    UpdateOffsets(axis, 0);
+                }
+
+                const auto& children = GetInternalChildren();
+                cells_.clear();
+                cells_.resize(children.size());
+                cell_indices_.clear();
+                deferred_cells_.clear();
+                dirty_cells_.clear();
+                for (decltype(children.size()) i = 0; i < children.size(); i++)
+                {
+                    const auto index = static_cast<int>(i);
+                    cells_[i].control = children[i];
+                    cells_[i].is_dirty = false;
+                    cell_indices_[children[i]] = index;
+                    LinkCell(index);
+                    MarkCellDirty(index);
+                }
+
+                is_structure_dirty_ = false;
+            }
+
+            void Grid::LinkCell(const int index)
+            {
+                auto& cell = cells_[index];
+                const auto layout_params = cell.control->GetLayoutParams();
+                const auto grid_layout_params = dynamic_cast<const GridLayoutParams*>(layout_params.get());
+                const int starts[axis_count] = {
+                    grid_layout_params != nullptr ? grid_layout_params->column : 0,
+                    grid_layout_params != nullptr ? grid_layout_params->row : 0
+                };
+                const int spans[axis_count] = {
+                    grid_layout_params != nullptr ? grid_layout_params->column_span : 1,
+                    grid_layout_params != nullptr ? grid_layout_params->row_span : 1
+                };
+
+                auto has_auto_track = false;
+                auto has_star_track = false;
+                for (auto i = 0; i < axis_count; i++)
+                {
+                    auto& axis = axes_[i];
+                    const auto track_count = static_cast<int>(axis.tracks.size());
+                    const auto start = std::max(0, std::min(starts[i], track_count - 1));
+                    const auto span = std::max(1, std::min(spans[i], track_count - start));
+                    cell.start[i] = start;
+                    cell.span[i] = span;
+                    cell.owner[i] = -1;
+                    cell.length[i] = 0.0f;
+
+                    auto last_auto_track = -1;
+                    auto has_star_in_axis = false;
+                    for (auto j = start; j < start + span; j++)
+                    {
+                        if (IsAutoTrack(axis, axis.tracks[j]))
+                            last_auto_track = j;
+                        else if (axis.tracks[j].definition.unit == GridUnit::Star)
+                            has_star_in_axis = true;
+                    }
+
+                    if (last_auto_track != -1)
+                        has_auto_track = true;
+                    if (has_star_in_axis)
+                    {
+                        has_star_track = true;
+                        continue;
+                    }
+                    if (last_auto_track == -1)
+                        continue;
+
+                    cell.owner[i] = last_auto_track;
+                    if (span == 1)
+                    {
+                        axis.tracks[start].single_cells.push_back(index);
+                        axis.tracks[start].is_single_content_dirty = true;
+                    }
+                    else
+                    {
+                        axis.tracks[last_auto_track].owned_cells.push_back(index);
+                        axis.tracks[last_auto_track].is_content_dirty = true;
+                        for (auto j = start; j < start + span; j++)
+                            axis.tracks[j].spanning_cells.push_back(index);
+                    }
+                }
+
+                // a cell in both an auto and a star track is measured with infinite
+                // room in the star direction, otherwise it would wait for itself.
+                cell.is_deferred = has_star_track && !has_auto_track;
+                if (cell.is_deferred)
+                    deferred_cells_.push_back(index);
+            }
+
+            void Grid::UnlinkCell(const int index)
+            {
+                auto& cell = cells_[index];
+                for (auto i = 0; i < axis_count; i++)
+                {
+                    const auto owner = cell.owner[i];
+                    if (owner == -1)
+                        continue;
+                    auto& tracks = axes_[i].tracks;
+                    if (cell.span[i] == 1)
+                    {
+                        EraseIndexHelperFunc(tracks[owner].single_cells, index);
+                        tracks[owner].is_single_content_dirty = true;
+                    }
+                    else
+                    {
+                        EraseIndexHelperFunc(tracks[owner].owned_cells, index);
+                        tracks[owner].is_content_dirty = true;
+                        for (auto j = cell.start[i]; j < cell.start[i] + cell.span[i]; j++)
+                            EraseIndexHelperFunc(tracks[j].spanning_cells, index);
+                    }
+                }
+                if (cell.is_deferred)
+                    EraseIndexHelperFunc(deferred_cells_, index);
+            }
+
+            void Grid::RefreshCell(const int index)
+            {
+                // the layout params may have moved the cell.
+                const auto& cell = cells_[index];
+                const auto layout_params = cell.control->GetLayoutParams();
+                const auto grid_layout_params = dynamic_cast<const GridLayoutParams*>(layout_params.get());
+                const int starts[axis_count] = {
+                    grid_layout_params != nullptr ? grid_layout_params->column : 0,
+                    grid_layout_params != nullptr ? grid_layout_params->row : 0
+                };
+                const int spans[axis_count] = {
+                    grid_layout_params != nullptr ? grid_layout_params->column_span : 1,
+                    grid_layout_params != nullptr ? grid_layout_params->row_span : 1
+                };
+
+                for (auto i = 0; i < axis_count; i++)
+                {
+                    const auto track_count = static_cast<int>(axes_[i].tracks.size());
+                    const auto start = std::max(0, std::min(starts[i], track_count - 1));
+                    const auto span = std::max(1, std::min(spans[i], track_count - start));
+                    if (start != cell.start[i] || span != cell.span[i])
+                    {
+                        UnlinkCell(index);
+                        LinkCell(index);
+                        return;
+                    }
+                }
+            }
+
+            void Grid::MarkCellDirty(const int index)
+            {
+                auto& cell = cells_[index];
+                if (cell.is_dirty)
+                    return;
+                cell.is_dirty = true;
+                dirty_cells_.push_back(index);
+            }
+
+            Size Grid::GetCellRoom(const Cell& cell) const
+            {
+                float room[axis_count];
+                for (auto i = 0; i < axis_count; i++)
+                {
+                    const auto& axis = axes_[i];
+                    auto is_infinite = false;
+                    auto length = 0.0f;
+                    for (auto j = cell.start[i]; j < cell.start[i] + cell.span[i]; j++)
+                    {
+                        const auto& track = axis.tracks[j];
+                        if (IsAutoTrack(axis, track) || (track.definition.unit == GridUnit::Star && !cell.is_deferred))
+                            is_infinite = true;
+                        length += track.length;
+                    }
+                    room[i] = is_infinite ? std::numeric_limits<float>::infinity() : length;
+                }
+                return Size(room[0], room[1]);
+            }
+
+            void Grid::MeasureCell(const int index)
+            {
+                auto& cell = cells_[index];
+                cell.control->Measure(GetCellRoom(cell));
+                last_measured_cell_count_++;
+
+                if (cell.is_deferred)
+                    return;
+
+                const auto desired_size = cell.control->GetDesiredSize();
+                for (auto i = 0; i < axis_count; i++)
+                {
+                    if (cell.owner[i] == -1)
+                        continue;
+                    const auto length = GetAxisLengthHelperFunc(desired_size, i);
+                    if (length == cell.length[i])
+                        continue;
+                    cell.length[i] = length;
+                    auto& track = axes_[i].tracks[cell.owner[i]];
+                    if (cell.span[i] == 1)
+                        track.is_single_content_dirty = true;
+                    else
+                        track.is_content_dirty = true;
+                }
+            }
+
+            bool Grid::ResolveAxis(const int axis_index, const float available_length)
+            {
+                auto& axis = axes_[axis_index];
+                auto& tracks = axis.tracks;
+                const auto track_count = static_cast<int>(tracks.size());
+                auto changed_from = track_count;
+
+                for (auto& track : tracks)
+                {
+                    if (!track.is_single_content_dirty)
+                        continue;
+                    track.is_single_content_dirty = false;
+
+                    auto length = 0.0f;
+                    for (const auto index : track.single_cells)
+                        length = std::max(length, cells_[index].length[axis_index]);
+                    if (length == track.single_content_length)
+                        continue;
+                    track.single_content_length = length;
+                    track.is_content_dirty = true;
+                    // cells spanning this track give it less or more.
+                    for (const auto index : track.spanning_cells)
+                        tracks[cells_[index].owner[axis_index]].is_content_dirty = true;
+                }
+
+                for (auto i = 0; i < track_count; i++)
+                {
+                    auto& track = tracks[i];
+                    if (!track.is_content_dirty)
+                        continue;
+                    track.is_content_dirty = false;
+                    last_resolved_track_count_++;
+
+                    auto length = track.single_content_length;
+                    for (const auto index : track.owned_cells)
+                    {
+                        const auto& cell = cells_[index];
+                        auto rest = cell.length[axis_index];
+                        for (auto j = cell.start[axis_index]; j < cell.start[axis_index] + cell.span[axis_index]; j++)
+                        {
+                            if (j == i)
+                                continue;
+                            const auto& other = tracks[j];
+                            rest -= other.definition.unit == GridUnit::Fixed ? other.definition.value : other.single_content_length;
+                        }
+                        length = std::max(length, rest);
+                    }
+                    track.content_length = length;
+
+                    if (IsAutoTrack(axis, track) && track.length != length)
+                    {
+                        track.length = length;
+                        changed_from = std::min(changed_from, i);
+                    }
+                }
+
+                auto is_star_changed = false;
+                if (!axis.is_star_as_auto)
+                {
+                    const auto first_star = ShareStarRoom(axis, available_length);
+                    if (first_star != -1)
+                    {
+                        is_star_changed = true;
+                        changed_from = std::min(changed_from, first_star);
+                    }
+                }
+
+                if (changed_from != track_count)
+                    UpdateOffsets(axis, changed_from);
+                return is_star_changed;
+            }
+
+            int Grid::ShareStarRoom(Axis& axis, const float available_length)
+            {
+                auto used_length = 0.0f;
+                auto total_weight = 0.0f;
+                auto first_star = -1;
+                for (decltype(axis.tracks.size()) i = 0; i < axis.tracks.size(); i++)
+                {
+                    const auto& track = axis.tracks[i];
+                    if (track.definition.unit == GridUnit::Star)
+                    {
+                        total_weight += track.definition.value;
+                        if (first_star == -1)
+                            first_star = static_cast<int>(i);
+                    }
+                    else
+                        used_length += track.length;
+                }
+
+                const auto room = std::max(0.0f, available_length - used_length);
+                if (first_star == -1 || room == axis.star_room)
+                    return -1;
+                axis.star_room = room;
+
+                for (auto& track : axis.tracks)
+                    if (track.definition.unit == GridUnit::Star)
+                        track.length = total_weight > 0.0f ? room * track.definition.value / total_weight : 0.0f;
+                return first_star;
+            }
+
+            void Grid::UpdateOffsets(Axis& axis, const int from)
+            {
+                auto& tracks = axis.tracks;
+                auto offset = from == 0 ? 0.0f : tracks[from - 1].offset + tracks[from - 1].length;
+                for (auto i = from; i < static_cast<int>(tracks.size()); i++)
+                {
+                    tracks[i].offset = offset;
+                    offset += tracks[i].length;
+                }
+            }
+
+            float Grid::GetCellLength(const Cell& cell, const int axis_index) const
+            {
+                const auto& tracks = axes_[axis_index].tracks;
+                const auto& first = tracks[cell.start[axis_index]];
+                const auto& last = tracks[cell.start[axis_index] + cell.span[axis_index] - 1];
+                return last.offset + last.length - first.offset;
+            }
+        }
+    }
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ui/control.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            enum class GridUnit : uint8_t
+            {
+                //Sized to the largest child in the track.
+                Auto,
+                //Fixed length.
+                Fixed,
+                //A share of the room left by auto and fixed tracks. It behaves
+                //like "Auto" when the room is infinite.
+                Star
+            };
+
+            //The definition of a row or a column.
+            struct GridLength
+            {
+                static constexpr GridLength Auto()
+                {
+                    return GridLength(GridUnit::Auto, 0.0f);
+                }
+
+                static constexpr GridLength Fixed(const float length)
+                {
+                    return GridLength(GridUnit::Fixed, length);
+                }
+
+                static constexpr GridLength Star(const float weight = 1.0f)
+                {
+                    return GridLength(GridUnit::Star, weight);
+                }
+
+                constexpr GridLength() = default;
+                constexpr GridLength(const GridUnit unit, const float value)
+                    : unit(unit), value(value) { }
+
+                GridUnit unit = GridUnit::Auto;
+                //The length for "Fixed" and the weight for "Star".
+                float value = 0.0f;
+            };
+
+            inline bool operator == (const GridLength& left, const GridLength& right)
+            {
+                return left.unit == right.unit && left.value == right.value;
+            }
+
+            inline bool operator != (const GridLength& left, const GridLength& right)
+            {
+                return !(left == right);
+            }
+
+            //Layout params of children of "Grid". Children with plain
+            //"BasicLayoutParams" are put in the first cell.
+            struct GridLayoutParams : BasicLayoutParams
+            {
+                int row = 0;
+                int column = 0;
+                int row_span = 1;
+                int column_span = 1;
+            };
+
+            //A panel that places children in cells of rows and columns.
+            //
+            //The track solution is cached. A changed child only re-measures
+            //itself and recomputes the content of the tracks it contributes
+            //to; other tracks keep their content and only their offsets move.
+            //Changing the definitions, adding or removing children, or
+            //switching between finite and infinite room solves from scratch.
+            //
+            //A child spanning several tracks gives what doesn't fit the other
+            //spanned tracks to the last auto track of the span. A child
+            //spanning a star track doesn't size any track in that direction.
+            class Grid : public Control
+            {
+            public:
+                Grid();
+                Grid(std::vector<GridLength> rows, std::vector<GridLength> columns);
+                Grid(const Grid& other) = delete;
+                Grid(Grid&& other) = delete;
+                Grid& operator=(const Grid& other) = delete;
+                Grid& operator=(Grid&& other) = delete;
+                ~Grid() override = default;
+
+                //No rows or columns means a single star track.
+                const std::vector<GridLength>& GetRows() const
+                {
+                    return row_definitions_;
+                }
+
+                void SetRows(std::vector<GridLength> rows);
+
+                const std::vector<GridLength>& GetColumns() const
+                {
+                    return column_definitions_;
+                }
+
+                void SetColumns(std::vector<GridLength> columns);
+
+                //Get the length of a track from the last layout.
+                float GetRowLength(int row) const;
+                float GetColumnLength(int column) const;
+
+                //Count of children measured in the last measure.
+                int GetLastMeasuredCellCount() const
+                {
+                    return last_measured_cell_count_;
+                }
+
+                //Count of tracks whose content was recomputed in the last measure.
+                int GetLastResolvedTrackCount() const
+                {
+                    return last_resolved_track_count_;
+                }
+
+            protected:
+                void OnAddChild(Control* child) override;
+                void OnRemoveChild(Control* child) override;
+                void OnChildMeasureInvalidated(Control* child) override;
+
+                Size OnMeasure(const Size& available_size) override;
+                void OnLayout(const Rect& rect) override;
+
+            private:
+                //Index of axes: 0 for columns and 1 for rows.
+                static constexpr int axis_count = 2;
+
+                struct Track
+                {
+                    GridLength definition;
+                    //The largest child only in this track.
+                    float single_content_length = 0.0f;
+                    //"single_content_length" plus what children spanning
+                    //several tracks give to this track.
+                    float content_length = 0.0f;
+                    float length = 0.0f;
+                    float offset = 0.0f;
+                    bool is_single_content_dirty = true;
+                    bool is_content_dirty = true;
+                    //Cells only in this track.
+                    std::vector<int> single_cells;
+                    //Cells spanning several tracks that give their content to this track.
+                    std::vector<int> owned_cells;
+                    //Cells spanning several tracks including this one.
+                    std::vector<int> spanning_cells;
+                };
+
+                struct Axis
+                {
+                    std::vector<Track> tracks;
+                    bool is_star_as_auto = false;
+                    //The room shared by star tracks in the current solution.
+                    float star_room = 0.0f;
+                };
+
+                struct Cell
+                {
+                    Control* control;
+                    int start[axis_count];
+                    int span[axis_count];
+                    //The track the cell gives its content to, -1 for none.
+                    int owner[axis_count];
+                    //The desired length the tracks were computed with.
+                    float length[axis_count];
+                    //Measured after star tracks are resolved and gives nothing to tracks.
+                    bool is_deferred;
+                    bool is_dirty;
+                };
+
+                static bool IsAutoTrack(const Axis& axis, const Track& track);
+
+                void RebuildCells();
+                void LinkCell(int index);
+                void UnlinkCell(int index);
+                void RefreshCell(int index);
+                void MarkCellDirty(int index);
+                Size GetCellRoom(const Cell& cell) const;
+                void MeasureCell(int index);
+                //Resolve lengths and offsets. Return true if star lengths changed.
+                bool ResolveAxis(int axis_index, float available_length);
+                //Share the room left by other tracks. Return the index of the first star track, or -1.
+                int ShareStarRoom(Axis& axis, float available_length);
+                static void UpdateOffsets(Axis& axis, int from);
+                float GetCellLength(const Cell& cell, int axis_index) const;
+
+            private:
+                std::vector<GridLength> row_definitions_;
+                std::vector<GridLength> column_definitions_;
+
+                Axis axes_[axis_count];
+                std::vector<Cell> cells_;
+                std::unordered_map<Control*, int> cell_indices_;
+                std::vector<int> deferred_cells_;
+                std::vector<int> dirty_cells_;
+                bool is_structure_dirty_ = true;
+
+                int last_measured_cell_count_ = 0;
+                int last_resolved_track_count_ = 0;
+            };
+        }
+    }
+}
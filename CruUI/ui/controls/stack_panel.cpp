@@ -0,0 +1,87 @@
+#include "stack_panel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            StackPanel::StackPanel(const Orientation orientation)
+                : orientation_(orientation)
+            {
+
+            }
+
+            void StackPanel::SetOrientation(const Orientation orientation)
+            {
+                if (orientation_ == orientation)
+                    return;
+                orientation_ = orientation;
+                InvalidateMeasure();
+            }
+
+            Size StackPanel::OnMeasure(const Size& available_size)
+            {
+                const auto content_available_size = GetContentAvailableSize(available_size);
+                // children whose room doesn't change skip measuring in "Measure".
+                MeasureChildren(MakeSize(
+                    std::numeric_limits<float>::infinity(),
+                    GetCrossLength(content_available_size, orientation_),
+                    orientation_
+                ));
+
+                UpdateChildMetrics();
+
+                auto main_length = 0.0f;
+                auto cross_length = 0.0f;
+                for (const auto& metrics : child_metrics_)
+                {
+                    main_length += metrics.main_length;
+                    cross_length = std::max(cross_length, metrics.cross_length);
+                }
+
+                return CalculateDesiredSize(available_size, MakeSize(main_length, cross_length, orientation_));
+            }
+
+            void StackPanel::OnLayout(const Rect& rect)
+            {
+                const auto& children = GetInternalChildren();
+                if (child_metrics_.size() != children.size())
+                    UpdateChildMetrics();
+
+                const auto cross_length = GetCrossLength(rect.GetSize(), orientation_);
+                auto main_offset = 0.0f;
+                for (decltype(children.size()) i = 0; i < children.size(); i++)
+                {
+                    const auto& metrics = child_metrics_[i];
+                    const auto child_cross_length = metrics.is_cross_stretch
+                        ? GetCrossLength(GetChildLayoutSize(children[i], MakeSize(metrics.main_length, cross_length, orientation_)), orientation_)
+                        : metrics.cross_length;
+                    children[i]->Layout(Rect(
+                        MakePoint(main_offset, 0.0f, orientation_),
+                        MakeSize(metrics.main_length, child_cross_length, orientation_)
+                    ));
+                    main_offset += metrics.main_length;
+                }
+            }
+
+            void StackPanel::UpdateChildMetrics()
+            {
+                const auto& children = GetInternalChildren();
+                child_metrics_.resize(children.size());
+                for (decltype(children.size()) i = 0; i < children.size(); i++)
+                {
+                    const auto desired_size = children[i]->GetDesiredSize();
+                    const auto& size_params = children[i]->GetLayoutParams()->size;
+                    auto& metrics = child_metrics_[i];
+                    metrics.main_length = GetMainLength(desired_size, orientation_);
+                    metrics.cross_length = GetCrossLength(desired_size, orientation_);
+                    metrics.is_cross_stretch = (orientation_ == Orientation::Horizontal ? size_params.height : size_params.width).mode == MeasureMode::Stretch;
+                }
+            }
+        }
+    }
+}
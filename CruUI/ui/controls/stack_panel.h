@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "ui/control.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            //A panel that puts children one after another along an orientation.
+            //Children get infinite room along the orientation and the panel's
+            //room across it. A child stretched across fills the panel.
+            class StackPanel : public Control
+            {
+            public:
+                explicit StackPanel(Orientation orientation = Orientation::Vertical);
+                StackPanel(const StackPanel& other) = delete;
+                StackPanel(StackPanel&& other) = delete;
+                StackPanel& operator=(const StackPanel& other) = delete;
+                StackPanel& operator=(StackPanel&& other) = delete;
+                ~StackPanel() override = default;
+
+                Orientation GetOrientation() const
+                {
+                    return orientation_;
+                }
+
+                void SetOrientation(Orientation orientation);
+
+            protected:
+                Size OnMeasure(const Size& available_size) override;
+                void OnLayout(const Rect& rect) override;
+
+            private:
+                //Measure results of children kept contiguous for layout.
+                struct ChildMetrics
+                {
+                    float main_length;
+                    float cross_length;
+                    bool is_cross_stretch;
+                };
+
+                void UpdateChildMetrics();
+
+            private:
+                Orientation orientation_;
+                std::vector<ChildMetrics> child_metrics_;
+            };
+        }
+    }
+}
@@ -0,0 +1,286 @@
+#include "text_box.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            using namespace events;
+
+            constexpr auto caret_color = graph::Color::FromRgb(0x000000);
+            constexpr auto caret_width = 1.0f;
+
+            //Get the x of the caret before the code unit at "column" of a line.
+            inline float GetColumnXHelperFunc(const graph::TextLayout& layout, const int column)
+            {
+                auto x = 0.0f;
+                for (const auto& glyph : layout.GetShapedText().glyphs)
+                {
+                    if (glyph.text_index >= column)
+                        break;
+                    x += glyph.advance;
+                }
+                return x;
+            }
+
+            //Get the column whose caret is the nearest to "x" in a line.
+            inline int GetColumnAtXHelperFunc(const graph::TextLayout& layout, const float x)
+            {
+                const auto& shaped_text = layout.GetShapedText();
+                auto glyph_x = 0.0f;
+                for (const auto& glyph : shaped_text.glyphs)
+                {
+                    if (x < glyph_x + glyph.advance / 2.0f)
+                        return glyph.text_index;
+                    glyph_x += glyph.advance;
+                }
+                return static_cast<int>(shaped_text.text.size());
+            }
+
+            TextBox::TextBox(graph::TextShaper* shaper, const graph::TextFormat& format)
+                : format_(format), shaper_(shaper), layout_cache_(shaper)
+            {
+                metrics_ = shaper_->GetMetrics(format_);
+            }
+
+            void TextBox::SetText(String text)
+            {
+                Repaint();
+                buffer_.SetText(std::move(text));
+                line_widths_.Clear();
+                caret_position_ = 0;
+                scroll_offset_ = 0.0f;
+                if (is_size_dependent_on_text_)
+                    InvalidateMeasure();
+                UiEventArgs args(this, this);
+                text_changed_event.Raise(args);
+            }
+
+            void TextBox::Replace(const int begin, const int length, const String& text)
+            {
+                if (begin < 0 || length < 0 || begin + length > buffer_.GetLength())
+                    throw std::invalid_argument("Range is out of the text.");
+                // nothing changes, so there is nothing to repaint or raise.
+                if (length == 0 && text.empty())
+                    return;
+
+                Repaint();
+                const auto old_line_count = buffer_.GetLineCount();
+                buffer_.Replace(begin, length, text);
+                buffer_.LimitUndoSteps(max_undo_step_count);
+                TextChange change;
+                change.begin = begin;
+                change.removed_count = length;
+                change.inserted_count = static_cast<int>(text.size());
+                UpdateLineWidths(change, old_line_count);
+                OnTextChanged(change);
+            }
+
+            bool TextBox::Undo()
+            {
+                if (!buffer_.CanUndo())
+                    return false;
+                Repaint();
+                const auto old_line_count = buffer_.GetLineCount();
+                const auto change = buffer_.Undo();
+                UpdateLineWidths(change, old_line_count);
+                OnTextChanged(change);
+                return true;
+            }
+
+            bool TextBox::Redo()
+            {
+                if (!buffer_.CanRedo())
+                    return false;
+                Repaint();
+                const auto old_line_count = buffer_.GetLineCount();
+                const auto change = buffer_.Redo();
+                UpdateLineWidths(change, old_line_count);
+                OnTextChanged(change);
+                return true;
+            }
+
+            void TextBox::SetCaretPosition(const int position)
+            {
+                if (position < 0 || position > buffer_.GetLength())
+                    throw std::invalid_argument("Caret position is out of the text.");
+                if (caret_position_ == position)
+                    return;
+                Repaint();
+                caret_position_ = position;
+            }
+
+            void TextBox::SetFormat(const graph::TextFormat& format)
+            {
+                if (format_ == format)
+                    return;
+                Repaint();
+                format_ = format;
+                metrics_ = shaper_->GetMetrics(format_);
+                line_widths_.Clear();
+                // layouts of the old format are left to be evicted.
+                scroll_offset_ = std::min(scroll_offset_, GetMaxScrollOffset());
+                InvalidateMeasure();
+            }
+
+            void TextBox::SetScrollOffset(const float offset)
+            {
+                const auto clamped_offset = std::max(0.0f, std::min(offset, GetMaxScrollOffset()));
+                if (scroll_offset_ == clamped_offset)
+                    return;
+                Repaint();
+                scroll_offset_ = clamped_offset;
+            }
+
+            int TextBox::GetFirstVisibleLine()
+            {
+                if (metrics_.line_height <= 0.0f)
+                    return 0;
+                const auto line = static_cast<int>(std::floor(scroll_offset_ / metrics_.line_height));
+                return std::max(0, std::min(line, buffer_.GetLineCount() - 1));
+            }
+
+            int TextBox::GetVisibleLineCount()
+            {
+                const auto first = GetFirstVisibleLine();
+                const auto line_count = buffer_.GetLineCount();
+                if (metrics_.line_height <= 0.0f)
+                    return line_count - first;
+                const auto bottom = (scroll_offset_ + GetSize().height) / metrics_.line_height;
+                if (!(bottom < static_cast<float>(line_count)))
+                    return line_count - first;
+                return std::max(0, static_cast<int>(std::ceil(bottom)) - first);
+            }
+
+            std::shared_ptr<const graph::TextLayout> TextBox::GetLineLayout(const int line)
+            {
+                auto text = buffer_.GetLine(line);
+                // lines of files with "\r\n" end with a carriage return.
+                if (!text.empty() && text.back() == L'\r')
+                    text.pop_back();
+                return layout_cache_.GetLayout(text, format_, std::numeric_limits<float>::infinity());
+            }
+
+            void TextBox::OnDraw(graph::Painter& painter)
+            {
+                const auto size = GetSize();
+                painter.PushClip(Rect(Point::zero, size));
+
+                const auto caret = buffer_.GetPosition(caret_position_);
+                const auto first = GetFirstVisibleLine();
+                const auto end = first + GetVisibleLineCount();
+                for (auto line = first; line < end; line++)
+                {
+                    const auto layout = GetLineLayout(line);
+                    const Point lefttop(0.0f, static_cast<float>(line) * metrics_.line_height - scroll_offset_);
+                    OnDrawLine(painter, *layout, lefttop);
+                    if (line == caret.line && HasFocus())
+                        painter.FillRectangle(Rect(GetColumnXHelperFunc(*layout, caret.column), lefttop.y, caret_width, metrics_.line_height), caret_color);
+                }
+
+                painter.PopClip();
+            }
+
+            void TextBox::OnDrawLine(graph::Painter& painter, const graph::TextLayout& layout, const Point& lefttop)
+            {
+
+            }
+
+            Size TextBox::OnMeasure(const Size& available_size)
+            {
+                const auto content_available_size = GetContentAvailableSize(available_size);
+                // in finite room it is a view of the text, whose size doesn't
+                // depend on it.
+                is_size_dependent_on_text_ = std::isinf(content_available_size.width) || std::isinf(content_available_size.height);
+                auto content_size = content_available_size;
+                if (std::isinf(content_size.height))
+                    content_size.height = static_cast<float>(buffer_.GetLineCount()) * metrics_.line_height;
+                if (std::isinf(content_size.width))
+                {
+                    if (line_widths_.IsEmpty())
+                        UpdateLineWidths();
+                    content_size.width = line_widths_.GetMaxWidth();
+                }
+                return CalculateDesiredSize(available_size, content_size);
+            }
+
+            void TextBox::OnMouseDownCore(MouseButtonEventArgs& args)
+            {
+                Control::OnMouseDownCore(args);
+                if (args.GetMouseButton() != MouseButton::Left)
+                    return;
+                RequestFocus();
+                const auto point = args.GetPoint(this);
+                const auto line_count = buffer_.GetLineCount();
+                auto line = metrics_.line_height > 0.0f ? static_cast<int>(std::floor((point.y + scroll_offset_) / metrics_.line_height)) : 0;
+                line = std::max(0, std::min(line, line_count - 1));
+                TextPosition position;
+                position.line = line;
+                position.column = GetColumnAtXHelperFunc(*GetLineLayout(line), point.x);
+                SetCaretPosition(buffer_.GetOffset(position));
+            }
+
+            void TextBox::OnGetFocusCore(UiEventArgs& args)
+            {
+                // the caret shows only with focus.
+                Repaint();
+                Control::OnGetFocusCore(args);
+            }
+
+            void TextBox::OnLoseFocusCore(UiEventArgs& args)
+            {
+                Repaint();
+                Control::OnLoseFocusCore(args);
+            }
+
+            void TextBox::OnTextChanged(const TextChange& change)
+            {
+                caret_position_ = change.begin + change.inserted_count;
+                scroll_offset_ = std::min(scroll_offset_, GetMaxScrollOffset());
+                if (is_size_dependent_on_text_)
+                    InvalidateMeasure();
+                UiEventArgs args(this, this);
+                text_changed_event.Raise(args);
+            }
+
+            void TextBox::UpdateLineWidths()
+            {
+                const auto line_count = buffer_.GetLineCount();
+                std::vector<float> widths(line_count);
+                for (auto line = 0; line < line_count; line++)
+                    widths[line] = GetLineLayout(line)->GetSize().width;
+                line_widths_.Assign(widths);
+            }
+
+            void TextBox::UpdateLineWidths(const TextChange& change, const int old_line_count)
+            {
+                if (line_widths_.IsEmpty())
+                    return;
+
+                // text before the change is kept, so its first line is the
+                // same before and after, and lines after it only move.
+                const auto first = buffer_.GetPosition(change.begin).line;
+                const auto last = buffer_.GetPosition(change.begin + change.inserted_count).line;
+                const auto old_last = last - (buffer_.GetLineCount() - old_line_count);
+
+                std::vector<float> widths;
+                widths.reserve(last - first + 1);
+                for (auto line = first; line <= last; line++)
+                    widths.push_back(GetLineLayout(line)->GetSize().width);
+                line_widths_.Replace(first, old_last - first + 1, widths);
+            }
+
+            float TextBox::GetMaxScrollOffset()
+            {
+                const auto text_height = static_cast<float>(buffer_.GetLineCount()) * metrics_.line_height;
+                return std::max(0.0f, text_height - GetSize().height);
+            }
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "ui/control.h"
+#include "ui/line_width_tree.h"
+#include "ui/text_buffer.h"
+#include "graph/text_layout.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            //A control editing text of large documents. The text is kept in a
+            //"TextBuffer" and every line is a row of the same height without
+            //wrapping, so the rows in view are found from the scroll offset
+            //directly. Only those are laid out, through a cache of layouts
+            //by text, so an edit lays out again only the lines it changed.
+            //In infinite room it takes the size of all lines. The first
+            //measure lays out every line, so large documents should get
+            //finite room; after it the widest line is kept up to date from
+            //the lines each edit touches, in O(log n) more than them.
+            class TextBox : public Control
+            {
+            public:
+                //Steps of undo kept, beyond which the oldest are dropped.
+                static constexpr int max_undo_step_count = 1000;
+
+            public:
+                //"shaper" must outlive the text box.
+                TextBox(graph::TextShaper* shaper, const graph::TextFormat& format);
+                TextBox(const TextBox& other) = delete;
+                TextBox(TextBox&& other) = delete;
+                TextBox& operator=(const TextBox& other) = delete;
+                TextBox& operator=(TextBox&& other) = delete;
+                ~TextBox() override = default;
+
+                const TextBuffer& GetBuffer() const
+                {
+                    return buffer_;
+                }
+
+                String GetText() const
+                {
+                    return buffer_.GetText();
+                }
+
+                //Replace all text, which clears undo and moves the caret to
+                //the start.
+                void SetText(String text);
+
+                //Replace the text in [begin, begin + length) as one step of
+                //undo, and move the caret after the new text.
+                void Replace(int begin, int length, const String& text);
+
+                void Insert(const int position, const String& text)
+                {
+                    Replace(position, 0, text);
+                }
+
+                void Remove(const int begin, const int length)
+                {
+                    Replace(begin, length, String());
+                }
+
+                //Return false if there is nothing to undo.
+                bool Undo();
+
+                //Return false if there is nothing to redo.
+                bool Redo();
+
+                int GetCaretPosition() const
+                {
+                    return caret_position_;
+                }
+
+                void SetCaretPosition(int position);
+
+                const graph::TextFormat& GetFormat() const
+                {
+                    return format_;
+                }
+
+                void SetFormat(const graph::TextFormat& format);
+
+                float GetLineHeight() const
+                {
+                    return metrics_.line_height;
+                }
+
+                float GetScrollOffset() const
+                {
+                    return scroll_offset_;
+                }
+
+                //Scroll the rows up by "offset", clamped so the last row
+                //stays in view.
+                void SetScrollOffset(float offset);
+
+                //Get the first line in view.
+                int GetFirstVisibleLine();
+
+                //Get the count of lines in view from the first one.
+                int GetVisibleLineCount();
+
+                //Get the layout of a line, without its line feed and a
+                //carriage return before it.
+                std::shared_ptr<const graph::TextLayout> GetLineLayout(int line);
+
+                graph::TextLayoutCacheStatistics GetLayoutStatistics() const
+                {
+                    return layout_cache_.GetStatistics();
+                }
+
+                //Raised after the text changes.
+                events::UiEvent text_changed_event;
+
+            protected:
+                void OnDraw(graph::Painter& painter) override;
+
+                //Draw the glyphs of a line with its lefttop at "lefttop".
+                //Painters don't draw text, so it draws nothing; subclasses
+                //draw the glyphs, from a "GlyphAtlas" for example.
+                virtual void OnDrawLine(graph::Painter& painter, const graph::TextLayout& layout, const Point& lefttop);
+
+                Size OnMeasure(const Size& available_size) override;
+
+                void OnMouseDownCore(events::MouseButtonEventArgs& args) override;
+
+                void OnGetFocusCore(events::UiEventArgs& args) override;
+                void OnLoseFocusCore(events::UiEventArgs& args) override;
+
+            private:
+                //Update the caret, the view and the listeners after the text
+                //changed by "change".
+                void OnTextChanged(const TextChange& change);
+
+                float GetMaxScrollOffset();
+
+                //Lay out every line for "line_widths_".
+                void UpdateLineWidths();
+
+                //Update "line_widths_" from the lines touched by "change",
+                //given the line count before it.
+                void UpdateLineWidths(const TextChange& change, int old_line_count);
+
+            private:
+                TextBuffer buffer_;
+                graph::TextFormat format_;
+                graph::FontMetrics metrics_;
+                graph::TextShaper* shaper_;
+                graph::TextLayoutCache layout_cache_;
+
+                int caret_position_ = 0;
+                float scroll_offset_ = 0.0f;
+                //The last measure had infinite room, so its result depends
+                //on the text.
+                bool is_size_dependent_on_text_ = false;
+                //Widths of the lines in infinite room, kept once a measure
+                //needs them. Empty if not kept.
+                LineWidthTree line_widths_;
+            };
+        }
+    }
+}
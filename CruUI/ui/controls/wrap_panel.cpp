@@ -0,0 +1,309 @@
+#include "wrap_panel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            WrapPanel::WrapPanel(const Orientation orientation)
+                : orientation_(orientation), wrap_length_(std::numeric_limits<float>::infinity()),
+                layout_wrap_length_(std::numeric_limits<float>::infinity()),
+                first_dirty_index_(std::numeric_limits<int>::max()), last_dirty_index_(-1),
+                layout_line_begin_(0), layout_line_end_(0)
+            {
+
+            }
+
+            void WrapPanel::SetOrientation(const Orientation orientation)
+            {
+                if (orientation_ == orientation)
+                    return;
+                orientation_ = orientation;
+                child_available_size_ = std::nullopt;
+                InvalidateMeasure();
+            }
+
+            void WrapPanel::OnAddChild(Control* child)
+            {
+                Control::OnAddChild(child);
+
+                const auto& children = GetInternalChildren();
+                const auto index = static_cast<int>(std::find(children.cbegin(), children.cend(), child) - children.cbegin());
+                child_metrics_.insert(child_metrics_.cbegin() + index, ChildMetrics{ child, 0.0f, 0.0f });
+
+                // indices after the new child move by one.
+                for (auto& line : lines_)
+                    if (line.begin > index)
+                        line.begin++;
+                if (first_dirty_index_ > index && first_dirty_index_ != std::numeric_limits<int>::max())
+                    first_dirty_index_++;
+                if (last_dirty_index_ >= index)
+                    last_dirty_index_++;
+
+                MarkChildDirty(index);
+            }
+
+            void WrapPanel::OnRemoveChild(Control* child)
+            {
+                Control::OnRemoveChild(child);
+
+                const auto index = FindChildIndex(child);
+                child_metrics_.erase(child_metrics_.cbegin() + index);
+                const auto count = static_cast<int>(child_metrics_.size());
+
+                for (auto& line : lines_)
+                    if (line.begin > index)
+                        line.begin--;
+                // drop the line if the child was alone in it.
+                lines_.erase(std::unique(lines_.begin(), lines_.end(), [](const Line& left, const Line& right) {
+                    return left.begin == right.begin;
+                }), lines_.end());
+                if (!lines_.empty() && lines_.back().begin >= count)
+                    lines_.pop_back();
+
+                if (first_dirty_index_ > index && first_dirty_index_ != std::numeric_limits<int>::max())
+                    first_dirty_index_--;
+                if (last_dirty_index_ >= index)
+                    last_dirty_index_--;
+
+                // the previous child may take the room, and the next one moves.
+                if (count > 0)
+                {
+                    MarkChildDirty(std::max(0, index - 1));
+                    MarkChildDirty(std::min(index, count - 1));
+                }
+            }
+
+            void WrapPanel::OnChildMeasureInvalidated(Control* child)
+            {
+                Control::OnChildMeasureInvalidated(child);
+                const auto index = FindChildIndex(child);
+                if (index != -1)
+                    MarkChildDirty(index);
+            }
+
+            Size WrapPanel::OnMeasure(const Size& available_size)
+            {
+                const auto content_available_size = GetContentAvailableSize(available_size);
+                if (child_available_size_ != content_available_size)
+                {
+                    child_available_size_ = content_available_size;
+                    // more room may fit lines a layout broke before.
+                    layout_wrap_length_ = std::numeric_limits<float>::infinity();
+                    wrap_length_ = GetMainLength(content_available_size, orientation_);
+                    MarkAllDirty();
+                }
+                const auto wrap_length = std::min(GetMainLength(content_available_size, orientation_), layout_wrap_length_);
+                if (wrap_length_ != wrap_length)
+                {
+                    wrap_length_ = wrap_length;
+                    MarkAllDirty();
+                }
+
+                last_reflowed_child_count_ = 0;
+                if (first_dirty_index_ <= last_dirty_index_ || lines_.empty())
+                    Reflow(wrap_length_, content_available_size);
+
+                auto main_length = 0.0f;
+                for (const auto& line : lines_)
+                    main_length = std::max(main_length, line.main_length);
+                const auto cross_length = lines_.empty() ? 0.0f : lines_.back().cross_offset + lines_.back().cross_length;
+
+                return CalculateDesiredSize(available_size, MakeSize(main_length, cross_length, orientation_));
+            }
+
+            void WrapPanel::OnLayout(const Rect& rect)
+            {
+                // breaking lines here would leave the desired size of the old
+                // ones, so measure again at the length instead. The layout pass
+                // runs again for it; the old lines are laid out until then.
+                const auto main_length = GetMainLength(rect.GetSize(), orientation_);
+                if (child_available_size_.has_value() && IsBrokenOtherwise(std::min(GetMainLength(*child_available_size_, orientation_), main_length)))
+                {
+                    layout_wrap_length_ = main_length;
+                    InvalidateMeasure();
+                }
+
+                // laid out again without any line changing, so lay out all.
+                if (layout_line_begin_ >= layout_line_end_)
+                {
+                    layout_line_begin_ = 0;
+                    layout_line_end_ = static_cast<int>(lines_.size());
+                }
+
+                const auto count = static_cast<int>(child_metrics_.size());
+                const auto line_end = std::min(layout_line_end_, static_cast<int>(lines_.size()));
+                for (auto i = layout_line_begin_; i < line_end; i++)
+                {
+                    const auto& line = lines_[i];
+                    const auto end = i + 1 < static_cast<int>(lines_.size()) ? lines_[i + 1].begin : count;
+                    auto main_offset = 0.0f;
+                    for (auto j = line.begin; j < end; j++)
+                    {
+                        const auto& metrics = child_metrics_[j];
+                        metrics.control->Layout(Rect(
+                            MakePoint(main_offset, line.cross_offset, orientation_),
+                            GetChildLayoutSize(metrics.control, MakeSize(metrics.main_length, line.cross_length, orientation_))
+                        ));
+                        main_offset += metrics.main_length;
+                    }
+                }
+
+                layout_line_begin_ = 0;
+                layout_line_end_ = 0;
+            }
+
+            bool WrapPanel::IsBrokenOtherwise(const float wrap_length) const
+            {
+                // lines are broken greedily, so they stay the same as long as
+                // each fits and can't take the first child of the next one.
+                const auto count = static_cast<int>(child_metrics_.size());
+                for (auto i = 0; i < static_cast<int>(lines_.size()); i++)
+                {
+                    const auto& line = lines_[i];
+                    const auto end = i + 1 < static_cast<int>(lines_.size()) ? lines_[i + 1].begin : count;
+                    if (end - line.begin > 1 && line.main_length > wrap_length)
+                        return true;
+                    if (end < count && line.main_length + child_metrics_[end].main_length <= wrap_length)
+                        return true;
+                }
+                return false;
+            }
+
+            int WrapPanel::FindChildIndex(Control* child) const
+            {
+                const auto found = std::find_if(child_metrics_.cbegin(), child_metrics_.cend(), [child](const ChildMetrics& metrics) {
+                    return metrics.control == child;
+                });
+                return found == child_metrics_.cend() ? -1 : static_cast<int>(found - child_metrics_.cbegin());
+            }
+
+            int WrapPanel::FindLine(const int child_index) const
+            {
+                const auto found = std::upper_bound(lines_.cbegin(), lines_.cend(), child_index, [](const int index, const Line& line) {
+                    return index < line.begin;
+                });
+                return std::max(0, static_cast<int>(found - lines_.cbegin()) - 1);
+            }
+
+            void WrapPanel::MarkChildDirty(const int index)
+            {
+                first_dirty_index_ = std::min(first_dirty_index_, index);
+                last_dirty_index_ = std::max(last_dirty_index_, index);
+            }
+
+            void WrapPanel::MarkAllDirty()
+            {
+                lines_.clear();
+                first_dirty_index_ = 0;
+                last_dirty_index_ = static_cast<int>(child_metrics_.size()) - 1;
+            }
+
+            void WrapPanel::Reflow(const float wrap_length, const Size& child_available_size)
+            {
+                const auto count = static_cast<int>(child_metrics_.size());
+                const auto first_dirty_index = std::min(first_dirty_index_, count - 1);
+                const auto last_dirty_index = std::min(last_dirty_index_, count - 1);
+                first_dirty_index_ = std::numeric_limits<int>::max();
+                last_dirty_index_ = -1;
+
+                if (count == 0)
+                {
+                    lines_.clear();
+                    AddLayoutLines(0, 0);
+                    return;
+                }
+
+                // a child starting a line may now fit the previous one.
+                auto start_line = 0;
+                if (!lines_.empty())
+                {
+                    start_line = FindLine(first_dirty_index);
+                    if (start_line > 0 && lines_[start_line].begin == first_dirty_index)
+                        start_line--;
+                }
+
+                const std::vector<Line> old_tail(lines_.size() > static_cast<decltype(lines_.size())>(start_line) ? lines_.cbegin() + start_line + 1 : lines_.cend(), lines_.cend());
+                decltype(old_tail.size()) old_index = 0;
+
+                std::vector<Line> new_lines;
+                Line line{ lines_.empty() ? 0 : lines_[start_line].begin, 0.0f, 0.0f, 0.0f };
+                auto is_realigned = false;
+                for (auto i = line.begin; i < count; i++)
+                {
+                    auto& metrics = child_metrics_[i];
+                    metrics.control->Measure(child_available_size);
+                    const auto desired_size = metrics.control->GetDesiredSize();
+                    metrics.main_length = GetMainLength(desired_size, orientation_);
+                    metrics.cross_length = GetCrossLength(desired_size, orientation_);
+                    last_reflowed_child_count_++;
+
+                    if (i > line.begin && line.main_length + metrics.main_length > wrap_length)
+                    {
+                        new_lines.push_back(line);
+                        line = Line{ i, 0.0f, 0.0f, 0.0f };
+
+                        // past all changed children, a break where one was
+                        // before means the rest is the same as before.
+                        while (old_index < old_tail.size() && old_tail[old_index].begin < i)
+                            old_index++;
+                        if (i > last_dirty_index && old_index < old_tail.size() && old_tail[old_index].begin == i)
+                        {
+                            is_realigned = true;
+                            break;
+                        }
+                    }
+
+                    line.main_length += metrics.main_length;
+                    line.cross_length = std::max(line.cross_length, metrics.cross_length);
+                }
+                if (!is_realigned)
+                    new_lines.push_back(line);
+
+                lines_.resize(start_line);
+                lines_.insert(lines_.cend(), new_lines.cbegin(), new_lines.cend());
+                const auto tail_begin = static_cast<int>(lines_.size());
+                if (is_realigned)
+                    lines_.insert(lines_.cend(), old_tail.cbegin() + old_index, old_tail.cend());
+
+                auto cross_offset = start_line == 0 ? 0.0f : lines_[start_line - 1].cross_offset + lines_[start_line - 1].cross_length;
+                for (auto i = start_line; i < tail_begin; i++)
+                {
+                    lines_[i].cross_offset = cross_offset;
+                    cross_offset += lines_[i].cross_length;
+                }
+
+                // reused lines only move if the lines before changed their extent.
+                if (is_realigned && lines_[tail_begin].cross_offset == cross_offset)
+                {
+                    AddLayoutLines(start_line, tail_begin);
+                    return;
+                }
+
+                for (auto i = tail_begin; i < static_cast<int>(lines_.size()); i++)
+                {
+                    lines_[i].cross_offset = cross_offset;
+                    cross_offset += lines_[i].cross_length;
+                }
+                AddLayoutLines(start_line, static_cast<int>(lines_.size()));
+            }
+
+            void WrapPanel::AddLayoutLines(const int begin, const int end)
+            {
+                // line indices of a pending range may have moved, so lay out to the end.
+                if (layout_line_begin_ < layout_line_end_)
+                {
+                    layout_line_begin_ = std::min(layout_line_begin_, begin);
+                    layout_line_end_ = static_cast<int>(lines_.size());
+                    return;
+                }
+                layout_line_begin_ = begin;
+                layout_line_end_ = end;
+            }
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vector>
+
+#include "ui/control.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace controls
+        {
+            //A panel that puts children one after another along an orientation
+            //and starts a new line when the next child doesn't fit.
+            //
+            //Line breaks are kept between passes. When children change, lines
+            //are broken again from the line holding the first changed child,
+            //and the old lines are reused as soon as a break lands where it
+            //did before after the last changed child. Only the lines that
+            //moved are laid out again.
+            //
+            //Lines are broken at the main length measured. Laid out at a
+            //length that breaks them otherwise, the panel measures again at
+            //that length, so its desired size always agrees with its lines.
+            class WrapPanel : public Control
+            {
+            public:
+                explicit WrapPanel(Orientation orientation = Orientation::Horizontal);
+                WrapPanel(const WrapPanel& other) = delete;
+                WrapPanel(WrapPanel&& other) = delete;
+                WrapPanel& operator=(const WrapPanel& other) = delete;
+                WrapPanel& operator=(WrapPanel&& other) = delete;
+                ~WrapPanel() override = default;
+
+                Orientation GetOrientation() const
+                {
+                    return orientation_;
+                }
+
+                void SetOrientation(Orientation orientation);
+
+                int GetLineCount() const
+                {
+                    return static_cast<int>(lines_.size());
+                }
+
+                //Count of children visited by the last line breaking.
+                int GetLastReflowedChildCount() const
+                {
+                    return last_reflowed_child_count_;
+                }
+
+            protected:
+                void OnAddChild(Control* child) override;
+                void OnRemoveChild(Control* child) override;
+                void OnChildMeasureInvalidated(Control* child) override;
+
+                Size OnMeasure(const Size& available_size) override;
+                void OnLayout(const Rect& rect) override;
+
+            private:
+                struct ChildMetrics
+                {
+                    Control* control;
+                    float main_length;
+                    float cross_length;
+                };
+
+                struct Line
+                {
+                    //Index of the first child. The line ends at the next line.
+                    int begin;
+                    float main_length;
+                    float cross_length;
+                    float cross_offset;
+                };
+
+                //Return true if breaking at "wrap_length" gives other lines.
+                bool IsBrokenOtherwise(float wrap_length) const;
+                int FindChildIndex(Control* child) const;
+                int FindLine(int child_index) const;
+                void MarkChildDirty(int index);
+                void MarkAllDirty();
+                //Break lines again from the first dirty child. Children on the
+                //way are measured with "child_available_size".
+                void Reflow(float wrap_length, const Size& child_available_size);
+                void AddLayoutLines(int begin, int end);
+
+            private:
+                Orientation orientation_;
+                std::vector<ChildMetrics> child_metrics_;
+                std::vector<Line> lines_;
+
+                //The main length lines are broken at and the room children got.
+                float wrap_length_;
+                std::optional<Size> child_available_size_;
+                //The main length of the last layout that broke the lines
+                //otherwise, which bounds the wrap length of measure.
+                float layout_wrap_length_;
+
+                //Range of children changed since the last line breaking.
+                int first_dirty_index_;
+                int last_dirty_index_;
+
+                //Range of lines to lay out again.
+                int layout_line_begin_;
+                int layout_line_end_;
+
+                int last_reflowed_child_count_ = 0;
+            };
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#include "damage_tracker.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace cru
+{
+    namespace ui
+    {
+        inline Region SimplifyRegionHelperFunc(Region region, const int max_rect_count)
+        {
+            if (region.GetRectCount() > max_rect_count)
+                return Region(region.GetBounds());
+            return region;
+        }
+
+        DamageTracker::DamageTracker(const int buffer_count)
+            : buffer_count_(buffer_count)
+        {
+            if (buffer_count < 1)
+                throw std::invalid_argument("Buffer count must be at least 1.");
+        }
+
+        void DamageTracker::AddDamage(const Rect& rect)
+        {
+            if (is_full_damage_ || rect.IsEmpty())
+                return;
+            damage_ = damage_.Union(Rect::FromVertices(
+                std::floor(rect.left), std::floor(rect.top),
+                std::ceil(rect.GetRight()), std::ceil(rect.GetBottom())
+            ));
+        }
+
+        void DamageTracker::AddFullDamage()
+        {
+            is_full_damage_ = true;
+            damage_.Clear();
+        }
+
+        DamageFrame DamageTracker::TakeFrame(const Rect& viewport, const int max_rect_count)
+        {
+            DamageFrame frame;
+
+            if (is_full_damage_)
+                frame.present_region = Region(viewport);
+            else
+                frame.present_region = SimplifyRegionHelperFunc(damage_.Intersect(viewport), max_rect_count);
+            frame.is_full = frame.present_region.Contains(viewport);
+
+            auto paint_region = frame.present_region;
+            for (const auto& region : history_)
+                paint_region = paint_region.Union(region);
+            frame.paint_region = SimplifyRegionHelperFunc(paint_region.Intersect(viewport), max_rect_count);
+
+            history_.push_back(frame.present_region);
+            if (static_cast<int>(history_.size()) >= buffer_count_)
+                history_.pop_front();
+
+            damage_.Clear();
+            is_full_damage_ = false;
+            return frame;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <deque>
+
+#include "base.h"
+#include "ui_base.h"
+#include "region.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        //What to paint and present for a frame.
+        struct DamageFrame
+        {
+            //The area to draw again in the back buffer.
+            Region paint_region;
+            //The area that changed since the last frame, which is a part of
+            //"paint_region".
+            Region present_region;
+            //True if "present_region" is the whole viewport.
+            bool is_full = false;
+        };
+
+        //Collects the area that changed between frames of a window.
+        class DamageTracker : public Object
+        {
+        public:
+            //"buffer_count" is the count of back buffers the frames rotate
+            //through. A buffer drawn again has missed the damage of the
+            //frames drawn into the other buffers, so that damage is painted
+            //again too.
+            explicit DamageTracker(int buffer_count = 1);
+            DamageTracker(const DamageTracker& other) = delete;
+            DamageTracker(DamageTracker&& other) = delete;
+            DamageTracker& operator=(const DamageTracker& other) = delete;
+            DamageTracker& operator=(DamageTracker&& other) = delete;
+            ~DamageTracker() override = default;
+
+            //Damage a rect. It is rounded out to whole units so that edges
+            //drawn with anti-aliasing are painted again.
+            void AddDamage(const Rect& rect);
+
+            //Damage the whole viewport, for example after the buffers are
+            //resized and their content is lost.
+            void AddFullDamage();
+
+            //Return true if anything is damaged since the last frame.
+            bool HasDamage() const
+            {
+                return is_full_damage_ || !damage_.IsEmpty();
+            }
+
+            //Get the damage collected since the last frame.
+            const Region& GetDamage() const
+            {
+                return damage_;
+            }
+
+            //Finish collecting the damage of a frame and start the next one.
+            //Everything is clipped to "viewport". A region of more than
+            //"max_rect_count" rects is replaced by its bounds, because every
+            //rect costs a pass when drawing.
+            DamageFrame TakeFrame(const Rect& viewport, int max_rect_count);
+
+        private:
+            Region damage_;
+            bool is_full_damage_ = true;
+            //Damage of the latest frames, newest at the back.
+            std::deque<Region> history_;
+            int buffer_count_;
+        };
+    }
+}
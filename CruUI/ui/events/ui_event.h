@@ -1,11 +1,11 @@
 #pragma once
 
-#include "system_headers.h"
 #include <optional>
 
 #include "base.h"
 #include "cru_event.h"
 #include "ui/ui_base.h"
+#include "graph/painter.h"
 
 namespace cru
 {
@@ -88,8 +88,8 @@ namespace cru
             class DrawEventArgs : public UiEventArgs
             {
             public:
-                DrawEventArgs(Object* sender, Object* original_sender, ID2D1DeviceContext* device_context)
-                    : UiEventArgs(sender, original_sender), device_context_(device_context)
+                DrawEventArgs(Object* sender, Object* original_sender, graph::Painter* painter)
+                    : UiEventArgs(sender, original_sender), painter_(painter)
                 {
                     
                 }
@@ -99,13 +99,15 @@ namespace cru
                 DrawEventArgs& operator=(DrawEventArgs&& other) = default;
                 ~DrawEventArgs() = default;
 
-                ID2D1DeviceContext* GetDeviceContext() const
+                //Get the painter in local coordinates. What is drawn with it is
+                //recorded and replayed until the control repaints.
+                graph::Painter* GetPainter() const
                 {
-                    return device_context_;
+                    return painter_;
                 }
 
             private:
-                ID2D1DeviceContext * device_context_;
+                graph::Painter* painter_;
             };
 
 
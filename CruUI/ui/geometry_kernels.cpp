@@ -0,0 +1,437 @@
+#include "geometry_kernels.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#if defined(CRU_GEOMETRY_SCALAR)
+#define CRU_GEOMETRY_KERNEL_SCALAR
+#elif defined(__AVX2__)
+#define CRU_GEOMETRY_KERNEL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CRU_GEOMETRY_KERNEL_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CRU_GEOMETRY_KERNEL_NEON
+#include <arm_neon.h>
+#else
+#define CRU_GEOMETRY_KERNEL_SCALAR
+#endif
+
+namespace cru
+{
+    namespace ui
+    {
+        namespace geometry
+        {
+            // kernels load the structs as packed floats.
+            static_assert(sizeof(Point) == 2 * sizeof(float) && std::is_standard_layout<Point>::value, "Point must be two packed floats.");
+            static_assert(sizeof(Rect) == 4 * sizeof(float) && std::is_standard_layout<Rect>::value, "Rect must be four packed floats.");
+
+            // The scalar versions define the results, and vector versions do
+            // the same operations in the same order so the results are equal.
+
+            inline Point TransformPointHelperFunc(const Point& point, const Matrix& matrix)
+            {
+                return Point(
+                    (point.x * matrix.m11 + point.y * matrix.m21) + matrix.dx,
+                    (point.x * matrix.m12 + point.y * matrix.m22) + matrix.dy
+                );
+            }
+
+            inline Rect IntersectRectHelperFunc(const Rect& left, const Rect& right)
+            {
+                const auto l = std::max(left.left, right.left);
+                const auto t = std::max(left.top, right.top);
+                const auto r = std::min(left.left + left.width, right.left + right.width);
+                const auto b = std::min(left.top + left.height, right.top + right.height);
+                return Rect(l, t, std::max(r - l, 0.0f), std::max(b - t, 0.0f));
+            }
+
+            inline Rect UnionRectHelperFunc(const Rect& left, const Rect& right)
+            {
+                const auto l = std::min(left.left, right.left);
+                const auto t = std::min(left.top, right.top);
+                const auto r = std::max(left.left + left.width, right.left + right.width);
+                const auto b = std::max(left.top + left.height, right.top + right.height);
+                return Rect(l, t, r - l, b - t);
+            }
+
+            inline bool ContainsPointHelperFunc(const Rect& rect, const Point& point)
+            {
+                return point.x >= rect.left && point.y >= rect.top &&
+                    point.x < rect.left + rect.width && point.y < rect.top + rect.height;
+            }
+
+#if defined(CRU_GEOMETRY_KERNEL_SSE2) || defined(CRU_GEOMETRY_KERNEL_AVX2)
+            // (l, t, w, h) -> (l, t, min/max of right, min/max of bottom) is
+            // done by adding (l, t, l, t) and taking the high half.
+
+            inline __m128 IntersectRectHelperFunc(const __m128 left, const __m128 right)
+            {
+                const auto left_far = _mm_add_ps(left, _mm_movelh_ps(left, left));
+                const auto right_far = _mm_add_ps(right, _mm_movelh_ps(right, right));
+                const auto vertices = _mm_shuffle_ps(_mm_max_ps(left, right), _mm_min_ps(left_far, right_far), _MM_SHUFFLE(3, 2, 1, 0));
+                const auto size = _mm_max_ps(_mm_sub_ps(vertices, _mm_movelh_ps(vertices, vertices)), _mm_setzero_ps());
+                return _mm_shuffle_ps(vertices, size, _MM_SHUFFLE(3, 2, 1, 0));
+            }
+
+            inline __m128 UnionRectHelperFunc(const __m128 left, const __m128 right)
+            {
+                const auto left_far = _mm_add_ps(left, _mm_movelh_ps(left, left));
+                const auto right_far = _mm_add_ps(right, _mm_movelh_ps(right, right));
+                const auto vertices = _mm_shuffle_ps(_mm_min_ps(left, right), _mm_max_ps(left_far, right_far), _MM_SHUFFLE(3, 2, 1, 0));
+                const auto size = _mm_sub_ps(vertices, _mm_movelh_ps(vertices, vertices));
+                return _mm_shuffle_ps(vertices, size, _MM_SHUFFLE(3, 2, 1, 0));
+            }
+
+            //"point" is (x, y, x, y).
+            inline bool ContainsPointHelperFunc(const __m128 rect, const __m128 point)
+            {
+                const auto far = _mm_add_ps(rect, _mm_movelh_ps(rect, rect));
+                const auto mask = _mm_shuffle_ps(_mm_cmpge_ps(point, rect), _mm_cmplt_ps(point, far), _MM_SHUFFLE(3, 2, 1, 0));
+                return _mm_movemask_ps(mask) == 0xF;
+            }
+#endif
+
+#if defined(CRU_GEOMETRY_KERNEL_AVX2)
+            // the same as the sse versions, on two rects in the two lanes.
+
+            inline __m256 IntersectRectsHelperFunc(const __m256 left, const __m256 right)
+            {
+                const auto left_far = _mm256_add_ps(left, _mm256_shuffle_ps(left, left, _MM_SHUFFLE(1, 0, 1, 0)));
+                const auto right_far = _mm256_add_ps(right, _mm256_shuffle_ps(right, right, _MM_SHUFFLE(1, 0, 1, 0)));
+                const auto vertices = _mm256_shuffle_ps(_mm256_max_ps(left, right), _mm256_min_ps(left_far, right_far), _MM_SHUFFLE(3, 2, 1, 0));
+                const auto size = _mm256_max_ps(_mm256_sub_ps(vertices, _mm256_shuffle_ps(vertices, vertices, _MM_SHUFFLE(1, 0, 1, 0))), _mm256_setzero_ps());
+                return _mm256_shuffle_ps(vertices, size, _MM_SHUFFLE(3, 2, 1, 0));
+            }
+
+            inline __m256 UnionRectsHelperFunc(const __m256 left, const __m256 right)
+            {
+                const auto left_far = _mm256_add_ps(left, _mm256_shuffle_ps(left, left, _MM_SHUFFLE(1, 0, 1, 0)));
+                const auto right_far = _mm256_add_ps(right, _mm256_shuffle_ps(right, right, _MM_SHUFFLE(1, 0, 1, 0)));
+                const auto vertices = _mm256_shuffle_ps(_mm256_min_ps(left, right), _mm256_max_ps(left_far, right_far), _MM_SHUFFLE(3, 2, 1, 0));
+                const auto size = _mm256_sub_ps(vertices, _mm256_shuffle_ps(vertices, vertices, _MM_SHUFFLE(1, 0, 1, 0)));
+                return _mm256_shuffle_ps(vertices, size, _MM_SHUFFLE(3, 2, 1, 0));
+            }
+
+            //Return a 2-bit mask, bit i for the rect in lane i.
+            inline int ContainsPointsHelperFunc(const __m256 rects, const __m256 point)
+            {
+                const auto far = _mm256_add_ps(rects, _mm256_shuffle_ps(rects, rects, _MM_SHUFFLE(1, 0, 1, 0)));
+                const auto mask = _mm256_movemask_ps(_mm256_shuffle_ps(
+                    _mm256_cmp_ps(point, rects, _CMP_GE_OQ), _mm256_cmp_ps(point, far, _CMP_LT_OQ), _MM_SHUFFLE(3, 2, 1, 0)));
+                return ((mask & 0x0F) == 0x0F ? 1 : 0) | ((mask & 0xF0) == 0xF0 ? 2 : 0);
+            }
+#endif
+
+#if defined(CRU_GEOMETRY_KERNEL_NEON)
+            inline float32x4_t IntersectRectHelperFunc(const float32x4_t left, const float32x4_t right)
+            {
+                const auto left_near = vget_low_f32(left);
+                const auto right_near = vget_low_f32(right);
+                const auto left_far = vadd_f32(vget_high_f32(left), left_near);
+                const auto right_far = vadd_f32(vget_high_f32(right), right_near);
+                const auto near = vmax_f32(left_near, right_near);
+                const auto far = vmin_f32(left_far, right_far);
+                return vcombine_f32(near, vmax_f32(vsub_f32(far, near), vdup_n_f32(0.0f)));
+            }
+
+            inline float32x4_t UnionRectHelperFunc(const float32x4_t left, const float32x4_t right)
+            {
+                const auto left_near = vget_low_f32(left);
+                const auto right_near = vget_low_f32(right);
+                const auto left_far = vadd_f32(vget_high_f32(left), left_near);
+                const auto right_far = vadd_f32(vget_high_f32(right), right_near);
+                const auto near = vmin_f32(left_near, right_near);
+                const auto far = vmax_f32(left_far, right_far);
+                return vcombine_f32(near, vsub_f32(far, near));
+            }
+
+            //Return a 4-bit mask for 4 rects split into lanes by "vld4q_f32".
+            inline int ContainsPointsHelperFunc(const float32x4x4_t& rects, const float x, const float y)
+            {
+                const auto px = vdupq_n_f32(x);
+                const auto py = vdupq_n_f32(y);
+                auto mask = vandq_u32(vcgeq_f32(px, rects.val[0]), vcgeq_f32(py, rects.val[1]));
+                mask = vandq_u32(mask, vcltq_f32(px, vaddq_f32(rects.val[0], rects.val[2])));
+                mask = vandq_u32(mask, vcltq_f32(py, vaddq_f32(rects.val[1], rects.val[3])));
+                const uint32x4_t bits = { 1, 2, 4, 8 };
+                return static_cast<int>(vaddvq_u32(vandq_u32(mask, bits)));
+            }
+#endif
+
+            const char* GetKernelInstructionSet()
+            {
+#if defined(CRU_GEOMETRY_KERNEL_AVX2)
+                return "avx2";
+#elif defined(CRU_GEOMETRY_KERNEL_SSE2)
+                return "sse2";
+#elif defined(CRU_GEOMETRY_KERNEL_NEON)
+                return "neon";
+#else
+                return "scalar";
+#endif
+            }
+
+            void TranslatePoints(Point* points, const int count, const Point& offset)
+            {
+                auto i = 0;
+                const auto data = reinterpret_cast<float*>(points);
+#if defined(CRU_GEOMETRY_KERNEL_AVX2)
+                const auto vector_offset = _mm256_setr_ps(offset.x, offset.y, offset.x, offset.y, offset.x, offset.y, offset.x, offset.y);
+                for (; i + 4 <= count; i += 4)
+                    _mm256_storeu_ps(data + i * 2, _mm256_add_ps(_mm256_loadu_ps(data + i * 2), vector_offset));
+#elif defined(CRU_GEOMETRY_KERNEL_SSE2)
+                const auto vector_offset = _mm_setr_ps(offset.x, offset.y, offset.x, offset.y);
+                for (; i + 2 <= count; i += 2)
+                    _mm_storeu_ps(data + i * 2, _mm_add_ps(_mm_loadu_ps(data + i * 2), vector_offset));
+#elif defined(CRU_GEOMETRY_KERNEL_NEON)
+                const float offset_data[] = { offset.x, offset.y, offset.x, offset.y };
+                const auto vector_offset = vld1q_f32(offset_data);
+                for (; i + 2 <= count; i += 2)
+                    vst1q_f32(data + i * 2, vaddq_f32(vld1q_f32(data + i * 2), vector_offset));
+#endif
+                for (; i < count; i++)
+                    points[i] += offset;
+            }
+
+            void TransformPoints(const Point* source, Point* destination, const int count, const Matrix& matrix)
+            {
+                if (matrix.IsTranslation())
+                {
+                    if (source != destination)
+                        std::copy(source, source + count, destination);
+                    TranslatePoints(destination, count, Point(matrix.dx, matrix.dy));
+                    return;
+                }
+
+                auto i = 0;
+                const auto source_data = reinterpret_cast<const float*>(source);
+                const auto destination_data = reinterpret_cast<float*>(destination);
+#if defined(CRU_GEOMETRY_KERNEL_AVX2)
+                // (x0, y0, x1, y1 | x2, y2, x3, y3) -> (x0, x0, x1, x1 | ...) and (y0, y0, y1, y1 | ...)
+                const auto column_x = _mm256_setr_ps(matrix.m11, matrix.m12, matrix.m11, matrix.m12, matrix.m11, matrix.m12, matrix.m11, matrix.m12);
+                const auto column_y = _mm256_setr_ps(matrix.m21, matrix.m22, matrix.m21, matrix.m22, matrix.m21, matrix.m22, matrix.m21, matrix.m22);
+                const auto translation = _mm256_setr_ps(matrix.dx, matrix.dy, matrix.dx, matrix.dy, matrix.dx, matrix.dy, matrix.dx, matrix.dy);
+                for (; i + 4 <= count; i += 4)
+                {
+                    const auto points = _mm256_loadu_ps(source_data + i * 2);
+                    const auto x = _mm256_permute_ps(points, _MM_SHUFFLE(2, 2, 0, 0));
+                    const auto y = _mm256_permute_ps(points, _MM_SHUFFLE(3, 3, 1, 1));
+                    _mm256_storeu_ps(destination_data + i * 2, _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(x, column_x), _mm256_mul_ps(y, column_y)), translation));
+                }
+#elif defined(CRU_GEOMETRY_KERNEL_SSE2)
+                const auto column_x = _mm_setr_ps(matrix.m11, matrix.m12, matrix.m11, matrix.m12);
+                const auto column_y = _mm_setr_ps(matrix.m21, matrix.m22, matrix.m21, matrix.m22);
+                const auto translation = _mm_setr_ps(matrix.dx, matrix.dy, matrix.dx, matrix.dy);
+                for (; i + 2 <= count; i += 2)
+                {
+                    const auto points = _mm_loadu_ps(source_data + i * 2);
+                    const auto x = _mm_shuffle_ps(points, points, _MM_SHUFFLE(2, 2, 0, 0));
+                    const auto y = _mm_shuffle_ps(points, points, _MM_SHUFFLE(3, 3, 1, 1));
+                    _mm_storeu_ps(destination_data + i * 2, _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(x, column_x), _mm_mul_ps(y, column_y)), translation));
+                }
+#elif defined(CRU_GEOMETRY_KERNEL_NEON)
+                // split 4 points into xs and ys.
+                const auto m11 = vdupq_n_f32(matrix.m11), m12 = vdupq_n_f32(matrix.m12);
+                const auto m21 = vdupq_n_f32(matrix.m21), m22 = vdupq_n_f32(matrix.m22);
+                const auto dx = vdupq_n_f32(matrix.dx), dy = vdupq_n_f32(matrix.dy);
+                for (; i + 4 <= count; i += 4)
+                {
+                    const auto points = vld2q_f32(source_data + i * 2);
+                    float32x4x2_t result;
+                    result.val[0] = vaddq_f32(vaddq_f32(vmulq_f32(points.val[0], m11), vmulq_f32(points.val[1], m21)), dx);
+                    result.val[1] = vaddq_f32(vaddq_f32(vmulq_f32(points.val[0], m12), vmulq_f32(points.val[1], m22)), dy);
+                    vst2q_f32(destination_data + i * 2, result);
+                }
+#endif
+                for (; i < count; i++)
+                    destination[i] = TransformPointHelperFunc(source[i], matrix);
+            }
+
+            void IntersectRects(const Rect* left, const Rect* right, Rect* result, const int count)
+            {
+                auto i = 0;
+                const auto left_data = reinterpret_cast<const float*>(left);
+                const auto right_data = reinterpret_cast<const float*>(right);
+                const auto result_data = reinterpret_cast<float*>(result);
+#if defined(CRU_GEOMETRY_KERNEL_AVX2)
+                for (; i + 2 <= count; i += 2)
+                    _mm256_storeu_ps(result_data + i * 4, IntersectRectsHelperFunc(
+                        _mm256_loadu_ps(left_data + i * 4), _mm256_loadu_ps(right_data + i * 4)));
+#endif
+#if defined(CRU_GEOMETRY_KERNEL_SSE2) || defined(CRU_GEOMETRY_KERNEL_AVX2)
+                for (; i < count; i++)
+                    _mm_storeu_ps(result_data + i * 4, IntersectRectHelperFunc(
+                        _mm_loadu_ps(left_data + i * 4), _mm_loadu_ps(right_data + i * 4)));
+#elif defined(CRU_GEOMETRY_KERNEL_NEON)
+                for (; i < count; i++)
+                    vst1q_f32(result_data + i * 4, IntersectRectHelperFunc(
+                        vld1q_f32(left_data + i * 4), vld1q_f32(right_data + i * 4)));
+#endif
+                for (; i < count; i++)
+                    result[i] = IntersectRectHelperFunc(left[i], right[i]);
+            }
+
+            void UnionRects(const Rect* left, const Rect* right, Rect* result, const int count)
+            {
+                auto i = 0;
+                const auto left_data = reinterpret_cast<const float*>(left);
+                const auto right_data = reinterpret_cast<const float*>(right);
+                const auto result_data = reinterpret_cast<float*>(result);
+#if defined(CRU_GEOMETRY_KERNEL_AVX2)
+                for (; i + 2 <= count; i += 2)
+                    _mm256_storeu_ps(result_data + i * 4, UnionRectsHelperFunc(
+                        _mm256_loadu_ps(left_data + i * 4), _mm256_loadu_ps(right_data + i * 4)));
+#endif
+#if defined(CRU_GEOMETRY_KERNEL_SSE2) || defined(CRU_GEOMETRY_KERNEL_AVX2)
+                for (; i < count; i++)
+                    _mm_storeu_ps(result_data + i * 4, UnionRectHelperFunc(
+                        _mm_loadu_ps(left_data + i * 4), _mm_loadu_ps(right_data + i * 4)));
+#elif defined(CRU_GEOMETRY_KERNEL_NEON)
+                for (; i < count; i++)
+                    vst1q_f32(result_data + i * 4, UnionRectHelperFunc(
+                        vld1q_f32(left_data + i * 4), vld1q_f32(right_data + i * 4)));
+#endif
+                for (; i < count; i++)
+                    result[i] = UnionRectHelperFunc(left[i], right[i]);
+            }
+
+            Rect GetBounds(const Rect* rects, const int count)
+            {
+                if (count <= 0)
+                    return Rect();
+
+                auto left = rects[0].left;
+                auto top = rects[0].top;
+                auto right = rects[0].left + rects[0].width;
+                auto bottom = rects[0].top + rects[0].height;
+                auto i = 1;
+#if defined(CRU_GEOMETRY_KERNEL_SSE2) || defined(CRU_GEOMETRY_KERNEL_AVX2)
+                // keep (left, top, right, bottom) as (min, min, max, max).
+                const auto data = reinterpret_cast<const float*>(rects);
+                auto near = _mm_setr_ps(left, top, left, top);
+                auto far = _mm_setr_ps(right, bottom, right, bottom);
+                for (; i < count; i++)
+                {
+                    const auto rect = _mm_loadu_ps(data + i * 4);
+                    near = _mm_min_ps(near, rect);
+                    far = _mm_max_ps(far, _mm_add_ps(rect, _mm_movelh_ps(rect, rect)));
+                }
+                float near_data[4], far_data[4];
+                _mm_storeu_ps(near_data, near);
+                _mm_storeu_ps(far_data, far);
+                left = near_data[0];
+                top = near_data[1];
+                right = far_data[2];
+                bottom = far_data[3];
+#elif defined(CRU_GEOMETRY_KERNEL_NEON)
+                const auto data = reinterpret_cast<const float*>(rects);
+                const float initial_near[] = { left, top };
+                const float initial_far[] = { right, bottom };
+                auto near = vld1_f32(initial_near);
+                auto far = vld1_f32(initial_far);
+                for (; i < count; i++)
+                {
+                    const auto rect = vld1q_f32(data + i * 4);
+                    near = vmin_f32(near, vget_low_f32(rect));
+                    far = vmax_f32(far, vadd_f32(vget_high_f32(rect), vget_low_f32(rect)));
+                }
+                left = vget_lane_f32(near, 0);
+                top = vget_lane_f32(near, 1);
+                right = vget_lane_f32(far, 0);
+                bottom = vget_lane_f32(far, 1);
+#endif
+                for (; i < count; i++)
+                {
+                    left = std::min(left, rects[i].left);
+                    top = std::min(top, rects[i].top);
+                    right = std::max(right, rects[i].left + rects[i].width);
+                    bottom = std::max(bottom, rects[i].top + rects[i].height);
+                }
+                return Rect(left, top, right - left, bottom - top);
+            }
+
+            int ContainsPoint(const Rect* rects, const int count, const Point& point, uint8_t* result)
+            {
+                auto inside_count = 0;
+                auto i = 0;
+#if defined(CRU_GEOMETRY_KERNEL_AVX2)
+                const auto data = reinterpret_cast<const float*>(rects);
+                const auto vector_point = _mm256_setr_ps(point.x, point.y, point.x, point.y, point.x, point.y, point.x, point.y);
+                for (; i + 2 <= count; i += 2)
+                {
+                    const auto mask = ContainsPointsHelperFunc(_mm256_loadu_ps(data + i * 4), vector_point);
+                    result[i] = static_cast<uint8_t>(mask & 1);
+                    result[i + 1] = static_cast<uint8_t>(mask >> 1);
+                    inside_count += result[i] + result[i + 1];
+                }
+#elif defined(CRU_GEOMETRY_KERNEL_SSE2)
+                const auto data = reinterpret_cast<const float*>(rects);
+                const auto vector_point = _mm_setr_ps(point.x, point.y, point.x, point.y);
+                for (; i < count; i++)
+                {
+                    result[i] = ContainsPointHelperFunc(_mm_loadu_ps(data + i * 4), vector_point) ? 1 : 0;
+                    inside_count += result[i];
+                }
+#elif defined(CRU_GEOMETRY_KERNEL_NEON)
+                const auto data = reinterpret_cast<const float*>(rects);
+                for (; i + 4 <= count; i += 4)
+                {
+                    const auto mask = ContainsPointsHelperFunc(vld4q_f32(data + i * 4), point.x, point.y);
+                    for (auto j = 0; j < 4; j++)
+                    {
+                        result[i + j] = static_cast<uint8_t>((mask >> j) & 1);
+                        inside_count += result[i + j];
+                    }
+                }
+#endif
+                for (; i < count; i++)
+                {
+                    result[i] = ContainsPointHelperFunc(rects[i], point) ? 1 : 0;
+                    inside_count += result[i];
+                }
+                return inside_count;
+            }
+
+            int FindLastContaining(const Rect* rects, const int count, const Point& point)
+            {
+                auto i = count;
+#if defined(CRU_GEOMETRY_KERNEL_AVX2)
+                const auto data = reinterpret_cast<const float*>(rects);
+                const auto vector_point = _mm256_setr_ps(point.x, point.y, point.x, point.y, point.x, point.y, point.x, point.y);
+                for (; i >= 2; i -= 2)
+                {
+                    const auto mask = ContainsPointsHelperFunc(_mm256_loadu_ps(data + (i - 2) * 4), vector_point);
+                    if (mask & 2)
+                        return i - 1;
+                    if (mask & 1)
+                        return i - 2;
+                }
+#elif defined(CRU_GEOMETRY_KERNEL_SSE2)
+                const auto data = reinterpret_cast<const float*>(rects);
+                const auto vector_point = _mm_setr_ps(point.x, point.y, point.x, point.y);
+                for (; i >= 1; i--)
+                    if (ContainsPointHelperFunc(_mm_loadu_ps(data + (i - 1) * 4), vector_point))
+                        return i - 1;
+#elif defined(CRU_GEOMETRY_KERNEL_NEON)
+                const auto data = reinterpret_cast<const float*>(rects);
+                for (; i >= 4; i -= 4)
+                {
+                    const auto mask = ContainsPointsHelperFunc(vld4q_f32(data + (i - 4) * 4), point.x, point.y);
+                    for (auto j = 3; j >= 0; j--)
+                        if (mask & (1 << j))
+                            return i - 4 + j;
+                }
+#endif
+                for (; i >= 1; i--)
+                    if (ContainsPointHelperFunc(rects[i - 1], point))
+                        return i - 1;
+                return -1;
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ui_base.h"
+#include "matrix.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        //Batch kernels over arrays of geometry. They are compiled for the best
+        //instruction set the build targets (AVX2, SSE2 or NEON) and fall back
+        //to plain loops otherwise, or when "CRU_GEOMETRY_SCALAR" is defined.
+        //Every kernel gives the same result as the scalar one.
+        namespace geometry
+        {
+            //Get the instruction set the kernels are compiled for: "avx2",
+            //"sse2", "neon" or "scalar".
+            const char* GetKernelInstructionSet();
+
+            //points[i] += offset
+            void TranslatePoints(Point* points, int count, const Point& offset);
+
+            //destination[i] = matrix.TransformPoint(source[i])
+            //"source" and "destination" may be the same array.
+            void TransformPoints(const Point* source, Point* destination, int count, const Matrix& matrix);
+
+            //result[i] = left[i].Intersect(right[i])
+            void IntersectRects(const Rect* left, const Rect* right, Rect* result, int count);
+
+            //result[i] = left[i].Union(right[i])
+            void UnionRects(const Rect* left, const Rect* right, Rect* result, int count);
+
+            //Get the bounds of all rects. Return an empty rect at zero if there is none.
+            Rect GetBounds(const Rect* rects, int count);
+
+            //result[i] = rects[i].IsPointInside(point) ? 1 : 0
+            //Return the count of rects containing the point.
+            int ContainsPoint(const Rect* rects, int count, const Point& point, uint8_t* result);
+
+            //Return the index of the last rect containing the point, or -1. For
+            //rects in paint order, it is the topmost one.
+            int FindLastContaining(const Rect* rects, int count, const Point& point);
+        }
+    }
+}
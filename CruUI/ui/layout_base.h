@@ -1,12 +1,47 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <optional>
 
+#include "ui_base.h"
+
 namespace cru
 {
     namespace ui
     {
-        enum class MeasureMode
+        enum class Orientation : std::uint8_t
+        {
+            Horizontal,
+            Vertical
+        };
+
+        // Helpers for panels that lay out along a main axis and a cross axis.
+        inline float GetMainLength(const Size& size, const Orientation orientation)
+        {
+            return orientation == Orientation::Horizontal ? size.width : size.height;
+        }
+
+        inline float GetCrossLength(const Size& size, const Orientation orientation)
+        {
+            return orientation == Orientation::Horizontal ? size.height : size.width;
+        }
+
+        inline Size MakeSize(const float main_length, const float cross_length, const Orientation orientation)
+        {
+            return orientation == Orientation::Horizontal ? Size(main_length, cross_length) : Size(cross_length, main_length);
+        }
+
+        inline Point MakePoint(const float main_offset, const float cross_offset, const Orientation orientation)
+        {
+            return orientation == Orientation::Horizontal ? Point(main_offset, cross_offset) : Point(cross_offset, main_offset);
+        }
+
+        //A byte per length. Packing both modes of a size into one byte
+        //would save 4 bytes of "MeasureSize", but "BasicLayoutParams" stays
+        //40 bytes as its vtable pointer aligns it to 8, and controls share
+        //interned params anyway.
+        enum class MeasureMode : std::uint8_t
         {
             Exactly,
             Content,
@@ -15,7 +50,7 @@ namespace cru
 
         struct MeasureLength final
         {
-            explicit MeasureLength(const double length = 0.0, const MeasureMode mode = MeasureMode::Exactly)
+            explicit MeasureLength(const float length = 0.0f, const MeasureMode mode = MeasureMode::Exactly)
                 : length(length), mode(mode)
             {
 
@@ -23,13 +58,23 @@ namespace cru
 
             bool Validate() const
             {
-                return !(mode == MeasureMode::Exactly && length < 0.0);
+                return !(mode == MeasureMode::Exactly && length < 0.0f);
             }
 
-            double length;
+            float length;
             MeasureMode mode;
         };
 
+        inline bool operator == (const MeasureLength& left, const MeasureLength& right)
+        {
+            return left.length == right.length && left.mode == right.mode;
+        }
+
+        inline bool operator != (const MeasureLength& left, const MeasureLength& right)
+        {
+            return !(left == right);
+        }
+
         struct MeasureSize final
         {
             MeasureLength width;
@@ -41,6 +86,81 @@ namespace cru
             }
         };
 
+        inline bool operator == (const MeasureSize& left, const MeasureSize& right)
+        {
+            return left.width == right.width && left.height == right.height;
+        }
+
+        inline bool operator != (const MeasureSize& left, const MeasureSize& right)
+        {
+            return !(left == right);
+        }
+
+        // An optional length packed in a single float, where NaN means no value.
+        // It has the same interface as "std::optional<float>" at half the size.
+        class OptionalLength final
+        {
+        public:
+            constexpr OptionalLength()
+                : value_(std::numeric_limits<float>::quiet_NaN())
+            {
+
+            }
+
+            constexpr OptionalLength(std::nullopt_t)
+                : OptionalLength()
+            {
+
+            }
+
+            constexpr OptionalLength(const float value)
+                : value_(value)
+            {
+
+            }
+
+            constexpr OptionalLength(const std::optional<float> value)
+                : value_(value.has_value() ? value.value() : std::numeric_limits<float>::quiet_NaN())
+            {
+
+            }
+
+            constexpr bool has_value() const
+            {
+                return value_ == value_; // false only for NaN
+            }
+
+            float value() const
+            {
+                if (!has_value())
+                    throw std::bad_optional_access();
+                return value_;
+            }
+
+            constexpr float value_or(const float default_value) const
+            {
+                return has_value() ? value_ : default_value;
+            }
+
+            operator std::optional<float>() const
+            {
+                return has_value() ? std::make_optional(value_) : std::nullopt;
+            }
+
+        private:
+            float value_;
+        };
+
+        inline bool operator == (const OptionalLength& left, const OptionalLength& right)
+        {
+            return left.has_value() ? right.has_value() && left.value() == right.value() : !right.has_value();
+        }
+
+        inline bool operator != (const OptionalLength& left, const OptionalLength& right)
+        {
+            return !(left == right);
+        }
+
         struct OptionalSize final
         {
             OptionalSize()
@@ -49,7 +169,7 @@ namespace cru
 
             }
 
-            OptionalSize(const std::optional<float> width, const std::optional<float> height)
+            OptionalSize(const OptionalLength width, const OptionalLength height)
                 : width(width), height(height)
             {
 
@@ -63,17 +183,27 @@ namespace cru
 
             bool Validate() const
             {
-                if (width.has_value() && width.value() < 0.0)
+                if (width.has_value() && width.value() < 0.0f)
                     return false;
-                if (height.has_value() && height.value() < 0.0)
+                if (height.has_value() && height.value() < 0.0f)
                     return false;
                 return true;
             }
 
-            std::optional<float> width;
-            std::optional<float> height;
+            OptionalLength width;
+            OptionalLength height;
         };
 
+        inline bool operator == (const OptionalSize& left, const OptionalSize& right)
+        {
+            return left.width == right.width && left.height == right.height;
+        }
+
+        inline bool operator != (const OptionalSize& left, const OptionalSize& right)
+        {
+            return !(left == right);
+        }
+
         struct BasicLayoutParams
         {
             BasicLayoutParams() = default;
@@ -92,5 +222,16 @@ namespace cru
             OptionalSize min_size;
             OptionalSize max_size;
         };
+
+        // Compare the basic part only.
+        inline bool operator == (const BasicLayoutParams& left, const BasicLayoutParams& right)
+        {
+            return left.size == right.size && left.min_size == right.min_size && left.max_size == right.max_size;
+        }
+
+        inline bool operator != (const BasicLayoutParams& left, const BasicLayoutParams& right)
+        {
+            return !(left == right);
+        }
     }
 }
\ No newline at end of file
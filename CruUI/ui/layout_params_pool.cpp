@@ -0,0 +1,87 @@
+#include "layout_params_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace cru
+{
+    namespace ui
+    {
+        LayoutParamsPool* LayoutParamsPool::GetInstance()
+        {
+            static LayoutParamsPool instance;
+            return &instance;
+        }
+
+        std::shared_ptr<const BasicLayoutParams> LayoutParamsPool::Intern(const BasicLayoutParams& params)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto find_result = map_.find(params);
+            if (find_result != map_.cend())
+            {
+                if (auto shared = find_result->second.lock())
+                    return shared;
+            }
+
+            auto shared = std::make_shared<const BasicLayoutParams>(params);
+            map_[params] = shared;
+
+            if (map_.size() >= purge_threshold_)
+            {
+                PurgeExpired();
+                purge_threshold_ = std::max<std::size_t>(64, map_.size() * 2);
+            }
+
+            return shared;
+        }
+
+        int LayoutParamsPool::GetEntryCount() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return static_cast<int>(map_.size());
+        }
+
+        void LayoutParamsPool::PurgeExpired()
+        {
+            for (auto i = map_.cbegin(); i != map_.cend();)
+            {
+                if (i->second.expired())
+                    i = map_.erase(i);
+                else
+                    ++i;
+            }
+        }
+
+        inline void HashCombineHelperFunc(std::size_t& seed, const std::size_t value)
+        {
+            seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+
+        inline std::size_t HashFloatHelperFunc(const float value)
+        {
+            // all NaN mean "no value", and 0.0 equals -0.0, so normalize them first.
+            if (value != value)
+                return 1;
+            if (value == 0.0f)
+                return 0;
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof bits);
+            return bits;
+        }
+
+        std::size_t LayoutParamsPool::Hash::operator()(const BasicLayoutParams& params) const
+        {
+            std::size_t seed = static_cast<std::size_t>(params.size.width.mode) |
+                static_cast<std::size_t>(params.size.height.mode) << 8;
+            HashCombineHelperFunc(seed, HashFloatHelperFunc(params.size.width.length));
+            HashCombineHelperFunc(seed, HashFloatHelperFunc(params.size.height.length));
+            HashCombineHelperFunc(seed, HashFloatHelperFunc(params.min_size.width.value_or(std::numeric_limits<float>::quiet_NaN())));
+            HashCombineHelperFunc(seed, HashFloatHelperFunc(params.min_size.height.value_or(std::numeric_limits<float>::quiet_NaN())));
+            HashCombineHelperFunc(seed, HashFloatHelperFunc(params.max_size.width.value_or(std::numeric_limits<float>::quiet_NaN())));
+            HashCombineHelperFunc(seed, HashFloatHelperFunc(params.max_size.height.value_or(std::numeric_limits<float>::quiet_NaN())));
+            return seed;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "base.h"
+#include "layout_base.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        //Interns "BasicLayoutParams" by value, so that controls with identical
+        //params share one immutable instance instead of owning a copy each.
+        //Entries are held weakly and dropped when no control uses them.
+        //It is thread-safe, so detached controls can get their params on
+        //other threads, for example while a loader builds trees on the
+        //thread pool.
+        class LayoutParamsPool : public Object
+        {
+        public:
+            static LayoutParamsPool* GetInstance();
+
+        public:
+            LayoutParamsPool() = default;
+            LayoutParamsPool(const LayoutParamsPool& other) = delete;
+            LayoutParamsPool(LayoutParamsPool&& other) = delete;
+            LayoutParamsPool& operator=(const LayoutParamsPool& other) = delete;
+            LayoutParamsPool& operator=(LayoutParamsPool&& other) = delete;
+            ~LayoutParamsPool() override = default;
+
+            //Return the shared instance equal to "params", creating it if needed.
+            //Only the basic part is compared, so subclasses must not be interned.
+            std::shared_ptr<const BasicLayoutParams> Intern(const BasicLayoutParams& params);
+
+            //Get the count of entries including expired ones not purged yet.
+            int GetEntryCount() const;
+
+        private:
+            struct Hash
+            {
+                std::size_t operator()(const BasicLayoutParams& params) const;
+            };
+
+            void PurgeExpired();
+
+        private:
+            mutable std::mutex mutex_;
+            std::unordered_map<BasicLayoutParams, std::weak_ptr<const BasicLayoutParams>, Hash> map_;
+            //Expired entries are purged when the map grows past this.
+            std::size_t purge_threshold_ = 64;
+        };
+    }
+}
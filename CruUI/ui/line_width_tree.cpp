@@ -0,0 +1,181 @@
+#include "line_width_tree.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace cru
+{
+    namespace ui
+    {
+        float LineWidthTree::GetWidth(const int line) const
+        {
+            if (line < 0 || line >= GetCount())
+                throw std::invalid_argument("Line is out of the lines.");
+
+            auto index = line;
+            auto node = root_;
+            while (true)
+            {
+                const auto& n = nodes_[node];
+                const auto left_count = n.left == -1 ? 0 : nodes_[n.left].count;
+                if (index == left_count)
+                    return n.width;
+                if (index < left_count)
+                    node = n.left;
+                else
+                {
+                    index -= left_count + 1;
+                    node = n.right;
+                }
+            }
+        }
+
+        void LineWidthTree::Assign(const std::vector<float>& widths)
+        {
+            Clear();
+            root_ = Build(widths);
+        }
+
+        void LineWidthTree::Replace(const int first, const int count, const std::vector<float>& widths)
+        {
+            if (first < 0 || count < 0 || first + count > GetCount())
+                throw std::invalid_argument("Range is out of the lines.");
+
+            int left, rest, removed, right;
+            Split(root_, first, left, rest);
+            Split(rest, count, removed, right);
+            FreeTree(removed);
+            root_ = Merge(Merge(left, Build(widths)), right);
+        }
+
+        void LineWidthTree::Clear()
+        {
+            nodes_.clear();
+            free_nodes_.clear();
+            root_ = -1;
+        }
+
+        int LineWidthTree::NewNode(const float width)
+        {
+            Node node;
+            node.left = -1;
+            node.right = -1;
+            node.width = width;
+            node.priority = NextPriority();
+            node.count = 1;
+            node.max_width = width;
+            if (free_nodes_.empty())
+            {
+                nodes_.push_back(node);
+                return static_cast<int>(nodes_.size()) - 1;
+            }
+            const auto index = free_nodes_.back();
+            free_nodes_.pop_back();
+            nodes_[index] = node;
+            return index;
+        }
+
+        void LineWidthTree::Update(const int node)
+        {
+            auto& n = nodes_[node];
+            n.count = 1;
+            n.max_width = n.width;
+            for (const auto child : { n.left, n.right })
+                if (child != -1)
+                {
+                    n.count += nodes_[child].count;
+                    n.max_width = std::max(n.max_width, nodes_[child].max_width);
+                }
+        }
+
+        int LineWidthTree::Merge(const int left, const int right)
+        {
+            if (left == -1)
+                return right;
+            if (right == -1)
+                return left;
+            if (nodes_[left].priority > nodes_[right].priority)
+            {
+                const auto merged = Merge(nodes_[left].right, right);
+                nodes_[left].right = merged;
+                Update(left);
+                return left;
+            }
+            const auto merged = Merge(left, nodes_[right].left);
+            nodes_[right].left = merged;
+            Update(right);
+            return right;
+        }
+
+        void LineWidthTree::Split(const int node, const int count, int& left, int& right)
+        {
+            if (node == -1)
+            {
+                left = -1;
+                right = -1;
+                return;
+            }
+
+            const auto left_count = nodes_[node].left == -1 ? 0 : nodes_[nodes_[node].left].count;
+            if (count <= left_count)
+            {
+                int split_right;
+                Split(nodes_[node].left, count, left, split_right);
+                nodes_[node].left = split_right;
+                Update(node);
+                right = node;
+            }
+            else
+            {
+                int split_left;
+                Split(nodes_[node].right, count - left_count - 1, split_left, right);
+                nodes_[node].right = split_left;
+                Update(node);
+                left = node;
+            }
+        }
+
+        int LineWidthTree::Build(const std::vector<float>& widths)
+        {
+            // the right spine on a stack takes each node in turn, which is
+            // linear as every node is pushed and popped once.
+            std::vector<int> spine;
+            for (const auto width : widths)
+            {
+                const auto node = NewNode(width);
+                auto last_popped = -1;
+                while (!spine.empty() && nodes_[spine.back()].priority < nodes_[node].priority)
+                {
+                    last_popped = spine.back();
+                    spine.pop_back();
+                    Update(last_popped);
+                }
+                nodes_[node].left = last_popped;
+                if (!spine.empty())
+                    nodes_[spine.back()].right = node;
+                spine.push_back(node);
+            }
+            for (auto i = spine.rbegin(); i != spine.rend(); ++i)
+                Update(*i);
+            return spine.empty() ? -1 : spine.front();
+        }
+
+        void LineWidthTree::FreeTree(const int node)
+        {
+            if (node == -1)
+                return;
+            FreeTree(nodes_[node].left);
+            FreeTree(nodes_[node].right);
+            free_nodes_.push_back(node);
+        }
+
+        std::uint32_t LineWidthTree::NextPriority()
+        {
+            // xorshift32
+            random_state_ ^= random_state_ << 13;
+            random_state_ ^= random_state_ >> 17;
+            random_state_ ^= random_state_ << 5;
+            return random_state_;
+        }
+    }
+}
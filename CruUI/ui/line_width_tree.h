@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "base.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        //The widths of a sequence of lines, held in a tree balanced by random
+        //priorities with the count and the widest line of each subtree. So
+        //replacing lines costs O(log n) more than the new lines, and the
+        //widest line is read from the root, however many lines an edit
+        //removes.
+        //It is not thread-safe.
+        class LineWidthTree : public Object
+        {
+        public:
+            LineWidthTree() = default;
+            LineWidthTree(const LineWidthTree& other) = delete;
+            LineWidthTree(LineWidthTree&& other) = delete;
+            LineWidthTree& operator=(const LineWidthTree& other) = delete;
+            LineWidthTree& operator=(LineWidthTree&& other) = delete;
+            ~LineWidthTree() override = default;
+
+            int GetCount() const
+            {
+                return root_ == -1 ? 0 : nodes_[root_].count;
+            }
+
+            bool IsEmpty() const
+            {
+                return root_ == -1;
+            }
+
+            //Get the widest line, 0 if there is none.
+            float GetMaxWidth() const
+            {
+                return root_ == -1 ? 0.0f : nodes_[root_].max_width;
+            }
+
+            float GetWidth(int line) const;
+
+            //Replace all lines in O(n).
+            void Assign(const std::vector<float>& widths);
+
+            //Replace the lines in [first, first + count) with "widths".
+            //Throw std::invalid_argument if the range is out of the lines.
+            void Replace(int first, int count, const std::vector<float>& widths);
+
+            void Clear();
+
+        private:
+            struct Node
+            {
+                int left;
+                int right;
+                float width;
+                std::uint32_t priority;
+                //Totals of the subtree.
+                int count;
+                float max_width;
+            };
+
+            int NewNode(float width);
+            void Update(int node);
+            int Merge(int left, int right);
+            //Split the first "count" lines from the rest.
+            void Split(int node, int count, int& left, int& right);
+            //Build a tree of the widths, returning its root.
+            int Build(const std::vector<float>& widths);
+            void FreeTree(int node);
+            std::uint32_t NextPriority();
+
+        private:
+            std::vector<Node> nodes_;
+            std::vector<int> free_nodes_;
+            int root_ = -1;
+            std::uint32_t random_state_ = 0x9E3779B9u;
+        };
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cmath>
+#include <optional>
+
+#include "ui_base.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        //A 2D affine matrix in row-vector convention, laid out the same as
+        //"D2D1_MATRIX_3X2_F". A point (x, y) maps to
+        //(x * m11 + y * m21 + dx, x * m12 + y * m22 + dy).
+        struct Matrix
+        {
+            static Matrix Identity()
+            {
+                return Matrix();
+            }
+
+            static Matrix Translation(const float x, const float y)
+            {
+                return Matrix(1.0f, 0.0f, 0.0f, 1.0f, x, y);
+            }
+
+            static Matrix Translation(const Point& offset)
+            {
+                return Translation(offset.x, offset.y);
+            }
+
+            //Scale around "center".
+            static Matrix Scale(const float scale_x, const float scale_y, const Point& center = Point::zero)
+            {
+                return Matrix(scale_x, 0.0f, 0.0f, scale_y,
+                    center.x - scale_x * center.x, center.y - scale_y * center.y);
+            }
+
+            //Rotate clockwise by "degrees" around "center", as y goes down.
+            static Matrix Rotation(const float degrees, const Point& center = Point::zero)
+            {
+                const auto radians = degrees * 3.14159265358979323846f / 180.0f;
+                const auto cos = std::cos(radians);
+                const auto sin = std::sin(radians);
+                return Matrix(cos, sin, -sin, cos,
+                    center.x - center.x * cos + center.y * sin,
+                    center.y - center.x * sin - center.y * cos);
+            }
+
+            Matrix() : Matrix(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f) { }
+            Matrix(const float m11, const float m12, const float m21, const float m22, const float dx, const float dy)
+                : m11(m11), m12(m12), m21(m21), m22(m22), dx(dx), dy(dy) { }
+
+            bool IsIdentity() const
+            {
+                return IsTranslation() && dx == 0.0f && dy == 0.0f;
+            }
+
+            //Return true if the matrix only moves points.
+            bool IsTranslation() const
+            {
+                return m11 == 1.0f && m12 == 0.0f && m21 == 0.0f && m22 == 1.0f;
+            }
+
+            float GetDeterminant() const
+            {
+                return m11 * m22 - m12 * m21;
+            }
+
+            //Return nothing if the matrix collapses the plane, such as a zero scale.
+            std::optional<Matrix> GetInverse() const
+            {
+                if (IsTranslation())
+                    return Translation(-dx, -dy);
+
+                const auto determinant = GetDeterminant();
+                if (determinant == 0.0f || !std::isfinite(determinant))
+                    return std::nullopt;
+                return Matrix(
+                    m22 / determinant, -m12 / determinant,
+                    -m21 / determinant, m11 / determinant,
+                    (m21 * dy - m22 * dx) / determinant,
+                    (m12 * dx - m11 * dy) / determinant
+                );
+            }
+
+            Point TransformPoint(const Point& point) const
+            {
+                return Point(point.x * m11 + point.y * m21 + dx, point.x * m12 + point.y * m22 + dy);
+            }
+
+            //Get the axis-aligned bounds of the transformed rect.
+            Rect TransformBounds(const Rect& rect) const
+            {
+                if (IsTranslation())
+                    return Rect(rect.left + dx, rect.top + dy, rect.width, rect.height);
+
+                const Point corners[] = {
+                    TransformPoint(rect.GetLeftTop()),
+                    TransformPoint(Point(rect.GetRight(), rect.top)),
+                    TransformPoint(Point(rect.left, rect.GetBottom())),
+                    TransformPoint(rect.GetRightBottom())
+                };
+                auto left = corners[0].x, top = corners[0].y, right = corners[0].x, bottom = corners[0].y;
+                for (const auto& corner : corners)
+                {
+                    left = std::fmin(left, corner.x);
+                    top = std::fmin(top, corner.y);
+                    right = std::fmax(right, corner.x);
+                    bottom = std::fmax(bottom, corner.y);
+                }
+                return Rect::FromVertices(left, top, right, bottom);
+            }
+
+            float m11;
+            float m12;
+            float m21;
+            float m22;
+            float dx;
+            float dy;
+        };
+
+        //Combine two matrices: "left" is applied first, then "right".
+        inline Matrix operator * (const Matrix& left, const Matrix& right)
+        {
+            return Matrix(
+                left.m11 * right.m11 + left.m12 * right.m21,
+                left.m11 * right.m12 + left.m12 * right.m22,
+                left.m21 * right.m11 + left.m22 * right.m21,
+                left.m21 * right.m12 + left.m22 * right.m22,
+                left.dx * right.m11 + left.dy * right.m21 + right.dx,
+                left.dx * right.m12 + left.dy * right.m22 + right.dy
+            );
+        }
+
+        inline bool operator == (const Matrix& left, const Matrix& right)
+        {
+            return left.m11 == right.m11 && left.m12 == right.m12 &&
+                left.m21 == right.m21 && left.m22 == right.m22 &&
+                left.dx == right.dx && left.dy == right.dy;
+        }
+
+        inline bool operator != (const Matrix& left, const Matrix& right)
+        {
+            return !(left == right);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#include "offscreen_renderer.h"
+
+#include <cmath>
+#include <memory>
+
+#include "window.h"
+#include "thread_pool.h"
+#include "graph/display_list.h"
+#include "graph/software_painter.h"
+#include "graph/tiled_painter.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        //What a control draws, recorded and placed on the pixels of a bitmap.
+        struct RecordedControl
+        {
+            std::unique_ptr<graph::DisplayList> display_list;
+            Matrix transform;
+            int width;
+            int height;
+        };
+
+        inline RecordedControl RecordControlHelperFunc(Control* control, const RenderOptions& options)
+        {
+            if (control == nullptr)
+                throw std::invalid_argument("Control to render can't be null.");
+            if (!(options.dpi > 0.0f))
+                throw std::invalid_argument("Dpi to render at must be positive.");
+
+            if (const auto window = control->GetWindow())
+            {
+                window->GetLayoutManager()->RefreshInvalidControlLayout();
+                window->GetLayoutManager()->RefreshInvalidControlPositionCache();
+            }
+            else
+            {
+                // nothing places a root without a window, so it is placed at the origin.
+                if (control->GetParent() == nullptr)
+                {
+                    control->Measure(options.available_size);
+                    control->Layout(Rect(Point::zero, control->GetDesiredSize()));
+                }
+                WindowLayoutManager::RefreshControlPositionCache(control);
+            }
+
+            const auto scale = options.dpi / 96.0f;
+            const auto bounds = control->GetSubtreeBounds();
+            const auto left = std::floor(bounds.left * scale);
+            const auto top = std::floor(bounds.top * scale);
+            const auto right = std::ceil(bounds.GetRight() * scale);
+            const auto bottom = std::ceil(bounds.GetBottom() * scale);
+
+            RecordedControl recorded_control;
+            recorded_control.display_list = std::make_unique<graph::DisplayList>();
+            recorded_control.transform = Matrix::Scale(scale, scale) * Matrix::Translation(-left, -top);
+            recorded_control.width = bounds.IsEmpty() ? 0 : static_cast<int>(right - left);
+            recorded_control.height = bounds.IsEmpty() ? 0 : static_cast<int>(bottom - top);
+            if (recorded_control.width != 0 && recorded_control.height != 0)
+                control->DrawSubtree(*recorded_control.display_list);
+            return recorded_control;
+        }
+
+        inline void FillBitmapHelperFunc(const RecordedControl& recorded_control, graph::Painter& painter, const graph::Color& background)
+        {
+            painter.Clear(background);
+            // transforms in the list are relative to the one it is replayed at.
+            painter.SetTransform(recorded_control.transform);
+            recorded_control.display_list->Replay(painter);
+        }
+
+        graph::Bitmap RenderToBitmap(Control* control, const RenderOptions& options)
+        {
+            const auto recorded_control = RecordControlHelperFunc(control, options);
+            graph::Bitmap bitmap(recorded_control.width, recorded_control.height);
+            graph::TiledPainter painter(&bitmap, options.thread_pool);
+            FillBitmapHelperFunc(recorded_control, painter, options.background);
+            painter.Flush();
+            return bitmap;
+        }
+
+        std::vector<graph::Bitmap> RenderToBitmaps(const std::vector<Control*>& controls, const RenderOptions& options)
+        {
+            // controls are not thread-safe, so only filling is parallel.
+            std::vector<RecordedControl> recorded_controls;
+            recorded_controls.reserve(controls.size());
+            for (const auto control : controls)
+                recorded_controls.push_back(RecordControlHelperFunc(control, options));
+
+            std::vector<graph::Bitmap> bitmaps(recorded_controls.size());
+            const auto fill = [&recorded_controls, &bitmaps, &options](const int index) {
+                const auto& recorded_control = recorded_controls[index];
+                bitmaps[index] = graph::Bitmap(recorded_control.width, recorded_control.height);
+                // bitmaps are small and many, so each is filled on one thread.
+                graph::SoftwarePainter painter(&bitmaps[index]);
+                FillBitmapHelperFunc(recorded_control, painter, options.background);
+            };
+            if (options.thread_pool != nullptr)
+                options.thread_pool->ParallelFor(static_cast<int>(recorded_controls.size()), fill);
+            else
+                for (auto i = 0; i < static_cast<int>(recorded_controls.size()); i++)
+                    fill(i);
+            return bitmaps;
+        }
+    }
+}
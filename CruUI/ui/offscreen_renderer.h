@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "ui_base.h"
+#include "graph/bitmap.h"
+
+namespace cru
+{
+    class ThreadPool;
+
+    namespace ui
+    {
+        class Control;
+
+        //Options of rendering controls into bitmaps.
+        struct RenderOptions
+        {
+            //Dots per inch of the bitmap. At 96 one unit is one pixel.
+            float dpi = 96.0f;
+            //Color of the pixels no control draws. A window clears to white.
+            graph::Color background = graph::Color(0.0f, 0.0f, 0.0f, 0.0f);
+            //A root control without a window is measured with this size and
+            //laid out at its desired size.
+            Size available_size = Size(800.0f, 600.0f);
+            //Bitmaps are filled in parallel on it if it is not null.
+            ThreadPool* thread_pool = nullptr;
+        };
+
+        //Draw "control" and its descendants into a bitmap on the cpu, with
+        //neither a device nor a swap chain, so a window never shown or a
+        //control without a window can be rendered headless, for example for
+        //thumbnails and pixel tests. The invalid layout is refreshed first.
+        //The bitmap covers the subtree bounds, rounded out to whole pixels.
+        graph::Bitmap RenderToBitmap(Control* control, const RenderOptions& options = RenderOptions());
+
+        //Render each of "controls" as "RenderToBitmap" does. Drawing is
+        //recorded on the calling thread, and the bitmaps are filled on the
+        //thread pool of "options" if any.
+        std::vector<graph::Bitmap> RenderToBitmaps(const std::vector<Control*>& controls, const RenderOptions& options = RenderOptions());
+    }
+}
@@ -0,0 +1,266 @@
+#include "region.h"
+
+#include <algorithm>
+
+namespace cru
+{
+    namespace ui
+    {
+        Region::Region(const Rect& rect)
+        {
+            if (rect.IsEmpty())
+                return;
+            bands_.push_back(Band{ rect.top, rect.GetBottom(), 0, 1 });
+            spans_.push_back(Span{ rect.left, rect.GetRight() });
+        }
+
+        void Region::Clear()
+        {
+            bands_.clear();
+            spans_.clear();
+        }
+
+        Rect Region::GetBounds() const
+        {
+            if (IsEmpty())
+                return Rect();
+
+            auto left = spans_.front().left;
+            auto right = spans_.front().right;
+            for (const auto& band : bands_)
+            {
+                // spans are sorted, so only the ends of a band matter.
+                left = std::min(left, spans_[band.span_begin].left);
+                right = std::max(right, spans_[band.span_end - 1].right);
+            }
+            return Rect::FromVertices(left, bands_.front().top, right, bands_.back().bottom);
+        }
+
+        std::vector<Rect> Region::GetRects() const
+        {
+            std::vector<Rect> rects;
+            rects.reserve(spans_.size());
+            for (const auto& band : bands_)
+                for (auto i = band.span_begin; i < band.span_end; i++)
+                    rects.push_back(Rect::FromVertices(spans_[i].left, band.top, spans_[i].right, band.bottom));
+            return rects;
+        }
+
+        float Region::GetArea() const
+        {
+            auto area = 0.0f;
+            for (const auto& band : bands_)
+            {
+                auto width = 0.0f;
+                for (auto i = band.span_begin; i < band.span_end; i++)
+                    width += spans_[i].right - spans_[i].left;
+                area += width * (band.bottom - band.top);
+            }
+            return area;
+        }
+
+        bool Region::IsPointInside(const Point& point) const
+        {
+            const auto index = FindBand(point.y);
+            if (index == -1)
+                return false;
+            const auto& band = bands_[index];
+            const auto begin = spans_.cbegin() + band.span_begin;
+            const auto end = spans_.cbegin() + band.span_end;
+            const auto span = std::upper_bound(begin, end, point.x, [](const float x, const Span& s) {
+                return x < s.right;
+            });
+            return span != end && span->left <= point.x;
+        }
+
+        bool Region::Contains(const Rect& rect) const
+        {
+            return Region(rect).Subtract(*this).IsEmpty();
+        }
+
+        bool Region::Intersects(const Rect& rect) const
+        {
+            if (rect.IsEmpty() || IsEmpty())
+                return false;
+            return !Intersect(Region(rect)).IsEmpty();
+        }
+
+        Region Region::Union(const Region& other) const
+        {
+            if (IsEmpty())
+                return other;
+            if (other.IsEmpty())
+                return *this;
+            return Combine(*this, other, Operation::Union);
+        }
+
+        Region Region::Intersect(const Region& other) const
+        {
+            if (IsEmpty() || other.IsEmpty())
+                return Region();
+            return Combine(*this, other, Operation::Intersect);
+        }
+
+        Region Region::Subtract(const Region& other) const
+        {
+            if (IsEmpty() || other.IsEmpty())
+                return *this;
+            return Combine(*this, other, Operation::Subtract);
+        }
+
+        bool operator == (const Region& left, const Region& right)
+        {
+            if (left.bands_.size() != right.bands_.size() || left.spans_.size() != right.spans_.size())
+                return false;
+            for (decltype(left.bands_.size()) i = 0; i < left.bands_.size(); i++)
+            {
+                const auto& l = left.bands_[i];
+                const auto& r = right.bands_[i];
+                if (l.top != r.top || l.bottom != r.bottom || l.span_begin != r.span_begin || l.span_end != r.span_end)
+                    return false;
+            }
+            for (decltype(left.spans_.size()) i = 0; i < left.spans_.size(); i++)
+                if (left.spans_[i].left != right.spans_[i].left || left.spans_[i].right != right.spans_[i].right)
+                    return false;
+            return true;
+        }
+
+        Region Region::Combine(const Region& left, const Region& right, const Operation operation)
+        {
+            // every band edge of either region starts a new piece.
+            std::vector<float> edges;
+            edges.reserve((left.bands_.size() + right.bands_.size()) * 2);
+            for (const auto& band : left.bands_)
+            {
+                edges.push_back(band.top);
+                edges.push_back(band.bottom);
+            }
+            for (const auto& band : right.bands_)
+            {
+                edges.push_back(band.top);
+                edges.push_back(band.bottom);
+            }
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+            Region result;
+            std::vector<Span> spans;
+            decltype(left.bands_.size()) left_index = 0, right_index = 0;
+            for (decltype(edges.size()) i = 0; i + 1 < edges.size(); i++)
+            {
+                const auto top = edges[i];
+                const auto bottom = edges[i + 1];
+                while (left_index < left.bands_.size() && left.bands_[left_index].bottom <= top)
+                    left_index++;
+                while (right_index < right.bands_.size() && right.bands_[right_index].bottom <= top)
+                    right_index++;
+
+                const Span* left_spans = nullptr;
+                auto left_count = 0;
+                if (left_index < left.bands_.size() && left.bands_[left_index].top <= top)
+                {
+                    const auto& band = left.bands_[left_index];
+                    left_spans = left.spans_.data() + band.span_begin;
+                    left_count = band.span_end - band.span_begin;
+                }
+
+                const Span* right_spans = nullptr;
+                auto right_count = 0;
+                if (right_index < right.bands_.size() && right.bands_[right_index].top <= top)
+                {
+                    const auto& band = right.bands_[right_index];
+                    right_spans = right.spans_.data() + band.span_begin;
+                    right_count = band.span_end - band.span_begin;
+                }
+
+                CombineSpans(left_spans, left_count, right_spans, right_count, operation, spans);
+                if (!spans.empty())
+                    result.AppendBand(top, bottom, spans);
+            }
+            return result;
+        }
+
+        void Region::CombineSpans(const Span* left, const int left_count, const Span* right, const int right_count,
+            const Operation operation, std::vector<Span>& result)
+        {
+            result.clear();
+            auto i = 0, j = 0;
+            switch (operation)
+            {
+            case Operation::Union:
+                // merge by left edge, joining spans that overlap or touch.
+                while (i < left_count || j < right_count)
+                {
+                    const auto& span = j >= right_count || (i < left_count && left[i].left <= right[j].left) ? left[i++] : right[j++];
+                    if (!result.empty() && span.left <= result.back().right)
+                        result.back().right = std::max(result.back().right, span.right);
+                    else
+                        result.push_back(span);
+                }
+                break;
+            case Operation::Intersect:
+                while (i < left_count && j < right_count)
+                {
+                    const auto l = std::max(left[i].left, right[j].left);
+                    const auto r = std::min(left[i].right, right[j].right);
+                    if (l < r)
+                        result.push_back(Span{ l, r });
+                    if (left[i].right < right[j].right)
+                        i++;
+                    else
+                        j++;
+                }
+                break;
+            case Operation::Subtract:
+                for (; i < left_count; i++)
+                {
+                    auto l = left[i].left;
+                    const auto r = left[i].right;
+                    // spans of "right" ending before this span can't cut later ones either.
+                    while (j < right_count && right[j].right <= l)
+                        j++;
+                    for (auto k = j; k < right_count && right[k].left < r; k++)
+                    {
+                        if (right[k].left > l)
+                            result.push_back(Span{ l, right[k].left });
+                        l = std::max(l, right[k].right);
+                    }
+                    if (l < r)
+                        result.push_back(Span{ l, r });
+                }
+                break;
+            }
+        }
+
+        void Region::AppendBand(const float top, const float bottom, const std::vector<Span>& spans)
+        {
+            if (!bands_.empty())
+            {
+                auto& last = bands_.back();
+                const auto count = static_cast<int>(spans.size());
+                if (last.bottom == top && last.span_end - last.span_begin == count &&
+                    std::equal(spans.cbegin(), spans.cend(), spans_.cbegin() + last.span_begin, [](const Span& l, const Span& r) {
+                        return l.left == r.left && l.right == r.right;
+                    }))
+                {
+                    last.bottom = bottom;
+                    return;
+                }
+            }
+
+            const auto begin = static_cast<int>(spans_.size());
+            spans_.insert(spans_.cend(), spans.cbegin(), spans.cend());
+            bands_.push_back(Band{ top, bottom, begin, static_cast<int>(spans_.size()) });
+        }
+
+        int Region::FindBand(const float y) const
+        {
+            const auto band = std::upper_bound(bands_.cbegin(), bands_.cend(), y, [](const float value, const Band& b) {
+                return value < b.bottom;
+            });
+            if (band == bands_.cend() || band->top > y)
+                return -1;
+            return static_cast<int>(band - bands_.cbegin());
+        }
+    }
+}
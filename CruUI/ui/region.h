@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+
+#include "ui_base.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        //A set of points made of rects, stored as horizontal bands sorted top
+        //to bottom, each with sorted disjoint spans. Adjacent bands with the
+        //same spans are merged, so a region has one canonical form and two
+        //regions covering the same points compare equal.
+        //
+        //Set operations walk the bands of both regions once.
+        class Region
+        {
+        public:
+            Region() = default;
+            //An empty rect gives an empty region.
+            explicit Region(const Rect& rect);
+            Region(const Region& other) = default;
+            Region(Region&& other) = default;
+            Region& operator=(const Region& other) = default;
+            Region& operator=(Region&& other) = default;
+            ~Region() = default;
+
+            bool IsEmpty() const
+            {
+                return bands_.empty();
+            }
+
+            void Clear();
+
+            //Get the bounds. Return an empty rect at zero if the region is empty.
+            Rect GetBounds() const;
+
+            //Get the count of rects returned by "GetRects".
+            int GetRectCount() const
+            {
+                return static_cast<int>(spans_.size());
+            }
+
+            //Get disjoint rects covering the region, top to bottom and left to right.
+            std::vector<Rect> GetRects() const;
+
+            float GetArea() const;
+
+            bool IsPointInside(const Point& point) const;
+
+            //Return true if the region covers all of the rect.
+            bool Contains(const Rect& rect) const;
+
+            //Return true if the region and the rect share any point.
+            bool Intersects(const Rect& rect) const;
+
+            Region Union(const Region& other) const;
+            Region Union(const Rect& rect) const
+            {
+                return Union(Region(rect));
+            }
+
+            Region Intersect(const Region& other) const;
+            Region Intersect(const Rect& rect) const
+            {
+                return Intersect(Region(rect));
+            }
+
+            Region Subtract(const Region& other) const;
+            Region Subtract(const Rect& rect) const
+            {
+                return Subtract(Region(rect));
+            }
+
+            friend bool operator == (const Region& left, const Region& right);
+
+        private:
+            struct Span
+            {
+                float left;
+                float right;
+            };
+
+            struct Band
+            {
+                float top;
+                float bottom;
+                //Range of the spans in "spans_".
+                int span_begin;
+                int span_end;
+            };
+
+            enum class Operation
+            {
+                Union,
+                Intersect,
+                Subtract
+            };
+
+            static Region Combine(const Region& left, const Region& right, Operation operation);
+            static void CombineSpans(const Span* left, int left_count, const Span* right, int right_count,
+                Operation operation, std::vector<Span>& result);
+            //Append a band below the others, merging it into the last band if they touch and have the same spans.
+            void AppendBand(float top, float bottom, const std::vector<Span>& spans);
+            //Return the index of the band containing "y", or -1.
+            int FindBand(float y) const;
+
+        private:
+            std::vector<Band> bands_;
+            std::vector<Span> spans_;
+        };
+
+        bool operator == (const Region& left, const Region& right);
+
+        inline bool operator != (const Region& left, const Region& right)
+        {
+            return !(left == right);
+        }
+    }
+}
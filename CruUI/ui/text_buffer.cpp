@@ -0,0 +1,349 @@
+#include "text_buffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace cru
+{
+    namespace ui
+    {
+        void TextBuffer::Buffer::Append(const String& text)
+        {
+            const auto begin = static_cast<int>(this->text.size());
+            this->text.append(text);
+            for (auto i = 0; i < static_cast<int>(text.size()); i++)
+                if (text[i] == L'\n')
+                    line_feeds.push_back(begin + i);
+        }
+
+        int TextBuffer::Buffer::CountLineFeeds(const int begin, const int length) const
+        {
+            const auto first = std::lower_bound(line_feeds.cbegin(), line_feeds.cend(), begin);
+            const auto last = std::lower_bound(first, line_feeds.cend(), begin + length);
+            return static_cast<int>(last - first);
+        }
+
+        TextBuffer::TextBuffer(String text)
+        {
+            SetText(std::move(text));
+        }
+
+        int TextBuffer::GetLength() const
+        {
+            return root_ == nullptr ? 0 : root_->length;
+        }
+
+        int TextBuffer::GetLineCount() const
+        {
+            return (root_ == nullptr ? 0 : root_->line_feed_count) + 1;
+        }
+
+        String TextBuffer::GetText(const int begin, const int length) const
+        {
+            if (begin < 0 || length < 0 || begin + length > GetLength())
+                throw std::invalid_argument("Range is out of the text.");
+            String text;
+            text.reserve(length);
+            AppendText(root_, begin, begin + length, text);
+            return text;
+        }
+
+        int TextBuffer::GetLineStart(const int line) const
+        {
+            if (line < 0 || line >= GetLineCount())
+                throw std::invalid_argument("Line is out of the text.");
+            return line == 0 ? 0 : FindLineFeedEnd(line - 1);
+        }
+
+        int TextBuffer::GetLineLength(const int line) const
+        {
+            const auto start = GetLineStart(line);
+            const auto end = line + 1 == GetLineCount() ? GetLength() : FindLineFeedEnd(line) - 1;
+            return end - start;
+        }
+
+        String TextBuffer::GetLine(const int line) const
+        {
+            const auto start = GetLineStart(line);
+            const auto end = line + 1 == GetLineCount() ? GetLength() : FindLineFeedEnd(line) - 1;
+            return GetText(start, end - start);
+        }
+
+        TextPosition TextBuffer::GetPosition(const int offset) const
+        {
+            if (offset < 0 || offset > GetLength())
+                throw std::invalid_argument("Offset is out of the text.");
+
+            // count the line feeds before the offset.
+            auto line = 0;
+            auto node = root_.get();
+            auto node_offset = offset;
+            while (node != nullptr)
+            {
+                const auto left_length = node->left == nullptr ? 0 : node->left->length;
+                if (node_offset < left_length)
+                {
+                    node = node->left.get();
+                    continue;
+                }
+                if (node->left != nullptr)
+                    line += node->left->line_feed_count;
+                node_offset -= left_length;
+                const auto& piece = node->piece;
+                if (node_offset <= piece.length)
+                {
+                    line += GetBuffer(piece).CountLineFeeds(piece.begin, node_offset);
+                    break;
+                }
+                line += piece.line_feed_count;
+                node_offset -= piece.length;
+                node = node->right.get();
+            }
+
+            TextPosition position;
+            position.line = line;
+            position.column = offset - (line == 0 ? 0 : FindLineFeedEnd(line - 1));
+            return position;
+        }
+
+        int TextBuffer::GetOffset(const TextPosition& position) const
+        {
+            const auto start = GetLineStart(position.line);
+            if (position.column < 0)
+                throw std::invalid_argument("Column can't be negative.");
+            return start + std::min(position.column, GetLineLength(position.line));
+        }
+
+        int TextBuffer::GetPieceCount() const
+        {
+            return root_ == nullptr ? 0 : root_->piece_count;
+        }
+
+        void TextBuffer::Replace(const int begin, const int length, const String& text)
+        {
+            if (begin < 0 || length < 0 || begin + length > GetLength())
+                throw std::invalid_argument("Range is out of the text.");
+            if (length == 0 && text.empty())
+                return;
+
+            const auto old_root = root_;
+            NodePtr left, rest, removed, right;
+            Split(root_, begin, left, rest);
+            Split(rest, length, removed, right);
+            if (!text.empty())
+            {
+                const auto added_begin = static_cast<int>(added_.text.size());
+                added_.Append(text);
+                // typing appends to the piece it continues instead of adding one.
+                auto last = left.get();
+                while (last != nullptr && last->right != nullptr)
+                    last = last->right.get();
+                if (last != nullptr && last->piece.is_added && last->piece.begin + last->piece.length == added_begin)
+                    left = ReplaceLast(left, MakePiece(true, last->piece.begin, last->piece.length + static_cast<int>(text.size())));
+                else
+                    left = Merge(left, MakeNode(nullptr, MakePiece(true, added_begin, static_cast<int>(text.size())), NextPriority(), nullptr));
+            }
+            root_ = Merge(left, right);
+
+            TextChange change;
+            change.begin = begin;
+            change.removed_count = length;
+            change.inserted_count = static_cast<int>(text.size());
+            undo_steps_.push_back(Step{ old_root, change });
+            redo_steps_.clear();
+        }
+
+        void TextBuffer::SetText(String text)
+        {
+            original_ = Buffer();
+            original_.Append(text);
+            added_ = Buffer();
+            root_ = text.empty() ? nullptr : MakeNode(nullptr, MakePiece(false, 0, static_cast<int>(text.size())), NextPriority(), nullptr);
+            undo_steps_.clear();
+            redo_steps_.clear();
+        }
+
+        TextChange TextBuffer::Undo()
+        {
+            if (undo_steps_.empty())
+                throw std::logic_error("There is nothing to undo.");
+            auto step = std::move(undo_steps_.back());
+            undo_steps_.pop_back();
+            redo_steps_.push_back(Step{ root_, step.change });
+            root_ = std::move(step.root);
+
+            TextChange change;
+            change.begin = step.change.begin;
+            change.removed_count = step.change.inserted_count;
+            change.inserted_count = step.change.removed_count;
+            return change;
+        }
+
+        TextChange TextBuffer::Redo()
+        {
+            if (redo_steps_.empty())
+                throw std::logic_error("There is nothing to redo.");
+            auto step = std::move(redo_steps_.back());
+            redo_steps_.pop_back();
+            undo_steps_.push_back(Step{ root_, step.change });
+            root_ = std::move(step.root);
+            return step.change;
+        }
+
+        void TextBuffer::LimitUndoSteps(const int count)
+        {
+            if (count < 0)
+                throw std::invalid_argument("Count of undo steps can't be negative.");
+            if (static_cast<int>(undo_steps_.size()) > count)
+                undo_steps_.erase(undo_steps_.begin(), undo_steps_.end() - count);
+        }
+
+        TextBuffer::Piece TextBuffer::MakePiece(const bool is_added, const int begin, const int length) const
+        {
+            Piece piece;
+            piece.is_added = is_added;
+            piece.begin = begin;
+            piece.length = length;
+            piece.line_feed_count = (is_added ? added_ : original_).CountLineFeeds(begin, length);
+            return piece;
+        }
+
+        TextBuffer::NodePtr TextBuffer::MakeNode(NodePtr left, const Piece& piece, const std::uint32_t priority, NodePtr right)
+        {
+            auto node = std::make_shared<Node>();
+            node->piece = piece;
+            node->priority = priority;
+            node->length = piece.length;
+            node->line_feed_count = piece.line_feed_count;
+            node->piece_count = 1;
+            for (const auto& child : { &left, &right })
+                if (*child != nullptr)
+                {
+                    node->length += (*child)->length;
+                    node->line_feed_count += (*child)->line_feed_count;
+                    node->piece_count += (*child)->piece_count;
+                }
+            node->left = std::move(left);
+            node->right = std::move(right);
+            return node;
+        }
+
+        TextBuffer::NodePtr TextBuffer::Merge(const NodePtr& left, const NodePtr& right)
+        {
+            if (left == nullptr)
+                return right;
+            if (right == nullptr)
+                return left;
+            if (left->priority > right->priority)
+                return MakeNode(left->left, left->piece, left->priority, Merge(left->right, right));
+            return MakeNode(Merge(left, right->left), right->piece, right->priority, right->right);
+        }
+
+        void TextBuffer::Split(const NodePtr& node, const int offset, NodePtr& left, NodePtr& right) const
+        {
+            if (node == nullptr)
+            {
+                left = nullptr;
+                right = nullptr;
+                return;
+            }
+            if (offset <= 0)
+            {
+                left = nullptr;
+                right = node;
+                return;
+            }
+            if (offset >= node->length)
+            {
+                left = node;
+                right = nullptr;
+                return;
+            }
+
+            const auto left_length = node->left == nullptr ? 0 : node->left->length;
+            const auto& piece = node->piece;
+            if (offset <= left_length)
+            {
+                NodePtr split_right;
+                Split(node->left, offset, left, split_right);
+                right = MakeNode(std::move(split_right), piece, node->priority, node->right);
+            }
+            else if (offset >= left_length + piece.length)
+            {
+                NodePtr split_left;
+                Split(node->right, offset - left_length - piece.length, split_left, right);
+                left = MakeNode(node->left, piece, node->priority, std::move(split_left));
+            }
+            else
+            {
+                // both halves keep the priority, which is still above the subtrees.
+                const auto piece_offset = offset - left_length;
+                left = MakeNode(node->left, MakePiece(piece.is_added, piece.begin, piece_offset), node->priority, nullptr);
+                right = MakeNode(nullptr, MakePiece(piece.is_added, piece.begin + piece_offset, piece.length - piece_offset), node->priority, node->right);
+            }
+        }
+
+        TextBuffer::NodePtr TextBuffer::ReplaceLast(const NodePtr& node, const Piece& piece)
+        {
+            if (node->right == nullptr)
+                return MakeNode(node->left, piece, node->priority, nullptr);
+            return MakeNode(node->left, node->piece, node->priority, ReplaceLast(node->right, piece));
+        }
+
+        int TextBuffer::FindLineFeedEnd(int index) const
+        {
+            auto offset = 0;
+            auto node = root_.get();
+            while (node != nullptr)
+            {
+                const auto left_count = node->left == nullptr ? 0 : node->left->line_feed_count;
+                if (index < left_count)
+                {
+                    node = node->left.get();
+                    continue;
+                }
+                index -= left_count;
+                if (node->left != nullptr)
+                    offset += node->left->length;
+                const auto& piece = node->piece;
+                if (index < piece.line_feed_count)
+                {
+                    const auto& line_feeds = GetBuffer(piece).line_feeds;
+                    const auto first = std::lower_bound(line_feeds.cbegin(), line_feeds.cend(), piece.begin);
+                    return offset + first[index] - piece.begin + 1;
+                }
+                index -= piece.line_feed_count;
+                offset += piece.length;
+                node = node->right.get();
+            }
+            throw std::invalid_argument("Line feed is out of the text.");
+        }
+
+        void TextBuffer::AppendText(const NodePtr& node, const int begin, const int end, String& text) const
+        {
+            // "begin" and "end" are relative to the subtree.
+            if (node == nullptr || begin >= end)
+                return;
+            const auto left_length = node->left == nullptr ? 0 : node->left->length;
+            if (begin < left_length)
+                AppendText(node->left, begin, std::min(end, left_length), text);
+            const auto& piece = node->piece;
+            const auto piece_begin = std::max(begin - left_length, 0);
+            const auto piece_end = std::min(end - left_length, piece.length);
+            if (piece_begin < piece_end)
+                text.append(GetBuffer(piece).text, piece.begin + piece_begin, piece_end - piece_begin);
+            const auto right_begin = left_length + piece.length;
+            if (end > right_begin)
+                AppendText(node->right, std::max(begin - right_begin, 0), end - right_begin, text);
+        }
+
+        std::uint32_t TextBuffer::NextPriority()
+        {
+            // xorshift32
+            random_state_ ^= random_state_ << 13;
+            random_state_ ^= random_state_ >> 17;
+            random_state_ ^= random_state_ << 5;
+            return random_state_;
+        }
+    }
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "base.h"
+
+namespace cru
+{
+    namespace ui
+    {
+        //A place in text by line and column, both from 0. Lines end at line
+        //feeds, which stay at the end of their lines.
+        struct TextPosition
+        {
+            int line = 0;
+            int column = 0;
+        };
+
+        //An edit replacing the code units in [begin, begin + removed_count)
+        //with "inserted_count" ones.
+        struct TextChange
+        {
+            int begin = 0;
+            int removed_count = 0;
+            int inserted_count = 0;
+        };
+
+        //Editable text for large documents, stored as a piece table: the
+        //original text and an append-only buffer of inserted text, with the
+        //text being a sequence of pieces of them. Pieces are kept in a tree
+        //balanced by random priorities, with the lengths and line feed counts
+        //of subtrees, so edits and lookups by offset or line take O(log n)
+        //of the piece count, and reading text costs its length more.
+        //
+        //Trees are immutable and edits copy only the paths they change, so
+        //every version is a root shared with the others, and undo and redo
+        //just switch roots.
+        //It is not thread-safe.
+        class TextBuffer : public Object
+        {
+        public:
+            explicit TextBuffer(String text = String());
+            TextBuffer(const TextBuffer& other) = delete;
+            TextBuffer(TextBuffer&& other) = delete;
+            TextBuffer& operator=(const TextBuffer& other) = delete;
+            TextBuffer& operator=(TextBuffer&& other) = delete;
+            ~TextBuffer() override = default;
+
+            int GetLength() const;
+
+            //Get the count of lines, the count of line feeds plus 1.
+            int GetLineCount() const;
+
+            String GetText() const
+            {
+                return GetText(0, GetLength());
+            }
+
+            String GetText(int begin, int length) const;
+
+            //Get the offset of the first code unit of a line.
+            int GetLineStart(int line) const;
+
+            //Get the length of a line without its line feed.
+            int GetLineLength(int line) const;
+
+            //Get the text of a line without its line feed.
+            String GetLine(int line) const;
+
+            TextPosition GetPosition(int offset) const;
+
+            //Get the offset of a position. A column past the end of its line
+            //is clamped to it.
+            int GetOffset(const TextPosition& position) const;
+
+            //Get the count of pieces, which only edits increase.
+            int GetPieceCount() const;
+
+            //Replace the text in [begin, begin + length) with "text" as one
+            //step of undo, and clear the redo steps.
+            void Replace(int begin, int length, const String& text);
+
+            void Insert(const int position, const String& text)
+            {
+                Replace(position, 0, text);
+            }
+
+            void Remove(const int begin, const int length)
+            {
+                Replace(begin, length, String());
+            }
+
+            //Replace all text with a new original text and clear the steps of
+            //undo and redo.
+            void SetText(String text);
+
+            bool CanUndo() const
+            {
+                return !undo_steps_.empty();
+            }
+
+            bool CanRedo() const
+            {
+                return !redo_steps_.empty();
+            }
+
+            //Revert the last edit and return what it changes in the text.
+            //Throw std::logic_error if there is nothing to undo.
+            TextChange Undo();
+
+            //Apply the last undone edit again and return what it changes in
+            //the text. Throw std::logic_error if there is nothing to redo.
+            TextChange Redo();
+
+            //Drop the steps of undo beyond the last "count", so the pieces
+            //only they reference are freed.
+            void LimitUndoSteps(int count);
+
+        private:
+            struct Piece
+            {
+                bool is_added;
+                int begin;
+                int length;
+                int line_feed_count;
+            };
+
+            struct Node;
+            using NodePtr = std::shared_ptr<const Node>;
+
+            struct Node
+            {
+                NodePtr left;
+                NodePtr right;
+                Piece piece;
+                std::uint32_t priority;
+                //Totals of the subtree.
+                int length;
+                int line_feed_count;
+                int piece_count;
+            };
+
+            //Text and the offsets of its line feeds.
+            struct Buffer
+            {
+                String text;
+                std::vector<int> line_feeds;
+
+                void Append(const String& text);
+                //Count the line feeds in [begin, begin + length).
+                int CountLineFeeds(int begin, int length) const;
+            };
+
+            struct Step
+            {
+                NodePtr root;
+                TextChange change;
+            };
+
+            const Buffer& GetBuffer(const Piece& piece) const
+            {
+                return piece.is_added ? added_ : original_;
+            }
+
+            Piece MakePiece(bool is_added, int begin, int length) const;
+            static NodePtr MakeNode(NodePtr left, const Piece& piece, std::uint32_t priority, NodePtr right);
+            static NodePtr Merge(const NodePtr& left, const NodePtr& right);
+            //Split the first "offset" code units from the rest.
+            void Split(const NodePtr& node, int offset, NodePtr& left, NodePtr& right) const;
+            //Return the tree with its last piece replaced.
+            static NodePtr ReplaceLast(const NodePtr& node, const Piece& piece);
+            //Get the offset after the line feed with the index.
+            int FindLineFeedEnd(int index) const;
+            void AppendText(const NodePtr& node, int begin, int end, String& text) const;
+            std::uint32_t NextPriority();
+
+        private:
+            Buffer original_;
+            Buffer added_;
+            NodePtr root_;
+            std::vector<Step> undo_steps_;
+            std::vector<Step> redo_steps_;
+            std::uint32_t random_state_ = 0x9E3779B9u;
+        };
+    }
+}
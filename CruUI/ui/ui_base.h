@@ -73,6 +73,37 @@ namespace cru
                     point.y < GetBottom();
             }
 
+            bool IsEmpty() const
+            {
+                return width <= 0.0f || height <= 0.0f;
+            }
+
+            bool Contains(const Rect& other) const
+            {
+                return other.left >= left && other.top >= top &&
+                    other.GetRight() <= GetRight() && other.GetBottom() <= GetBottom();
+            }
+
+            //The common part. Disjoint rects give an empty rect at the greater lefttop.
+            Rect Intersect(const Rect& other) const
+            {
+                const auto l = left > other.left ? left : other.left;
+                const auto t = top > other.top ? top : other.top;
+                const auto r = GetRight() < other.GetRight() ? GetRight() : other.GetRight();
+                const auto b = GetBottom() < other.GetBottom() ? GetBottom() : other.GetBottom();
+                return Rect(l, t, r - l > 0.0f ? r - l : 0.0f, b - t > 0.0f ? b - t : 0.0f);
+            }
+
+            //The bounds of both rects.
+            Rect Union(const Rect& other) const
+            {
+                const auto l = left < other.left ? left : other.left;
+                const auto t = top < other.top ? top : other.top;
+                const auto r = GetRight() > other.GetRight() ? GetRight() : other.GetRight();
+                const auto b = GetBottom() > other.GetBottom() ? GetBottom() : other.GetBottom();
+                return Rect(l, t, r - l, b - t);
+            }
+
             float left = 0.0f;
             float top = 0.0f;
             float width = 0.0f;
@@ -88,6 +119,15 @@ namespace cru
             Thickness(const float left, const float top, const float right, const float bottom)
                 : left(left), top(top), right(right), bottom(bottom) { }
 
+            float GetHorizontalTotal() const
+            {
+                return left + right;
+            }
+
+            float GetVerticalTotal() const
+            {
+                return top + bottom;
+            }
 
             float left;
             float top;
@@ -95,6 +135,139 @@ namespace cru
             float bottom;
         };
 
+        inline bool operator == (const Point& left, const Point& right)
+        {
+            return left.x == right.x && left.y == right.y;
+        }
+
+        inline bool operator != (const Point& left, const Point& right)
+        {
+            return !(left == right);
+        }
+
+        inline bool operator == (const Size& left, const Size& right)
+        {
+            return left.width == right.width && left.height == right.height;
+        }
+
+        inline bool operator != (const Size& left, const Size& right)
+        {
+            return !(left == right);
+        }
+
+        inline bool operator == (const Rect& left, const Rect& right)
+        {
+            return left.left == right.left && left.top == right.top &&
+                left.width == right.width && left.height == right.height;
+        }
+
+        inline bool operator != (const Rect& left, const Rect& right)
+        {
+            return !(left == right);
+        }
+
+        inline bool operator == (const Thickness& left, const Thickness& right)
+        {
+            return left.left == right.left && left.top == right.top &&
+                left.right == right.right && left.bottom == right.bottom;
+        }
+
+        inline bool operator != (const Thickness& left, const Thickness& right)
+        {
+            return !(left == right);
+        }
+
+        inline Point operator + (const Point& left, const Point& right)
+        {
+            return Point(left.x + right.x, left.y + right.y);
+        }
+
+        inline Point operator - (const Point& left, const Point& right)
+        {
+            return Point(left.x - right.x, left.y - right.y);
+        }
+
+        inline Point operator - (const Point& point)
+        {
+            return Point(-point.x, -point.y);
+        }
+
+        inline Point operator * (const Point& point, const float scale)
+        {
+            return Point(point.x * scale, point.y * scale);
+        }
+
+        inline Point& operator += (Point& left, const Point& right)
+        {
+            left.x += right.x;
+            left.y += right.y;
+            return left;
+        }
+
+        inline Point& operator -= (Point& left, const Point& right)
+        {
+            left.x -= right.x;
+            left.y -= right.y;
+            return left;
+        }
+
+        //The point moved by the size, such as lefttop + size = rightbottom.
+        inline Point operator + (const Point& point, const Size& size)
+        {
+            return Point(point.x + size.width, point.y + size.height);
+        }
+
+        inline Size operator + (const Size& left, const Size& right)
+        {
+            return Size(left.width + right.width, left.height + right.height);
+        }
+
+        inline Size operator - (const Size& left, const Size& right)
+        {
+            return Size(left.width - right.width, left.height - right.height);
+        }
+
+        inline Size operator * (const Size& size, const float scale)
+        {
+            return Size(size.width * scale, size.height * scale);
+        }
+
+        //The rect moved by the offset.
+        inline Rect operator + (const Rect& rect, const Point& offset)
+        {
+            return Rect(rect.left + offset.x, rect.top + offset.y, rect.width, rect.height);
+        }
+
+        inline Rect operator - (const Rect& rect, const Point& offset)
+        {
+            return Rect(rect.left - offset.x, rect.top - offset.y, rect.width, rect.height);
+        }
+
+        //The size with the thickness added on both sides.
+        inline Size operator + (const Size& size, const Thickness& thickness)
+        {
+            return Size(size.width + thickness.GetHorizontalTotal(), size.height + thickness.GetVerticalTotal());
+        }
+
+        inline Size operator - (const Size& size, const Thickness& thickness)
+        {
+            return Size(size.width - thickness.GetHorizontalTotal(), size.height - thickness.GetVerticalTotal());
+        }
+
+        //The rect grown outwards by the thickness.
+        inline Rect operator + (const Rect& rect, const Thickness& thickness)
+        {
+            return Rect(rect.left - thickness.left, rect.top - thickness.top,
+                rect.width + thickness.GetHorizontalTotal(), rect.height + thickness.GetVerticalTotal());
+        }
+
+        //The rect shrunk inwards by the thickness.
+        inline Rect operator - (const Rect& rect, const Thickness& thickness)
+        {
+            return Rect(rect.left + thickness.left, rect.top + thickness.top,
+                rect.width - thickness.GetHorizontalTotal(), rect.height - thickness.GetVerticalTotal());
+        }
+
         enum class MouseButton
         {
             Left,
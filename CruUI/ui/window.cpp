@@ -0,0 +1,965 @@
+#include "window.h"
+#ifndef CRU_HEADLESS
+#include "application.h"
+#include "graph/graph.h"
+#include "graph/d2d_painter.h"
+#include "graph/batching_painter.h"
+#include "exception.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "geometry_kernels.h"
+
+namespace cru
+{
+	namespace ui
+	{
+#ifndef CRU_HEADLESS
+		WindowClass::WindowClass(const std::wstring& name, WNDPROC window_proc, HINSTANCE hinstance)
+			: name_(name)
+		{
+			WNDCLASSEX window_class;
+			window_class.cbSize = sizeof(WNDCLASSEX);
+
+			window_class.style = CS_HREDRAW | CS_VREDRAW | CS_DBLCLKS;
+			window_class.lpfnWndProc = window_proc;
+			window_class.cbClsExtra = 0;
+			window_class.cbWndExtra = 0;
+			window_class.hInstance = hinstance;
+			window_class.hIcon = LoadIcon(NULL, IDI_APPLICATION);
+			window_class.hCursor = LoadCursor(NULL, IDC_ARROW);
+			window_class.hbrBackground = GetSysColorBrush(COLOR_BTNFACE);
+			window_class.lpszMenuName = NULL;
+			window_class.lpszClassName = name.c_str();
+			window_class.hIconSm = NULL;
+
+			atom_ = RegisterClassEx(&window_class);
+			if (atom_ == 0)
+				throw std::runtime_error("Failed to create window class.");
+		}
+
+		WindowClass::~WindowClass()
+		{
+
+		}
+
+		const wchar_t * WindowClass::GetName() {
+			return name_.c_str();
+		}
+
+		ATOM WindowClass::GetAtom() {
+			return atom_;
+		}
+
+		LRESULT __stdcall GeneralWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam) {
+			auto window = Application::GetInstance()->GetWindowManager()->FromHandle(hWnd);
+
+			LRESULT result;
+			if (window != nullptr && window->HandleWindowMessage(hWnd, Msg, wParam, lParam, result))
+				return result;
+
+			return DefWindowProc(hWnd, Msg, wParam, lParam);
+		}
+
+		WindowManager::WindowManager() {
+			general_window_class_ = std::make_unique<WindowClass>(
+				L"CruUIWindowClass",
+				GeneralWndProc,
+				Application::GetInstance()->GetInstanceHandle()
+				);
+		}
+
+		void WindowManager::RegisterWindow(HWND hwnd, Window * window) {
+			const auto find_result = window_map_.find(hwnd);
+			if (find_result != window_map_.end())
+				throw std::runtime_error("The hwnd is already in the map.");
+
+			window_map_.emplace(hwnd, window);
+		}
+
+		void WindowManager::UnregisterWindow(HWND hwnd) {
+			const auto find_result = window_map_.find(hwnd);
+			if (find_result == window_map_.end())
+				throw std::runtime_error("The hwnd is not in the map.");
+			window_map_.erase(find_result);
+
+			if (window_map_.empty())
+				Application::GetInstance()->Quit(0);
+		}
+
+		Window* WindowManager::FromHandle(HWND hwnd) {
+		    const auto find_result = window_map_.find(hwnd);
+			if (find_result == window_map_.end())
+				return nullptr;
+			else
+				return find_result->second;
+		}
+#endif
+
+#ifdef CRU_HEADLESS
+		WindowLayoutManager::WindowLayoutManager()
+			: thread_pool_(nullptr)
+		{
+		}
+#else
+		WindowLayoutManager::WindowLayoutManager()
+			: thread_pool_(Application::GetInstance()->GetThreadPool())
+		{
+		}
+#endif
+
+		WindowLayoutManager::~WindowLayoutManager()
+		{
+		}
+
+		void WindowLayoutManager::InvalidateControlPositionCache(Control * control)
+		{
+			if (cache_invalid_controls_.count(control) == 1)
+				return;
+
+			// find descendant then erase it; find ancestor then just return.
+			for (auto i = cache_invalid_controls_.cbegin(); i != cache_invalid_controls_.cend();)
+			{
+				const auto ancestor = IsAncestorOrDescendant(*i, control);
+				if (ancestor == control)
+					i = cache_invalid_controls_.erase(i);
+				else if (ancestor == *i)
+					return; // find a ancestor of "control", just return
+				else
+					++i;
+			}
+
+			cache_invalid_controls_.insert(control);
+
+			// without a message loop it is refreshed by rendering and hit testing.
+#ifndef CRU_HEADLESS
+			if (cache_invalid_controls_.size() == 1) // when insert just now and not repeat to "InvokeLater".
+			{
+				InvokeLater([this] {
+					RefreshInvalidControlPositionCache();
+				});
+			}
+#endif
+		}
+
+		double GetSecondsSinceHelperFunc(const std::chrono::steady_clock::time_point& start)
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		void WindowLayoutManager::RefreshInvalidControlPositionCache()
+		{
+			if (cache_invalid_controls_.empty())
+				return;
+
+			const auto start = std::chrono::steady_clock::now();
+			auto count = 0;
+			for (auto i : cache_invalid_controls_)
+				count += RefreshControlPositionCache(i);
+			cache_invalid_controls_.clear();
+			last_position_cache_statistics_.refresh_count = count;
+			last_position_cache_statistics_.seconds = GetSecondsSinceHelperFunc(start);
+		}
+
+		int WindowLayoutManager::RefreshControlPositionCache(Control * control)
+		{
+			Matrix matrix;
+			auto parent = control;
+			while ((parent = parent->GetParent())) {
+				matrix = matrix * parent->GetLocalMatrix();
+			}
+			// bounds of ancestors contain the subtree.
+			control->InvalidateSubtreeBounds();
+			return RefreshControlPositionCacheInternal(control, matrix);
+		}
+
+		int WindowLayoutManager::RefreshControlPositionCacheInternal(Control * control, const Matrix & parent_world_matrix)
+		{
+			const auto world_matrix = control->GetLocalMatrix() * parent_world_matrix;
+			auto& cache = control->position_cache_;
+			cache.world_matrix = world_matrix;
+			cache.inverse_world_matrix = world_matrix.GetInverse();
+			cache.lefttop_position_absolute = Point(world_matrix.dx, world_matrix.dy);
+			control->is_subtree_bounds_invalid_ = true;
+			auto count = 1;
+			control->ForeachChild([&world_matrix, &count](Control* c) {
+				count += RefreshControlPositionCacheInternal(c, world_matrix);
+			});
+			return count;
+		}
+
+		void WindowLayoutManager::InvalidateControlLayout(Control * control)
+		{
+#ifdef CRU_HEADLESS
+			// without a message loop it is refreshed by rendering.
+			layout_invalid_controls_.insert(control);
+#else
+			const auto insert_result = layout_invalid_controls_.insert(control);
+			if (insert_result.second && layout_invalid_controls_.size() == 1) // when insert just now and not repeat to "InvokeLater".
+			{
+				InvokeLater([this] {
+					RefreshInvalidControlLayout();
+				});
+			}
+#endif
+		}
+
+		int GetDepthHelperFunc(Control* control)
+		{
+			auto depth = 0;
+			while ((control = control->GetParent()))
+				depth++;
+			return depth;
+		}
+
+		void WindowLayoutManager::RefreshInvalidControlLayout()
+		{
+			current_root_count_ = 0;
+			current_measure_count_ = 0;
+			current_layout_count_ = 0;
+			current_parallel_measure_count_ = 0;
+			auto measure_seconds = 0.0;
+			auto layout_seconds = 0.0;
+
+			// a control laid out at a size that changes what it measures
+			// invalidates its measure during the pass, so it runs again.
+			for (auto round = 0; round < max_layout_round_count && !layout_invalid_controls_.empty(); round++)
+			{
+				// Ancestors go first so that a root below them is already valid when it is reached.
+				// The set is taken so that invalidation during the round schedules another one.
+				std::vector<std::pair<int, Control*>> roots;
+				for (auto control : layout_invalid_controls_)
+					roots.emplace_back(GetDepthHelperFunc(control), control);
+				layout_invalid_controls_.clear();
+				std::sort(roots.begin(), roots.end());
+
+				for (const auto& root : roots)
+				{
+					const auto control = root.second;
+					if (control->IsMeasureValid() && control->IsLayoutValid())
+						continue;
+
+					current_root_count_++;
+
+					if (const auto window = dynamic_cast<Window*>(control))
+					{
+						// A window is not placed by "Layout" because its size is the client size.
+						const auto size = window->GetSize();
+						auto start = std::chrono::steady_clock::now();
+						window->Measure(size);
+						measure_seconds += GetSecondsSinceHelperFunc(start);
+						if (!window->IsLayoutValid())
+						{
+							start = std::chrono::steady_clock::now();
+							current_layout_count_++;
+							window->OnLayout(Rect(Point::zero, size));
+							window->is_layout_invalid_ = false;
+							layout_seconds += GetSecondsSinceHelperFunc(start);
+						}
+					}
+					else if (control->last_measure_available_size_.has_value() && control->last_layout_rect_.has_value())
+					{
+						auto start = std::chrono::steady_clock::now();
+						control->Measure(control->last_measure_available_size_.value());
+						measure_seconds += GetSecondsSinceHelperFunc(start);
+						start = std::chrono::steady_clock::now();
+						control->Layout(control->last_layout_rect_.value());
+						layout_seconds += GetSecondsSinceHelperFunc(start);
+					}
+					// Otherwise it has never been laid out and its parent, which is also invalid, will do it.
+				}
+			}
+
+			last_statistics_.root_count = current_root_count_;
+			last_statistics_.measure_count = current_measure_count_;
+			last_statistics_.layout_count = current_layout_count_;
+			last_statistics_.parallel_measure_count = current_parallel_measure_count_;
+			last_statistics_.measure_seconds = measure_seconds;
+			last_statistics_.layout_seconds = layout_seconds;
+		}
+
+		void WindowLayoutManager::SetParallelMeasureThreshold(const int threshold)
+		{
+			if (threshold < 0)
+				throw std::invalid_argument("The threshold can't be negative.");
+			parallel_measure_threshold_ = threshold;
+		}
+
+		void WindowLayoutManager::OnControlDetach(Control* control)
+		{
+			cache_invalid_controls_.erase(control);
+			layout_invalid_controls_.erase(control);
+		}
+
+#ifdef CRU_HEADLESS
+		// every render draws a new image, so there is no buffer to rotate.
+		constexpr auto window_buffer_count = 1;
+#else
+		constexpr auto window_buffer_count = graph::WindowRenderTarget::buffer_count;
+#endif
+
+		Window::Window() : layout_manager_(new WindowLayoutManager()), control_list_({ this }), damage_tracker_(window_buffer_count) {
+			window_ = this;
+
+			BasicLayoutParams layout_params;
+			layout_params.size.width.mode = MeasureMode::Stretch;
+			layout_params.size.height.mode = MeasureMode::Stretch;
+			SetLayoutParams(layout_params);
+
+#ifndef CRU_HEADLESS
+			auto app = Application::GetInstance();
+			hwnd_ = CreateWindowEx(0,
+				app->GetWindowManager()->GetGeneralWindowClass()->GetName(),
+				L"", WS_OVERLAPPEDWINDOW,
+				CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT,
+				nullptr, nullptr, app->GetInstanceHandle(), nullptr
+			);
+
+			if (hwnd_ == nullptr)
+				throw std::runtime_error("Failed to create window.");
+
+			app->GetWindowManager()->RegisterWindow(hwnd_, this);
+
+			render_target_ = app->GetGraphManager()->CreateWindowRenderTarget(hwnd_);
+#endif
+		}
+
+		Window::~Window() {
+#ifndef CRU_HEADLESS
+			Close();
+#endif
+		}
+
+		WindowLayoutManager* Window::GetLayoutManager()
+		{
+			return layout_manager_.get();
+		}
+
+#ifndef CRU_HEADLESS
+		HWND Window::GetWindowHandle()
+		{
+			return hwnd_;
+		}
+
+		bool Window::IsWindowValid() {
+			return hwnd_ != nullptr;
+		}
+
+		void Window::Close() {
+			if (IsWindowValid())
+				DestroyWindow(hwnd_);
+		}
+#endif
+
+		void Window::Repaint() {
+			is_display_list_invalid_ = true;
+			layer_cache_.Clear();
+			damage_tracker_.AddFullDamage();
+#ifndef CRU_HEADLESS
+			if (IsWindowValid()) {
+				InvalidateRect(hwnd_, nullptr, false);
+				UpdateWindow(hwnd_);
+			}
+#endif
+		}
+
+#ifdef CRU_HEADLESS
+		Size Window::GetClientSize() {
+			return client_size_;
+		}
+
+		void Window::SetClientSize(const Size & size) {
+			if (client_size_ == size)
+				return;
+			client_size_ = size;
+			damage_tracker_.AddFullDamage();
+			InvalidateSubtreeBounds();
+			InvalidateMeasure();
+		}
+#else
+		void Window::Show() {
+			if (IsWindowValid()) {
+				ShowWindow(hwnd_, SW_SHOWNORMAL);
+			}
+		}
+
+		void Window::Hide() {
+			if (IsWindowValid()) {
+				ShowWindow(hwnd_, SW_HIDE);
+			}
+		}
+
+		Size Window::GetClientSize() {
+			if (!IsWindowValid())
+				return Size();
+
+			const auto pixel_rect = GetClientRectPixel();
+			return Size(
+				graph::PixelToDipX(pixel_rect.right),
+				graph::PixelToDipY(pixel_rect.bottom)
+			);
+		}
+
+		void Window::SetClientSize(const Size & size) {
+			if (IsWindowValid()) {
+				const auto window_style = static_cast<DWORD>(GetWindowLongPtr(hwnd_, GWL_STYLE));
+				const auto window_ex_style = static_cast<DWORD>(GetWindowLongPtr(hwnd_, GWL_EXSTYLE));
+
+				RECT rect;
+				rect.left = 0;
+				rect.top = 0;
+				rect.right = graph::DipToPixelX(size.width);
+				rect.bottom = graph::DipToPixelY(size.height);
+				AdjustWindowRectEx(&rect, window_style, FALSE, window_ex_style);
+
+				SetWindowPos(
+					hwnd_, nullptr, 0, 0,
+					rect.right - rect.left,
+					rect.bottom - rect.top,
+					SWP_NOZORDER | SWP_NOMOVE
+				);
+			}
+		}
+
+		Rect Window::GetWindowRect() {
+			if (!IsWindowValid())
+				return Rect();
+
+			RECT rect;
+			::GetWindowRect(hwnd_, &rect);
+
+			return Rect::FromVertices(
+				graph::PixelToDipX(rect.left),
+				graph::PixelToDipY(rect.top),
+				graph::PixelToDipX(rect.right),
+				graph::PixelToDipY(rect.bottom)
+			);
+		}
+
+		void Window::SetWindowRect(const Rect & rect) {
+			if (IsWindowValid()) {
+				SetWindowPos(
+					hwnd_, nullptr,
+					graph::DipToPixelX(rect.left),
+					graph::DipToPixelY(rect.top),
+					graph::DipToPixelX(rect.GetRight()),
+					graph::DipToPixelY(rect.GetBottom()),
+					SWP_NOZORDER
+				);
+			}
+		}
+
+		bool Window::HandleWindowMessage(HWND hwnd, int msg, WPARAM w_param, LPARAM l_param, LRESULT & result) {
+			switch (msg) {
+			case WM_PAINT:
+				OnPaintInternal();
+				result = 0;
+				return true;
+			case WM_ERASEBKGND:
+				result = 1;
+				return true;
+			case WM_SETFOCUS:
+				OnSetFocusInternal();
+				result = 0;
+				return true;
+			case WM_KILLFOCUS:
+				OnKillFocusInternal();
+				result = 0;
+				return true;
+			case WM_LBUTTONDOWN:
+			{
+				POINT point;
+				point.x = GET_X_LPARAM(l_param);
+				point.y = GET_Y_LPARAM(l_param);
+				OnMouseDownInternal(MouseButton::Left, point);
+				result = 0;
+				return true;
+			}
+			case WM_LBUTTONUP:
+			{
+				POINT point;
+				point.x = GET_X_LPARAM(l_param);
+				point.y = GET_Y_LPARAM(l_param);
+				OnMouseDownInternal(MouseButton::Left, point);
+				result = 0;
+				return true;
+			}
+			case WM_RBUTTONDOWN:
+			{
+				POINT point;
+				point.x = GET_X_LPARAM(l_param);
+				point.y = GET_Y_LPARAM(l_param);
+				OnMouseDownInternal(MouseButton::Right, point);
+				result = 0;
+				return true;
+			}
+			case WM_RBUTTONUP:
+			{
+				POINT point;
+				point.x = GET_X_LPARAM(l_param);
+				point.y = GET_Y_LPARAM(l_param);
+				OnMouseDownInternal(MouseButton::Right, point);
+				result = 0;
+				return true;
+			}
+			case WM_MBUTTONDOWN:
+			{
+				POINT point;
+				point.x = GET_X_LPARAM(l_param);
+				point.y = GET_Y_LPARAM(l_param);
+				OnMouseDownInternal(MouseButton::Middle, point);
+				result = 0;
+				return true;
+			}
+			case WM_MBUTTONUP:
+			{
+				POINT point;
+				point.x = GET_X_LPARAM(l_param);
+				point.y = GET_Y_LPARAM(l_param);
+				OnMouseDownInternal(MouseButton::Middle, point);
+				result = 0;
+				return true;
+			}
+			case WM_SIZE:
+				OnResizeInternal(LOWORD(l_param), HIWORD(l_param));
+				result = 0;
+				return true;
+			case WM_DESTROY:
+				OnDestroyInternal();
+				result = 0;
+				return true;
+			default: 
+                return false;
+			}
+		}
+#endif
+
+		Point Window::GetPositionRelative()
+		{
+			return Point();
+		}
+
+		void Window::SetPositionRelative(const Point & position)
+		{
+
+		}
+
+		Size Window::GetSize()
+		{
+			return GetClientSize();
+		}
+
+		void Window::SetSize(const Size & size)
+		{
+			SetClientSize(size);
+		}
+
+		void Window::RefreshControlList() {
+			control_list_.clear();
+			TraverseDescendants([this](Control* control) {
+				this->control_list_.push_back(control);
+			});
+			is_hit_test_bounds_invalid_ = true;
+		}
+
+		Control * Window::HitTest(const Point & point)
+		{
+			layout_manager_->RefreshInvalidControlPositionCache();
+
+			const auto start = std::chrono::steady_clock::now();
+			if (is_hit_test_bounds_invalid_)
+				RefreshHitTestBoundsInternal();
+
+			// only controls whose bounds contain the point are tested exactly,
+			// the topmost first.
+			Control* result = nullptr;
+			auto count = 0;
+			auto end = static_cast<int>(control_list_.size());
+			while ((end = geometry::FindLastContaining(hit_test_bounds_.data(), end, point)) != -1) {
+				const auto control = control_list_[end];
+				count++;
+				if (control->IsPointInside(control->AbsoluteToLocal(point))) {
+					result = control;
+					break;
+				}
+			}
+			last_hit_test_statistics_.visit_count = count;
+			last_hit_test_statistics_.seconds = GetSecondsSinceHelperFunc(start);
+			return result;
+		}
+
+		void Window::RefreshHitTestBoundsInternal()
+		{
+			hit_test_bounds_.resize(control_list_.size());
+			for (std::size_t i = 0; i < control_list_.size(); i++) {
+				const auto control = control_list_[i];
+				// a collapsed control contains no point.
+				if (!control->position_cache_.inverse_world_matrix.has_value()) {
+					hit_test_bounds_[i] = Rect();
+					continue;
+				}
+				const auto bounds = control->GetWorldMatrix().TransformBounds(Rect(Point::zero, control->GetSize()));
+				if (bounds.IsEmpty()) {
+					hit_test_bounds_[i] = bounds;
+					continue;
+				}
+				// rounding in the inverse matrix may put a point just outside
+				// the bounds inside the control, so they are widened a little.
+				const auto margin = 1.0f / 64.0f + 1e-4f * std::max({ std::abs(bounds.left), std::abs(bounds.top),
+					std::abs(bounds.GetRight()), std::abs(bounds.GetBottom()) });
+				hit_test_bounds_[i] = Rect(bounds.left - margin, bounds.top - margin,
+					bounds.width + 2.0f * margin, bounds.height + 2.0f * margin);
+			}
+			is_hit_test_bounds_invalid_ = false;
+		}
+
+		bool Window::RequestFocusFor(Control * control)
+		{
+			if (control == nullptr)
+				throw std::invalid_argument("The control to request focus can't be null. You can set it as the window.");
+
+			// a headless window has no system focus to wait for.
+#ifndef CRU_HEADLESS
+			if (!IsWindowValid())
+				return false;
+
+			if (!window_focus_)
+			{
+				::SetFocus(hwnd_);
+				focus_control_ = control;
+				return true; // event dispatch will be done in window message handling function "OnSetFocusInternal".
+			}
+#endif
+
+			if (focus_control_ == control)
+				return true;
+
+			DispatchEvent(focus_control_, &Control::OnLoseFocusCore, nullptr);
+
+			focus_control_ = control;
+
+			DispatchEvent(control, &Control::OnGetFocusCore, nullptr);
+
+			return true;
+		}
+
+		Control* Window::GetFocusControl()
+		{
+			return focus_control_;
+		}
+
+#ifndef CRU_HEADLESS
+		RECT Window::GetClientRectPixel() {
+			RECT rect{ };
+			GetClientRect(hwnd_, &rect);
+			return rect;
+		}
+#endif
+
+		void Window::FlushControlDamageInternal()
+		{
+			for (const auto control : damaged_controls_)
+				damage_tracker_.AddDamage(control->GetSubtreeBounds());
+			damaged_controls_.clear();
+		}
+
+		void Window::AddControlDamage(Control* control, const bool is_drawn)
+		{
+			// damage comes with every change of position, transform or size.
+			is_hit_test_bounds_invalid_ = true;
+			// only the bounds before the first change of a frame were drawn.
+			if (damaged_controls_.insert(control).second && is_drawn)
+				damage_tracker_.AddDamage(control->GetSubtreeBounds());
+			// a layer of an ancestor has the old content inside. Layout damages
+			// every control on deep paths, so the walk is skipped without layers.
+			if (layer_cache_.GetCount() != 0)
+				for (auto layer_control = control; layer_control != nullptr; layer_control = layer_control->GetParent())
+					if (layer_control->IsCachedAsLayer())
+						layer_cache_.Remove(layer_control);
+			// no "UpdateWindow", so changes until the next paint are drawn together.
+#ifndef CRU_HEADLESS
+			if (IsWindowValid())
+				InvalidateRect(hwnd_, nullptr, false);
+#endif
+		}
+
+#ifndef CRU_HEADLESS
+		void Window::OnDestroyInternal() {
+			Application::GetInstance()->GetWindowManager()->UnregisterWindow(hwnd_);
+			hwnd_ = nullptr;
+		}
+
+		inline RECT DipToPixelRectHelperFunc(const Rect& rect, const RECT& client_rect)
+		{
+			// round out, so every pixel the rect touches is included.
+			return RECT{
+				std::max<LONG>(graph::DipToPixelX(rect.left), client_rect.left),
+				std::max<LONG>(graph::DipToPixelY(rect.top), client_rect.top),
+				std::min<LONG>(graph::DipToPixelX(rect.GetRight()) + 1, client_rect.right),
+				std::min<LONG>(graph::DipToPixelY(rect.GetBottom()) + 1, client_rect.bottom)
+			};
+		}
+
+		inline Rect PixelToDipRectHelperFunc(const RECT& rect)
+		{
+			return Rect::FromVertices(
+				graph::PixelToDipX(rect.left),
+				graph::PixelToDipY(rect.top),
+				graph::PixelToDipX(rect.right),
+				graph::PixelToDipY(rect.bottom)
+			);
+		}
+
+		void Window::OnPaintInternal() {
+			layout_manager_->RefreshInvalidControlLayout();
+			layout_manager_->RefreshInvalidControlPositionCache();
+
+			FlushControlDamageInternal();
+
+			// a paint not caused by damage, for example from the system, draws everything.
+			if (!damage_tracker_.HasDamage())
+				damage_tracker_.AddFullDamage();
+
+			const Rect client_rect(Point::zero, GetSize());
+			const auto frame = damage_tracker_.TakeFrame(client_rect, max_paint_rect_count_);
+			const auto client_rect_pixel = GetClientRectPixel();
+
+			// clip to whole pixels, the same ones that are presented.
+			std::vector<Rect> clips;
+			for (const auto& rect : frame.paint_region.GetRects())
+			{
+				const auto clip = PixelToDipRectHelperFunc(DipToPixelRectHelperFunc(rect, client_rect_pixel));
+				if (!clip.IsEmpty())
+					clips.push_back(clip);
+			}
+
+			render_target_->SetAsTarget();
+
+			auto device_context = render_target_->GetD2DDeviceContext();
+
+			const auto resource_cache = render_target_->GetGraphManager()->GetResourceCache();
+			resource_cache->BeginFrame();
+
+			device_context->BeginDraw();
+			graph::D2DPainter d2d_painter(device_context.Get(), resource_cache);
+			graph::BatchingPainter painter(&d2d_painter);
+			DrawInternal(painter, clips);
+			painter.Flush();
+			current_draw_statistics_.primitive_count = painter.GetStatistics().primitive_count;
+			current_draw_statistics_.submission_count = painter.GetStatistics().submission_count;
+			const auto resource_statistics = resource_cache->GetFrameStatistics();
+			current_draw_statistics_.resource_hit_count = resource_statistics.brushes.hit_count + resource_statistics.geometries.hit_count;
+			current_draw_statistics_.resource_miss_count = resource_statistics.brushes.miss_count + resource_statistics.geometries.miss_count;
+			current_draw_statistics_.is_full_present = frame.is_full;
+			last_draw_statistics_ = current_draw_statistics_;
+
+			ThrowIfFailed(
+				device_context->EndDraw(), "Failed to draw window."
+			);
+
+			if (frame.is_full)
+				render_target_->Present();
+			else
+			{
+				std::vector<RECT> dirty_rects;
+				for (const auto& rect : frame.present_region.GetRects())
+				{
+					const auto dirty_rect = DipToPixelRectHelperFunc(rect, client_rect_pixel);
+					if (dirty_rect.left < dirty_rect.right && dirty_rect.top < dirty_rect.bottom)
+						dirty_rects.push_back(dirty_rect);
+				}
+				// presenting no dirty rect would present everything.
+				if (!dirty_rects.empty())
+					render_target_->Present(dirty_rects);
+			}
+
+			ValidateRect(hwnd_, nullptr);
+		}
+#endif
+
+		DamageFrame Window::Render(graph::Painter& painter, const bool is_damage_only)
+		{
+			layout_manager_->RefreshInvalidControlLayout();
+			layout_manager_->RefreshInvalidControlPositionCache();
+			FlushControlDamageInternal();
+
+			const Rect client_rect(Point::zero, GetSize());
+			auto frame = damage_tracker_.TakeFrame(client_rect, max_paint_rect_count_);
+			DrawInternal(painter, is_damage_only ? frame.paint_region.GetRects() : std::vector<Rect>{ client_rect });
+			current_draw_statistics_.is_full_present = frame.is_full;
+			last_draw_statistics_ = current_draw_statistics_;
+			return frame;
+		}
+
+		void Window::DrawInternal(graph::Painter& painter, const std::vector<Rect>& clips)
+		{
+			current_draw_statistics_ = DrawStatistics();
+			const auto draw_start = std::chrono::steady_clock::now();
+			for (const auto& clip : clips)
+			{
+				painter.SetTransform(Matrix::Identity());
+				painter.PushClip(clip);
+
+				//Clear the background.
+				painter.Clear(graph::Color(1.0f, 1.0f, 1.0f));
+
+				std::vector<Rect> occluders;
+				UpdateOcclusionInternal(this, clip, occluders);
+				Draw(painter, clip);
+
+				painter.SetTransform(Matrix::Identity());
+				painter.PopClip();
+
+				current_draw_statistics_.paint_rect_count++;
+				current_draw_statistics_.paint_area += clip.width * clip.height;
+			}
+			current_draw_statistics_.layer_byte_size = layer_cache_.GetCost();
+			current_draw_statistics_.seconds = GetSecondsSinceHelperFunc(draw_start);
+		}
+
+		inline bool IsRectCoveredHelperFunc(const Rect& rect, const std::vector<Rect>& occluders)
+		{
+			if (rect.IsEmpty())
+				return false;
+			return std::any_of(occluders.cbegin(), occluders.cend(), [&rect](const Rect& occluder) {
+				return occluder.Contains(rect);
+			});
+		}
+
+		void Window::UpdateOcclusionInternal(Control* control, const Rect& clip, std::vector<Rect>& occluders)
+		{
+			control->is_occluded_ = false;
+			control->is_subtree_occluded_ = false;
+
+			// skipped by "Draw" anyway.
+			const auto visible_subtree_bounds = control->GetSubtreeBounds().Intersect(clip);
+			if (visible_subtree_bounds.IsEmpty())
+				return;
+
+			if (IsRectCoveredHelperFunc(visible_subtree_bounds, occluders))
+			{
+				control->is_subtree_occluded_ = true;
+				return;
+			}
+
+			const auto& matrix = control->GetWorldMatrix();
+			auto child_clip = clip;
+			if (control->IsClipToBounds())
+				child_clip = clip.Intersect(matrix.TransformBounds(Rect(Point::zero, control->GetSize())));
+
+			// the last child is the front one.
+			const auto& children = control->GetInternalChildren();
+			for (auto i = children.crbegin(); i != children.crend(); ++i)
+				UpdateOcclusionInternal(*i, child_clip, occluders);
+
+			control->is_occluded_ = IsRectCoveredHelperFunc(matrix.TransformBounds(control->GetDrawBounds()).Intersect(clip), occluders);
+
+			// only rects that stay rects in the window occlude.
+			if (!control->is_occluded_ && matrix.m12 == 0.0f && matrix.m21 == 0.0f)
+			{
+				const auto opaque_bounds = control->GetOpaqueBounds();
+				if (!opaque_bounds.IsEmpty())
+				{
+					const auto occluder = matrix.TransformBounds(opaque_bounds).Intersect(clip);
+					if (!occluder.IsEmpty())
+						occluders.push_back(occluder);
+				}
+			}
+		}
+
+#ifndef CRU_HEADLESS
+		void Window::OnResizeInternal(int new_width, int new_height) {
+			render_target_->ResizeBuffer(new_width, new_height);
+			// resizing the buffers loses their content.
+			damage_tracker_.AddFullDamage();
+			InvalidateSubtreeBounds();
+			InvalidateMeasure();
+		}
+
+		void Window::OnSetFocusInternal()
+		{
+			window_focus_ = true;
+			if (focus_control_ != nullptr)
+				DispatchEvent(focus_control_, &Control::OnGetFocusCore, nullptr);
+		}
+
+		void Window::OnKillFocusInternal()
+		{
+			window_focus_ = false;
+			if (focus_control_ != nullptr)
+				DispatchEvent(focus_control_, &Control::OnLoseFocusCore, nullptr);
+		}
+
+		void Window::OnMouseMoveInternal(POINT point)
+		{
+			Point dip_point(
+				graph::PixelToDipX(point.x),
+				graph::PixelToDipY(point.y)
+			);
+
+			//when mouse was previous outside the window
+			if (mouse_hover_control_ == nullptr) {
+				//invoke TrackMouseEvent to have WM_MOUSELEAVE sent.
+				TRACKMOUSEEVENT tme;
+				tme.cbSize = sizeof tme;
+				tme.dwFlags = TME_LEAVE;
+				tme.hwndTrack = hwnd_;
+
+				TrackMouseEvent(&tme);
+			}
+
+			//Find the first control that hit test succeed.
+		    const auto new_control_mouse_hover = HitTest(dip_point);
+
+			if (new_control_mouse_hover != mouse_hover_control_) //if the mouse-hover-on control changed
+			{
+				const auto lowest_common_ancestor = FindLowestCommonAncestor(mouse_hover_control_, new_control_mouse_hover);
+				if (mouse_hover_control_ != nullptr) // if last mouse-hover-on control exists
+				{
+					// dispatch mouse leave event.
+					DispatchEvent(mouse_hover_control_, &Control::OnMouseLeaveCore, lowest_common_ancestor);
+				}
+				mouse_hover_control_ = new_control_mouse_hover;
+				// dispatch mouse enter event.
+				DispatchEvent(new_control_mouse_hover, &Control::OnMouseEnterCore, lowest_common_ancestor, dip_point);
+			}
+
+			DispatchEvent(new_control_mouse_hover, &Control::OnMouseMoveCore, nullptr, dip_point);
+		}
+
+		void Window::OnMouseLeaveInternal()
+		{
+			DispatchEvent(mouse_hover_control_, &Control::OnMouseLeaveCore, nullptr);
+			mouse_hover_control_ = nullptr;
+		}
+
+		void Window::OnMouseDownInternal(MouseButton button, POINT point)
+		{
+			Point dip_point(
+				graph::PixelToDipX(point.x),
+				graph::PixelToDipY(point.y)
+			);
+
+			const auto control = HitTest(dip_point);
+
+			DispatchEvent(control, &Control::OnMouseDownCore, nullptr, dip_point, button);
+		}
+
+		void Window::OnMouseUpInternal(MouseButton button, POINT point)
+		{
+			Point dip_point(
+				graph::PixelToDipX(point.x),
+				graph::PixelToDipY(point.y)
+			);
+
+			const auto control = HitTest(dip_point);
+
+			DispatchEvent(control, &Control::OnMouseUpCore, nullptr, dip_point, button);
+		}
+#endif
+	}
+}
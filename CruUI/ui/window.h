@@ -0,0 +1,514 @@
+#pragma once
+
+#ifndef CRU_HEADLESS
+#include "system_headers.h"
+#endif
+#include <set>
+#include <map>
+#include <vector>
+#include <unordered_set>
+#include <memory>
+#include <atomic>
+#include <chrono>
+
+#include "control.h"
+#include "damage_tracker.h"
+#include "lru_cache.h"
+
+namespace cru {
+	class ThreadPool;
+
+	namespace graph {
+		class WindowRenderTarget;
+	}
+
+	namespace ui {
+#ifndef CRU_HEADLESS
+		class WindowClass : public Object
+		{
+		public:
+			WindowClass(const std::wstring& name, WNDPROC window_proc, HINSTANCE h_instance);
+		    WindowClass(const WindowClass& other) = delete;
+		    WindowClass(WindowClass&& other) = delete;
+		    WindowClass& operator=(const WindowClass& other) = delete;
+		    WindowClass& operator=(WindowClass&& other) = delete;
+		    ~WindowClass() override;
+
+
+			const wchar_t* GetName();
+			ATOM GetAtom();
+
+		private:
+			std::wstring name_;
+			ATOM atom_;
+		};
+
+		class WindowManager : public Object
+		{
+		public:
+			WindowManager();
+		    WindowManager(const WindowManager& other) = delete;
+		    WindowManager(WindowManager&& other) = delete;
+		    WindowManager& operator=(const WindowManager& other) = delete;
+		    WindowManager& operator=(WindowManager&& other) = delete;
+			~WindowManager() override = default;
+
+
+			//Get the general window class for creating ordinary window.
+			WindowClass* GetGeneralWindowClass() const
+			{
+                return general_window_class_.get();
+			}
+
+			//Register a window newly created.
+			//This function adds the hwnd to hwnd-window map.
+			//It should be called immediately after a window was created.
+			void RegisterWindow(HWND hwnd, Window* window);
+
+			//Unregister a window that is going to be destroyed.
+			//This function removes the hwnd from the hwnd-window map.
+			//It should be called immediately before a window is going to be destroyed,
+			void UnregisterWindow(HWND hwnd);
+
+			//Return a pointer to the Window object related to the HWND or nullptr if the hwnd is not in the map.
+			Window* FromHandle(HWND hwnd);
+
+		private:
+			std::unique_ptr<WindowClass> general_window_class_;
+			std::map<HWND, Window*> window_map_;
+		};
+#endif
+
+
+		//Statistics of a layout pass, exposed to make regressions visible.
+		struct LayoutPassStatistics
+		{
+			//Count of controls the pass started from.
+			int root_count = 0;
+			//Count of controls whose "OnMeasure" was invoked.
+			int measure_count = 0;
+			//Count of controls whose "OnLayout" was invoked.
+			int layout_count = 0;
+			//Count of controls that measured their children on the thread pool.
+			int parallel_measure_count = 0;
+			//Wall time spent in measure and in layout.
+			double measure_seconds = 0.0;
+			double layout_seconds = 0.0;
+		};
+
+		//Statistics of a position cache refresh.
+		struct PositionCacheStatistics
+		{
+			//Count of controls whose cache was recalculated.
+			int refresh_count = 0;
+			double seconds = 0.0;
+		};
+
+		//Statistics of a hit test.
+		struct HitTestStatistics
+		{
+			//Count of controls tested before the result was found.
+			int visit_count = 0;
+			double seconds = 0.0;
+		};
+
+		//Statistics of drawing a frame.
+		struct DrawStatistics
+		{
+			//Count of controls drawn.
+			int drawn_count = 0;
+			//Count of drawn controls whose content was recorded again instead
+			//of replayed.
+			int recorded_count = 0;
+			//Count of subtrees skipped because they are out of the clip.
+			int culled_subtree_count = 0;
+			//Count of controls not drawn because opaque controls above cover
+			//them. Their children may still be drawn.
+			int occluded_count = 0;
+			//Count of subtrees skipped because opaque controls above cover them.
+			int occluded_subtree_count = 0;
+			//Count of rects drawn into separately.
+			int paint_rect_count = 0;
+			//Area drawn into, in dips.
+			float paint_area = 0.0f;
+			//Count of subtrees drawn from their cached layers.
+			int layer_hit_count = 0;
+			//Count of subtrees painted into new layers.
+			int layer_miss_count = 0;
+			//Memory taken by cached layers after the frame, in bytes.
+			std::size_t layer_byte_size = 0;
+			//Count of fills drawn by controls, and of commands sent to the
+			//backend after fills of the same color are batched.
+			int primitive_count = 0;
+			int submission_count = 0;
+			//Count of brushes and geometries found in the resource cache
+			//shared by windows, and of ones created.
+			int resource_hit_count = 0;
+			int resource_miss_count = 0;
+			//True if the whole window was presented instead of dirty rects.
+			bool is_full_present = false;
+			double seconds = 0.0;
+		};
+
+		//A layer a subtree is drawn into, and the subtree bounds it was
+		//painted for.
+		struct CachedLayer
+		{
+			Rect bounds;
+			std::shared_ptr<graph::Layer> layer;
+		};
+
+		//Layers of the subtrees of a window, which cost their bytes.
+		using LayerCache = LruCache<const Control*, CachedLayer>;
+
+		class WindowLayoutManager : public Object
+		{
+			friend class Control;
+		public:
+			//Times a layout pass lays out the controls invalidated during it.
+			static constexpr int max_layout_round_count = 4;
+
+		public:
+			WindowLayoutManager();
+		    WindowLayoutManager(const WindowLayoutManager& other) = delete;
+		    WindowLayoutManager(WindowLayoutManager&& other) = delete;
+		    WindowLayoutManager& operator=(const WindowLayoutManager& other) = delete;
+		    WindowLayoutManager& operator=(WindowLayoutManager&& other) = delete;
+			~WindowLayoutManager() override;
+
+			//Mark position cache of the control and its descendants invalid,
+			//(which is saved as an auto-managed list internal)
+			//and send a message to refresh them.
+			void InvalidateControlPositionCache(Control* control);
+
+			//Refresh position cache of the control and its descendants whose cache
+			//has been marked as invalid. The cache holds the world matrix and its
+			//inverse, so it is refreshed before painting and hit testing.
+			void RefreshInvalidControlPositionCache();
+
+			//Refresh position cache of the control and its descendants immediately.
+			//Return the count of refreshed controls.
+			static int RefreshControlPositionCache(Control* control);
+
+			//Get the statistics of the last refresh of invalid position cache.
+			const PositionCacheStatistics& GetLastPositionCacheStatistics() const
+			{
+				return last_position_cache_statistics_;
+			}
+
+			//Mark the control to be re-laid out from its last measure and layout
+			//arguments and schedule a layout pass.
+			//This is usually invoked by "Control::InvalidateMeasure".
+			void InvalidateControlLayout(Control* control);
+
+			//Run a layout pass which visits only the invalid paths. Controls
+			//invalidated during it are laid out in the same pass, up to
+			//"max_layout_round_count" times.
+			void RefreshInvalidControlLayout();
+
+			//Forget the control which is being detached from the window.
+			void OnControlDetach(Control* control);
+
+			//Get the statistics of the last layout pass.
+			const LayoutPassStatistics& GetLastLayoutPassStatistics() const
+			{
+				return last_statistics_;
+			}
+
+			//Get the least estimated count of controls to measure under a control
+			//for measuring its children on the thread pool. 0 means never, which
+			//is the default.
+			int GetParallelMeasureThreshold() const
+			{
+				return parallel_measure_threshold_;
+			}
+
+			//Set the least estimated count of controls to measure under a control
+			//for measuring its children on the thread pool. 0 means never.
+			//Overrides of "OnMeasure" must only touch their own subtree when
+			//enabled, so it is opt-in: text boxes share a text shaper, which is
+			//not thread-safe.
+			void SetParallelMeasureThreshold(int threshold);
+
+			ThreadPool* GetThreadPool() const
+			{
+				return thread_pool_;
+			}
+
+			//Set the thread pool children are measured on, or null to measure
+			//them on the calling thread. It is the pool of the application by
+			//default, and null for headless windows.
+			void SetThreadPool(ThreadPool* thread_pool)
+			{
+				thread_pool_ = thread_pool;
+			}
+
+		private:
+			static int RefreshControlPositionCacheInternal(Control* control, const Matrix& parent_world_matrix);
+
+		private:
+			std::set<Control*> cache_invalid_controls_;
+			PositionCacheStatistics last_position_cache_statistics_{};
+
+			std::set<Control*> layout_invalid_controls_;
+			// Counters of the current pass. They are atomic because measure may run on workers.
+			int current_root_count_ = 0;
+			std::atomic<int> current_measure_count_{ 0 };
+			std::atomic<int> current_layout_count_{ 0 };
+			std::atomic<int> current_parallel_measure_count_{ 0 };
+			LayoutPassStatistics last_statistics_{};
+
+			ThreadPool* thread_pool_;
+			int parallel_measure_threshold_ = 0;
+		};
+
+		class Window : public Control
+		{
+			friend class WindowManager;
+			friend class Control;
+		public:
+			static constexpr std::size_t default_layer_cache_budget = 64 * 1024 * 1024;
+
+		public:
+			Window();
+		    Window(const Window& other) = delete;
+		    Window(Window&& other) = delete;
+		    Window& operator=(const Window& other) = delete;
+		    Window& operator=(Window&& other) = delete;
+			~Window() override;
+
+		public:
+			//*************** region: managers ***************
+			WindowLayoutManager* GetLayoutManager();
+
+			//Get the cache of layers of subtrees cached as layers. Its budget
+			//is in bytes.
+			LayerCache& GetLayerCache()
+			{
+				return layer_cache_;
+			}
+
+
+#ifndef CRU_HEADLESS
+			//*************** region: handle ***************
+
+			//Get the handle of the window. Return null if window is invalid.
+			HWND GetWindowHandle();
+
+			//Return if the window is still valid, that is, hasn't been closed or destroyed.
+			bool IsWindowValid();
+#endif
+
+
+			//*************** region: window operations ***************
+
+			//Damage the whole window, record the content of the window again,
+			//drop the cached layers and paint it now.
+			void Repaint() override;
+
+			//Get the client size.
+			Size GetClientSize();
+
+			//Set the client size and repaint.
+			void SetClientSize(const Size& size);
+
+#ifndef CRU_HEADLESS
+			//Close and destroy the window if the window is valid.
+			void Close();
+
+			//Show the window.
+			void Show();
+
+			//Hide thw window.
+			void Hide();
+
+			//Get the rect of the window containing frame.
+			//The lefttop of the rect is relative to screen lefttop.
+			Rect GetWindowRect();
+
+			//Set the rect of the window containing frame.
+			//The lefttop of the rect is relative to screen lefttop.
+			void SetWindowRect(const Rect& rect);
+
+			//Handle the raw window message.
+			//Return true if the message is handled and get the result through "result" argument.
+			//Return false if the message is not handled.
+			bool HandleWindowMessage(HWND hwnd, int msg, WPARAM w_param, LPARAM l_param, LRESULT& result);
+#endif
+
+
+			//*************** region: position and size ***************
+
+			//Always return (0, 0) for a window.
+			Point GetPositionRelative() override final;
+
+			//This method has no effect for a window.
+			void SetPositionRelative(const Point& position) override final;
+
+			//Get the size of client area for a window.
+			Size GetSize() override final;
+
+			//Set the size of client area for a window.
+			void SetSize(const Size& size) override final;
+
+
+			//*************** region: features ***************
+
+			//Refresh control list.
+			//It should be invoked every time a control is added or removed from the tree.
+			void RefreshControlList();
+
+			//Get the most top control at "point".
+			Control* HitTest(const Point& point);
+
+			//Lay out and draw a frame of the window with "painter", whose
+			//target is in dips, taking the damage since the last frame as a
+			//paint does. With "is_damage_only" only the damaged area is drawn,
+			//for a target keeping the last frame like the bitmap of a tiled
+			//painter; otherwise all of it is, for example to take a snapshot.
+			//Return the damage of the frame.
+			DamageFrame Render(graph::Painter& painter, bool is_damage_only = false);
+
+
+			//Get the statistics of the last hit test.
+			const HitTestStatistics& GetLastHitTestStatistics() const
+			{
+				return last_hit_test_statistics_;
+			}
+
+			//Get the statistics of drawing the last frame.
+			const DrawStatistics& GetLastDrawStatistics() const
+			{
+				return last_draw_statistics_;
+			}
+
+			
+			//*************** region: focus ***************
+
+			//Request focus for specified control.
+			bool RequestFocusFor(Control* control);
+
+			//Get the control that has focus.
+			Control* GetFocusControl();
+
+
+		private:
+#ifndef CRU_HEADLESS
+			//*************** region: native operations ***************
+
+			//Get the client rect in pixel.
+			RECT GetClientRectPixel();
+#endif
+
+
+			//*************** region: damage ***************
+
+			//Damage the subtree bounds of "control" now if it has been drawn,
+			//and again after the next layout, then schedule a paint. The
+			//layers of the control and its ancestors are dropped.
+			void AddControlDamage(Control* control, bool is_drawn = true);
+
+			//Damage the new bounds of the controls changed since the last
+			//frame. The position cache must be fresh.
+			void FlushControlDamageInternal();
+
+
+			//*************** region: drawing ***************
+
+			//Clear and draw each of "clips" with "painter".
+			void DrawInternal(graph::Painter& painter, const std::vector<Rect>& clips);
+
+			//Mark controls covered by opaque controls above them, front to back
+			//in z order. "occluders" are the opaque rects seen so far.
+			static void UpdateOcclusionInternal(Control* control, const Rect& clip, std::vector<Rect>& occluders);
+
+
+			//*************** region: hit test ***************
+
+			//Get the world bounds of the controls in "control_list_" again.
+			//The position cache must be fresh.
+			void RefreshHitTestBoundsInternal();
+
+
+#ifndef CRU_HEADLESS
+			//*************** region: native messages ***************
+
+			void OnDestroyInternal();
+			void OnPaintInternal();
+			void OnResizeInternal(int new_width, int new_height);
+
+			void OnSetFocusInternal();
+			void OnKillFocusInternal();
+
+			void OnMouseMoveInternal(POINT point);
+			void OnMouseLeaveInternal();
+			void OnMouseDownInternal(MouseButton button, POINT point);
+			void OnMouseUpInternal(MouseButton button, POINT point);
+#endif
+
+
+
+			//*************** region: event dispatcher helper ***************
+
+			template<typename EventArgs>
+			using EventMethod = void (Control::*)(EventArgs&);
+
+			// Dispatch the event.
+			// 
+			// This will invoke the "event_method" of the control and its parent and parent's
+			// parent ... (until "last_receiver" if it's not nullptr) with appropriate args.
+			//
+			// Args is of type "EventArgs". The first init argument is "sender", which is
+			// automatically bound to each receiving control. The second init argument is
+			// "original_sender", which is unchanged. And "args" will be perfectly forwarded
+			// as the rest arguments.
+			template<typename EventArgs, typename... Args>
+			void DispatchEvent(Control* original_sender, EventMethod<EventArgs> event_method, Control* last_receiver, Args&&... args)
+			{
+				auto control = original_sender;
+				while (control != nullptr && control != last_receiver)
+				{
+					EventArgs event_args(control, original_sender, std::forward<Args>(args)...);
+					(control->*event_method)(event_args);
+					control = control->GetParent();
+				}
+			}
+
+		private:
+			std::unique_ptr<WindowLayoutManager> layout_manager_;
+
+#ifdef CRU_HEADLESS
+			Size client_size_ = Size::zero;
+#else
+			HWND hwnd_ = nullptr;
+			std::shared_ptr<graph::WindowRenderTarget> render_target_{};
+#endif
+
+			//Controls in paint order, the topmost last.
+			std::vector<Control*> control_list_{};
+			//World bounds of the controls in "control_list_", containing every
+			//point inside them. Any damage makes them invalid.
+			std::vector<Rect> hit_test_bounds_{};
+			bool is_hit_test_bounds_invalid_ = true;
+
+			DamageTracker damage_tracker_;
+			//Controls whose bounds are damaged after the next layout.
+			std::unordered_set<Control*> damaged_controls_{};
+			//Damage is presented as at most this count of rects.
+			int max_paint_rect_count_ = 8;
+
+			LayerCache layer_cache_{ default_layer_cache_budget };
+
+			HitTestStatistics last_hit_test_statistics_{};
+			DrawStatistics current_draw_statistics_{};
+			DrawStatistics last_draw_statistics_{};
+
+			Control* mouse_hover_control_ = nullptr;
+
+#ifndef CRU_HEADLESS
+			bool window_focus_ = false;
+#endif
+			Control* focus_control_ = this; // "focus_control_" can't be nullptr
+		};
+	}
+}
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "timing.h"
+#include "ui/constraint/constraint_solver.h"
+
+// Boxes in a row filling the width of a window, which is resized by a few
+// dips a step as dragging its border does. Every box has a required minimum,
+// a medium constraint to be as wide as the first and a weak preferred width,
+// so a system of 4 constraints a box. Counters give the solve time and the
+// pivots of a step, which show that a step is incremental.
+
+using namespace cru::ui::constraint;
+using cru::benchmarks::GetSecondsSince;
+
+class BoxRow
+{
+public:
+    explicit BoxRow(const int box_count)
+        : lefts_(box_count), widths_(box_count)
+    {
+        std::mt19937 random(1);
+        std::uniform_int_distribution<int> length(1, 25);
+        solver_.AddConstraint(lefts_[0] == 0.0);
+        for (auto i = 0; i < box_count; i++)
+        {
+            if (i > 0)
+            {
+                solver_.AddConstraint(lefts_[i] == lefts_[i - 1] + widths_[i - 1]);
+                solver_.AddConstraint(widths_[i] == widths_[0] | strength::medium);
+            }
+            solver_.AddConstraint(widths_[i] >= static_cast<double>(length(random) * 2));
+            solver_.AddConstraint(widths_[i] == static_cast<double>(length(random) * 8) | strength::weak);
+        }
+        solver_.AddConstraint(lefts_.back() + widths_.back() == width_);
+        solver_.AddEditVariable(width_, strength::strong);
+    }
+
+    Solver& GetSolver()
+    {
+        return solver_;
+    }
+
+    const Variable& GetWidth() const
+    {
+        return width_;
+    }
+
+private:
+    Solver solver_;
+    Variable width_;
+    std::vector<Variable> lefts_;
+    std::vector<Variable> widths_;
+};
+
+// Suggest the width of a step and write the solution to the variables.
+void BM_ResizeStep(benchmark::State& state)
+{
+    BoxRow row(static_cast<int>(state.range(0)));
+    auto& solver = row.GetSolver();
+    // the first suggestion moves every box, so it isn't a step.
+    solver.SuggestValue(row.GetWidth(), 32.0 * static_cast<double>(state.range(0)));
+    solver.UpdateVariables();
+    const auto start_pivot_count = solver.GetPivotCount();
+    auto seconds = 0.0;
+    auto step = 0;
+    for (auto _ : state)
+    {
+        // the minimums are 26 dips on average, so they all fit.
+        const auto width = 32.0 * static_cast<double>(state.range(0)) + static_cast<double>(step++ % 64) * 8.0;
+        const auto start = std::chrono::steady_clock::now();
+        solver.SuggestValue(row.GetWidth(), width);
+        solver.UpdateVariables();
+        const auto iteration_seconds = GetSecondsSince(start);
+        state.SetIterationTime(iteration_seconds);
+        seconds += iteration_seconds;
+    }
+    const auto iteration_count = static_cast<double>(state.iterations());
+    state.counters["constraints"] = solver.GetConstraintCount();
+    state.counters["us_per_step"] = seconds * 1e6 / iteration_count;
+    state.counters["pivots_per_step"] = static_cast<double>(solver.GetPivotCount() - start_pivot_count) / iteration_count;
+}
+
+// Building the system from scratch, to compare a step with.
+void BM_Build(benchmark::State& state)
+{
+    std::int64_t pivot_count = 0;
+    for (auto _ : state)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        BoxRow row(static_cast<int>(state.range(0)));
+        row.GetSolver().SuggestValue(row.GetWidth(), 32.0 * static_cast<double>(state.range(0)));
+        row.GetSolver().UpdateVariables();
+        state.SetIterationTime(GetSecondsSince(start));
+        pivot_count += row.GetSolver().GetPivotCount();
+    }
+    state.counters["pivots"] = static_cast<double>(pivot_count) / static_cast<double>(state.iterations());
+}
+
+BENCHMARK(BM_ResizeStep)->Arg(64)->Arg(256)->Arg(1024)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Build)->Arg(64)->Arg(256)->Arg(1024)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,209 @@
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "synthetic_tree.h"
+#include "timing.h"
+#include "graph/display_list.h"
+#include "ui/window.h"
+
+// A canvas about a hundred times the area of the window, filled with 10^4
+// to 10^6 controls, scrolled so about 1% of them are in view. Controls are
+// children of the canvas directly, or of a control per row, which lets a
+// whole row out of view be culled at once. Frames are drawn into a display
+// list, so the time is walking, culling and recording the controls rather
+// than filling pixels.
+
+using namespace cru::benchmarks;
+using namespace cru::ui;
+
+const Size client_size(1280.0f, 720.0f);
+constexpr float canvas_to_window_area = 100.0f;
+
+enum class CanvasShape
+{
+    Flat,
+    Rows
+};
+
+//A control placing its children at given rects, as a canvas does.
+class CanvasControl : public Control
+{
+public:
+    explicit CanvasControl(const Size& size)
+        : size_(size)
+    {
+
+    }
+
+    void AddChildAt(Control* child, const Rect& rect)
+    {
+        AddChild(child);
+        rects_.push_back(rect);
+    }
+
+protected:
+    Size OnMeasure(const Size& available_size) override
+    {
+        MeasureChildren(size_);
+        return size_;
+    }
+
+    void OnLayout(const Rect& rect) override
+    {
+        const auto& children = GetInternalChildren();
+        for (decltype(children.size()) i = 0; i < children.size(); i++)
+            children[i]->Layout(rects_[i]);
+    }
+
+private:
+    Size size_;
+    std::vector<Rect> rects_;
+};
+
+//A cell filling its rect, so every control in view paints.
+class CellControl : public Control
+{
+public:
+    CellControl() = default;
+
+protected:
+    void OnDraw(cru::graph::Painter& painter) override
+    {
+        painter.FillRectangle(Rect(Point::zero, GetSize()), cru::graph::Color(0.2f, 0.4f, 0.8f));
+    }
+};
+
+class ScrolledCanvas
+{
+public:
+    ScrolledCanvas(const CanvasShape shape, const int control_count)
+    {
+        const auto canvas_length = std::sqrt(client_size.width * client_size.height * canvas_to_window_area);
+        const auto column_count = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(control_count))));
+        const auto row_count = (control_count + column_count - 1) / column_count;
+        const auto cell_length = canvas_length / static_cast<float>(column_count);
+        const auto cell_size = Size(cell_length * 0.8f, cell_length * 0.8f);
+
+        canvas_ = std::make_unique<CanvasControl>(Size(canvas_length, cell_length * static_cast<float>(row_count)));
+        // children are added while the canvas has no window, so no add walks up.
+        for (auto row = 0; row < row_count; row++)
+        {
+            auto parent = canvas_.get();
+            auto top = static_cast<float>(row) * cell_length;
+            if (shape == CanvasShape::Rows)
+            {
+                rows_.push_back(std::make_unique<CanvasControl>(Size(canvas_length, cell_length)));
+                canvas_->AddChildAt(rows_.back().get(), Rect(0.0f, top, canvas_length, cell_length));
+                parent = rows_.back().get();
+                top = 0.0f;
+            }
+            for (auto column = 0; column < column_count && static_cast<int>(cells_.size()) < control_count; column++)
+            {
+                cells_.push_back(std::make_unique<CellControl>());
+                parent->AddChildAt(cells_.back().get(), Rect(Point(static_cast<float>(column) * cell_length, top), cell_size));
+            }
+        }
+
+        window_.SetClientSize(client_size);
+        window_.AddChild(canvas_.get());
+        ScrollTo(Point::zero);
+    }
+
+    Window* GetWindow()
+    {
+        return &window_;
+    }
+
+    //Scroll the canvas, as a fraction of the room it scrolls in.
+    void ScrollTo(const Point& fraction)
+    {
+        const auto canvas_size = canvas_->GetDesiredSize();
+        canvas_->SetTransform(Matrix::Translation(
+            -fraction.x * std::max(0.0f, canvas_size.width - client_size.width),
+            -fraction.y * std::max(0.0f, canvas_size.height - client_size.height)));
+    }
+
+private:
+    Window window_;
+    std::unique_ptr<CanvasControl> canvas_;
+    std::vector<std::unique_ptr<CanvasControl>> rows_;
+    std::vector<std::unique_ptr<CellControl>> cells_;
+};
+
+ScrolledCanvas& GetCanvasHelperFunc(const CanvasShape shape, const int control_count)
+{
+    static std::unique_ptr<ScrolledCanvas> canvas;
+    static CanvasShape canvas_shape;
+    static int canvas_control_count = 0;
+    if (canvas == nullptr || canvas_shape != shape || canvas_control_count != control_count)
+    {
+        canvas = nullptr;
+        canvas = std::make_unique<ScrolledCanvas>(shape, control_count);
+        canvas_shape = shape;
+        canvas_control_count = control_count;
+    }
+    return *canvas;
+}
+
+void SetDrawCountersHelperFunc(benchmark::State& state, Window* window)
+{
+    const auto& statistics = window->GetLastDrawStatistics();
+    state.counters["drawn"] = statistics.drawn_count;
+    state.counters["culled_subtrees"] = statistics.culled_subtree_count;
+    state.counters["drawn_percent"] = 100.0 * statistics.drawn_count / static_cast<double>(state.range(0));
+}
+
+// A frame at a fixed scroll offset in the middle of the canvas: only the
+// drawing, as the layout and position cache stay valid.
+void BM_DrawScrolledCanvas(benchmark::State& state, const CanvasShape shape)
+{
+    auto& canvas = GetCanvasHelperFunc(shape, static_cast<int>(state.range(0)));
+    const auto window = canvas.GetWindow();
+    canvas.ScrollTo(Point(0.5f, 0.5f));
+    cru::graph::DisplayList painter;
+    window->Render(painter);
+    for (auto _ : state)
+    {
+        painter.Clear();
+        window->Render(painter);
+        state.SetIterationTime(window->GetLastDrawStatistics().seconds);
+    }
+    SetDrawCountersHelperFunc(state, window);
+    state.SetComplexityN(state.range(0));
+}
+
+// Frames scrolling down the canvas, which moves every control, so the
+// position cache of the canvas is refreshed before drawing.
+void BM_ScrollCanvas(benchmark::State& state, const CanvasShape shape)
+{
+    auto& canvas = GetCanvasHelperFunc(shape, static_cast<int>(state.range(0)));
+    const auto window = canvas.GetWindow();
+    cru::graph::DisplayList painter;
+    auto step = 0;
+    for (auto _ : state)
+    {
+        painter.Clear();
+        canvas.ScrollTo(Point(0.5f, static_cast<float>(step++ % 100) / 100.0f));
+        const auto start = std::chrono::steady_clock::now();
+        window->Render(painter);
+        state.SetIterationTime(GetSecondsSince(start));
+    }
+    SetDrawCountersHelperFunc(state, window);
+    state.SetComplexityN(state.range(0));
+}
+
+#define CRU_CULLING_BENCHMARK(function) \
+    BENCHMARK_CAPTURE(function, flat, CanvasShape::Flat)->RangeMultiplier(10)->Range(10000, 1000000)->UseManualTime()->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond); \
+    BENCHMARK_CAPTURE(function, rows, CanvasShape::Rows)->RangeMultiplier(10)->Range(10000, 1000000)->UseManualTime()->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond)
+
+CRU_CULLING_BENCHMARK(BM_DrawScrolledCanvas);
+CRU_CULLING_BENCHMARK(BM_ScrollCanvas);
+
+int main(int argc, char** argv)
+{
+    return RunBenchmarksWithLargeStack(argc, argv);
+}
@@ -0,0 +1,109 @@
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "synthetic_tree.h"
+#include "timing.h"
+#include "ui/window.h"
+#include "ui/controls/flex_panel.h"
+
+// A flex panel of 10^4 children, a tenth of them clamped by a min or max
+// width, growing or shrinking with every step of resizing the window, with
+// and without wrapping.
+
+using namespace cru::benchmarks;
+using namespace cru::ui;
+using namespace cru::ui::controls;
+
+constexpr int child_count = 10000;
+
+class FlexPanelFixture
+{
+public:
+    explicit FlexPanelFixture(const FlexWrap wrap)
+        : panel_(Orientation::Horizontal, wrap)
+    {
+        std::mt19937 random(1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<int> length(1, 25);
+        for (auto i = 0; i < child_count; i++)
+        {
+            auto layout_params = std::make_shared<FlexLayoutParams>();
+            layout_params->size.width = MeasureLength(static_cast<float>(length(random) * 8));
+            layout_params->size.height = MeasureLength(static_cast<float>(length(random) * 8));
+            layout_params->grow = static_cast<float>(percent(random) % 3);
+            layout_params->shrink = static_cast<float>(percent(random) % 3);
+            if (percent(random) < 5)
+                layout_params->min_size.width = 64.0f;
+            else if (percent(random) < 5)
+                layout_params->max_size.width = 96.0f;
+            children_.push_back(std::make_unique<SyntheticControl>(0));
+            children_.back()->SetLayoutParams(layout_params);
+            panel_.AddChild(children_.back().get());
+        }
+        window_.SetClientSize(Size(1280.0f, 720.0f));
+        window_.AddChild(&panel_);
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    }
+
+    Window* GetWindow()
+    {
+        return &window_;
+    }
+
+    const std::vector<std::unique_ptr<SyntheticControl>>& GetChildren() const
+    {
+        return children_;
+    }
+
+private:
+    Window window_;
+    FlexPanel panel_;
+    std::vector<std::unique_ptr<SyntheticControl>> children_;
+};
+
+// Every child changed, so all are measured, broken into lines and flexed.
+void BM_FlexFullLayout(benchmark::State& state, const FlexWrap wrap)
+{
+    FlexPanelFixture fixture(wrap);
+    const auto layout_manager = fixture.GetWindow()->GetLayoutManager();
+    auto seconds = 0.0;
+    for (auto _ : state)
+    {
+        for (const auto& child : fixture.GetChildren())
+            child->InvalidateMeasure();
+        const auto start = std::chrono::steady_clock::now();
+        layout_manager->RefreshInvalidControlLayout();
+        const auto iteration_seconds = GetSecondsSince(start);
+        state.SetIterationTime(iteration_seconds);
+        seconds += iteration_seconds;
+    }
+    state.counters["ns_per_child"] = seconds * 1e9 / (static_cast<double>(child_count) * static_cast<double>(state.iterations()));
+}
+
+// The window is resized by a few dips a step, as dragging its border does,
+// so the lines are resolved again and flexed children measured again.
+void BM_FlexResize(benchmark::State& state, const FlexWrap wrap)
+{
+    FlexPanelFixture fixture(wrap);
+    const auto window = fixture.GetWindow();
+    auto step = 0;
+    for (auto _ : state)
+    {
+        window->SetClientSize(Size(1000.0f + static_cast<float>(step++ % 64) * 8.0f, 720.0f));
+        const auto start = std::chrono::steady_clock::now();
+        window->GetLayoutManager()->RefreshInvalidControlLayout();
+        state.SetIterationTime(GetSecondsSince(start));
+    }
+    state.counters["measured"] = window->GetLayoutManager()->GetLastLayoutPassStatistics().measure_count;
+}
+
+BENCHMARK_CAPTURE(BM_FlexFullLayout, nowrap, FlexWrap::NoWrap)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_FlexFullLayout, wrap, FlexWrap::Wrap)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_FlexResize, nowrap, FlexWrap::NoWrap)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_FlexResize, wrap, FlexWrap::Wrap)->UseManualTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "ui/geometry_kernels.h"
+
+// The batch geometry kernels over 10^3 to 10^6 elements. It is built twice,
+// as geometry_benchmark with the kernels of the target and as
+// geometry_benchmark_scalar with "CRU_GEOMETRY_SCALAR", and the label names
+// the instruction set, so the two runs compare vector with scalar code.
+
+using namespace cru::ui;
+
+constexpr int min_count = 1000;
+constexpr int max_count = 1000000;
+
+std::vector<Rect> MakeRectsHelperFunc(const int count, const unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(0.0f, 4000.0f);
+    std::uniform_real_distribution<float> length(0.0f, 400.0f);
+    std::vector<Rect> rects;
+    rects.reserve(count);
+    for (auto i = 0; i < count; i++)
+        rects.emplace_back(position(random), position(random), length(random), length(random));
+    return rects;
+}
+
+std::vector<Point> MakePointsHelperFunc(const int count)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(0.0f, 4000.0f);
+    std::vector<Point> points;
+    points.reserve(count);
+    for (auto i = 0; i < count; i++)
+        points.emplace_back(position(random), position(random));
+    return points;
+}
+
+void SetItemsHelperFunc(benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(geometry::GetKernelInstructionSet());
+}
+
+void BM_TranslatePoints(benchmark::State& state)
+{
+    auto points = MakePointsHelperFunc(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+    {
+        geometry::TranslatePoints(points.data(), static_cast<int>(points.size()), Point(0.5f, -0.5f));
+        benchmark::ClobberMemory();
+    }
+    SetItemsHelperFunc(state);
+}
+
+void BM_TransformPoints(benchmark::State& state)
+{
+    const auto source = MakePointsHelperFunc(static_cast<int>(state.range(0)));
+    std::vector<Point> destination(source.size());
+    const auto matrix = Matrix::Rotation(30.0f, Point(100.0f, 100.0f)) * Matrix::Scale(1.5f, 1.5f);
+    for (auto _ : state)
+    {
+        geometry::TransformPoints(source.data(), destination.data(), static_cast<int>(source.size()), matrix);
+        benchmark::ClobberMemory();
+    }
+    SetItemsHelperFunc(state);
+}
+
+void BM_IntersectRects(benchmark::State& state)
+{
+    const auto left = MakeRectsHelperFunc(static_cast<int>(state.range(0)), 1);
+    const auto right = MakeRectsHelperFunc(static_cast<int>(state.range(0)), 2);
+    std::vector<Rect> result(left.size());
+    for (auto _ : state)
+    {
+        geometry::IntersectRects(left.data(), right.data(), result.data(), static_cast<int>(left.size()));
+        benchmark::ClobberMemory();
+    }
+    SetItemsHelperFunc(state);
+}
+
+void BM_UnionRects(benchmark::State& state)
+{
+    const auto left = MakeRectsHelperFunc(static_cast<int>(state.range(0)), 1);
+    const auto right = MakeRectsHelperFunc(static_cast<int>(state.range(0)), 2);
+    std::vector<Rect> result(left.size());
+    for (auto _ : state)
+    {
+        geometry::UnionRects(left.data(), right.data(), result.data(), static_cast<int>(left.size()));
+        benchmark::ClobberMemory();
+    }
+    SetItemsHelperFunc(state);
+}
+
+void BM_GetBounds(benchmark::State& state)
+{
+    const auto rects = MakeRectsHelperFunc(static_cast<int>(state.range(0)), 1);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(geometry::GetBounds(rects.data(), static_cast<int>(rects.size())));
+    SetItemsHelperFunc(state);
+}
+
+void BM_ContainsPoint(benchmark::State& state)
+{
+    const auto rects = MakeRectsHelperFunc(static_cast<int>(state.range(0)), 1);
+    std::vector<std::uint8_t> result(rects.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(geometry::ContainsPoint(rects.data(), static_cast<int>(rects.size()), Point(2000.0f, 2000.0f), result.data()));
+        benchmark::ClobberMemory();
+    }
+    SetItemsHelperFunc(state);
+}
+
+// a point outside every rect makes it scan all of them, as a miss does.
+void BM_FindLastContaining(benchmark::State& state)
+{
+    const auto rects = MakeRectsHelperFunc(static_cast<int>(state.range(0)), 1);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(geometry::FindLastContaining(rects.data(), static_cast<int>(rects.size()), Point(-1.0f, -1.0f)));
+    SetItemsHelperFunc(state);
+}
+
+BENCHMARK(BM_TranslatePoints)->RangeMultiplier(10)->Range(min_count, max_count);
+BENCHMARK(BM_TransformPoints)->RangeMultiplier(10)->Range(min_count, max_count);
+BENCHMARK(BM_IntersectRects)->RangeMultiplier(10)->Range(min_count, max_count);
+BENCHMARK(BM_UnionRects)->RangeMultiplier(10)->Range(min_count, max_count);
+BENCHMARK(BM_GetBounds)->RangeMultiplier(10)->Range(min_count, max_count);
+BENCHMARK(BM_ContainsPoint)->RangeMultiplier(10)->Range(min_count, max_count);
+BENCHMARK(BM_FindLastContaining)->RangeMultiplier(10)->Range(min_count, max_count);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,186 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "synthetic_tree.h"
+#include "timing.h"
+#include "ui/window.h"
+#include "ui/controls/grid.h"
+
+// A grid of 1000 auto rows and 50 columns, a cell each, as a table does:
+// the columns are auto, fixed and star, and a few cells span two columns.
+// Counters give the cells measured and the tracks recomputed by a pass, which
+// show that a changed cell only recomputes its own tracks, and the controls
+// whose rect changed. The grid still visits every cell to arrange it.
+
+using namespace cru::benchmarks;
+using namespace cru::ui;
+using namespace cru::ui::controls;
+
+constexpr int row_count = 1000;
+constexpr int column_count = 50;
+
+class GridFixture
+{
+public:
+    GridFixture()
+    {
+        std::vector<GridLength> rows(row_count, GridLength::Auto());
+        std::vector<GridLength> columns;
+        for (auto column = 0; column < column_count; column++)
+        {
+            if (column % 5 == 0)
+                columns.push_back(GridLength::Fixed(64.0f));
+            else if (column % 5 == 1)
+                columns.push_back(GridLength::Star());
+            else
+                columns.push_back(GridLength::Auto());
+        }
+        grid_.SetRows(std::move(rows));
+        grid_.SetColumns(std::move(columns));
+
+        std::mt19937 random(1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<int> length(1, 25);
+        for (auto row = 0; row < row_count; row++)
+            for (auto column = 0; column < column_count; column++)
+            {
+                auto layout_params = std::make_shared<GridLayoutParams>();
+                layout_params->row = row;
+                layout_params->column = column;
+                if (column + 1 < column_count && percent(random) < 2)
+                    layout_params->column_span = 2;
+                layout_params->size.width = MeasureLength(static_cast<float>(length(random) * 4));
+                layout_params->size.height = MeasureLength(static_cast<float>(length(random)));
+                cells_.push_back(std::make_unique<SyntheticControl>(0));
+                cells_.back()->SetLayoutParams(layout_params);
+                grid_.AddChild(cells_.back().get());
+                column += layout_params->column_span - 1;
+            }
+        window_.SetClientSize(Size(1920.0f, 1080.0f));
+        window_.AddChild(&grid_);
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    }
+
+    Window* GetWindow()
+    {
+        return &window_;
+    }
+
+    Grid* GetGrid()
+    {
+        return &grid_;
+    }
+
+    const std::vector<std::unique_ptr<SyntheticControl>>& GetCells() const
+    {
+        return cells_;
+    }
+
+private:
+    Window window_;
+    Grid grid_;
+    std::vector<std::unique_ptr<SyntheticControl>> cells_;
+};
+
+// the grid is large, so it is built once for all benchmarks.
+GridFixture& GetFixtureHelperFunc()
+{
+    static GridFixture fixture;
+    return fixture;
+}
+
+void SetGridCountersHelperFunc(benchmark::State& state, Window* window, const std::int64_t measured_cell_count, const std::int64_t resolved_track_count)
+{
+    const auto iteration_count = static_cast<double>(state.iterations());
+    state.counters["cells_measured"] = static_cast<double>(measured_cell_count) / iteration_count;
+    state.counters["tracks_resolved"] = static_cast<double>(resolved_track_count) / iteration_count;
+    state.counters["arranged"] = window->GetLayoutManager()->GetLastLayoutPassStatistics().layout_count;
+}
+
+// Every cell changed, so all are measured and every track is solved again.
+void BM_GridFullLayout(benchmark::State& state)
+{
+    auto& fixture = GetFixtureHelperFunc();
+    const auto layout_manager = fixture.GetWindow()->GetLayoutManager();
+    const auto grid = fixture.GetGrid();
+    auto seconds = 0.0;
+    std::int64_t measured_cell_count = 0;
+    std::int64_t resolved_track_count = 0;
+    for (auto _ : state)
+    {
+        for (const auto& cell : fixture.GetCells())
+            cell->InvalidateMeasure();
+        const auto start = std::chrono::steady_clock::now();
+        layout_manager->RefreshInvalidControlLayout();
+        const auto iteration_seconds = GetSecondsSince(start);
+        state.SetIterationTime(iteration_seconds);
+        seconds += iteration_seconds;
+        measured_cell_count += grid->GetLastMeasuredCellCount();
+        resolved_track_count += grid->GetLastResolvedTrackCount();
+    }
+    SetGridCountersHelperFunc(state, fixture.GetWindow(), measured_cell_count, resolved_track_count);
+    state.counters["ns_per_cell"] = seconds * 1e9 / (static_cast<double>(fixture.GetCells().size()) * static_cast<double>(state.iterations()));
+}
+
+// One random cell changed its size, as editing the text of a cell does.
+void BM_GridCellChange(benchmark::State& state)
+{
+    auto& fixture = GetFixtureHelperFunc();
+    const auto layout_manager = fixture.GetWindow()->GetLayoutManager();
+    const auto grid = fixture.GetGrid();
+    const auto& cells = fixture.GetCells();
+    std::mt19937 random(1);
+    std::uniform_int_distribution<std::size_t> cell_index(0, cells.size() - 1);
+    std::uniform_int_distribution<int> length(1, 25);
+    std::int64_t measured_cell_count = 0;
+    std::int64_t resolved_track_count = 0;
+    for (auto _ : state)
+    {
+        const auto cell = cells[cell_index(random)].get();
+        auto layout_params = std::make_shared<GridLayoutParams>(*cell->GetLayoutParams<GridLayoutParams>());
+        layout_params->size.width = MeasureLength(static_cast<float>(length(random) * 4));
+        cell->SetLayoutParams(layout_params);
+        const auto start = std::chrono::steady_clock::now();
+        layout_manager->RefreshInvalidControlLayout();
+        state.SetIterationTime(GetSecondsSince(start));
+        measured_cell_count += grid->GetLastMeasuredCellCount();
+        resolved_track_count += grid->GetLastResolvedTrackCount();
+    }
+    SetGridCountersHelperFunc(state, fixture.GetWindow(), measured_cell_count, resolved_track_count);
+}
+
+// The window is resized by a few dips a step, so star columns change and
+// the cells after the first are moved.
+void BM_GridResize(benchmark::State& state)
+{
+    auto& fixture = GetFixtureHelperFunc();
+    const auto window = fixture.GetWindow();
+    const auto grid = fixture.GetGrid();
+    auto step = 0;
+    std::int64_t measured_cell_count = 0;
+    std::int64_t resolved_track_count = 0;
+    for (auto _ : state)
+    {
+        window->SetClientSize(Size(1600.0f + static_cast<float>(step++ % 64) * 8.0f, 1080.0f));
+        const auto start = std::chrono::steady_clock::now();
+        window->GetLayoutManager()->RefreshInvalidControlLayout();
+        state.SetIterationTime(GetSecondsSince(start));
+        measured_cell_count += grid->GetLastMeasuredCellCount();
+        resolved_track_count += grid->GetLastResolvedTrackCount();
+    }
+    SetGridCountersHelperFunc(state, fixture.GetWindow(), measured_cell_count, resolved_track_count);
+}
+
+BENCHMARK(BM_GridFullLayout)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GridCellChange)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GridResize)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+    return RunBenchmarksWithLargeStack(argc, argv);
+}
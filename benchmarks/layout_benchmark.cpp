@@ -0,0 +1,147 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "synthetic_tree.h"
+#include "timing.h"
+
+// Layout of generated trees of 10^2 to 10^6 controls: measure and arrange
+// of every control, of the path of one control, the position cache refresh
+// and hit testing. Counters give the cost per control touched, and the
+// complexity fit over the sizes gives the scaling curve.
+
+using namespace cru::benchmarks;
+using cru::ui::Point;
+
+constexpr int min_control_count = 100;
+constexpr int max_control_count = 1000000;
+
+// trees are large, so the last one is kept for the benchmarks after it.
+SyntheticTree& GetTreeHelperFunc(const TreeShape shape, const int control_count)
+{
+    static std::unique_ptr<SyntheticTree> tree;
+    static TreeShape tree_shape;
+    if (tree == nullptr || tree_shape != shape || tree->GetControlCount() != control_count)
+    {
+        tree = nullptr;
+        SyntheticTreeOptions options;
+        options.shape = shape;
+        options.control_count = control_count;
+        tree = std::make_unique<SyntheticTree>(options);
+        tree_shape = shape;
+    }
+    return *tree;
+}
+
+// Every leaf changed, so every control whose size may change is measured
+// and arranged again.
+void BM_FullLayout(benchmark::State& state, const TreeShape shape)
+{
+    auto& tree = GetTreeHelperFunc(shape, static_cast<int>(state.range(0)));
+    const auto layout_manager = tree.GetWindow()->GetLayoutManager();
+    auto measure_seconds = 0.0;
+    auto layout_seconds = 0.0;
+    std::int64_t measure_count = 0;
+    std::int64_t layout_count = 0;
+    for (auto _ : state)
+    {
+        tree.InvalidateLeaves();
+        const auto start = std::chrono::steady_clock::now();
+        layout_manager->RefreshInvalidControlLayout();
+        state.SetIterationTime(GetSecondsSince(start));
+
+        const auto& statistics = layout_manager->GetLastLayoutPassStatistics();
+        measure_seconds += statistics.measure_seconds;
+        layout_seconds += statistics.layout_seconds;
+        measure_count += statistics.measure_count;
+        layout_count += statistics.layout_count;
+    }
+    state.counters["measured"] = static_cast<double>(measure_count) / static_cast<double>(state.iterations());
+    state.counters["measure_ns_per_control"] = measure_seconds * 1e9 / static_cast<double>(measure_count);
+    state.counters["arrange_ns_per_control"] = layout_seconds * 1e9 / static_cast<double>(layout_count);
+    state.SetComplexityN(state.range(0));
+}
+
+// One random leaf changed, so only its path is measured and arranged.
+void BM_IncrementalLayout(benchmark::State& state, const TreeShape shape)
+{
+    auto& tree = GetTreeHelperFunc(shape, static_cast<int>(state.range(0)));
+    const auto layout_manager = tree.GetWindow()->GetLayoutManager();
+    const auto& leaves = tree.GetLeaves();
+    std::mt19937 random(1);
+    std::uniform_int_distribution<std::size_t> leaf_index(0, leaves.size() - 1);
+    std::int64_t measure_count = 0;
+    for (auto _ : state)
+    {
+        leaves[leaf_index(random)]->InvalidateMeasure();
+        const auto start = std::chrono::steady_clock::now();
+        layout_manager->RefreshInvalidControlLayout();
+        state.SetIterationTime(GetSecondsSince(start));
+        measure_count += layout_manager->GetLastLayoutPassStatistics().measure_count;
+    }
+    state.counters["measured"] = static_cast<double>(measure_count) / static_cast<double>(state.iterations());
+    state.SetComplexityN(state.range(0));
+}
+
+// The root moved, so the cache of every control is recalculated.
+void BM_PositionCacheRefresh(benchmark::State& state, const TreeShape shape)
+{
+    auto& tree = GetTreeHelperFunc(shape, static_cast<int>(state.range(0)));
+    const auto layout_manager = tree.GetWindow()->GetLayoutManager();
+    auto seconds = 0.0;
+    std::int64_t refresh_count = 0;
+    for (auto _ : state)
+    {
+        layout_manager->InvalidateControlPositionCache(tree.GetRoot());
+        const auto start = std::chrono::steady_clock::now();
+        layout_manager->RefreshInvalidControlPositionCache();
+        state.SetIterationTime(GetSecondsSince(start));
+
+        const auto& statistics = layout_manager->GetLastPositionCacheStatistics();
+        seconds += statistics.seconds;
+        refresh_count += statistics.refresh_count;
+    }
+    state.counters["ns_per_control"] = seconds * 1e9 / static_cast<double>(refresh_count);
+    state.SetComplexityN(state.range(0));
+}
+
+// Hit tests at random points of the client area.
+void BM_HitTest(benchmark::State& state, const TreeShape shape)
+{
+    auto& tree = GetTreeHelperFunc(shape, static_cast<int>(state.range(0)));
+    const auto window = tree.GetWindow();
+    const auto client_size = window->GetClientSize();
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> x(0.0f, client_size.width);
+    std::uniform_real_distribution<float> y(0.0f, client_size.height);
+    std::int64_t visit_count = 0;
+    for (auto _ : state)
+    {
+        const Point point(x(random), y(random));
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(window->HitTest(point));
+        state.SetIterationTime(GetSecondsSince(start));
+        visit_count += window->GetLastHitTestStatistics().visit_count;
+    }
+    state.counters["visited"] = static_cast<double>(visit_count) / static_cast<double>(state.iterations());
+    state.SetComplexityN(state.range(0));
+}
+
+#define CRU_LAYOUT_BENCHMARK(function) \
+    BENCHMARK_CAPTURE(function, deep, TreeShape::Deep)->RangeMultiplier(10)->Range(min_control_count, max_control_count)->UseManualTime()->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond); \
+    BENCHMARK_CAPTURE(function, wide, TreeShape::Wide)->RangeMultiplier(10)->Range(min_control_count, max_control_count)->UseManualTime()->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond); \
+    BENCHMARK_CAPTURE(function, grid, TreeShape::Grid)->RangeMultiplier(10)->Range(min_control_count, max_control_count)->UseManualTime()->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond); \
+    BENCHMARK_CAPTURE(function, random, TreeShape::Random)->RangeMultiplier(10)->Range(min_control_count, max_control_count)->UseManualTime()->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond)
+
+CRU_LAYOUT_BENCHMARK(BM_FullLayout);
+CRU_LAYOUT_BENCHMARK(BM_IncrementalLayout);
+CRU_LAYOUT_BENCHMARK(BM_PositionCacheRefresh);
+CRU_LAYOUT_BENCHMARK(BM_HitTest);
+
+int main(int argc, char** argv)
+{
+    return RunBenchmarksWithLargeStack(argc, argv);
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "timing.h"
+#include "graph/line_break.h"
+
+// Line breaking of a text of about a megabyte: English prose, which the
+// vector loop skips in runs of letters, Chinese, which is looked up a code
+// unit at a time, and a mix of both with numbers and punctuation. Bytes are
+// the ones of the code units, so wchar_t of 2 or 4 bytes. Edits of the text
+// update the breaks around them only, and the counter gives the code units
+// scanned by an edit.
+
+using namespace cru;
+using namespace cru::graph;
+using cru::benchmarks::GetSecondsSince;
+
+enum class TextKind
+{
+    English,
+    Chinese,
+    Mixed
+};
+
+constexpr int text_length = 1 << 18;
+
+String MakeTextHelperFunc(const TextKind kind)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> word_length(1, 10);
+    std::uniform_int_distribution<int> letter(L'a', L'z');
+    std::uniform_int_distribution<int> ideograph(0x4E00, 0x9FFF);
+    String text;
+    while (static_cast<int>(text.size()) < text_length)
+    {
+        const auto is_chinese = kind == TextKind::Chinese || (kind == TextKind::Mixed && percent(random) < 30);
+        for (auto i = word_length(random); i > 0; i--)
+            text.push_back(static_cast<wchar_t>(is_chinese ? ideograph(random) : letter(random)));
+        const auto separator = percent(random);
+        if (is_chinese)
+            text += separator < 10 ? L"，" : separator < 15 ? L"。" : L"";
+        else if (kind == TextKind::Mixed && separator < 10)
+            text += L" (42.5%) ";
+        else
+            text += separator < 5 ? L".\n" : separator < 15 ? L", " : L" ";
+    }
+    return text;
+}
+
+const String& GetTextHelperFunc(const TextKind kind)
+{
+    static const String texts[] = {
+        MakeTextHelperFunc(TextKind::English),
+        MakeTextHelperFunc(TextKind::Chinese),
+        MakeTextHelperFunc(TextKind::Mixed)
+    };
+    return texts[static_cast<int>(kind)];
+}
+
+void BM_FindLineBreaks(benchmark::State& state, const TextKind kind)
+{
+    const auto& text = GetTextHelperFunc(kind);
+    std::vector<LineBreakKind> breaks;
+    for (auto _ : state)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        FindLineBreaks(text, breaks);
+        state.SetIterationTime(GetSecondsSince(start));
+        benchmark::DoNotOptimize(breaks.data());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(text.size() * sizeof(String::value_type)) * state.iterations());
+}
+
+// A code unit is typed at a random place and removed again, as in an editor.
+void BM_UpdateLineBreaks(benchmark::State& state, const TextKind kind)
+{
+    auto text = GetTextHelperFunc(kind);
+    std::vector<LineBreakKind> breaks;
+    FindLineBreaks(text, breaks);
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> position(0, static_cast<int>(text.size()));
+    std::int64_t scanned_count = 0;
+    for (auto _ : state)
+    {
+        const auto begin = position(random);
+        text.insert(text.begin() + begin, L'x');
+        auto start = std::chrono::steady_clock::now();
+        scanned_count += UpdateLineBreaks(text, begin, 0, 1, breaks);
+        auto seconds = GetSecondsSince(start);
+
+        text.erase(text.begin() + begin);
+        start = std::chrono::steady_clock::now();
+        scanned_count += UpdateLineBreaks(text, begin, 1, 0, breaks);
+        state.SetIterationTime(seconds + GetSecondsSince(start));
+    }
+    state.counters["scanned_per_edit"] = static_cast<double>(scanned_count) / (2.0 * static_cast<double>(state.iterations()));
+}
+
+BENCHMARK_CAPTURE(BM_FindLineBreaks, english, TextKind::English)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_FindLineBreaks, chinese, TextKind::Chinese)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_FindLineBreaks, mixed, TextKind::Mixed)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_UpdateLineBreaks, english, TextKind::English)->UseManualTime()->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_UpdateLineBreaks, chinese, TextKind::Chinese)->UseManualTime()->Unit(benchmark::kNanosecond);
+BENCHMARK_CAPTURE(BM_UpdateLineBreaks, mixed, TextKind::Mixed)->UseManualTime()->Unit(benchmark::kNanosecond);
+
+BENCHMARK_MAIN();
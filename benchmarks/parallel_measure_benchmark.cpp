@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "synthetic_tree.h"
+#include "timing.h"
+#include "thread_pool.h"
+
+// Full layout of trees of 10^5 controls whose leaves do busy work in
+// measure, as text does, on thread pools of 1 to 32 threads. The speedup
+// counter compares with measuring on the calling thread only, so it needs
+// a machine with at least as many cores as threads to mean anything.
+
+using namespace cru::benchmarks;
+
+constexpr int control_count = 100000;
+constexpr int leaf_measure_work = 200;
+constexpr int parallel_measure_threshold = 1000;
+
+SyntheticTree& GetTreeHelperFunc(const TreeShape shape)
+{
+    static std::unique_ptr<SyntheticTree> tree;
+    static TreeShape tree_shape;
+    if (tree == nullptr || tree_shape != shape)
+    {
+        tree = nullptr;
+        SyntheticTreeOptions options;
+        options.shape = shape;
+        options.control_count = control_count;
+        options.leaf_measure_work = leaf_measure_work;
+        tree = std::make_unique<SyntheticTree>(options);
+        tree_shape = shape;
+    }
+    return *tree;
+}
+
+double MeasureLayoutSecondsHelperFunc(SyntheticTree& tree)
+{
+    tree.InvalidateLeaves();
+    const auto start = std::chrono::steady_clock::now();
+    tree.GetWindow()->GetLayoutManager()->RefreshInvalidControlLayout();
+    return GetSecondsSince(start);
+}
+
+void BM_ParallelMeasure(benchmark::State& state, const TreeShape shape)
+{
+    auto& tree = GetTreeHelperFunc(shape);
+    const auto layout_manager = tree.GetWindow()->GetLayoutManager();
+
+    // the best of a few sequential passes is the base of the speedup.
+    layout_manager->SetThreadPool(nullptr);
+    layout_manager->SetParallelMeasureThreshold(0);
+    auto sequential_seconds = MeasureLayoutSecondsHelperFunc(tree);
+    for (auto i = 0; i < 2; i++)
+        sequential_seconds = std::min(sequential_seconds, MeasureLayoutSecondsHelperFunc(tree));
+
+    cru::ThreadPool thread_pool(static_cast<int>(state.range(0)));
+    layout_manager->SetThreadPool(&thread_pool);
+    layout_manager->SetParallelMeasureThreshold(parallel_measure_threshold);
+    auto seconds = 0.0;
+    for (auto _ : state)
+    {
+        const auto iteration_seconds = MeasureLayoutSecondsHelperFunc(tree);
+        state.SetIterationTime(iteration_seconds);
+        seconds += iteration_seconds;
+    }
+    state.counters["parallel_measures"] = layout_manager->GetLastLayoutPassStatistics().parallel_measure_count;
+    state.counters["speedup"] = sequential_seconds * static_cast<double>(state.iterations()) / seconds;
+
+    layout_manager->SetThreadPool(nullptr);
+    layout_manager->SetParallelMeasureThreshold(0);
+}
+
+#define CRU_PARALLEL_MEASURE_BENCHMARK(name, shape) \
+    BENCHMARK_CAPTURE(BM_ParallelMeasure, name, shape)->ArgName("threads")->RangeMultiplier(2)->Range(1, 32)->UseManualTime()->Unit(benchmark::kMillisecond)
+
+CRU_PARALLEL_MEASURE_BENCHMARK(wide, TreeShape::Wide);
+CRU_PARALLEL_MEASURE_BENCHMARK(grid, TreeShape::Grid);
+CRU_PARALLEL_MEASURE_BENCHMARK(random, TreeShape::Random);
+
+int main(int argc, char** argv)
+{
+    return RunBenchmarksWithLargeStack(argc, argv);
+}
@@ -0,0 +1,141 @@
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "timing.h"
+#include "string_util.h"
+
+// Conversion of a megabyte of utf-8 to strings and back: ASCII, which the
+// vector loop converts 16 bytes at a time, text mostly ASCII with some Latin
+// letters, as source and markup are, and Chinese of three bytes a character.
+// Bytes are the ones of the utf-8. Lookups in a map keyed by interned strings
+// are compared with one keyed by strings.
+
+using namespace cru;
+using cru::benchmarks::GetSecondsSince;
+
+enum class TextKind
+{
+    Ascii,
+    Latin,
+    Chinese
+};
+
+constexpr std::size_t text_size = 1 << 20;
+
+std::string MakeTextHelperFunc(const TextKind kind)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<int> ideograph(0x4E00, 0x9FFF);
+    String text;
+    while (text.size() < text_size / (kind == TextKind::Chinese ? 3 : 1))
+    {
+        if (kind == TextKind::Chinese)
+            text.push_back(static_cast<wchar_t>(ideograph(random)));
+        else if (kind == TextKind::Latin && percent(random) < 5)
+            text.push_back(static_cast<wchar_t>(0xE0 + percent(random) % 0x1F));
+        else
+            text.push_back(static_cast<wchar_t>(percent(random) < 15 ? ' ' : letter(random)));
+    }
+    return StringToUtf8(text);
+}
+
+const std::string& GetTextHelperFunc(const TextKind kind)
+{
+    static const std::string texts[] = {
+        MakeTextHelperFunc(TextKind::Ascii),
+        MakeTextHelperFunc(TextKind::Latin),
+        MakeTextHelperFunc(TextKind::Chinese)
+    };
+    return texts[static_cast<int>(kind)];
+}
+
+void BM_Utf8ToString(benchmark::State& state, const TextKind kind)
+{
+    const auto& text = GetTextHelperFunc(kind);
+    for (auto _ : state)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(Utf8ToString(text));
+        state.SetIterationTime(GetSecondsSince(start));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(text.size()) * state.iterations());
+}
+
+void BM_StringToUtf8(benchmark::State& state, const TextKind kind)
+{
+    const auto& text = GetTextHelperFunc(kind);
+    const auto converted = Utf8ToString(text);
+    for (auto _ : state)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(StringToUtf8(converted));
+        state.SetIterationTime(GetSecondsSince(start));
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(text.size()) * state.iterations());
+}
+
+constexpr int key_count = 256;
+
+// keys share a long prefix, as style keys do, so comparing strings is slow.
+std::vector<String> MakeKeysHelperFunc()
+{
+    std::vector<String> keys;
+    for (auto i = 0; i < key_count; i++)
+        keys.push_back(L"cru.ui.controls.style." + std::to_wstring(i));
+    return keys;
+}
+
+void BM_StringMapLookup(benchmark::State& state)
+{
+    const auto keys = MakeKeysHelperFunc();
+    std::unordered_map<String, int> map;
+    for (auto i = 0; i < key_count; i++)
+        map.emplace(keys[i], i);
+    auto i = 0;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(map.find(keys[i++ % key_count]));
+}
+
+void BM_InternedStringMapLookup(benchmark::State& state)
+{
+    const auto keys = MakeKeysHelperFunc();
+    std::vector<InternedString> interned_keys;
+    std::unordered_map<InternedString, int> map;
+    for (auto i = 0; i < key_count; i++)
+    {
+        interned_keys.emplace_back(keys[i]);
+        map.emplace(interned_keys.back(), i);
+    }
+    auto i = 0;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(map.find(interned_keys[i++ % key_count]));
+}
+
+// interning looks up the table under a lock, so it is done once per key.
+void BM_Intern(benchmark::State& state)
+{
+    const auto keys = MakeKeysHelperFunc();
+    auto i = 0;
+    for (auto _ : state)
+        benchmark::DoNotOptimize(InternedString(keys[i++ % key_count]));
+}
+
+BENCHMARK_CAPTURE(BM_Utf8ToString, ascii, TextKind::Ascii)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Utf8ToString, latin, TextKind::Latin)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Utf8ToString, chinese, TextKind::Chinese)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_StringToUtf8, ascii, TextKind::Ascii)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_StringToUtf8, latin, TextKind::Latin)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_StringToUtf8, chinese, TextKind::Chinese)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_StringMapLookup);
+BENCHMARK(BM_InternedStringMapLookup);
+BENCHMARK(BM_Intern);
+
+BENCHMARK_MAIN();
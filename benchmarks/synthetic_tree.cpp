@@ -0,0 +1,184 @@
+#include "synthetic_tree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <pthread.h>
+#include <benchmark/benchmark.h>
+
+#include "ui/controls/stack_panel.h"
+
+namespace cru
+{
+    namespace benchmarks
+    {
+        using namespace ui;
+
+        const char* GetTreeShapeName(const TreeShape shape)
+        {
+            switch (shape)
+            {
+            case TreeShape::Deep:
+                return "deep";
+            case TreeShape::Wide:
+                return "wide";
+            case TreeShape::Grid:
+                return "grid";
+            default:
+                return "random";
+            }
+        }
+
+        SyntheticControl::SyntheticControl(const int measure_work)
+            : measure_work_(measure_work)
+        {
+
+        }
+
+        Size SyntheticControl::OnMeasure(const Size& available_size)
+        {
+            auto x = 1.0f;
+            for (auto i = 0; i < measure_work_; i++)
+                x = x * 0.999f + 0.5f;
+            work_result_ = x;
+            return Control::OnMeasure(available_size);
+        }
+
+        // lengths are multiples of 8 dips from a small range, so identical
+        // params are common, as they are in real forms.
+        inline MeasureLength MakeMeasureLengthHelperFunc(std::mt19937& random, const bool is_leaf)
+        {
+            const auto percent = std::uniform_int_distribution<int>(0, 99)(random);
+            const auto length = static_cast<float>(std::uniform_int_distribution<int>(1, 25)(random) * 8);
+            if (is_leaf)
+            {
+                if (percent < 50)
+                    return MeasureLength(length, MeasureMode::Exactly);
+                return MeasureLength(0.0f, percent < 80 ? MeasureMode::Content : MeasureMode::Stretch);
+            }
+            if (percent < 20)
+                return MeasureLength(length * 4.0f, MeasureMode::Exactly);
+            return MeasureLength(0.0f, percent < 60 ? MeasureMode::Content : MeasureMode::Stretch);
+        }
+
+        inline BasicLayoutParams MakeLayoutParamsHelperFunc(std::mt19937& random, const bool is_leaf)
+        {
+            BasicLayoutParams params;
+            params.size.width = MakeMeasureLengthHelperFunc(random, is_leaf);
+            params.size.height = MakeMeasureLengthHelperFunc(random, is_leaf);
+            std::uniform_int_distribution<int> percent(0, 99);
+            if (percent(random) < 10)
+                params.min_size = OptionalSize(16.0f, 16.0f);
+            if (percent(random) < 10)
+                params.max_size = OptionalSize(640.0f, 480.0f);
+            return params;
+        }
+
+        SyntheticTree::SyntheticTree(const SyntheticTreeOptions& options, const Size& client_size)
+        {
+            if (options.control_count < 1)
+                throw std::invalid_argument("A tree has at least one control.");
+
+            const auto count = options.control_count;
+            std::mt19937 random(options.seed);
+            // the parent of every control but the root, which comes before it.
+            std::vector<int> parents(count, -1);
+
+            // the grid has a row for about every square root of cells.
+            const auto row_count = options.shape == TreeShape::Grid
+                ? std::min(count - 1, std::max(1, static_cast<int>(std::sqrt(static_cast<double>(count))) - 1))
+                : 0;
+            for (auto i = 1; i < count; i++)
+            {
+                switch (options.shape)
+                {
+                case TreeShape::Deep:
+                    parents[i] = i - 1;
+                    break;
+                case TreeShape::Wide:
+                    parents[i] = 0;
+                    break;
+                case TreeShape::Grid:
+                    parents[i] = i <= row_count ? 0 : 1 + (i - row_count - 1) % row_count;
+                    break;
+                default:
+                    parents[i] = std::uniform_int_distribution<int>(0, i - 1)(random);
+                    break;
+                }
+            }
+
+            std::vector<bool> is_leaf(count, true);
+            for (auto i = 1; i < count; i++)
+                is_leaf[parents[i]] = false;
+
+            for (auto i = 0; i < count; i++)
+            {
+                if (options.shape == TreeShape::Grid && i <= row_count)
+                    controls_.push_back(std::make_unique<controls::StackPanel>(i == 0 ? Orientation::Vertical : Orientation::Horizontal));
+                else
+                    controls_.push_back(std::make_unique<SyntheticControl>(is_leaf[i] ? options.leaf_measure_work : 0));
+            }
+
+            for (auto i = 0; i < count; i++)
+            {
+                if (is_leaf[i])
+                    leaves_.push_back(controls_[i].get());
+                // panels of the grid keep their default params.
+                if (options.shape != TreeShape::Grid || i > row_count)
+                    controls_[i]->SetLayoutParams(MakeLayoutParamsHelperFunc(random, is_leaf[i]));
+            }
+
+            // children are added to parents without parents, last first, so
+            // no add walks up a long path. The order of siblings is reversed.
+            for (auto i = count - 1; i > 0; i--)
+                controls_[parents[i]]->AddChild(controls_[i].get());
+
+            window_ = std::make_unique<Window>();
+            window_->SetClientSize(client_size);
+            window_->AddChild(GetRoot());
+            Refresh();
+        }
+
+        void SyntheticTree::InvalidateLeaves()
+        {
+            for (const auto leaf : leaves_)
+                leaf->InvalidateMeasure();
+        }
+
+        void SyntheticTree::Refresh()
+        {
+            window_->GetLayoutManager()->RefreshInvalidControlLayout();
+            window_->GetLayoutManager()->RefreshInvalidControlPositionCache();
+        }
+
+        void* RunBenchmarksHelperFunc(void*)
+        {
+            benchmark::RunSpecifiedBenchmarks();
+            return nullptr;
+        }
+
+        int RunBenchmarksWithLargeStack(int argc, char** argv)
+        {
+            benchmark::Initialize(&argc, argv);
+            if (benchmark::ReportUnrecognizedArguments(argc, argv))
+                return 1;
+
+            // the stack is reserved, so only the depth reached takes memory.
+            constexpr std::size_t stack_size = std::size_t(1) << 30;
+            pthread_attr_t attributes;
+            pthread_attr_init(&attributes);
+            pthread_attr_setstacksize(&attributes, stack_size);
+            pthread_t thread;
+            const auto error = pthread_create(&thread, &attributes, RunBenchmarksHelperFunc, nullptr);
+            pthread_attr_destroy(&attributes);
+            if (error != 0)
+                RunBenchmarksHelperFunc(nullptr);
+            else
+                pthread_join(thread, nullptr);
+
+            benchmark::Shutdown();
+            return 0;
+        }
+    }
+}
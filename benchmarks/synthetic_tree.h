@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ui/control.h"
+#include "ui/window.h"
+
+namespace cru
+{
+    namespace benchmarks
+    {
+        enum class TreeShape
+        {
+            //A chain of single children.
+            Deep,
+            //A root with all the other controls as children.
+            Wide,
+            //A vertical stack of horizontal stacks of cells, as square as
+            //the count allows.
+            Grid,
+            //Every control is a child of a uniformly random earlier one, so
+            //the depth is logarithmic and the fan-out varies.
+            Random
+        };
+
+        const char* GetTreeShapeName(TreeShape shape);
+
+        //A control that can be created directly. Its measure can do busy
+        //work first, as measuring text does.
+        class SyntheticControl : public ui::Control
+        {
+        public:
+            explicit SyntheticControl(int measure_work = 0);
+            SyntheticControl(const SyntheticControl& other) = delete;
+            SyntheticControl(SyntheticControl&& other) = delete;
+            SyntheticControl& operator=(const SyntheticControl& other) = delete;
+            SyntheticControl& operator=(SyntheticControl&& other) = delete;
+            ~SyntheticControl() override = default;
+
+        protected:
+            ui::Size OnMeasure(const ui::Size& available_size) override;
+
+        private:
+            int measure_work_;
+            //Keeps the busy work from being optimized out.
+            volatile float work_result_ = 0.0f;
+        };
+
+        struct SyntheticTreeOptions
+        {
+            TreeShape shape = TreeShape::Random;
+            int control_count = 1000;
+            std::uint32_t seed = 1;
+            //Iterations of busy work in the measure of every leaf.
+            int leaf_measure_work = 0;
+        };
+
+        //A tree of generated controls with a realistic mix of layout params,
+        //attached to a headless window. The same options generate the same
+        //tree.
+        class SyntheticTree
+        {
+        public:
+            explicit SyntheticTree(const SyntheticTreeOptions& options, const ui::Size& client_size = ui::Size(1280.0f, 720.0f));
+            SyntheticTree(const SyntheticTree& other) = delete;
+            SyntheticTree(SyntheticTree&& other) = delete;
+            SyntheticTree& operator=(const SyntheticTree& other) = delete;
+            SyntheticTree& operator=(SyntheticTree&& other) = delete;
+            ~SyntheticTree() = default;
+
+            ui::Window* GetWindow() const
+            {
+                return window_.get();
+            }
+
+            //Get the root of the generated controls, the only child of the
+            //window.
+            ui::Control* GetRoot() const
+            {
+                return controls_.front().get();
+            }
+
+            const std::vector<ui::Control*>& GetLeaves() const
+            {
+                return leaves_;
+            }
+
+            //Get the count of generated controls, without the window.
+            int GetControlCount() const
+            {
+                return static_cast<int>(controls_.size());
+            }
+
+            //Invalidate the measure of every leaf, so the next layout pass
+            //measures and arranges every control again.
+            void InvalidateLeaves();
+
+            //Refresh the invalid layout and position cache, as a frame does.
+            void Refresh();
+
+        private:
+            std::vector<std::unique_ptr<ui::Control>> controls_;
+            std::vector<ui::Control*> leaves_;
+            std::unique_ptr<ui::Window> window_;
+        };
+
+        //Run the benchmarks registered and parsed from the command line on a
+        //thread with a stack for trees 10^6 levels deep, since measure,
+        //layout and the position cache recurse once per level.
+        int RunBenchmarksWithLargeStack(int argc, char** argv);
+    }
+}
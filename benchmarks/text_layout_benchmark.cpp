@@ -0,0 +1,136 @@
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "timing.h"
+#include "graph/line_break.h"
+#include "graph/text_layout.h"
+
+// A list of 10^4 labels measured again with every step of resizing the
+// window, as a panel of text does. The labels are drawn from fewer texts, as
+// the cells of a table repeat, and laid out with the stub shaper, so the time
+// is the one of the cache and line breaking without a font engine. Counters
+// give the rate of hits, of layouts broken again from shaped text and of
+// misses, for the default budget and for one too small for the list.
+
+using namespace cru;
+using namespace cru::graph;
+using cru::benchmarks::GetSecondsSince;
+
+constexpr int label_count = 10000;
+constexpr int text_count = 2000;
+
+struct Label
+{
+    String text;
+    TextFormat format;
+};
+
+std::vector<Label> MakeLabelsHelperFunc()
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> word_count(1, 10);
+    std::uniform_int_distribution<int> word_length(1, 8);
+    std::uniform_int_distribution<int> letter(L'a', L'z');
+    std::vector<String> texts;
+    for (auto i = 0; i < text_count; i++)
+    {
+        String text;
+        for (auto j = word_count(random); j > 0; j--)
+        {
+            for (auto k = word_length(random); k > 0; k--)
+                text.push_back(static_cast<wchar_t>(letter(random)));
+            if (j > 1)
+                text.push_back(L' ');
+        }
+        texts.push_back(std::move(text));
+    }
+
+    std::uniform_int_distribution<int> text_index(0, text_count - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<Label> labels;
+    for (auto i = 0; i < label_count; i++)
+    {
+        TextFormat format;
+        format.size = percent(random) < 80 ? 14.0f : 20.0f;
+        labels.push_back(Label{ texts[text_index(random)], format });
+    }
+    return labels;
+}
+
+const std::vector<Label>& GetLabelsHelperFunc()
+{
+    static const auto labels = MakeLabelsHelperFunc();
+    return labels;
+}
+
+// widths move by a few dips a step and come back, as dragging a border does.
+float GetStepWidthHelperFunc(const int step)
+{
+    const auto phase = step % 64;
+    return 120.0f + static_cast<float>(phase < 32 ? phase : 64 - phase) * 4.0f;
+}
+
+// Every label is laid out with the cache in the width of a step.
+void BM_CachedResize(benchmark::State& state)
+{
+    const auto& labels = GetLabelsHelperFunc();
+    StubTextShaper shaper;
+    TextLayoutCache cache(&shaper, static_cast<std::size_t>(state.range(0)));
+    // the first step fills the cache.
+    for (const auto& label : labels)
+        cache.GetLayout(label.text, label.format, GetStepWidthHelperFunc(0));
+    cache.ResetStatistics();
+
+    auto step = 1;
+    for (auto _ : state)
+    {
+        const auto width = GetStepWidthHelperFunc(step++);
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& label : labels)
+            benchmark::DoNotOptimize(cache.GetLayout(label.text, label.format, width));
+        state.SetIterationTime(GetSecondsSince(start));
+    }
+
+    const auto statistics = cache.GetStatistics();
+    const auto lookup_count = static_cast<double>(statistics.hit_count + statistics.relayout_count + statistics.miss_count);
+    state.counters["hit_rate"] = statistics.hit_count / lookup_count;
+    state.counters["relayout_rate"] = statistics.relayout_count / lookup_count;
+    state.counters["miss_rate"] = statistics.miss_count / lookup_count;
+    state.counters["evictions_per_step"] = statistics.eviction_count / static_cast<double>(state.iterations());
+    state.counters["kb"] = static_cast<double>(cache.GetByteSize()) / 1024.0;
+    state.counters["layouts"] = benchmark::Counter(static_cast<double>(label_count) * static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// Every label is shaped and broken into lines, as without a cache.
+void BM_UncachedResize(benchmark::State& state)
+{
+    const auto& labels = GetLabelsHelperFunc();
+    StubTextShaper shaper;
+    auto step = 1;
+    for (auto _ : state)
+    {
+        const auto width = GetStepWidthHelperFunc(step++);
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& label : labels)
+        {
+            auto shaped_text = std::make_shared<ShapedText>();
+            shaped_text->text = label.text;
+            shaped_text->format = label.format;
+            shaped_text->metrics = shaper.GetMetrics(label.format);
+            shaper.Shape(label.text, label.format, shaped_text->glyphs);
+            FindLineBreaks(label.text, shaped_text->breaks);
+            benchmark::DoNotOptimize(std::make_shared<const TextLayout>(std::move(shaped_text), width));
+        }
+        state.SetIterationTime(GetSecondsSince(start));
+    }
+    state.counters["layouts"] = benchmark::Counter(static_cast<double>(label_count) * static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_CachedResize)->Arg(TextLayoutCache::default_budget)->Arg(256 * 1024)->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_UncachedResize)->UseManualTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "timing.h"
+#include "thread_pool.h"
+#include "graph/tiled_painter.h"
+
+// A full-hd frame of translucent shapes painted by a tiled painter on 1 to
+// 32 threads. The speedup counter compares with a software painter on the
+// calling thread, so it needs as many cores as threads to mean anything.
+
+using namespace cru;
+using namespace cru::graph;
+using cru::ui::Matrix;
+using cru::ui::Point;
+using cru::ui::Rect;
+using cru::benchmarks::GetSecondsSince;
+
+constexpr int bitmap_width = 1920;
+constexpr int bitmap_height = 1080;
+
+void PaintFrameHelperFunc(Painter& painter, const int shape_count)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> x(0.0f, static_cast<float>(bitmap_width));
+    std::uniform_real_distribution<float> y(0.0f, static_cast<float>(bitmap_height));
+    std::uniform_real_distribution<float> length(8.0f, 240.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    painter.Clear(Color(1.0f, 1.0f, 1.0f));
+    for (auto i = 0; i < shape_count; i++)
+    {
+        const Rect rect(x(random), y(random), length(random), length(random));
+        const Color color(unit(random), unit(random), unit(random), 0.5f + 0.5f * unit(random));
+        painter.SetTransform(i % 4 == 0 ? Matrix::Rotation(unit(random) * 90.0f, rect.GetLeftTop()) : Matrix::Identity());
+        if (i % 2 == 0)
+            painter.FillRoundedRectangle(rect, 12.0f, 12.0f, color);
+        else
+            painter.FillRectangle(rect, color);
+    }
+}
+
+double PaintSoftwareSecondsHelperFunc(Bitmap& bitmap, const int shape_count)
+{
+    const auto start = std::chrono::steady_clock::now();
+    SoftwarePainter painter(&bitmap);
+    PaintFrameHelperFunc(painter, shape_count);
+    return GetSecondsSince(start);
+}
+
+// Arguments are the count of threads and of shapes.
+void BM_TiledPaint(benchmark::State& state)
+{
+    const auto thread_count = static_cast<int>(state.range(0));
+    const auto shape_count = static_cast<int>(state.range(1));
+    Bitmap bitmap(bitmap_width, bitmap_height);
+
+    // the best of a few frames is the base of the speedup.
+    auto software_seconds = PaintSoftwareSecondsHelperFunc(bitmap, shape_count);
+    for (auto i = 0; i < 2; i++)
+        software_seconds = std::min(software_seconds, PaintSoftwareSecondsHelperFunc(bitmap, shape_count));
+
+    ThreadPool thread_pool(thread_count);
+    auto seconds = 0.0;
+    for (auto _ : state)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        TiledPainter painter(&bitmap, &thread_pool);
+        PaintFrameHelperFunc(painter, shape_count);
+        painter.Flush();
+        const auto iteration_seconds = GetSecondsSince(start);
+        state.SetIterationTime(iteration_seconds);
+        seconds += iteration_seconds;
+    }
+    state.counters["speedup"] = software_seconds * static_cast<double>(state.iterations()) / seconds;
+}
+
+BENCHMARK(BM_TiledPaint)->ArgNames({ "threads", "shapes" })
+    ->ArgsProduct({ benchmark::CreateRange(1, 32, 2), { 100, 1000 } })
+    ->UseManualTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
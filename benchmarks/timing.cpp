@@ -0,0 +1,12 @@
+#include "timing.h"
+
+namespace cru
+{
+    namespace benchmarks
+    {
+        double GetSecondsSince(const std::chrono::steady_clock::time_point& start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <chrono>
+
+namespace cru
+{
+    namespace benchmarks
+    {
+        //Get the seconds from "start" to now, for manual iteration times.
+        double GetSecondsSince(const std::chrono::steady_clock::time_point& start);
+    }
+}
@@ -0,0 +1,161 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graph/batching_painter.h"
+#include "graph/image_compare.h"
+#include "graph/software_painter.h"
+
+using namespace cru;
+using namespace cru::graph;
+using cru::ui::Matrix;
+using cru::ui::Point;
+using cru::ui::Rect;
+
+// A null painter counting each kind of fill and keeping the paths of
+// "FillPath", the ones a backend would cache.
+class FillCountPainter : public NullPainter
+{
+public:
+    void FillRectangle(const Rect& rect, const Brush& brush) override
+    {
+        NullPainter::FillRectangle(rect, brush);
+        rectangle_count++;
+    }
+
+    void FillRoundedRectangle(const Rect& rect, const float radius_x, const float radius_y, const Brush& brush) override
+    {
+        NullPainter::FillRoundedRectangle(rect, radius_x, radius_y, brush);
+        rounded_rectangle_count++;
+    }
+
+    void FillPath(const Path& path, const Brush& brush) override
+    {
+        NullPainter::FillPath(path, brush);
+        cached_paths.push_back(path);
+    }
+
+    void FillTransientPath(const Path& path, const Brush& brush) override
+    {
+        NullPainter::FillPath(path, brush);
+        transient_path_count++;
+    }
+
+    int rectangle_count = 0;
+    int rounded_rectangle_count = 0;
+    int transient_path_count = 0;
+    std::vector<Path> cached_paths;
+};
+
+// A grid of cells drawn as controls draw them, each under its own
+// translation, becomes a path per full batch.
+TEST(BatchingPainterTest, GridBecomesFewSubmissions)
+{
+    constexpr auto grid_size = 50;
+    FillCountPainter target;
+    BatchingPainter painter(&target);
+    for (auto y = 0; y < grid_size; y++)
+        for (auto x = 0; x < grid_size; x++)
+        {
+            painter.SetTransform(Matrix::Translation(x * 5.0f, y * 5.0f));
+            painter.FillRectangle(Rect(0.0f, 0.0f, 4.0f, 4.0f), Color(0.0f, 0.0f, 1.0f));
+        }
+    painter.Flush();
+
+    const auto& statistics = painter.GetStatistics();
+    const auto batch_count = (grid_size * grid_size + BatchingPainter::max_batch_size - 1) / BatchingPainter::max_batch_size;
+    EXPECT_EQ(statistics.primitive_count, grid_size * grid_size);
+    EXPECT_EQ(statistics.batched_primitive_count, grid_size * grid_size - batch_count);
+    EXPECT_EQ(statistics.submission_count, batch_count);
+    EXPECT_LE(statistics.transform_change_count, 1);
+    // merged paths are new every frame, so none is sent to be cached.
+    EXPECT_EQ(target.transient_path_count, batch_count);
+    EXPECT_TRUE(target.cached_paths.empty());
+    EXPECT_EQ(target.rectangle_count, 0);
+}
+
+// A fill that joins no batch is sent as it was drawn, under its transform.
+TEST(BatchingPainterTest, SendsSingleFillAsDrawn)
+{
+    Path path;
+    path.MoveTo(Point(0.0f, 0.0f));
+    path.QuadraticTo(Point(10.0f, 0.0f), Point(10.0f, 10.0f));
+    path.Close();
+
+    FillCountPainter target;
+    BatchingPainter painter(&target);
+    painter.SetTransform(Matrix::Translation(100.0f, 0.0f));
+    painter.FillRoundedRectangle(Rect(0.0f, 0.0f, 20.0f, 10.0f), 3.0f, 3.0f, Color(1.0f, 0.0f, 0.0f));
+    painter.SetTransform(Matrix::Translation(0.0f, 100.0f));
+    painter.FillPath(path, Color(0.0f, 1.0f, 0.0f));
+    painter.SetTransform(Matrix::Scale(2.0f, 2.0f));
+    painter.FillRectangle(Rect(0.0f, 0.0f, 4.0f, 4.0f), Color(0.0f, 0.0f, 1.0f));
+    painter.Flush();
+
+    EXPECT_EQ(target.rounded_rectangle_count, 1);
+    EXPECT_EQ(target.rectangle_count, 1);
+    EXPECT_EQ(target.transient_path_count, 0);
+    // the path is the one drawn, so a cache keyed by it hits every frame.
+    ASSERT_EQ(target.cached_paths.size(), 1u);
+    EXPECT_EQ(target.cached_paths[0], path);
+    EXPECT_EQ(target.GetTransform(), Matrix::Scale(2.0f, 2.0f));
+    EXPECT_EQ(painter.GetStatistics().submission_count, 3);
+}
+
+constexpr int bitmap_size = 120;
+
+// Overlapping fills of two colors in turns, translucent ones, rounded rects,
+// paths and a mirrored transform, on whole pixels so a merged path covers
+// the same pixels as separate fills.
+void PaintOverlapsHelperFunc(Painter& painter)
+{
+    const Color red(1.0f, 0.0f, 0.0f), blue(0.0f, 0.0f, 1.0f), half_green(0.0f, 1.0f, 0.0f, 0.5f);
+    painter.Clear(Color(1.0f, 1.0f, 1.0f));
+
+    // a blue rect over two red ones can't be moved below the second red.
+    painter.FillRectangle(Rect(0.0f, 0.0f, 30.0f, 30.0f), red);
+    painter.FillRectangle(Rect(20.0f, 20.0f, 30.0f, 30.0f), blue);
+    painter.FillRectangle(Rect(40.0f, 40.0f, 30.0f, 30.0f), red);
+    painter.FillRectangle(Rect(60.0f, 0.0f, 20.0f, 20.0f), red);
+
+    // opaque rects of a color overlapping each other are merged.
+    painter.FillRectangle(Rect(80.0f, 80.0f, 20.0f, 20.0f), blue);
+    painter.FillRectangle(Rect(90.0f, 90.0f, 20.0f, 20.0f), blue);
+
+    // overlapping translucent fills are drawn twice where they overlap.
+    painter.FillRectangle(Rect(0.0f, 60.0f, 30.0f, 30.0f), half_green);
+    painter.FillRectangle(Rect(15.0f, 75.0f, 30.0f, 30.0f), half_green);
+    painter.FillRoundedRectangle(Rect(85.0f, 5.0f, 30.0f, 30.0f), 10.0f, 10.0f, half_green);
+    painter.FillRoundedRectangle(Rect(95.0f, 15.0f, 20.0f, 20.0f), 6.0f, 6.0f, half_green);
+
+    Path triangle;
+    triangle.MoveTo(Point(0.0f, 0.0f));
+    triangle.LineTo(Point(20.0f, 0.0f));
+    triangle.LineTo(Point(0.0f, 20.0f));
+    triangle.Close();
+    painter.SetTransform(Matrix::Translation(50.0f, 90.0f));
+    painter.FillPath(triangle, red);
+    painter.SetTransform(Matrix::Scale(-1.0f, 1.0f) * Matrix::Translation(80.0f, 90.0f));
+    painter.FillPath(triangle, red);
+    painter.FillRectangle(Rect(0.0f, 10.0f, 10.0f, 10.0f), blue);
+    painter.SetTransform(Matrix::Identity());
+    painter.FillRectangle(Rect(40.0f, 70.0f, 10.0f, 10.0f), blue);
+}
+
+TEST(BatchingPainterTest, KeepsPixelsOfOverlaps)
+{
+    Bitmap expected(bitmap_size, bitmap_size);
+    SoftwarePainter expected_painter(&expected);
+    PaintOverlapsHelperFunc(expected_painter);
+
+    Bitmap actual(bitmap_size, bitmap_size);
+    SoftwarePainter target(&actual);
+    BatchingPainter painter(&target);
+    PaintOverlapsHelperFunc(painter);
+    painter.Flush();
+
+    EXPECT_GT(painter.GetStatistics().batched_primitive_count, 0);
+    EXPECT_LT(painter.GetStatistics().submission_count, painter.GetStatistics().primitive_count);
+    const auto difference = CompareBitmaps(expected, actual);
+    EXPECT_TRUE(difference.IsSame()) << difference.different_pixel_count << " pixels differ by up to " << difference.max_channel_difference;
+}
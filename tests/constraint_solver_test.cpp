@@ -0,0 +1,161 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ui/constraint/constraint_solver.h"
+
+using namespace cru::ui::constraint;
+
+constexpr double epsilon = 1e-6;
+
+TEST(ConstraintSolverTest, SolvesRequiredConstraints)
+{
+    Solver solver;
+    Variable x, y;
+    solver.AddConstraint(x + y == 90.0);
+    solver.AddConstraint(x == 2.0 * y);
+    solver.UpdateVariables();
+    EXPECT_NEAR(x.GetValue(), 60.0, epsilon);
+    EXPECT_NEAR(y.GetValue(), 30.0, epsilon);
+}
+
+TEST(ConstraintSolverTest, StrongerConstraintWins)
+{
+    Solver solver;
+    Variable x;
+    solver.AddConstraint(x == 10.0 | strength::weak);
+    solver.AddConstraint(x == 20.0 | strength::strong);
+    solver.UpdateVariables();
+    EXPECT_NEAR(x.GetValue(), 20.0, epsilon);
+}
+
+TEST(ConstraintSolverTest, ConflictingRequiredConstraintThrows)
+{
+    Solver solver;
+    Variable x;
+    solver.AddConstraint(x >= 10.0);
+    const auto conflict = Constraint(x <= 5.0);
+    EXPECT_THROW(solver.AddConstraint(conflict), UnsatisfiableConstraintError);
+    EXPECT_FALSE(solver.HasConstraint(conflict));
+    EXPECT_EQ(solver.GetConstraintCount(), 1);
+    solver.UpdateVariables();
+    EXPECT_GE(x.GetValue(), 10.0 - epsilon);
+}
+
+// Columns filling a width edited as a window is resized: the columns are
+// equal, but none is narrower than its minimum.
+class Columns
+{
+public:
+    static constexpr int column_count = 8;
+
+    Columns()
+        : widths(column_count)
+    {
+        auto right = Expression(0.0);
+        for (auto i = 0; i < column_count; i++)
+        {
+            solver.AddConstraint(widths[i] >= 10.0 * (i + 1));
+            if (i > 0)
+                solver.AddConstraint(widths[i] == widths[0] | strength::medium);
+            right = right + widths[i];
+        }
+        fill = right == total;
+        solver.AddConstraint(fill);
+        solver.AddEditVariable(total, strength::strong);
+    }
+
+    std::vector<double> Solve(const double value)
+    {
+        solver.SuggestValue(total, value);
+        solver.UpdateVariables();
+        std::vector<double> values;
+        for (const auto& width : widths)
+            values.push_back(width.GetValue());
+        return values;
+    }
+
+    Solver solver;
+    Variable total;
+    std::vector<Variable> widths;
+    Constraint fill = Constraint(Expression(0.0), RelationalOperator::Equal);
+};
+
+TEST(ColumnsTest, EditSharesWidthWithinMinimums)
+{
+    Columns columns;
+    // wide enough for all to be equal.
+    for (const auto width : columns.Solve(800.0))
+        EXPECT_NEAR(width, 100.0, epsilon);
+
+    // the sum of the minimums is 360, so the total is kept.
+    const auto widths = columns.Solve(400.0);
+    auto sum = 0.0;
+    for (auto i = 0; i < Columns::column_count; i++)
+    {
+        EXPECT_GE(widths[i], 10.0 * (i + 1) - epsilon);
+        sum += widths[i];
+    }
+    EXPECT_NEAR(sum, 400.0, epsilon);
+}
+
+TEST(ColumnsTest, EditsFollowEveryStep)
+{
+    Columns columns;
+    for (auto total = 360.0; total <= 1200.0; total += 7.0)
+    {
+        auto sum = 0.0;
+        for (const auto width : columns.Solve(total))
+            sum += width;
+        ASSERT_NEAR(sum, total, epsilon) << total;
+    }
+}
+
+TEST(ColumnsTest, RemovedAndAddedAgainConstraintGivesSameSolution)
+{
+    Columns columns;
+    const auto before = columns.Solve(500.0);
+    columns.solver.RemoveConstraint(columns.fill);
+    EXPECT_FALSE(columns.solver.HasConstraint(columns.fill));
+    columns.solver.AddConstraint(columns.fill);
+    const auto after = columns.Solve(500.0);
+    for (auto i = 0; i < Columns::column_count; i++)
+        EXPECT_NEAR(after[i], before[i], epsilon) << i;
+}
+
+TEST(ColumnsTest, RemovedConstraintNoLongerApplies)
+{
+    Columns columns;
+    columns.solver.RemoveConstraint(columns.fill);
+    // nothing ties the columns to the total, so they are equal at their
+    // largest minimum.
+    for (const auto width : columns.Solve(1000.0))
+        EXPECT_NEAR(width, 80.0, epsilon);
+}
+
+TEST(ColumnsTest, RemovedAndAddedAgainEditVariable)
+{
+    Columns columns;
+    columns.Solve(600.0);
+    columns.solver.RemoveEditVariable(columns.total);
+    EXPECT_FALSE(columns.solver.HasEditVariable(columns.total));
+    columns.solver.AddEditVariable(columns.total, strength::strong);
+    auto sum = 0.0;
+    for (const auto width : columns.Solve(900.0))
+        sum += width;
+    EXPECT_NEAR(sum, 900.0, epsilon);
+}
+
+TEST(ColumnsTest, SolutionEqualsFreshSolver)
+{
+    Columns columns;
+    columns.Solve(700.0);
+    columns.solver.RemoveConstraint(columns.fill);
+    columns.solver.AddConstraint(columns.fill);
+    const auto edited = columns.Solve(450.0);
+
+    Columns fresh;
+    const auto expected = fresh.Solve(450.0);
+    for (auto i = 0; i < Columns::column_count; i++)
+        EXPECT_NEAR(edited[i], expected[i], epsilon) << i;
+}
@@ -0,0 +1,233 @@
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "thread_pool.h"
+#include "ui/window.h"
+#include "ui/controls/stack_panel.h"
+
+using namespace cru::ui;
+
+BasicLayoutParams MakeLayoutParamsHelperFunc(const MeasureLength& width, const MeasureLength& height)
+{
+    BasicLayoutParams layout_params;
+    layout_params.size.width = width;
+    layout_params.size.height = height;
+    return layout_params;
+}
+
+class TestControl : public Control
+{
+public:
+    TestControl() = default;
+};
+
+// A vertical stack panel of a stretched control holding a leaf, and a
+// sibling below it. The panel offers infinite height, so the stretched
+// control takes the height of the leaf.
+class ControlLayoutTest : public testing::Test
+{
+protected:
+    ControlLayoutTest()
+    {
+        leaf_.SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(40.0f), MeasureLength(20.0f)));
+        stretched_.SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(0.0f, MeasureMode::Stretch), MeasureLength(0.0f, MeasureMode::Stretch)));
+        sibling_.SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(40.0f), MeasureLength(10.0f)));
+        stretched_.AddChild(&leaf_);
+        panel_.AddChild(&stretched_);
+        panel_.AddChild(&sibling_);
+        window_.SetClientSize(Size(200.0f, 100.0f));
+        window_.AddChild(&panel_);
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    }
+
+    Window window_;
+    controls::StackPanel panel_;
+    TestControl stretched_;
+    TestControl leaf_;
+    TestControl sibling_;
+};
+
+TEST_F(ControlLayoutTest, StretchInInfiniteRoomTakesContent)
+{
+    EXPECT_EQ(stretched_.GetSize(), Size(200.0f, 20.0f));
+    EXPECT_EQ(sibling_.GetPositionRelative(), Point(0.0f, 20.0f));
+}
+
+TEST_F(ControlLayoutTest, StretchInInfiniteRoomFollowsContent)
+{
+    leaf_.SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(40.0f), MeasureLength(50.0f)));
+    window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    EXPECT_EQ(stretched_.GetSize(), Size(200.0f, 50.0f));
+    EXPECT_EQ(sibling_.GetPositionRelative(), Point(0.0f, 50.0f));
+}
+
+TEST_F(ControlLayoutTest, StretchInFiniteRoomStopsInvalidation)
+{
+    // the cross length of the panel is finite, so a wider leaf doesn't
+    // change the stretched width.
+    leaf_.SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(80.0f), MeasureLength(20.0f)));
+    window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    EXPECT_EQ(stretched_.GetSize(), Size(200.0f, 20.0f));
+    EXPECT_EQ(leaf_.GetSize(), Size(80.0f, 20.0f));
+}
+
+// A vertical stack panel of horizontal groups of leaves, so a leaf has many
+// siblings and cousins but a path of four controls to the window.
+class WideTreeLayoutTest : public testing::Test
+{
+protected:
+    static constexpr int group_count = 20;
+    static constexpr int leaf_count = 20;
+
+    WideTreeLayoutTest() : panel_(Orientation::Vertical)
+    {
+        for (auto i = 0; i < group_count; i++)
+        {
+            groups_.push_back(std::make_unique<controls::StackPanel>(Orientation::Horizontal));
+            for (auto j = 0; j < leaf_count; j++)
+            {
+                leaves_.push_back(std::make_unique<TestControl>());
+                leaves_.back()->SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(10.0f), MeasureLength(10.0f)));
+                groups_.back()->AddChild(leaves_.back().get());
+            }
+            panel_.AddChild(groups_.back().get());
+        }
+        window_.SetClientSize(Size(400.0f, 400.0f));
+        window_.AddChild(&panel_);
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    }
+
+    TestControl& GetLeaf(const int group, const int leaf)
+    {
+        return *leaves_[group * leaf_count + leaf];
+    }
+
+    const LayoutPassStatistics& Refresh()
+    {
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+        return window_.GetLayoutManager()->GetLastLayoutPassStatistics();
+    }
+
+    Window window_;
+    controls::StackPanel panel_;
+    std::vector<std::unique_ptr<controls::StackPanel>> groups_;
+    std::vector<std::unique_ptr<TestControl>> leaves_;
+};
+
+TEST_F(WideTreeLayoutTest, OnlyPathIsLaidOut)
+{
+    // the leaf, its group, the panel and the window; the controls after the
+    // leaf and its group only move.
+    GetLeaf(7, 3).SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(15.0f), MeasureLength(12.0f)));
+    const auto& statistics = Refresh();
+    EXPECT_EQ(statistics.root_count, 1);
+    EXPECT_EQ(statistics.measure_count, 4);
+    EXPECT_EQ(statistics.layout_count, 4);
+    EXPECT_EQ(GetLeaf(7, 4).GetPositionRelative(), Point(45.0f, 0.0f));
+    EXPECT_EQ(groups_[8]->GetPositionRelative(), Point(0.0f, 82.0f));
+
+    // nothing is invalid, so nothing is visited.
+    const auto& idle_statistics = Refresh();
+    EXPECT_EQ(idle_statistics.measure_count, 0);
+    EXPECT_EQ(idle_statistics.layout_count, 0);
+}
+
+TEST_F(WideTreeLayoutTest, FixedSizeParentStopsPropagation)
+{
+    groups_[7]->SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(300.0f), MeasureLength(10.0f)));
+    Refresh();
+
+    // the group doesn't depend on its children, so only it and the leaf are.
+    GetLeaf(7, 3).SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(15.0f), MeasureLength(8.0f)));
+    const auto& statistics = Refresh();
+    EXPECT_EQ(statistics.root_count, 1);
+    EXPECT_EQ(statistics.measure_count, 2);
+    EXPECT_EQ(statistics.layout_count, 2);
+    EXPECT_EQ(groups_[8]->GetPositionRelative(), Point(0.0f, 80.0f));
+}
+
+// A tree of nested stack panels with leaves of random sizes from "seed",
+// and every control of it in preorder.
+class RandomTree
+{
+public:
+    RandomTree(Window& window, const unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> length(4.0f, 30.0f);
+        std::function<Control*(int, Orientation)> build = [&](const int depth, const Orientation orientation) -> Control* {
+            if (depth == 3)
+            {
+                leaves_.push_back(std::make_unique<TestControl>());
+                leaves_.back()->SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(length(random)), MeasureLength(length(random))));
+                controls_.push_back(leaves_.back().get());
+                return leaves_.back().get();
+            }
+            panels_.push_back(std::make_unique<controls::StackPanel>(orientation));
+            const auto panel = panels_.back().get();
+            controls_.push_back(panel);
+            const auto next_orientation = orientation == Orientation::Vertical ? Orientation::Horizontal : Orientation::Vertical;
+            for (auto i = 0; i < 8; i++)
+                panel->AddChild(build(depth + 1, next_orientation));
+            return panel;
+        };
+        window.SetClientSize(Size(800.0f, 600.0f));
+        window.AddChild(build(0, Orientation::Vertical));
+    }
+
+    TestControl& GetLeaf(const int index)
+    {
+        return *leaves_[index];
+    }
+
+    const std::vector<Control*>& GetControls() const
+    {
+        return controls_;
+    }
+
+private:
+    std::vector<std::unique_ptr<controls::StackPanel>> panels_;
+    std::vector<std::unique_ptr<TestControl>> leaves_;
+    std::vector<Control*> controls_;
+};
+
+void ExpectSameLayoutHelperFunc(const RandomTree& tree, const RandomTree& other_tree)
+{
+    for (std::size_t i = 0; i < tree.GetControls().size(); i++)
+    {
+        const auto control = tree.GetControls()[i];
+        const auto other_control = other_tree.GetControls()[i];
+        ASSERT_EQ(control->GetDesiredSize(), other_control->GetDesiredSize()) << "control " << i;
+        ASSERT_EQ(control->GetPositionRelative(), other_control->GetPositionRelative()) << "control " << i;
+        ASSERT_EQ(control->GetSize(), other_control->GetSize()) << "control " << i;
+    }
+}
+
+// Measuring children on a thread pool lays out the same as measuring them
+// in order, for the first pass and for a pass after changes.
+TEST(ParallelLayoutTest, MatchesSerialLayout)
+{
+    cru::ThreadPool thread_pool(4);
+    Window parallel_window, serial_window;
+    parallel_window.GetLayoutManager()->SetThreadPool(&thread_pool);
+    parallel_window.GetLayoutManager()->SetParallelMeasureThreshold(1);
+    RandomTree parallel_tree(parallel_window, 1), serial_tree(serial_window, 1);
+
+    parallel_window.GetLayoutManager()->RefreshInvalidControlLayout();
+    serial_window.GetLayoutManager()->RefreshInvalidControlLayout();
+    EXPECT_GT(parallel_window.GetLayoutManager()->GetLastLayoutPassStatistics().parallel_measure_count, 0);
+    EXPECT_EQ(serial_window.GetLayoutManager()->GetLastLayoutPassStatistics().parallel_measure_count, 0);
+    ExpectSameLayoutHelperFunc(parallel_tree, serial_tree);
+
+    for (const auto index : { 3, 100, 101, 400 })
+        for (auto tree : { &parallel_tree, &serial_tree })
+            tree->GetLeaf(index).SetLayoutParams(MakeLayoutParamsHelperFunc(MeasureLength(40.0f), MeasureLength(35.0f)));
+    parallel_window.GetLayoutManager()->RefreshInvalidControlLayout();
+    serial_window.GetLayoutManager()->RefreshInvalidControlLayout();
+    EXPECT_GT(parallel_window.GetLayoutManager()->GetLastLayoutPassStatistics().parallel_measure_count, 0);
+    ExpectSameLayoutHelperFunc(parallel_tree, serial_tree);
+}
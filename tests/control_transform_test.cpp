@@ -0,0 +1,121 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "ui/window.h"
+#include "ui/controls/stack_panel.h"
+
+using namespace cru::ui;
+
+BasicLayoutParams MakeLayoutParamsHelperFunc(const float width, const float height)
+{
+    BasicLayoutParams layout_params;
+    layout_params.size.width = MeasureLength(width);
+    layout_params.size.height = MeasureLength(height);
+    return layout_params;
+}
+
+class TestControl : public Control
+{
+public:
+    TestControl(const float width, const float height)
+    {
+        SetLayoutParams(MakeLayoutParamsHelperFunc(width, height));
+    }
+};
+
+// A box of 100 by 100 below a spacer 10 high, holding a child of 40 by 20 at
+// its lefttop.
+class ControlTransformTest : public testing::Test
+{
+protected:
+    ControlTransformTest()
+        : panel_(Orientation::Vertical), spacer_(100.0f, 10.0f), box_(100.0f, 100.0f), child_(40.0f, 20.0f)
+    {
+        box_.AddChild(&child_);
+        panel_.AddChild(&spacer_);
+        panel_.AddChild(&box_);
+        window_.SetClientSize(Size(200.0f, 200.0f));
+        window_.AddChild(&panel_);
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+        window_.GetLayoutManager()->RefreshInvalidControlPositionCache();
+    }
+
+    // The box turned a quarter clockwise around its center and the child
+    // scaled twice, so the child covers x in [60, 100] and y in [0, 80] of
+    // the box.
+    void Transform()
+    {
+        box_.SetTransform(Matrix::Rotation(90.0f, Point(50.0f, 50.0f)));
+        child_.SetTransform(Matrix::Scale(2.0f, 2.0f));
+        window_.GetLayoutManager()->RefreshInvalidControlPositionCache();
+    }
+
+    Window window_;
+    controls::StackPanel panel_;
+    TestControl spacer_;
+    TestControl box_;
+    TestControl child_;
+};
+
+TEST_F(ControlTransformTest, CachesWorldAndInverseMatrices)
+{
+    EXPECT_EQ(child_.GetWorldMatrix(), Matrix::Translation(0.0f, 10.0f));
+    EXPECT_EQ(child_.GetPositionAbsolute(), Point(0.0f, 10.0f));
+
+    Transform();
+    EXPECT_EQ(child_.GetWorldMatrix(), child_.GetLocalMatrix() * box_.GetWorldMatrix());
+    EXPECT_EQ(box_.GetWorldMatrix(), box_.GetLocalMatrix() * panel_.GetWorldMatrix());
+
+    const auto absolute = child_.LocalToAbsolute(Point(10.0f, 5.0f));
+    EXPECT_NEAR(absolute.x, 90.0f, 1e-4f);
+    EXPECT_NEAR(absolute.y, 30.0f, 1e-4f);
+    const auto local = child_.AbsoluteToLocal(absolute);
+    EXPECT_NEAR(local.x, 10.0f, 1e-4f);
+    EXPECT_NEAR(local.y, 5.0f, 1e-4f);
+
+    // only the changed subtree is recalculated.
+    child_.SetTransform(Matrix::Scale(3.0f, 3.0f));
+    window_.GetLayoutManager()->RefreshInvalidControlPositionCache();
+    EXPECT_EQ(window_.GetLayoutManager()->GetLastPositionCacheStatistics().refresh_count, 1);
+    box_.SetTransform(Matrix::Rotation(45.0f, Point(50.0f, 50.0f)));
+    window_.GetLayoutManager()->RefreshInvalidControlPositionCache();
+    EXPECT_EQ(window_.GetLayoutManager()->GetLastPositionCacheStatistics().refresh_count, 2);
+    EXPECT_EQ(child_.GetWorldMatrix(), child_.GetLocalMatrix() * box_.GetWorldMatrix());
+}
+
+TEST_F(ControlTransformTest, HitsThroughRotatedAndScaledControl)
+{
+    EXPECT_EQ(window_.HitTest(Point(5.0f, 15.0f)), &child_);
+    // the box and the child above the spacer are skipped by their bounds.
+    EXPECT_EQ(window_.HitTest(Point(50.0f, 5.0f)), &spacer_);
+    EXPECT_EQ(window_.GetLastHitTestStatistics().visit_count, 1);
+
+    Transform();
+    // where the child was, and where it would be unrotated, is the box now.
+    EXPECT_EQ(window_.HitTest(Point(5.0f, 15.0f)), &box_);
+    EXPECT_EQ(window_.HitTest(Point(30.0f, 30.0f)), &box_);
+    EXPECT_EQ(window_.HitTest(Point(90.0f, 30.0f)), &child_);
+    EXPECT_EQ(window_.HitTest(Point(65.0f, 85.0f)), &child_);
+    EXPECT_EQ(window_.HitTest(child_.LocalToAbsolute(Point(39.0f, 19.0f))), &child_);
+    EXPECT_EQ(window_.HitTest(child_.LocalToAbsolute(Point(41.0f, 10.0f))), &box_);
+}
+
+// A zero scale collapses the control to a line, which contains no point,
+// not even the points on the line.
+TEST_F(ControlTransformTest, CollapsedControlContainsNoPoint)
+{
+    child_.SetTransform(Matrix::Scale(0.0f, 1.0f));
+    window_.GetLayoutManager()->RefreshInvalidControlPositionCache();
+
+    const auto on_line = child_.LocalToAbsolute(Point(20.0f, 10.0f));
+    EXPECT_EQ(on_line, Point(0.0f, 20.0f));
+    EXPECT_EQ(window_.HitTest(on_line), &box_);
+    const auto local = child_.AbsoluteToLocal(on_line);
+    EXPECT_TRUE(std::isnan(local.x));
+    EXPECT_FALSE(child_.IsPointInside(local));
+
+    // restored, it contains the point again.
+    child_.SetTransform(Matrix::Identity());
+    EXPECT_EQ(window_.HitTest(on_line), &child_);
+}
@@ -0,0 +1,217 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graph/display_list.h"
+#include "ui/window.h"
+#include "ui/controls/stack_panel.h"
+
+using namespace cru;
+using namespace cru::ui;
+
+// A null painter keeping the brushes and paths it is given and the
+// transform of each command.
+class CapturePainter : public graph::NullPainter
+{
+public:
+    void FillRectangle(const Rect& rect, const graph::Brush& brush) override
+    {
+        NullPainter::FillRectangle(rect, brush);
+        brushes.push_back(brush);
+        transforms.push_back(GetTransform());
+    }
+
+    void FillPath(const graph::Path& path, const graph::Brush& brush) override
+    {
+        NullPainter::FillPath(path, brush);
+        brushes.push_back(brush);
+        paths.push_back(path);
+        transforms.push_back(GetTransform());
+    }
+
+    std::vector<graph::Brush> brushes;
+    std::vector<graph::Path> paths;
+    std::vector<Matrix> transforms;
+};
+
+const graph::Brush gradient_brush = graph::Brush::LinearGradient(Point(0.0f, 0.0f), Point(10.0f, 5.0f), {
+    { 0.0f, graph::Color(1.0f, 0.0f, 0.0f) },
+    { 0.25f, graph::Color(0.0f, 1.0f, 0.0f, 0.5f) },
+    { 1.0f, graph::Color(0.0f, 0.0f, 1.0f) }
+});
+
+graph::Path MakePathHelperFunc()
+{
+    graph::Path path;
+    path.SetFillRule(graph::FillRule::EvenOdd);
+    path.MoveTo(Point(1.0f, 2.0f));
+    path.LineTo(Point(10.0f, 2.0f));
+    path.QuadraticTo(Point(12.0f, 6.0f), Point(8.0f, 9.0f));
+    path.CubicTo(Point(6.0f, 12.0f), Point(3.0f, 11.0f), Point(1.0f, 8.0f));
+    path.Close();
+    path.AddRoundedRectangle(Rect(20.0f, 20.0f, 10.0f, 6.0f), 2.0f, 3.0f);
+    return path;
+}
+
+// Every command once, with a transform in the middle.
+void RecordHelperFunc(graph::Painter& painter)
+{
+    painter.Clear(graph::Color(1.0f, 1.0f, 1.0f));
+    painter.PushClip(Rect(0.0f, 0.0f, 50.0f, 40.0f));
+    painter.FillRectangle(Rect(1.0f, 2.0f, 3.0f, 4.0f), graph::Color(0.5f, 0.25f, 0.125f, 0.75f));
+    painter.StrokeRectangle(Rect(2.0f, 3.0f, 4.0f, 5.0f), gradient_brush, 1.5f);
+    painter.SetTransform(Matrix::Rotation(30.0f, Point(5.0f, 5.0f)));
+    painter.FillRoundedRectangle(Rect(0.0f, 0.0f, 8.0f, 6.0f), 2.0f, 1.0f, gradient_brush);
+    painter.StrokeRoundedRectangle(Rect(1.0f, 1.0f, 8.0f, 6.0f), 1.0f, 2.0f, graph::Color(0.0f, 0.0f, 0.0f), 0.5f);
+    painter.FillPath(MakePathHelperFunc(), gradient_brush);
+    painter.PopClip();
+}
+
+TEST(DisplayListTest, ReplayRoundTrips)
+{
+    graph::DisplayList list;
+    RecordHelperFunc(list);
+    EXPECT_EQ(list.GetCommandCount(), 9);
+    EXPECT_EQ(list.GetTransform(), Matrix::Rotation(30.0f, Point(5.0f, 5.0f)));
+
+    // recorded directly, and by replaying with no transform, the lists are the same.
+    graph::DisplayList direct;
+    RecordHelperFunc(direct);
+    EXPECT_TRUE(list.IsSameAs(direct));
+    graph::DisplayList replayed;
+    list.Replay(replayed);
+    EXPECT_EQ(replayed.GetCommandCount(), list.GetCommandCount() + 1);
+
+    // the replay adds the restore of the transform at the end.
+    direct.SetTransform(Matrix::Identity());
+    EXPECT_TRUE(replayed.IsSameAs(direct));
+
+    CapturePainter painter;
+    list.Replay(painter);
+    EXPECT_EQ(painter.GetCommandCount(), 8);
+    EXPECT_EQ(painter.GetClipDepth(), 0);
+    ASSERT_EQ(painter.brushes.size(), 2u);
+    EXPECT_EQ(painter.brushes[0], graph::Brush(graph::Color(0.5f, 0.25f, 0.125f, 0.75f)));
+    EXPECT_EQ(painter.brushes[1], gradient_brush);
+    ASSERT_EQ(painter.paths.size(), 1u);
+    EXPECT_EQ(painter.paths[0], MakePathHelperFunc());
+    EXPECT_EQ(painter.paths[0].GetFillRule(), graph::FillRule::EvenOdd);
+}
+
+TEST(DisplayListTest, IsSameAsComparesCommands)
+{
+    graph::DisplayList list, other;
+    EXPECT_TRUE(list.IsSameAs(other));
+    list.FillRectangle(Rect(0.0f, 0.0f, 1.0f, 1.0f), graph::Color(1.0f, 0.0f, 0.0f));
+    EXPECT_FALSE(list.IsSameAs(other));
+    other.FillRectangle(Rect(0.0f, 0.0f, 1.0f, 1.0f), graph::Color(1.0f, 0.0f, 0.1f));
+    EXPECT_FALSE(list.IsSameAs(other));
+
+    // a cleared list records from the start again.
+    other.Clear();
+    EXPECT_TRUE(other.IsEmpty());
+    EXPECT_EQ(other.GetByteSize(), 0u);
+    other.FillRectangle(Rect(0.0f, 0.0f, 1.0f, 1.0f), graph::Color(1.0f, 0.0f, 0.0f));
+    EXPECT_TRUE(list.IsSameAs(other));
+}
+
+// Transforms are replayed relative to the transform of the painter, which is
+// restored at the end.
+TEST(DisplayListTest, ReplaysTransformsRelativeToBase)
+{
+    const auto local = Matrix::Scale(2.0f, 3.0f);
+    graph::DisplayList list;
+    list.FillRectangle(Rect(0.0f, 0.0f, 1.0f, 1.0f), graph::Color());
+    list.SetTransform(local);
+    list.FillPath(MakePathHelperFunc(), graph::Color());
+
+    const auto base = Matrix::Translation(10.0f, 20.0f);
+    CapturePainter painter;
+    painter.SetTransform(base);
+    list.Replay(painter);
+    ASSERT_EQ(painter.transforms.size(), 2u);
+    EXPECT_EQ(painter.transforms[0], base);
+    EXPECT_EQ(painter.transforms[1], local * base);
+    EXPECT_EQ(painter.GetTransform(), base);
+
+    // a list without transforms leaves the painter alone.
+    graph::DisplayList plain;
+    plain.FillRectangle(Rect(0.0f, 0.0f, 1.0f, 1.0f), graph::Color());
+    plain.Replay(painter);
+    EXPECT_EQ(painter.transforms.back(), base);
+    EXPECT_EQ(painter.GetTransform(), base);
+}
+
+TEST(NullPainterTest, CountsCommandsAndClips)
+{
+    graph::NullPainter painter;
+    RecordHelperFunc(painter);
+    EXPECT_EQ(painter.GetCommandCount(), 8);
+    EXPECT_EQ(painter.GetClipDepth(), 0);
+    EXPECT_EQ(painter.GetTransform(), Matrix::Rotation(30.0f, Point(5.0f, 5.0f)));
+    painter.PushClip(Rect(0.0f, 0.0f, 1.0f, 1.0f));
+    EXPECT_EQ(painter.GetClipDepth(), 1);
+    EXPECT_EQ(painter.CreateLayer(Size(10.0f, 10.0f)), nullptr);
+}
+
+class RecordControl : public Control
+{
+public:
+    RecordControl(const float width, const float height)
+    {
+        SetExtent(width, height);
+    }
+
+    void SetExtent(const float width, const float height)
+    {
+        BasicLayoutParams layout_params;
+        layout_params.size.width = MeasureLength(width);
+        layout_params.size.height = MeasureLength(height);
+        SetLayoutParams(layout_params);
+    }
+
+protected:
+    void OnDraw(graph::Painter& painter) override
+    {
+        painter.FillRectangle(Rect(Point::zero, GetSize()), graph::Color(0.0f, 0.0f, 1.0f));
+    }
+};
+
+// A control records its display list only when it is repainted or resized,
+// and replays it on the other frames.
+TEST(DisplayListTest, ControlRecordsOnlyWhenChanged)
+{
+    Window window;
+    controls::StackPanel panel(Orientation::Vertical);
+    RecordControl first(40.0f, 20.0f), second(40.0f, 20.0f), third(40.0f, 20.0f);
+    panel.AddChild(&first);
+    panel.AddChild(&second);
+    panel.AddChild(&third);
+    window.SetClientSize(Size(100.0f, 100.0f));
+    window.AddChild(&panel);
+
+    graph::NullPainter painter;
+    window.Render(painter);
+    // the window, the panel and the three controls.
+    EXPECT_EQ(window.GetLastDrawStatistics().recorded_count, 5);
+
+    window.Render(painter);
+    EXPECT_EQ(window.GetLastDrawStatistics().recorded_count, 0);
+    EXPECT_EQ(window.GetLastDrawStatistics().drawn_count, 5);
+
+    second.Repaint();
+    window.Render(painter);
+    EXPECT_EQ(window.GetLastDrawStatistics().recorded_count, 1);
+
+    // a new size records again, here the control and the panel growing with
+    // it, but the moved siblings don't.
+    first.SetExtent(50.0f, 30.0f);
+    window.Render(painter);
+    EXPECT_EQ(window.GetLastDrawStatistics().recorded_count, 2);
+    EXPECT_EQ(second.GetPositionRelative().y, 30.0f);
+
+    // laying out to the same size records nothing.
+    first.SetExtent(50.0f, 30.0f);
+    window.Render(painter);
+    EXPECT_EQ(window.GetLastDrawStatistics().recorded_count, 0);
+}
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ui/window.h"
+#include "ui/controls/flex_panel.h"
+
+using namespace cru::ui;
+using namespace cru::ui::controls;
+
+class FixedControl : public Control
+{
+public:
+    FixedControl() = default;
+};
+
+// Its height is inversely proportional to its width, as wrapped text is.
+class WrappingControl : public Control
+{
+public:
+    WrappingControl() = default;
+
+protected:
+    Size OnMeasure(const Size& available_size) override
+    {
+        const auto width = std::min(available_size.width, 100.0f);
+        return Size(width, 1000.0f / width);
+    }
+};
+
+std::shared_ptr<FlexLayoutParams> MakeFlexLayoutParamsHelperFunc(const float width, const float grow, const float shrink)
+{
+    auto layout_params = std::make_shared<FlexLayoutParams>();
+    layout_params->size.width = MeasureLength(width);
+    layout_params->size.height = MeasureLength(10.0f);
+    layout_params->grow = grow;
+    layout_params->shrink = shrink;
+    return layout_params;
+}
+
+class FlexPanelTest : public testing::Test
+{
+protected:
+    FlexPanelTest()
+    {
+        window_.SetClientSize(Size(200.0f, 100.0f));
+    }
+
+    // Add the children to the panel and the panel to the window, then lay out.
+    void LayOut(const std::vector<Control*>& children)
+    {
+        for (const auto child : children)
+            panel_.AddChild(child);
+        window_.AddChild(&panel_);
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    }
+
+    Window window_;
+    FlexPanel panel_;
+    FixedControl children_[3];
+    WrappingControl wrapping_;
+};
+
+TEST_F(FlexPanelTest, GrowIsClampedByMax)
+{
+    for (auto& child : children_)
+        child.SetLayoutParams(MakeFlexLayoutParamsHelperFunc(20.0f, 1.0f, 1.0f));
+    auto clamped = MakeFlexLayoutParamsHelperFunc(20.0f, 1.0f, 1.0f);
+    clamped->max_size.width = 30.0f;
+    children_[1].SetLayoutParams(clamped);
+    LayOut({ &children_[0], &children_[1], &children_[2] });
+
+    // the share the clamped child can't take goes to the others.
+    EXPECT_FLOAT_EQ(children_[0].GetSize().width, 85.0f);
+    EXPECT_FLOAT_EQ(children_[1].GetSize().width, 30.0f);
+    EXPECT_FLOAT_EQ(children_[2].GetSize().width, 85.0f);
+    EXPECT_FLOAT_EQ(children_[2].GetPositionRelative().x, 115.0f);
+}
+
+TEST_F(FlexPanelTest, ShrinkIsClampedByMin)
+{
+    window_.SetClientSize(Size(240.0f, 100.0f));
+    for (auto& child : children_)
+        child.SetLayoutParams(MakeFlexLayoutParamsHelperFunc(100.0f, 0.0f, 1.0f));
+    auto clamped = MakeFlexLayoutParamsHelperFunc(100.0f, 0.0f, 1.0f);
+    clamped->min_size.width = 90.0f;
+    children_[0].SetLayoutParams(clamped);
+    LayOut({ &children_[0], &children_[1], &children_[2] });
+
+    EXPECT_FLOAT_EQ(children_[0].GetSize().width, 90.0f);
+    EXPECT_FLOAT_EQ(children_[1].GetSize().width, 75.0f);
+    EXPECT_FLOAT_EQ(children_[2].GetSize().width, 75.0f);
+}
+
+TEST_F(FlexPanelTest, ShrunkChildIsMeasuredAtFinalLength)
+{
+    window_.SetClientSize(Size(50.0f, 100.0f));
+    auto layout_params = std::make_shared<FlexLayoutParams>();
+    wrapping_.SetLayoutParams(layout_params);
+    LayOut({ &wrapping_ });
+
+    // 100 wide and 10 high in infinite room, 50 wide and 20 high shrunk.
+    EXPECT_EQ(wrapping_.GetSize(), Size(50.0f, 20.0f));
+    EXPECT_EQ(panel_.GetSize(), Size(50.0f, 20.0f));
+}
+
+TEST_F(FlexPanelTest, WiderPanelRestoresBasis)
+{
+    window_.SetClientSize(Size(50.0f, 100.0f));
+    auto layout_params = std::make_shared<FlexLayoutParams>();
+    wrapping_.SetLayoutParams(layout_params);
+    LayOut({ &wrapping_ });
+    window_.SetClientSize(Size(200.0f, 100.0f));
+    window_.GetLayoutManager()->RefreshInvalidControlLayout();
+
+    EXPECT_EQ(wrapping_.GetSize(), Size(100.0f, 10.0f));
+    EXPECT_EQ(panel_.GetSize(), Size(100.0f, 10.0f));
+}
+
+struct FlexItemHelper
+{
+    float basis;
+    float grow;
+    float shrink;
+    float min_length;
+    float max_length;
+    float length;
+    bool is_frozen;
+};
+
+// Flex items the way the spec describes it: clamp the shares, freeze the
+// items clamped the way the total is, and share the rest again.
+void FlexByFreezingHelperFunc(std::vector<FlexItemHelper>& items, const float free_length)
+{
+    for (auto& item : items)
+    {
+        item.length = item.basis;
+        item.is_frozen = free_length > 0.0f ? item.grow <= 0.0f : free_length < 0.0f ? item.shrink * item.basis <= 0.0f : true;
+    }
+    while (true)
+    {
+        auto remaining_length = free_length;
+        auto total_weight = 0.0f;
+        for (const auto& item : items)
+            if (item.is_frozen)
+                remaining_length -= item.length - item.basis;
+            else
+                total_weight += free_length > 0.0f ? item.grow : item.shrink * item.basis;
+        if (total_weight <= 0.0f)
+            return;
+
+        auto total_violation = 0.0f;
+        std::vector<float> violations(items.size());
+        for (std::size_t i = 0; i < items.size(); i++)
+        {
+            auto& item = items[i];
+            if (item.is_frozen)
+                continue;
+            const auto target = item.basis + remaining_length * (free_length > 0.0f ? item.grow : item.shrink * item.basis) / total_weight;
+            item.length = std::max(item.min_length, std::min(target, item.max_length));
+            violations[i] = item.length - target;
+            total_violation += violations[i];
+        }
+        if (total_violation == 0.0f)
+            return;
+        for (std::size_t i = 0; i < items.size(); i++)
+            if (!items[i].is_frozen && (total_violation > 0.0f ? violations[i] > 0.0f : violations[i] < 0.0f))
+                items[i].is_frozen = true;
+    }
+}
+
+// Random bases, weights and limits, growing and shrinking, give the lengths
+// of freezing the clamped items round by round.
+TEST(FlexPanelRandomTest, MatchesFreezingRounds)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_real_distribution<float> length(0.0f, 100.0f);
+    for (auto round = 0; round < 200; round++)
+    {
+        const auto count = 1 + percent(random) % 30;
+        const auto panel_width = length(random) * static_cast<float>(count) * 2.0f;
+        Window window;
+        window.SetClientSize(Size(panel_width, 100.0f));
+        FlexPanel panel;
+        std::vector<std::unique_ptr<FixedControl>> children;
+        for (auto i = 0; i < count; i++)
+        {
+            auto layout_params = MakeFlexLayoutParamsHelperFunc(length(random), percent(random) < 20 ? 0.0f : length(random) / 10.0f,
+                percent(random) < 20 ? 0.0f : length(random) / 10.0f);
+            if (percent(random) < 40)
+                layout_params->min_size.width = length(random);
+            if (percent(random) < 40)
+                layout_params->max_size.width = length(random) * 2.0f;
+            children.push_back(std::make_unique<FixedControl>());
+            children.back()->SetLayoutParams(layout_params);
+            panel.AddChild(children.back().get());
+        }
+        window.AddChild(&panel);
+        window.GetLayoutManager()->RefreshInvalidControlLayout();
+
+        // the basis is the desired length, already within the limits.
+        std::vector<FlexItemHelper> items;
+        auto total_basis = 0.0f;
+        for (const auto& child : children)
+        {
+            const auto layout_params = child->GetLayoutParams<FlexLayoutParams>();
+            FlexItemHelper item{};
+            item.basis = child->GetDesiredSize().width;
+            item.grow = layout_params->grow;
+            item.shrink = layout_params->shrink;
+            item.min_length = layout_params->min_size.width.value_or(0.0f);
+            item.max_length = layout_params->max_size.width.value_or(std::numeric_limits<float>::infinity());
+            items.push_back(item);
+            total_basis += item.basis;
+        }
+        FlexByFreezingHelperFunc(items, panel_width - total_basis);
+
+        for (auto i = 0; i < count; i++)
+            ASSERT_NEAR(children[i]->GetSize().width, items[i].length, 1e-3f * std::max(1.0f, items[i].length))
+                << "round " << round << " child " << i;
+    }
+}
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ui/geometry_kernels.h"
+
+using namespace cru::ui;
+
+// The kernels are checked against the plain formulas they are defined by,
+// for every count up to a few vectors, so both the vector loops and the
+// loops over the remainder run. The test is built twice: with the kernels
+// of the target and with "CRU_GEOMETRY_SCALAR".
+
+constexpr int max_count = 37;
+
+// rects snap to a coarse grid, so edges are often shared and points often
+// lie on them; some are empty or of negative size.
+std::vector<Rect> MakeRectsHelperFunc(std::mt19937& random, const int count)
+{
+    std::uniform_int_distribution<int> coordinate(-8, 8);
+    std::vector<Rect> rects;
+    for (auto i = 0; i < count; i++)
+        rects.emplace_back(static_cast<float>(coordinate(random)) * 2.0f, static_cast<float>(coordinate(random)) * 2.0f,
+            static_cast<float>(coordinate(random)) * 1.5f, static_cast<float>(coordinate(random)) * 1.5f);
+    return rects;
+}
+
+std::vector<Point> MakePointsHelperFunc(std::mt19937& random, const int count)
+{
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    std::vector<Point> points;
+    for (auto i = 0; i < count; i++)
+        points.emplace_back(coordinate(random), coordinate(random));
+    return points;
+}
+
+void ExpectSameRectHelperFunc(const Rect& actual, const Rect& expected, const int index)
+{
+    EXPECT_EQ(actual.left, expected.left) << index;
+    EXPECT_EQ(actual.top, expected.top) << index;
+    EXPECT_EQ(actual.width, expected.width) << index;
+    EXPECT_EQ(actual.height, expected.height) << index;
+}
+
+TEST(GeometryKernelsTest, InstructionSetIsNamed)
+{
+    const std::string name = geometry::GetKernelInstructionSet();
+#ifdef CRU_GEOMETRY_SCALAR
+    EXPECT_EQ(name, "scalar");
+#else
+    EXPECT_TRUE(name == "avx2" || name == "sse2" || name == "neon" || name == "scalar") << name;
+#endif
+}
+
+TEST(GeometryKernelsTest, TranslatePoints)
+{
+    std::mt19937 random(1);
+    for (auto count = 0; count <= max_count; count++)
+    {
+        auto points = MakePointsHelperFunc(random, count);
+        const auto expected = points;
+        const Point offset(1.25f, -3.5f);
+        geometry::TranslatePoints(points.data(), count, offset);
+        for (auto i = 0; i < count; i++)
+        {
+            EXPECT_EQ(points[i].x, expected[i].x + offset.x);
+            EXPECT_EQ(points[i].y, expected[i].y + offset.y);
+        }
+    }
+}
+
+TEST(GeometryKernelsTest, TransformPoints)
+{
+    std::mt19937 random(2);
+    const auto matrix = Matrix::Rotation(30.0f, Point(4.0f, 2.0f)) * Matrix::Scale(1.5f, 0.75f) * Matrix::Translation(-7.0f, 3.0f);
+    for (auto count = 0; count <= max_count; count++)
+    {
+        const auto source = MakePointsHelperFunc(random, count);
+        std::vector<Point> destination(count);
+        geometry::TransformPoints(source.data(), destination.data(), count, matrix);
+        auto in_place = source;
+        geometry::TransformPoints(in_place.data(), in_place.data(), count, matrix);
+        for (auto i = 0; i < count; i++)
+        {
+            const auto& point = source[i];
+            const auto x = (point.x * matrix.m11 + point.y * matrix.m21) + matrix.dx;
+            const auto y = (point.x * matrix.m12 + point.y * matrix.m22) + matrix.dy;
+            EXPECT_EQ(destination[i].x, x) << i;
+            EXPECT_EQ(destination[i].y, y) << i;
+            EXPECT_EQ(in_place[i].x, x) << i;
+            EXPECT_EQ(in_place[i].y, y) << i;
+        }
+    }
+}
+
+TEST(GeometryKernelsTest, IntersectAndUnionRects)
+{
+    std::mt19937 random(3);
+    for (auto count = 0; count <= max_count; count++)
+    {
+        const auto left = MakeRectsHelperFunc(random, count);
+        const auto right = MakeRectsHelperFunc(random, count);
+        std::vector<Rect> intersections(count), unions(count);
+        geometry::IntersectRects(left.data(), right.data(), intersections.data(), count);
+        geometry::UnionRects(left.data(), right.data(), unions.data(), count);
+        for (auto i = 0; i < count; i++)
+        {
+            const auto& l = left[i];
+            const auto& r = right[i];
+            const auto intersection_left = std::max(l.left, r.left);
+            const auto intersection_top = std::max(l.top, r.top);
+            ExpectSameRectHelperFunc(intersections[i], Rect(intersection_left, intersection_top,
+                std::max(std::min(l.left + l.width, r.left + r.width) - intersection_left, 0.0f),
+                std::max(std::min(l.top + l.height, r.top + r.height) - intersection_top, 0.0f)), i);
+            ExpectSameRectHelperFunc(unions[i], Rect::FromVertices(std::min(l.left, r.left), std::min(l.top, r.top),
+                std::max(l.left + l.width, r.left + r.width), std::max(l.top + l.height, r.top + r.height)), i);
+        }
+    }
+}
+
+TEST(GeometryKernelsTest, GetBounds)
+{
+    ExpectSameRectHelperFunc(geometry::GetBounds(nullptr, 0), Rect(0.0f, 0.0f, 0.0f, 0.0f), 0);
+
+    std::mt19937 random(4);
+    for (auto count = 1; count <= max_count; count++)
+    {
+        const auto rects = MakeRectsHelperFunc(random, count);
+        auto left = rects[0].left, top = rects[0].top;
+        auto right = rects[0].left + rects[0].width, bottom = rects[0].top + rects[0].height;
+        for (const auto& rect : rects)
+        {
+            left = std::min(left, rect.left);
+            top = std::min(top, rect.top);
+            right = std::max(right, rect.left + rect.width);
+            bottom = std::max(bottom, rect.top + rect.height);
+        }
+        ExpectSameRectHelperFunc(geometry::GetBounds(rects.data(), count), Rect::FromVertices(left, top, right, bottom), count);
+    }
+}
+
+TEST(GeometryKernelsTest, ContainsPointAndFindLastContaining)
+{
+    std::mt19937 random(5);
+    std::uniform_int_distribution<int> coordinate(-8, 8);
+    for (auto count = 0; count <= max_count; count++)
+    {
+        const auto rects = MakeRectsHelperFunc(random, count);
+        for (auto j = 0; j < 16; j++)
+        {
+            // points on the grid of the rects test the edges.
+            const Point point(static_cast<float>(coordinate(random)), static_cast<float>(coordinate(random)));
+            std::vector<std::uint8_t> result(count);
+            auto expected_count = 0;
+            auto expected_last = -1;
+            const auto inside_count = geometry::ContainsPoint(rects.data(), count, point, result.data());
+            for (auto i = 0; i < count; i++)
+            {
+                const auto& rect = rects[i];
+                const auto inside = point.x >= rect.left && point.y >= rect.top &&
+                    point.x < rect.left + rect.width && point.y < rect.top + rect.height;
+                EXPECT_EQ(result[i], inside ? 1 : 0) << i;
+                if (inside)
+                {
+                    expected_count++;
+                    expected_last = i;
+                }
+            }
+            EXPECT_EQ(inside_count, expected_count);
+            EXPECT_EQ(geometry::FindLastContaining(rects.data(), count, point), expected_last);
+        }
+    }
+}
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graph/glyph_atlas.h"
+#include "graph/skyline_packer.h"
+
+using namespace cru;
+using namespace cru::graph;
+
+GlyphKey MakeKeyHelperFunc(const std::uint32_t glyph_index, const float size = 20.0f, const GlyphMode mode = GlyphMode::Coverage)
+{
+    GlyphKey key;
+    key.font_id = 1;
+    key.glyph_index = glyph_index;
+    key.size = size;
+    key.mode = mode;
+    return key;
+}
+
+bool IsSameRectHelperFunc(const PackedRect& left, const PackedRect& right)
+{
+    return left.x == right.x && left.y == right.y && left.width == right.width && left.height == right.height;
+}
+
+bool IsOverlappedHelperFunc(const PackedRect& left, const PackedRect& right)
+{
+    return left.x < right.x + right.width && right.x < left.x + left.width &&
+        left.y < right.y + right.height && right.y < left.y + left.height;
+}
+
+TEST(SkylinePackerTest, PacksRectsApartInBounds)
+{
+    SkylinePacker packer(256, 256);
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> length(1, 24);
+    std::vector<PackedRect> rects;
+    PackedRect rect;
+    while (packer.Pack(length(random), length(random), rect))
+    {
+        ASSERT_GE(rect.x, 0);
+        ASSERT_GE(rect.y, 0);
+        ASSERT_LE(rect.x + rect.width, 256);
+        ASSERT_LE(rect.y + rect.height, 256);
+        for (const auto& other : rects)
+            ASSERT_FALSE(IsOverlappedHelperFunc(rect, other));
+        rects.push_back(rect);
+    }
+    // glyph like rects fill most of the texture before it is full.
+    EXPECT_GT(rects.size(), 100u);
+    EXPECT_LE(packer.GetUsedArea(), 256LL * 256);
+
+    packer.Reset();
+    EXPECT_EQ(packer.GetUsedArea(), 0);
+    ASSERT_TRUE(packer.Pack(256, 256, rect));
+    EXPECT_EQ(rect.x, 0);
+    EXPECT_EQ(rect.y, 0);
+}
+
+TEST(SkylinePackerTest, RejectsRectLargerThanTexture)
+{
+    SkylinePacker packer(64, 64);
+    PackedRect rect;
+    EXPECT_FALSE(packer.Pack(65, 1, rect));
+    EXPECT_FALSE(packer.Pack(1, 65, rect));
+    EXPECT_TRUE(packer.Pack(64, 64, rect));
+    EXPECT_FALSE(packer.Pack(1, 1, rect));
+}
+
+TEST(GlyphAtlasTest, RejectsInvalidArguments)
+{
+    StubGlyphRasterizer rasterizer;
+    EXPECT_THROW(GlyphAtlas(nullptr), std::invalid_argument);
+    EXPECT_THROW(GlyphAtlas(&rasterizer, 0), std::invalid_argument);
+    EXPECT_THROW(GlyphAtlas(&rasterizer, 64, 0), std::invalid_argument);
+    GlyphAtlas atlas(&rasterizer, 64, 2);
+    EXPECT_THROW(atlas.GetPage(2), std::invalid_argument);
+}
+
+TEST(GlyphAtlasTest, RasterizesGlyphOnce)
+{
+    StubGlyphRasterizer rasterizer;
+    GlyphAtlas atlas(&rasterizer);
+    GlyphLocation location;
+    EXPECT_FALSE(atlas.Find(MakeKeyHelperFunc(7), location));
+
+    GlyphLocation first, second;
+    ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(7), first));
+    ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(7), second));
+    ASSERT_TRUE(atlas.Find(MakeKeyHelperFunc(7), location));
+    EXPECT_TRUE(IsSameRectHelperFunc(first.rect, second.rect));
+    EXPECT_TRUE(IsSameRectHelperFunc(first.rect, location.rect));
+
+    // sizes are cached by quarters of a pixel.
+    ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(7, 20.05f), location));
+    EXPECT_TRUE(IsSameRectHelperFunc(first.rect, location.rect));
+
+    const auto statistics = atlas.GetStatistics();
+    EXPECT_EQ(statistics.rasterized_count, 1);
+    EXPECT_EQ(statistics.glyph_count, 1);
+    EXPECT_EQ(statistics.page_count, 1);
+}
+
+TEST(GlyphAtlasTest, PageHoldsRasterizedPixels)
+{
+    StubGlyphRasterizer rasterizer;
+    GlyphAtlas atlas(&rasterizer, 256);
+    for (std::uint32_t glyph_index = 0; glyph_index < 10; glyph_index++)
+    {
+        const auto size = 12.0f + static_cast<float>(glyph_index);
+        GlyphLocation location;
+        ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(glyph_index, size), location));
+        const auto image = rasterizer.Rasterize(1, glyph_index, size);
+        ASSERT_EQ(location.rect.width, image.width);
+        ASSERT_EQ(location.rect.height, image.height);
+        EXPECT_EQ(location.origin_x, image.origin_x);
+        EXPECT_EQ(location.origin_y, image.origin_y);
+
+        const auto& page = atlas.GetPage(location.page);
+        for (auto y = 0; y < image.height; y++)
+            for (auto x = 0; x < image.width; x++)
+                ASSERT_EQ(page.pixels[(location.rect.y + y) * page.width + location.rect.x + x], image.pixels[y * image.width + x])
+                    << "glyph " << glyph_index << " at " << x << ", " << y;
+
+        // the dirty rect covers every glyph packed since it was cleared.
+        EXPECT_LE(page.dirty_rect.x, location.rect.x);
+        EXPECT_LE(page.dirty_rect.y, location.rect.y);
+        EXPECT_GE(page.dirty_rect.x + page.dirty_rect.width, location.rect.x + location.rect.width);
+        EXPECT_GE(page.dirty_rect.y + page.dirty_rect.height, location.rect.y + location.rect.height);
+    }
+    atlas.ClearDirtyRect(0);
+    EXPECT_EQ(atlas.GetPage(0).dirty_rect.width, 0);
+}
+
+TEST(GlyphAtlasTest, PacksGlyphsApartByPadding)
+{
+    StubGlyphRasterizer rasterizer;
+    GlyphAtlas atlas(&rasterizer, 256);
+    std::vector<GlyphLocation> locations;
+    for (std::uint32_t glyph_index = 0; glyph_index < 100; glyph_index++)
+    {
+        GlyphLocation location;
+        ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(glyph_index, 10.0f + static_cast<float>(glyph_index % 7) * 2.0f), location));
+        auto padded_rect = location.rect;
+        padded_rect.width += GlyphAtlas::padding;
+        padded_rect.height += GlyphAtlas::padding;
+        for (const auto& other : locations)
+            if (other.page == location.page)
+                ASSERT_FALSE(IsOverlappedHelperFunc(padded_rect, other.rect)) << "glyph " << glyph_index;
+        locations.push_back(location);
+    }
+}
+
+TEST(GlyphAtlasTest, SignedDistanceIgnoresSize)
+{
+    StubGlyphRasterizer rasterizer;
+    GlyphAtlas atlas(&rasterizer);
+    GlyphLocation small, large;
+    ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(3, 12.0f, GlyphMode::SignedDistance), small));
+    ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(3, 48.0f, GlyphMode::SignedDistance), large));
+    EXPECT_TRUE(IsSameRectHelperFunc(small.rect, large.rect));
+    EXPECT_EQ(atlas.GetStatistics().rasterized_count, 1);
+
+    const auto image = rasterizer.Rasterize(1, 3, GlyphAtlas::signed_distance_size);
+    EXPECT_EQ(small.rect.width, image.width + GlyphAtlas::signed_distance_spread * 2);
+    EXPECT_EQ(small.rect.height, image.height + GlyphAtlas::signed_distance_spread * 2);
+}
+
+TEST(GlyphAtlasTest, EvictsLeastRecentlyUsedPage)
+{
+    StubGlyphRasterizer rasterizer;
+    GlyphAtlas atlas(&rasterizer, 64, 2);
+    // a glyph a frame, so every page but the current one can be evicted.
+    for (std::uint32_t glyph_index = 0; glyph_index < 200; glyph_index++)
+    {
+        atlas.BeginFrame();
+        GlyphLocation location;
+        ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(glyph_index), location)) << "glyph " << glyph_index;
+    }
+    auto statistics = atlas.GetStatistics();
+    EXPECT_GT(statistics.evicted_page_count, 0);
+    EXPECT_EQ(statistics.failed_count, 0);
+    EXPECT_EQ(statistics.rasterized_count, 200);
+    EXPECT_LT(statistics.glyph_count, 200);
+
+    // the first glyph was evicted, so it is rasterized again.
+    GlyphLocation location;
+    EXPECT_FALSE(atlas.Find(MakeKeyHelperFunc(0), location));
+    atlas.BeginFrame();
+    EXPECT_TRUE(atlas.Get(MakeKeyHelperFunc(0), location));
+    EXPECT_TRUE(atlas.Find(MakeKeyHelperFunc(0), location));
+    EXPECT_EQ(atlas.GetStatistics().rasterized_count, 201);
+}
+
+TEST(GlyphAtlasTest, KeepsPagesUsedInFrame)
+{
+    StubGlyphRasterizer rasterizer;
+    GlyphAtlas atlas(&rasterizer, 64, 2);
+    atlas.BeginFrame();
+    std::vector<GlyphKey> packed_keys;
+    for (std::uint32_t glyph_index = 0; glyph_index < 200; glyph_index++)
+    {
+        GlyphLocation location;
+        if (atlas.Get(MakeKeyHelperFunc(glyph_index), location))
+            packed_keys.push_back(MakeKeyHelperFunc(glyph_index));
+    }
+    const auto statistics = atlas.GetStatistics();
+    EXPECT_EQ(statistics.evicted_page_count, 0);
+    EXPECT_GT(statistics.failed_count, 0);
+    EXPECT_EQ(static_cast<int>(packed_keys.size()) + statistics.failed_count, 200);
+    for (const auto& key : packed_keys)
+    {
+        GlyphLocation location;
+        EXPECT_TRUE(atlas.Find(key, location)) << "glyph " << key.glyph_index;
+    }
+}
+
+// Glyphs are found on another thread while they are packed and evicted, as
+// shaping in parallel does, within each frame. A found location is one of the
+// glyph, never one of a stale table. The reader only finds glyphs of its
+// frame, as a found glyph keeps its page from being evicted in the frame, so
+// finding older ones could leave no page to evict.
+TEST(GlyphAtlasTest, FindsWhileGetting)
+{
+    StubGlyphRasterizer rasterizer;
+    GlyphAtlas atlas(&rasterizer, 128, 2);
+    constexpr std::uint32_t glyph_count = 400;
+    constexpr std::uint32_t frame_glyph_count = 8;
+    std::atomic<int> wrong_count{ 0 };
+    for (std::uint32_t frame_start = 0; frame_start < glyph_count; frame_start += frame_glyph_count)
+    {
+        atlas.BeginFrame();
+        std::atomic<bool> is_done{ false };
+        std::thread reader([&atlas, &is_done, &wrong_count, frame_start] {
+            auto glyph_index = frame_start;
+            while (!is_done.load())
+            {
+                GlyphLocation location;
+                const auto key = MakeKeyHelperFunc(glyph_index);
+                // the stub makes glyphs as wide as their index says.
+                if (atlas.Find(key, location) && location.rect.width != static_cast<int>(std::ceil(key.size * (0.3f + 0.1f * static_cast<float>(glyph_index % 5)))))
+                    wrong_count++;
+                glyph_index = glyph_index + 1 < frame_start + frame_glyph_count ? glyph_index + 1 : frame_start;
+            }
+        });
+        for (auto glyph_index = frame_start; glyph_index < frame_start + frame_glyph_count; glyph_index++)
+        {
+            GlyphLocation location;
+            EXPECT_TRUE(atlas.Get(MakeKeyHelperFunc(glyph_index), location));
+        }
+        is_done = true;
+        reader.join();
+    }
+    EXPECT_EQ(wrong_count.load(), 0);
+}
+
+// New glyphs every frame evict pages again and again, which leaves removed
+// slots and replaces the lookup table, but replaced tables are freed.
+TEST(GlyphAtlasTest, ChurnKeepsTablesBounded)
+{
+    StubGlyphRasterizer rasterizer;
+    GlyphAtlas atlas(&rasterizer, 256, 2);
+    constexpr int frame_count = 5000;
+    constexpr std::uint32_t frame_glyph_count = 20;
+    std::size_t max_table_byte_size = 0;
+    std::uint32_t glyph_index = 0;
+    for (auto frame = 0; frame < frame_count; frame++)
+    {
+        atlas.BeginFrame();
+        ASSERT_EQ(atlas.GetStatistics().table_count, 1);
+        for (std::uint32_t i = 0; i < frame_glyph_count; i++)
+        {
+            GlyphLocation location;
+            ASSERT_TRUE(atlas.Get(MakeKeyHelperFunc(glyph_index++), location));
+        }
+        const auto statistics = atlas.GetStatistics();
+        ASSERT_LE(statistics.table_count, 3) << "frame " << frame;
+        max_table_byte_size = std::max(max_table_byte_size, statistics.table_byte_size);
+    }
+    const auto statistics = atlas.GetStatistics();
+    EXPECT_GT(statistics.evicted_page_count, 100);
+    // a table has at most 8 slots of under 64 bytes a live glyph, and a frame
+    // keeps the current and the replaced one, far from all glyphs ever packed.
+    EXPECT_LT(max_table_byte_size, static_cast<std::size_t>(statistics.glyph_count + frame_glyph_count) * 8 * 64 * 2);
+    EXPECT_LT(statistics.glyph_count, static_cast<int>(glyph_index) / 10);
+}
@@ -0,0 +1,130 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ui/window.h"
+#include "ui/controls/grid.h"
+
+using namespace cru::ui;
+using namespace cru::ui::controls;
+
+class TestControl : public Control
+{
+public:
+    TestControl() = default;
+};
+
+std::shared_ptr<GridLayoutParams> MakeLayoutParamsHelperFunc(const int row, const int column, const float width, const float height, const int column_span = 1)
+{
+    auto layout_params = std::make_shared<GridLayoutParams>();
+    layout_params->row = row;
+    layout_params->column = column;
+    layout_params->column_span = column_span;
+    layout_params->size.width = MeasureLength(width);
+    layout_params->size.height = MeasureLength(height);
+    return layout_params;
+}
+
+// Columns of 30, auto, and stars of 1 and 3, and rows of auto, 20 and a
+// star, in a window 200 by 100.
+class GridTest : public testing::Test
+{
+protected:
+    GridTest()
+        : grid_(
+            { GridLength::Auto(), GridLength::Fixed(20.0f), GridLength::Star() },
+            { GridLength::Fixed(30.0f), GridLength::Auto(), GridLength::Star(1.0f), GridLength::Star(3.0f) })
+    {
+        corner_ = AddCell(MakeLayoutParamsHelperFunc(0, 0, 10.0f, 15.0f));
+        auto_cell_ = AddCell(MakeLayoutParamsHelperFunc(0, 1, 40.0f, 12.0f));
+        changing_cell_ = AddCell(MakeLayoutParamsHelperFunc(1, 1, 25.0f, 8.0f));
+        // gives 100 less the fixed 30 to the auto column.
+        spanning_cell_ = AddCell(MakeLayoutParamsHelperFunc(2, 0, 100.0f, 10.0f, 2));
+        // only in fixed and star tracks, so it waits for the stars.
+        star_cell_ = AddCell(MakeLayoutParamsHelperFunc(1, 3, 10.0f, 10.0f));
+        window_.SetClientSize(Size(200.0f, 100.0f));
+        window_.AddChild(&grid_);
+        Refresh();
+    }
+
+    TestControl* AddCell(std::shared_ptr<GridLayoutParams> layout_params)
+    {
+        cells_.push_back(std::make_unique<TestControl>());
+        cells_.back()->SetLayoutParams(std::move(layout_params));
+        grid_.AddChild(cells_.back().get());
+        return cells_.back().get();
+    }
+
+    void Refresh()
+    {
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    }
+
+    Window window_;
+    Grid grid_;
+    std::vector<std::unique_ptr<TestControl>> cells_;
+    TestControl* corner_;
+    TestControl* auto_cell_;
+    TestControl* changing_cell_;
+    TestControl* spanning_cell_;
+    TestControl* star_cell_;
+};
+
+TEST_F(GridTest, SolvesAutoFixedAndStarTracks)
+{
+    EXPECT_EQ(grid_.GetLastMeasuredCellCount(), 5);
+    EXPECT_EQ(grid_.GetColumnLength(0), 30.0f);
+    EXPECT_EQ(grid_.GetColumnLength(1), 70.0f);
+    // the 100 left is shared 1 to 3.
+    EXPECT_EQ(grid_.GetColumnLength(2), 25.0f);
+    EXPECT_EQ(grid_.GetColumnLength(3), 75.0f);
+    EXPECT_EQ(grid_.GetRowLength(0), 15.0f);
+    EXPECT_EQ(grid_.GetRowLength(1), 20.0f);
+    EXPECT_EQ(grid_.GetRowLength(2), 65.0f);
+
+    EXPECT_EQ(corner_->GetPositionRelative(), Point(0.0f, 0.0f));
+    EXPECT_EQ(auto_cell_->GetPositionRelative(), Point(30.0f, 0.0f));
+    EXPECT_EQ(changing_cell_->GetPositionRelative(), Point(30.0f, 15.0f));
+    EXPECT_EQ(spanning_cell_->GetPositionRelative(), Point(0.0f, 35.0f));
+    EXPECT_EQ(star_cell_->GetPositionRelative(), Point(125.0f, 15.0f));
+}
+
+// A changed cell measures only itself and its track, until the track grows
+// and the stars shrink, which measures the cell waiting for them again.
+TEST_F(GridTest, ChangedCellMeasuresOnlyItself)
+{
+    changing_cell_->SetLayoutParams(MakeLayoutParamsHelperFunc(1, 1, 50.0f, 8.0f));
+    Refresh();
+    EXPECT_EQ(grid_.GetLastMeasuredCellCount(), 1);
+    EXPECT_EQ(grid_.GetLastResolvedTrackCount(), 1);
+    EXPECT_EQ(grid_.GetColumnLength(1), 70.0f);
+    EXPECT_EQ(star_cell_->GetPositionRelative(), Point(125.0f, 15.0f));
+
+    changing_cell_->SetLayoutParams(MakeLayoutParamsHelperFunc(1, 1, 90.0f, 8.0f));
+    Refresh();
+    EXPECT_EQ(grid_.GetLastMeasuredCellCount(), 2);
+    EXPECT_EQ(grid_.GetColumnLength(1), 90.0f);
+    EXPECT_EQ(grid_.GetColumnLength(2), 20.0f);
+    EXPECT_EQ(grid_.GetColumnLength(3), 60.0f);
+    EXPECT_EQ(star_cell_->GetPositionRelative(), Point(140.0f, 15.0f));
+
+    // shrunk back, the span decides the track again.
+    changing_cell_->SetLayoutParams(MakeLayoutParamsHelperFunc(1, 1, 25.0f, 8.0f));
+    Refresh();
+    EXPECT_EQ(grid_.GetColumnLength(1), 70.0f);
+    EXPECT_EQ(star_cell_->GetPositionRelative(), Point(125.0f, 15.0f));
+}
+
+// A cell moved to another track leaves the old one.
+TEST_F(GridTest, MovedCellLeavesItsTrack)
+{
+    auto_cell_->SetLayoutParams(MakeLayoutParamsHelperFunc(1, 2, 40.0f, 12.0f));
+    Refresh();
+    EXPECT_EQ(grid_.GetRowLength(0), 15.0f);
+    corner_->SetLayoutParams(MakeLayoutParamsHelperFunc(1, 0, 10.0f, 15.0f));
+    Refresh();
+    EXPECT_EQ(grid_.GetRowLength(0), 0.0f);
+    EXPECT_EQ(changing_cell_->GetPositionRelative(), Point(30.0f, 0.0f));
+    EXPECT_EQ(auto_cell_->GetPositionRelative(), Point(100.0f, 0.0f));
+}
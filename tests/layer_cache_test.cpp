@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "graph/display_list.h"
+#include "graph/image_compare.h"
+#include "graph/software_painter.h"
+#include "ui/window.h"
+#include "ui/controls/stack_panel.h"
+
+using namespace cru;
+using namespace cru::ui;
+
+class SquareControl : public Control
+{
+public:
+    SquareControl(const graph::Color& color, const float length)
+        : color_(color)
+    {
+        BasicLayoutParams layout_params;
+        layout_params.size.width = MeasureLength(length);
+        layout_params.size.height = MeasureLength(length);
+        SetLayoutParams(layout_params);
+    }
+
+protected:
+    void OnDraw(graph::Painter& painter) override
+    {
+        painter.FillRoundedRectangle(Rect(Point::zero, GetSize()), 4.0f, 4.0f, color_);
+    }
+
+private:
+    graph::Color color_;
+};
+
+// A layer of another kind of painter, which a software painter can't draw.
+class OtherLayer : public graph::Layer
+{
+public:
+    explicit OtherLayer(const Size& size) : size_(size) { }
+
+    Size GetSize() const override
+    {
+        return size_;
+    }
+
+    std::size_t GetByteSize() const override
+    {
+        return 1;
+    }
+
+private:
+    Size size_;
+};
+
+class OtherLayerPainter : public graph::NullPainter
+{
+public:
+    std::shared_ptr<graph::Layer> CreateLayer(const Size& size) override
+    {
+        return std::make_shared<OtherLayer>(size);
+    }
+
+    void PaintLayer(graph::Layer& layer, const std::function<void(graph::Painter&)>& action) override
+    {
+        graph::NullPainter painter;
+        action(painter);
+    }
+
+    bool CanDrawLayer(const graph::Layer& layer) const override
+    {
+        return dynamic_cast<const OtherLayer*>(&layer) != nullptr;
+    }
+};
+
+constexpr int window_size = 100;
+
+// Two columns of two squares, each column cached as a layer.
+class LayerCacheTest : public testing::Test
+{
+protected:
+    LayerCacheTest()
+        : columns_(Orientation::Horizontal),
+        left_(Orientation::Vertical),
+        right_(Orientation::Vertical),
+        squares_{
+            { graph::Color(1.0f, 0.0f, 0.0f), 30.0f }, { graph::Color(0.0f, 0.0f, 1.0f, 0.5f), 25.0f },
+            { graph::Color(0.0f, 0.5f, 0.0f), 20.0f }, { graph::Color(0.5f, 0.5f, 0.0f), 35.0f }
+        }
+    {
+        left_.AddChild(&squares_[0]);
+        left_.AddChild(&squares_[1]);
+        right_.AddChild(&squares_[2]);
+        right_.AddChild(&squares_[3]);
+        columns_.AddChild(&left_);
+        columns_.AddChild(&right_);
+        left_.SetCachedAsLayer(true);
+        right_.SetCachedAsLayer(true);
+        window_.SetClientSize(Size(static_cast<float>(window_size), static_cast<float>(window_size)));
+        window_.AddChild(&columns_);
+    }
+
+    graph::Bitmap Render()
+    {
+        graph::Bitmap bitmap(window_size, window_size);
+        graph::SoftwarePainter painter(&bitmap);
+        window_.Render(painter);
+        return bitmap;
+    }
+
+    // Render without layers, to compare the pixels with.
+    graph::Bitmap RenderWithoutLayers()
+    {
+        left_.SetCachedAsLayer(false);
+        right_.SetCachedAsLayer(false);
+        auto bitmap = Render();
+        left_.SetCachedAsLayer(true);
+        right_.SetCachedAsLayer(true);
+        return bitmap;
+    }
+
+    const DrawStatistics& GetStatistics() const
+    {
+        return window_.GetLastDrawStatistics();
+    }
+
+    Window window_;
+    controls::StackPanel columns_;
+    controls::StackPanel left_;
+    controls::StackPanel right_;
+    SquareControl squares_[4];
+};
+
+TEST_F(LayerCacheTest, HitsUntilDescendantChanges)
+{
+    const auto first = Render();
+    EXPECT_EQ(GetStatistics().layer_miss_count, 2);
+    EXPECT_EQ(GetStatistics().layer_hit_count, 0);
+
+    const auto second = Render();
+    EXPECT_EQ(GetStatistics().layer_miss_count, 0);
+    EXPECT_EQ(GetStatistics().layer_hit_count, 2);
+    // the squares are not drawn, only the layers.
+    EXPECT_EQ(GetStatistics().drawn_count, 2);
+    EXPECT_TRUE(graph::CompareBitmaps(first, second).IsSame());
+
+    // only the column of the changed square is painted again.
+    squares_[3].Repaint();
+    Render();
+    EXPECT_EQ(GetStatistics().layer_miss_count, 1);
+    EXPECT_EQ(GetStatistics().layer_hit_count, 1);
+}
+
+TEST_F(LayerCacheTest, KeepsPixels)
+{
+    Render();
+    const auto with_layers = Render();
+    ASSERT_EQ(GetStatistics().layer_hit_count, 2);
+    const auto without_layers = RenderWithoutLayers();
+    EXPECT_EQ(GetStatistics().layer_hit_count, 0);
+    const auto difference = graph::CompareBitmaps(with_layers, without_layers);
+    EXPECT_TRUE(difference.IsSame()) << difference.different_pixel_count << " pixels differ by up to " << difference.max_channel_difference;
+}
+
+TEST_F(LayerCacheTest, EvictsByBudget)
+{
+    Render();
+    const auto left_byte_size = window_.GetLayerCache().Find(&left_)->layer->GetByteSize();
+    const auto right_byte_size = window_.GetLayerCache().Find(&right_)->layer->GetByteSize();
+
+    // room for the larger layer only, so each frame drops the other one.
+    window_.GetLayerCache().SetBudget(std::max(left_byte_size, right_byte_size));
+    EXPECT_EQ(window_.GetLayerCache().GetCount(), 1);
+    for (auto i = 0; i < 3; i++)
+    {
+        Render();
+        EXPECT_EQ(GetStatistics().layer_miss_count, 2);
+        EXPECT_EQ(window_.GetLayerCache().GetCount(), 1);
+    }
+
+    // a budget smaller than any layer keeps none, and the subtrees are
+    // still drawn.
+    window_.GetLayerCache().SetBudget(16);
+    const auto bitmap = Render();
+    EXPECT_EQ(window_.GetLayerCache().GetCount(), 0);
+    EXPECT_TRUE(graph::CompareBitmaps(bitmap, RenderWithoutLayers()).IsSame());
+}
+
+// A layer of another kind of painter is a miss rather than dropping the
+// subtree or failing.
+TEST_F(LayerCacheTest, OtherPainterKindIsMiss)
+{
+    OtherLayerPainter other_painter;
+    window_.Render(other_painter);
+    EXPECT_EQ(GetStatistics().layer_miss_count, 2);
+
+    graph::Bitmap bitmap(window_size, window_size);
+    graph::SoftwarePainter painter(&bitmap);
+    EXPECT_NO_THROW(window_.Render(painter));
+    EXPECT_EQ(GetStatistics().layer_miss_count, 2);
+    EXPECT_EQ(GetStatistics().layer_hit_count, 0);
+    EXPECT_TRUE(graph::CompareBitmaps(bitmap, RenderWithoutLayers()).IsSame());
+
+    // a display list has no layers, so the subtrees are recorded.
+    Render();
+    graph::DisplayList display_list;
+    window_.Render(display_list);
+    EXPECT_EQ(GetStatistics().layer_hit_count, 0);
+    graph::Bitmap replayed(window_size, window_size);
+    graph::SoftwarePainter replay_painter(&replayed);
+    display_list.Replay(replay_painter);
+    EXPECT_TRUE(graph::CompareBitmaps(replayed, RenderWithoutLayers()).IsSame());
+}
@@ -0,0 +1,45 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ui/layout_params_pool.h"
+
+using namespace cru::ui;
+
+BasicLayoutParams MakeLayoutParamsHelperFunc(const int index)
+{
+    BasicLayoutParams params;
+    params.size.width = MeasureLength(static_cast<float>(index % 16) * 8.0f);
+    params.size.height = MeasureLength(0.0f, MeasureMode::Content);
+    return params;
+}
+
+TEST(LayoutParamsPoolTest, EqualParamsShareOneInstance)
+{
+    LayoutParamsPool pool;
+    const auto first = pool.Intern(MakeLayoutParamsHelperFunc(1));
+    EXPECT_EQ(pool.Intern(MakeLayoutParamsHelperFunc(1)), first);
+    EXPECT_NE(pool.Intern(MakeLayoutParamsHelperFunc(2)), first);
+}
+
+TEST(LayoutParamsPoolTest, ConcurrentInternsShareOneInstance)
+{
+    LayoutParamsPool pool;
+    constexpr int thread_count = 8;
+    constexpr int intern_count = 10000;
+    std::vector<std::vector<std::shared_ptr<const BasicLayoutParams>>> results(thread_count);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < thread_count; i++)
+        threads.emplace_back([&pool, &results, i] {
+            for (auto j = 0; j < intern_count; j++)
+                results[i].push_back(pool.Intern(MakeLayoutParamsHelperFunc(j)));
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto i = 1; i < thread_count; i++)
+        for (auto j = 0; j < intern_count; j++)
+            ASSERT_EQ(results[i][j], results[0][j]);
+    EXPECT_EQ(pool.GetEntryCount(), 16);
+}
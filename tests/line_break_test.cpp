@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graph/line_break.h"
+
+using namespace cru;
+using namespace cru::graph;
+
+std::vector<LineBreakKind> FindLineBreaksHelperFunc(const String& text)
+{
+    std::vector<LineBreakKind> breaks;
+    FindLineBreaks(text, breaks);
+    return breaks;
+}
+
+TEST(LineBreakTest, BreaksAfterSpaces)
+{
+    const auto breaks = FindLineBreaksHelperFunc(L"ab cd");
+    ASSERT_EQ(breaks.size(), 6u);
+    EXPECT_EQ(breaks[0], LineBreakKind::None);
+    EXPECT_EQ(breaks[1], LineBreakKind::None);
+    EXPECT_EQ(breaks[2], LineBreakKind::None);
+    EXPECT_EQ(breaks[3], LineBreakKind::Allowed);
+    EXPECT_EQ(breaks[4], LineBreakKind::None);
+    EXPECT_EQ(breaks[5], LineBreakKind::Mandatory);
+}
+
+TEST(LineBreakTest, BreaksAfterLineFeeds)
+{
+    const auto breaks = FindLineBreaksHelperFunc(L"a\r\nb\nc");
+    ASSERT_EQ(breaks.size(), 7u);
+    // a carriage return and a line feed are one break.
+    EXPECT_EQ(breaks[2], LineBreakKind::None);
+    EXPECT_EQ(breaks[3], LineBreakKind::Mandatory);
+    EXPECT_EQ(breaks[5], LineBreakKind::Mandatory);
+    EXPECT_EQ(breaks[6], LineBreakKind::Mandatory);
+}
+
+TEST(LineBreakTest, BreaksBetweenIdeographs)
+{
+    const auto breaks = FindLineBreaksHelperFunc(L"一二三");
+    EXPECT_EQ(breaks[1], LineBreakKind::Allowed);
+    EXPECT_EQ(breaks[2], LineBreakKind::Allowed);
+}
+
+TEST(LineBreakTest, EmptyTextEndsWithMandatoryBreak)
+{
+    const auto breaks = FindLineBreaksHelperFunc(String());
+    ASSERT_EQ(breaks.size(), 1u);
+    EXPECT_EQ(breaks[0], LineBreakKind::Mandatory);
+}
+
+// Pieces of text whose breaks depend on what is around them: spaces before
+// closing punctuation, numbers, combining marks, emoji sequences joined by
+// ZWJ, regional indicator pairs, ideographs and line feeds.
+const wchar_t* const text_pieces[] = {
+    L"word", L" ", L"  ", L"\n", L"\r\n", L"(", L")", L"12.5", L"$", L"%", L"-", L" ",
+    L"é", L"一二", L"。", L"\U0001F469‍\U0001F467", L"\U0001F44D\U0001F3FD",
+    L"\U0001F1EF\U0001F1F5\U0001F1FA", L"—", L"\"", L"​", L"⁠", L"אב-", L"가",
+};
+
+String MakeRandomTextHelperFunc(std::mt19937& random, const int piece_count)
+{
+    std::uniform_int_distribution<std::size_t> piece(0, std::size(text_pieces) - 1);
+    String text;
+    for (auto i = 0; i < piece_count; i++)
+        text += text_pieces[piece(random)];
+    return text;
+}
+
+TEST(LineBreakTest, UpdateEqualsFindAfterRandomEdits)
+{
+    std::mt19937 random(1);
+    auto text = MakeRandomTextHelperFunc(random, 200);
+    auto breaks = FindLineBreaksHelperFunc(text);
+    for (auto edit = 0; edit < 2000; edit++)
+    {
+        const auto size = static_cast<int>(text.size());
+        const auto begin = std::uniform_int_distribution<int>(0, size)(random);
+        const auto removed_count = std::uniform_int_distribution<int>(0, std::min(size - begin, 8))(random);
+        const auto inserted = MakeRandomTextHelperFunc(random, std::uniform_int_distribution<int>(0, 3)(random));
+        text.replace(begin, removed_count, inserted);
+
+        const auto scanned_count = UpdateLineBreaks(text, begin, removed_count, static_cast<int>(inserted.size()), breaks);
+        ASSERT_EQ(breaks, FindLineBreaksHelperFunc(text)) << "edit " << edit << " at " << begin;
+        EXPECT_LE(scanned_count, static_cast<int>(text.size()));
+    }
+}
+
+TEST(LineBreakTest, UpdateScansOnlyAroundEdit)
+{
+    String text;
+    for (auto i = 0; i < 1000; i++)
+        text += L"word ";
+    auto breaks = FindLineBreaksHelperFunc(text);
+    text.replace(2500, 4, L"other");
+    const auto scanned_count = UpdateLineBreaks(text, 2500, 4, 5, breaks);
+    EXPECT_EQ(breaks, FindLineBreaksHelperFunc(text));
+    EXPECT_LT(scanned_count, 32);
+}
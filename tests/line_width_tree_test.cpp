@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ui/line_width_tree.h"
+
+using namespace cru::ui;
+
+TEST(LineWidthTreeTest, EmptyHasNoWidth)
+{
+    LineWidthTree tree;
+    EXPECT_TRUE(tree.IsEmpty());
+    EXPECT_EQ(tree.GetMaxWidth(), 0.0f);
+    tree.Assign({ 3.0f, 1.0f });
+    EXPECT_EQ(tree.GetCount(), 2);
+    EXPECT_EQ(tree.GetMaxWidth(), 3.0f);
+    EXPECT_THROW(tree.Replace(1, 2, {}), std::invalid_argument);
+    EXPECT_THROW(tree.GetWidth(2), std::invalid_argument);
+    tree.Replace(0, 2, {});
+    EXPECT_TRUE(tree.IsEmpty());
+}
+
+// Replaces of random ranges, compared with a vector of the same widths.
+TEST(LineWidthTreeTest, MatchesVector)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> width(0.0f, 100.0f);
+    std::vector<float> widths(1000);
+    for (auto& w : widths)
+        w = width(random);
+    LineWidthTree tree;
+    tree.Assign(widths);
+
+    for (auto step = 0; step < 5000; step++)
+    {
+        const auto count = static_cast<int>(widths.size());
+        const auto first = std::uniform_int_distribution<int>(0, count)(random);
+        const auto removed = std::uniform_int_distribution<int>(0, std::min(count - first, 20))(random);
+        std::vector<float> inserted(std::uniform_int_distribution<int>(0, 20)(random));
+        for (auto& w : inserted)
+            w = width(random);
+
+        widths.erase(widths.begin() + first, widths.begin() + first + removed);
+        widths.insert(widths.begin() + first, inserted.cbegin(), inserted.cend());
+        tree.Replace(first, removed, inserted);
+
+        ASSERT_EQ(tree.GetCount(), static_cast<int>(widths.size())) << "step " << step;
+        const auto max_width = widths.empty() ? 0.0f : *std::max_element(widths.cbegin(), widths.cend());
+        ASSERT_EQ(tree.GetMaxWidth(), max_width) << "step " << step;
+        if (!widths.empty())
+        {
+            const auto line = std::uniform_int_distribution<int>(0, static_cast<int>(widths.size()) - 1)(random);
+            ASSERT_EQ(tree.GetWidth(line), widths[line]) << "step " << step;
+        }
+    }
+}
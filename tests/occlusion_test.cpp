@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "graph/image_compare.h"
+#include "graph/software_painter.h"
+#include "ui/window.h"
+#include "ui/controls/stack_panel.h"
+
+using namespace cru;
+using namespace cru::ui;
+
+BasicLayoutParams MakeLayoutParamsHelperFunc(const float width, const float height)
+{
+    BasicLayoutParams layout_params;
+    layout_params.size.width = MeasureLength(width);
+    layout_params.size.height = MeasureLength(height);
+    return layout_params;
+}
+
+class ColorControl : public Control
+{
+public:
+    ColorControl(const graph::Color& color, const float width, const float height)
+        : color_(color)
+    {
+        SetLayoutParams(MakeLayoutParamsHelperFunc(width, height));
+    }
+
+protected:
+    void OnDraw(graph::Painter& painter) override
+    {
+        painter.FillRectangle(Rect(Point::zero, GetSize()), graph::Brush(color_));
+    }
+
+private:
+    graph::Color color_;
+};
+
+constexpr int window_size = 100;
+
+// A column of three rows under an overlay of the same width, both in a
+// control overlapping its children.
+class OcclusionTest : public testing::Test
+{
+protected:
+    OcclusionTest()
+        : root_(graph::Color(1.0f, 1.0f, 1.0f), 100.0f, 100.0f),
+        column_(Orientation::Vertical),
+        rows_{
+            { graph::Color(1.0f, 0.0f, 0.0f), 100.0f, 30.0f },
+            { graph::Color(0.0f, 1.0f, 0.0f), 100.0f, 30.0f },
+            { graph::Color(0.0f, 0.0f, 1.0f), 100.0f, 30.0f }
+        },
+        overlay_(graph::Color(0.5f, 0.5f, 0.5f), 100.0f, 100.0f)
+    {
+        for (auto& row : rows_)
+            column_.AddChild(&row);
+        root_.AddChild(&column_);
+        root_.AddChild(&overlay_);
+        window_.SetClientSize(Size(static_cast<float>(window_size), static_cast<float>(window_size)));
+        window_.AddChild(&root_);
+    }
+
+    graph::Bitmap Render()
+    {
+        graph::Bitmap bitmap(window_size, window_size);
+        graph::SoftwarePainter painter(&bitmap);
+        window_.Render(painter);
+        return bitmap;
+    }
+
+    const DrawStatistics& GetStatistics() const
+    {
+        return window_.GetLastDrawStatistics();
+    }
+
+    Window window_;
+    ColorControl root_;
+    controls::StackPanel column_;
+    ColorControl rows_[3];
+    ColorControl overlay_;
+};
+
+TEST_F(OcclusionTest, TranslucentControlOccludesNothing)
+{
+    Render();
+    EXPECT_EQ(GetStatistics().occluded_count, 0);
+    EXPECT_EQ(GetStatistics().occluded_subtree_count, 0);
+    EXPECT_EQ(GetStatistics().drawn_count, 7);
+}
+
+// The column under the opaque overlay is skipped without visiting its rows,
+// and the controls behind it aren't drawn, but the pixels are the same.
+TEST_F(OcclusionTest, OpaqueOverlaySkipsSubtreeBelow)
+{
+    const auto expected = Render();
+    overlay_.SetOpaque(true);
+    const auto actual = Render();
+
+    EXPECT_EQ(GetStatistics().occluded_subtree_count, 1);
+    // the window and the root are covered, but they are still visited.
+    EXPECT_EQ(GetStatistics().occluded_count, 2);
+    EXPECT_EQ(GetStatistics().drawn_count, 1);
+    EXPECT_TRUE(graph::CompareBitmaps(expected, actual).IsSame());
+}
+
+// Only the rows the overlay fully covers are skipped.
+TEST_F(OcclusionTest, PartlyCoveredSubtreeIsDrawn)
+{
+    overlay_.SetLayoutParams(MakeLayoutParamsHelperFunc(100.0f, 45.0f));
+    const auto expected = Render();
+    overlay_.SetOpaque(true);
+    const auto actual = Render();
+
+    EXPECT_EQ(GetStatistics().occluded_subtree_count, 1);
+    EXPECT_EQ(GetStatistics().occluded_count, 0);
+    EXPECT_EQ(GetStatistics().drawn_count, 6);
+    EXPECT_TRUE(graph::CompareBitmaps(expected, actual).IsSame());
+}
+
+// A rotated control doesn't stay a rect, so it occludes nothing.
+TEST_F(OcclusionTest, RotatedControlOccludesNothing)
+{
+    overlay_.SetOpaque(true);
+    overlay_.SetTransform(Matrix::Rotation(30.0f, Point(50.0f, 50.0f)));
+    Render();
+    EXPECT_EQ(GetStatistics().occluded_count, 0);
+    EXPECT_EQ(GetStatistics().occluded_subtree_count, 0);
+
+    // turned back, it covers the column again.
+    overlay_.SetTransform(Matrix::Identity());
+    Render();
+    EXPECT_EQ(GetStatistics().occluded_subtree_count, 1);
+}
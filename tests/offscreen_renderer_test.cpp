@@ -0,0 +1,178 @@
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "thread_pool.h"
+#include "ui/offscreen_renderer.h"
+#include "ui/window.h"
+#include "ui/controls/stack_panel.h"
+#include "graph/image_compare.h"
+
+using namespace cru;
+using namespace cru::ui;
+
+// Golden images are binary ppm files in tests/golden, so any image viewer
+// shows them. Run with CRU_UPDATE_GOLDEN set to write them again after an
+// intended change of rendering.
+
+constexpr int golden_tolerance = 2;
+
+class FillControl : public Control
+{
+public:
+    FillControl(const graph::Brush& brush, const float radius, const Size& size)
+        : brush_(brush), radius_(radius)
+    {
+        BasicLayoutParams layout_params;
+        layout_params.size.width = MeasureLength(size.width);
+        layout_params.size.height = MeasureLength(size.height);
+        SetLayoutParams(layout_params);
+    }
+
+protected:
+    void OnDraw(graph::Painter& painter) override
+    {
+        const Rect rect(Point::zero, GetSize());
+        if (radius_ > 0.0f)
+            painter.FillRoundedRectangle(rect, radius_, radius_, brush_);
+        else
+            painter.FillRectangle(rect, brush_);
+    }
+
+private:
+    graph::Brush brush_;
+    float radius_;
+};
+
+std::string GetGoldenPathHelperFunc(const std::string& name)
+{
+    return std::string(CRU_GOLDEN_DIRECTORY) + "/" + name + ".ppm";
+}
+
+// only opaque bitmaps are stored, so the premultiplied pixels are exact.
+void SaveGoldenHelperFunc(const std::string& name, const graph::Bitmap& bitmap)
+{
+    std::ofstream file(GetGoldenPathHelperFunc(name), std::ios::binary);
+    file << "P6\n" << bitmap.GetWidth() << " " << bitmap.GetHeight() << "\n255\n";
+    for (const auto pixel : bitmap.GetPixels())
+    {
+        const char rgb[] = { static_cast<char>(pixel >> 16), static_cast<char>(pixel >> 8), static_cast<char>(pixel) };
+        file.write(rgb, sizeof rgb);
+    }
+}
+
+graph::Bitmap LoadGoldenHelperFunc(const std::string& name)
+{
+    std::ifstream file(GetGoldenPathHelperFunc(name), std::ios::binary);
+    std::string magic;
+    int width = 0, height = 0, max_value = 0;
+    file >> magic >> width >> height >> max_value;
+    file.get();
+    if (!file || magic != "P6" || max_value != 255)
+        throw std::runtime_error("Golden image " + name + " is missing or not a binary ppm.");
+    graph::Bitmap bitmap(width, height);
+    for (auto y = 0; y < height; y++)
+        for (auto x = 0; x < width; x++)
+        {
+            unsigned char rgb[3];
+            file.read(reinterpret_cast<char*>(rgb), sizeof rgb);
+            bitmap.SetPixel(x, y, 0xFF000000u | rgb[0] << 16 | rgb[1] << 8 | rgb[2]);
+        }
+    if (!file)
+        throw std::runtime_error("Golden image " + name + " is truncated.");
+    return bitmap;
+}
+
+void ExpectGoldenHelperFunc(const std::string& name, const graph::Bitmap& bitmap)
+{
+    for (const auto pixel : bitmap.GetPixels())
+        ASSERT_EQ(pixel >> 24, 0xFFu) << "Golden images must be opaque.";
+
+    if (std::getenv("CRU_UPDATE_GOLDEN") != nullptr)
+    {
+        SaveGoldenHelperFunc(name, bitmap);
+        return;
+    }
+
+    const auto golden = LoadGoldenHelperFunc(name);
+    ASSERT_EQ(bitmap.GetWidth(), golden.GetWidth());
+    ASSERT_EQ(bitmap.GetHeight(), golden.GetHeight());
+    const auto difference = graph::CompareBitmaps(bitmap, golden, golden_tolerance);
+    EXPECT_TRUE(difference.IsSame()) << difference.different_pixel_count << " pixels differ from " << name
+        << " by up to " << difference.max_channel_difference << ".";
+}
+
+// A window with a row of a rounded rect, a gradient and a rotated square,
+// which covers layout, transforms and anti-aliased edges.
+class OffscreenRendererTest : public testing::Test
+{
+protected:
+    OffscreenRendererTest()
+        : panel_(Orientation::Horizontal),
+        rounded_(graph::Color::FromRgb(0x3366CC), 6.0f, Size(24.0f, 24.0f)),
+        gradient_(graph::Brush::LinearGradient(Point(0.0f, 0.0f), Point(0.0f, 32.0f), {
+            graph::GradientStop{ 0.0f, graph::Color::FromRgb(0xFFCC00) },
+            graph::GradientStop{ 1.0f, graph::Color::FromRgb(0xCC3300) } }), 0.0f, Size(16.0f, 32.0f)),
+        rotated_(graph::Color::FromRgb(0x339933), 0.0f, Size(16.0f, 16.0f))
+    {
+        // moved down, so the rotated corners stay inside the client area.
+        rotated_.SetTransform(Matrix::Rotation(30.0f, Point(8.0f, 8.0f)) * Matrix::Translation(0.0f, 8.0f));
+        panel_.AddChild(&rounded_);
+        panel_.AddChild(&gradient_);
+        panel_.AddChild(&rotated_);
+        window_.SetClientSize(Size(64.0f, 40.0f));
+        window_.AddChild(&panel_);
+    }
+
+    Window window_;
+    controls::StackPanel panel_;
+    FillControl rounded_;
+    FillControl gradient_;
+    FillControl rotated_;
+};
+
+TEST_F(OffscreenRendererTest, WindowMatchesGolden)
+{
+    RenderOptions options;
+    options.background = graph::Color(1.0f, 1.0f, 1.0f);
+    const auto bitmap = RenderToBitmap(&window_, options);
+    ASSERT_EQ(bitmap.GetWidth(), 64);
+    ASSERT_EQ(bitmap.GetHeight(), 40);
+    ExpectGoldenHelperFunc("offscreen_window", bitmap);
+}
+
+TEST_F(OffscreenRendererTest, HighDpiWindowMatchesGolden)
+{
+    RenderOptions options;
+    options.background = graph::Color(1.0f, 1.0f, 1.0f);
+    options.dpi = 192.0f;
+    const auto bitmap = RenderToBitmap(&window_, options);
+    ASSERT_EQ(bitmap.GetWidth(), 128);
+    ASSERT_EQ(bitmap.GetHeight(), 80);
+    ExpectGoldenHelperFunc("offscreen_window_192dpi", bitmap);
+}
+
+TEST_F(OffscreenRendererTest, BatchEqualsSingleRenders)
+{
+    const std::vector<Control*> controls = { &window_, &rounded_, &gradient_, &rotated_ };
+    ThreadPool thread_pool(4);
+    RenderOptions options;
+    options.thread_pool = &thread_pool;
+    const auto bitmaps = RenderToBitmaps(controls, options);
+    ASSERT_EQ(bitmaps.size(), controls.size());
+    for (std::size_t i = 0; i < controls.size(); i++)
+        EXPECT_TRUE(bitmaps[i] == RenderToBitmap(controls[i])) << "control " << i;
+}
+
+TEST_F(OffscreenRendererTest, ChangeIsFoundByComparison)
+{
+    const auto before = RenderToBitmap(&window_);
+    rotated_.SetTransform(Matrix::Rotation(45.0f, Point(8.0f, 8.0f)) * Matrix::Translation(0.0f, 8.0f));
+    const auto after = RenderToBitmap(&window_);
+    const auto difference = graph::CompareBitmaps(before, after, golden_tolerance);
+    EXPECT_GT(difference.different_pixel_count, 0);
+    EXPECT_GT(difference.max_channel_difference, golden_tolerance);
+}
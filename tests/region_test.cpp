@@ -0,0 +1,248 @@
+#include <array>
+#include <random>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "ui/damage_tracker.h"
+#include "ui/region.h"
+
+using namespace cru::ui;
+
+// Regions of rects on a small integer grid are compared with sets of unit
+// cells, which are obviously right.
+constexpr int grid_size = 12;
+
+using Cells = std::array<std::array<bool, grid_size>, grid_size>;
+
+Rect MakeRandomRectHelperFunc(std::mt19937& random)
+{
+    std::uniform_int_distribution<int> coordinate(0, grid_size);
+    auto left = coordinate(random), right = coordinate(random);
+    auto top = coordinate(random), bottom = coordinate(random);
+    if (left > right)
+        std::swap(left, right);
+    if (top > bottom)
+        std::swap(top, bottom);
+    return Rect::FromVertices(static_cast<float>(left), static_cast<float>(top), static_cast<float>(right), static_cast<float>(bottom));
+}
+
+void AddRectHelperFunc(Cells& cells, const Rect& rect)
+{
+    for (auto y = static_cast<int>(rect.top); y < static_cast<int>(rect.GetBottom()); y++)
+        for (auto x = static_cast<int>(rect.left); x < static_cast<int>(rect.GetRight()); x++)
+            cells[y][x] = true;
+}
+
+// A random region and the cells it covers.
+Region MakeRandomRegionHelperFunc(std::mt19937& random, Cells& cells)
+{
+    cells = Cells();
+    Region region;
+    for (auto i = std::uniform_int_distribution<int>(0, 4)(random); i > 0; i--)
+    {
+        const auto rect = MakeRandomRectHelperFunc(random);
+        region = region.Union(rect);
+        AddRectHelperFunc(cells, rect);
+    }
+    return region;
+}
+
+// The cells of a region by "IsPointInside" at the centers, checking on the
+// way that its rects are disjoint and give its area.
+Cells GetCellsHelperFunc(const Region& region)
+{
+    Cells cells{};
+    Cells covered{};
+    auto area = 0.0f;
+    for (const auto& rect : region.GetRects())
+    {
+        EXPECT_FALSE(rect.IsEmpty());
+        area += rect.width * rect.height;
+        for (auto y = static_cast<int>(rect.top); y < static_cast<int>(rect.GetBottom()); y++)
+            for (auto x = static_cast<int>(rect.left); x < static_cast<int>(rect.GetRight()); x++)
+            {
+                EXPECT_FALSE(covered[y][x]) << "rects overlap at " << x << ", " << y;
+                covered[y][x] = true;
+            }
+    }
+    EXPECT_EQ(area, region.GetArea());
+    for (auto y = 0; y < grid_size; y++)
+        for (auto x = 0; x < grid_size; x++)
+        {
+            cells[y][x] = region.IsPointInside(Point(x + 0.5f, y + 0.5f));
+            EXPECT_EQ(cells[y][x], covered[y][x]) << "at " << x << ", " << y;
+        }
+    return cells;
+}
+
+TEST(RegionTest, EmptyRectGivesEmptyRegion)
+{
+    EXPECT_TRUE(Region(Rect(1.0f, 1.0f, 0.0f, 5.0f)).IsEmpty());
+    EXPECT_TRUE(Region().GetBounds().IsEmpty());
+    EXPECT_EQ(Region(), Region(Rect(2.0f, 2.0f, 3.0f, 0.0f)));
+}
+
+TEST(RegionTest, SetOperationsMatchCells)
+{
+    std::mt19937 random(1);
+    for (auto i = 0; i < 5000; i++)
+    {
+        Cells left_cells, right_cells;
+        const auto left = MakeRandomRegionHelperFunc(random, left_cells);
+        const auto right = MakeRandomRegionHelperFunc(random, right_cells);
+        ASSERT_EQ(GetCellsHelperFunc(left), left_cells) << "case " << i;
+
+        Cells union_cells{}, intersect_cells{}, subtract_cells{};
+        for (auto y = 0; y < grid_size; y++)
+            for (auto x = 0; x < grid_size; x++)
+            {
+                union_cells[y][x] = left_cells[y][x] || right_cells[y][x];
+                intersect_cells[y][x] = left_cells[y][x] && right_cells[y][x];
+                subtract_cells[y][x] = left_cells[y][x] && !right_cells[y][x];
+            }
+        ASSERT_EQ(GetCellsHelperFunc(left.Union(right)), union_cells) << "case " << i;
+        ASSERT_EQ(GetCellsHelperFunc(left.Intersect(right)), intersect_cells) << "case " << i;
+        ASSERT_EQ(GetCellsHelperFunc(left.Subtract(right)), subtract_cells) << "case " << i;
+    }
+}
+
+// Regions covering the same cells are equal however they were built.
+TEST(RegionTest, EqualityIsCanonical)
+{
+    std::mt19937 random(2);
+    for (auto i = 0; i < 2000; i++)
+    {
+        Cells cells;
+        const auto region = MakeRandomRegionHelperFunc(random, cells);
+
+        // the same cells added one by one, bottom to top.
+        Region cell_region;
+        for (auto y = grid_size - 1; y >= 0; y--)
+            for (auto x = grid_size - 1; x >= 0; x--)
+                if (cells[y][x])
+                    cell_region = cell_region.Union(Rect(static_cast<float>(x), static_cast<float>(y), 1.0f, 1.0f));
+        ASSERT_EQ(region, cell_region) << "case " << i;
+        ASSERT_EQ(region.GetRectCount(), cell_region.GetRectCount()) << "case " << i;
+
+        Cells other_cells;
+        const auto other = MakeRandomRegionHelperFunc(random, other_cells);
+        ASSERT_EQ(region == other, cells == other_cells) << "case " << i;
+    }
+}
+
+TEST(RegionTest, ContainsAndIntersectsMatchCells)
+{
+    std::mt19937 random(3);
+    for (auto i = 0; i < 5000; i++)
+    {
+        Cells cells;
+        const auto region = MakeRandomRegionHelperFunc(random, cells);
+        const auto rect = MakeRandomRectHelperFunc(random);
+        // an empty rect has no point out of the region.
+        auto is_contained = true;
+        auto is_intersected = false;
+        for (auto y = static_cast<int>(rect.top); y < static_cast<int>(rect.GetBottom()); y++)
+            for (auto x = static_cast<int>(rect.left); x < static_cast<int>(rect.GetRight()); x++)
+            {
+                is_contained = is_contained && cells[y][x];
+                is_intersected = is_intersected || cells[y][x];
+            }
+        ASSERT_EQ(region.Contains(rect), is_contained) << "case " << i;
+        ASSERT_EQ(region.Intersects(rect), is_intersected) << "case " << i;
+    }
+}
+
+TEST(RegionTest, BoundsCoverRects)
+{
+    const auto region = Region(Rect(1.0f, 2.0f, 3.0f, 1.0f)).Union(Rect(6.0f, 5.0f, 2.0f, 4.0f));
+    const auto bounds = region.GetBounds();
+    EXPECT_EQ(bounds.left, 1.0f);
+    EXPECT_EQ(bounds.top, 2.0f);
+    EXPECT_EQ(bounds.GetRight(), 8.0f);
+    EXPECT_EQ(bounds.GetBottom(), 9.0f);
+}
+
+const Rect viewport(0.0f, 0.0f, 100.0f, 100.0f);
+
+TEST(DamageTrackerTest, FirstFrameIsFull)
+{
+    DamageTracker tracker;
+    EXPECT_TRUE(tracker.HasDamage());
+    const auto frame = tracker.TakeFrame(viewport, 8);
+    EXPECT_TRUE(frame.is_full);
+    EXPECT_EQ(frame.present_region, Region(viewport));
+    EXPECT_FALSE(tracker.HasDamage());
+}
+
+TEST(DamageTrackerTest, DamageIsRoundedOutAndClipped)
+{
+    DamageTracker tracker;
+    tracker.TakeFrame(viewport, 8);
+    tracker.AddDamage(Rect(10.5f, 10.25f, 5.0f, 5.0f));
+    tracker.AddDamage(Rect(90.0f, 90.0f, 20.0f, 20.0f));
+    const auto frame = tracker.TakeFrame(viewport, 8);
+    EXPECT_FALSE(frame.is_full);
+    EXPECT_EQ(frame.present_region, Region(Rect(10.0f, 10.0f, 6.0f, 6.0f)).Union(Rect(90.0f, 90.0f, 10.0f, 10.0f)));
+    EXPECT_EQ(frame.paint_region, frame.present_region);
+}
+
+TEST(DamageTrackerTest, ManyRectsBecomeBounds)
+{
+    DamageTracker tracker;
+    tracker.TakeFrame(viewport, 8);
+    for (auto i = 0; i < 5; i++)
+        tracker.AddDamage(Rect(i * 20.0f, i * 20.0f, 5.0f, 5.0f));
+    const auto frame = tracker.TakeFrame(viewport, 4);
+    EXPECT_EQ(frame.present_region, Region(Rect(0.0f, 0.0f, 85.0f, 85.0f)));
+}
+
+// With one buffer the buffer keeps the last frame, so only new damage is painted.
+TEST(DamageTrackerTest, SingleBufferPaintsOnlyNewDamage)
+{
+    DamageTracker tracker(1);
+    tracker.TakeFrame(viewport, 8);
+    tracker.AddDamage(Rect(0.0f, 0.0f, 10.0f, 10.0f));
+    tracker.TakeFrame(viewport, 8);
+    tracker.AddDamage(Rect(50.0f, 50.0f, 10.0f, 10.0f));
+    const auto frame = tracker.TakeFrame(viewport, 8);
+    EXPECT_EQ(frame.present_region, Region(Rect(50.0f, 50.0f, 10.0f, 10.0f)));
+    EXPECT_EQ(frame.paint_region, frame.present_region);
+}
+
+// With two buffers a buffer missed the frame drawn into the other one, so
+// the damage of the previous frame is painted again but not presented.
+TEST(DamageTrackerTest, DoubleBufferPaintsPreviousDamage)
+{
+    DamageTracker tracker(2);
+    const auto first = tracker.TakeFrame(viewport, 8);
+    EXPECT_TRUE(first.is_full);
+
+    // the other buffer has never been drawn, so the full first frame is painted.
+    tracker.AddDamage(Rect(0.0f, 0.0f, 10.0f, 10.0f));
+    auto frame = tracker.TakeFrame(viewport, 8);
+    EXPECT_EQ(frame.present_region, Region(Rect(0.0f, 0.0f, 10.0f, 10.0f)));
+    EXPECT_EQ(frame.paint_region, Region(viewport));
+
+    tracker.AddDamage(Rect(50.0f, 50.0f, 10.0f, 10.0f));
+    frame = tracker.TakeFrame(viewport, 8);
+    EXPECT_EQ(frame.present_region, Region(Rect(50.0f, 50.0f, 10.0f, 10.0f)));
+    EXPECT_EQ(frame.paint_region, Region(Rect(0.0f, 0.0f, 10.0f, 10.0f)).Union(Rect(50.0f, 50.0f, 10.0f, 10.0f)));
+
+    // a frame without damage still paints what the other buffer missed.
+    frame = tracker.TakeFrame(viewport, 8);
+    EXPECT_TRUE(frame.present_region.IsEmpty());
+    EXPECT_EQ(frame.paint_region, Region(Rect(50.0f, 50.0f, 10.0f, 10.0f)));
+}
+
+TEST(DamageTrackerTest, FullDamageCoversAll)
+{
+    DamageTracker tracker;
+    tracker.TakeFrame(viewport, 8);
+    tracker.AddDamage(Rect(0.0f, 0.0f, 10.0f, 10.0f));
+    tracker.AddFullDamage();
+    tracker.AddDamage(Rect(0.0f, 0.0f, 10.0f, 10.0f));
+    const auto frame = tracker.TakeFrame(viewport, 8);
+    EXPECT_TRUE(frame.is_full);
+    EXPECT_EQ(frame.paint_region, Region(viewport));
+}
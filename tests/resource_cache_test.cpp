@@ -0,0 +1,193 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "lru_cache.h"
+#include "graph/resource_cache.h"
+
+using namespace cru;
+using namespace cru::graph;
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsed)
+{
+    LruCache<std::string, int> cache(3);
+    cache.Add("a", 1, 1);
+    cache.Add("b", 2, 1);
+    cache.Add("c", 3, 1);
+    ASSERT_NE(cache.Find("a"), nullptr);
+
+    // "b" is now the least recently used.
+    cache.Add("d", 4, 1);
+    EXPECT_EQ(cache.Find("b"), nullptr);
+    EXPECT_EQ(*cache.Find("a"), 1);
+    EXPECT_EQ(cache.GetCount(), 3);
+    EXPECT_EQ(cache.GetStatistics().eviction_count, 1);
+
+    // room for a value of two drops the two least recently used, "c" and "d".
+    cache.Add("e", 5, 2);
+    EXPECT_EQ(cache.Find("c"), nullptr);
+    EXPECT_EQ(cache.Find("d"), nullptr);
+    EXPECT_NE(cache.Find("a"), nullptr);
+    EXPECT_EQ(cache.GetCost(), 3u);
+    EXPECT_EQ(cache.GetStatistics().eviction_count, 3);
+
+    cache.SetBudget(1);
+    EXPECT_EQ(cache.GetCount(), 1);
+    EXPECT_NE(cache.Find("a"), nullptr);
+}
+
+TEST(LruCacheTest, DoesNotCacheValueOverBudget)
+{
+    LruCache<int, int> cache(4);
+    cache.Add(1, 10, 2);
+    EXPECT_FALSE(cache.Add(2, 20, 5));
+    EXPECT_EQ(cache.Find(2), nullptr);
+    // nothing was evicted for it.
+    EXPECT_NE(cache.Find(1), nullptr);
+    EXPECT_EQ(cache.GetStatistics().eviction_count, 0);
+
+    // a replacement over the budget drops the old value.
+    EXPECT_FALSE(cache.Add(1, 11, 5));
+    EXPECT_EQ(cache.Find(1), nullptr);
+    EXPECT_EQ(cache.GetCost(), 0u);
+}
+
+TEST(LruCacheTest, ReplacesValueAndCost)
+{
+    LruCache<int, int> cache(4);
+    cache.Add(1, 10, 1);
+    EXPECT_TRUE(cache.Add(1, 11, 3));
+    EXPECT_EQ(*cache.Find(1), 11);
+    EXPECT_EQ(cache.GetCost(), 3u);
+    EXPECT_TRUE(cache.Remove(1));
+    EXPECT_FALSE(cache.Remove(1));
+    EXPECT_EQ(cache.GetCost(), 0u);
+}
+
+using IntResourceCache = ResourceCache<int, int>;
+
+TEST(ResourceCacheTest, CreatesOncePerValue)
+{
+    IntResourceCache cache;
+    auto created_count = 0;
+    const auto create = [&created_count]() { return ++created_count; };
+
+    const auto red = cache.GetBrush(Color(1.0f, 0.0f, 0.0f), create);
+    EXPECT_EQ(cache.GetBrush(Color(1.0f, 0.0f, 0.0f), create), red);
+    EXPECT_NE(cache.GetBrush(Color(0.0f, 1.0f, 0.0f), create), red);
+    EXPECT_EQ(created_count, 2);
+
+    Path path;
+    path.AddRectangle(ui::Rect(0.0f, 0.0f, 4.0f, 4.0f));
+    const auto geometry = cache.GetGeometry(path, create);
+    Path same_path;
+    same_path.AddRectangle(ui::Rect(0.0f, 0.0f, 4.0f, 4.0f));
+    EXPECT_EQ(cache.GetGeometry(same_path, create), geometry);
+    EXPECT_EQ(created_count, 3);
+    EXPECT_EQ(cache.GetBrushCount(), 2);
+    EXPECT_EQ(cache.GetGeometryCount(), 1);
+}
+
+TEST(ResourceCacheTest, KeepsMostRecentlyUsed)
+{
+    IntResourceCache cache(2, 2);
+    auto created_count = 0;
+    const auto create = [&created_count]() { return ++created_count; };
+
+    cache.GetBrush(Color(1.0f, 0.0f, 0.0f), create);
+    cache.GetBrush(Color(0.0f, 1.0f, 0.0f), create);
+    cache.GetBrush(Color(1.0f, 0.0f, 0.0f), create);
+    cache.GetBrush(Color(0.0f, 0.0f, 1.0f), create);
+    EXPECT_EQ(cache.GetBrushCount(), 2);
+    EXPECT_EQ(created_count, 3);
+
+    // green was dropped, red wasn't.
+    cache.GetBrush(Color(1.0f, 0.0f, 0.0f), create);
+    EXPECT_EQ(created_count, 3);
+    cache.GetBrush(Color(0.0f, 1.0f, 0.0f), create);
+    EXPECT_EQ(created_count, 4);
+    EXPECT_EQ(cache.GetFrameStatistics().brushes.eviction_count, 2);
+}
+
+TEST(ResourceCacheTest, BeginFrameResetsCounters)
+{
+    IntResourceCache cache;
+    const auto create = []() { return 1; };
+    cache.GetBrush(Color(1.0f, 0.0f, 0.0f), create);
+    cache.GetBrush(Color(1.0f, 0.0f, 0.0f), create);
+    EXPECT_EQ(cache.GetFrameStatistics().brushes.hit_count, 1);
+    EXPECT_EQ(cache.GetFrameStatistics().brushes.miss_count, 1);
+
+    // the resources are kept across frames.
+    cache.BeginFrame();
+    EXPECT_EQ(cache.GetFrameStatistics().brushes.hit_count, 0);
+    EXPECT_EQ(cache.GetFrameStatistics().brushes.miss_count, 0);
+    cache.GetBrush(Color(1.0f, 0.0f, 0.0f), create);
+    EXPECT_EQ(cache.GetFrameStatistics().brushes.hit_count, 1);
+    EXPECT_EQ(cache.GetFrameStatistics().brushes.miss_count, 0);
+    EXPECT_EQ(cache.GetFrameStatistics().geometries.miss_count, 0);
+
+    cache.Clear();
+    EXPECT_EQ(cache.GetBrushCount(), 0);
+}
+
+// Values from few choices, so many pairs are equal.
+Brush MakeRandomBrushHelperFunc(std::mt19937& random)
+{
+    const float values[] = { 0.0f, -0.0f, 0.5f, 1.0f };
+    std::uniform_int_distribution<int> pick(0, 3);
+    const auto value = [&]() { return values[pick(random)]; };
+    if (pick(random) < 2)
+        return Brush(Color(value(), value(), 0.0f, value()));
+    std::vector<GradientStop> stops(pick(random) % 3);
+    for (auto& stop : stops)
+        stop = GradientStop{ value(), Color(value(), 0.0f, value()) };
+    return Brush::LinearGradient(ui::Point(value(), 0.0f), ui::Point(1.0f, value()), std::move(stops));
+}
+
+Path MakeRandomPathHelperFunc(std::mt19937& random)
+{
+    const float values[] = { 0.0f, -0.0f, 1.0f };
+    std::uniform_int_distribution<int> pick(0, 2);
+    const auto point = [&]() { return ui::Point(values[pick(random)], values[pick(random)]); };
+    Path path;
+    path.SetFillRule(pick(random) == 0 ? FillRule::EvenOdd : FillRule::NonZero);
+    for (auto i = pick(random); i > 0; i--)
+    {
+        if (pick(random) == 0)
+            path.LineTo(point());
+        else
+            path.QuadraticTo(point(), point());
+    }
+    if (pick(random) == 0)
+        path.Close();
+    return path;
+}
+
+TEST(ResourceCacheTest, HashesAgreeWithEquality)
+{
+    std::mt19937 random(1);
+    auto equal_count = 0;
+    for (auto i = 0; i < 20000; i++)
+    {
+        const auto brush = MakeRandomBrushHelperFunc(random);
+        const auto other_brush = MakeRandomBrushHelperFunc(random);
+        if (brush == other_brush)
+        {
+            ASSERT_EQ(BrushHash()(brush), BrushHash()(other_brush)) << "case " << i;
+            equal_count++;
+        }
+
+        const auto path = MakeRandomPathHelperFunc(random);
+        const auto other_path = MakeRandomPathHelperFunc(random);
+        if (path == other_path)
+        {
+            ASSERT_EQ(PathHash()(path), PathHash()(other_path)) << "case " << i;
+            equal_count++;
+        }
+    }
+    // the pairs are equal often enough to test something.
+    EXPECT_GT(equal_count, 1000);
+}
@@ -0,0 +1,156 @@
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "string_util.h"
+
+using namespace cru;
+
+// A plain decoder of valid utf-8 to compare the converted strings with.
+String DecodeUtf8HelperFunc(const std::string& text)
+{
+    std::u32string code_points;
+    for (std::size_t i = 0; i < text.size();)
+    {
+        const auto lead = static_cast<unsigned char>(text[i]);
+        const auto length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+        char32_t code_point = length == 1 ? lead : lead & (0x7F >> length);
+        for (auto j = 1; j < length; j++)
+            code_point = code_point << 6 | (static_cast<unsigned char>(text[i + j]) & 0x3F);
+        code_points.push_back(code_point);
+        i += length;
+    }
+
+    String result;
+    for (const auto code_point : code_points)
+    {
+        if (sizeof(wchar_t) == 2 && code_point >= 0x10000)
+        {
+            result.push_back(static_cast<wchar_t>(0xD800 + ((code_point - 0x10000) >> 10)));
+            result.push_back(static_cast<wchar_t>(0xDC00 + ((code_point - 0x10000) & 0x3FF)));
+        }
+        else
+            result.push_back(static_cast<wchar_t>(code_point));
+    }
+    return result;
+}
+
+TEST(StringUtilTest, ConvertsEverySequenceLength)
+{
+    const std::string text = "a\xC3\xA9\xE4\xB8\x80\xF0\x9F\x98\x80z";
+    const auto converted = Utf8ToString(text);
+    EXPECT_EQ(converted, DecodeUtf8HelperFunc(text));
+    EXPECT_EQ(StringToUtf8(converted), text);
+}
+
+TEST(StringUtilTest, ConvertsEmptyString)
+{
+    EXPECT_TRUE(Utf8ToString(std::string()).empty());
+    EXPECT_TRUE(StringToUtf8(String()).empty());
+}
+
+// Sequences at every offset from the runs of ASCII converted 16 bytes at a
+// time, so the vector loop hands over at every position.
+TEST(StringUtilTest, ConvertsAroundAsciiRuns)
+{
+    const std::string sequences[] = { "\xC3\xA9", "\xE4\xB8\x80", "\xF0\x9F\x98\x80" };
+    for (const auto& sequence : sequences)
+        for (auto before = 0; before < 40; before++)
+            for (const auto after : { 0, 1, 15, 16, 17 })
+            {
+                const auto text = std::string(before, 'a') + sequence + std::string(after, 'b');
+                const auto converted = Utf8ToString(text);
+                ASSERT_EQ(converted, DecodeUtf8HelperFunc(text)) << before << " before, " << after << " after";
+                ASSERT_EQ(StringToUtf8(converted), text) << before << " before, " << after << " after";
+            }
+}
+
+TEST(StringUtilTest, RoundTripsRandomText)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (auto i = 0; i < 100; i++)
+    {
+        String text;
+        for (auto j = std::uniform_int_distribution<int>(0, 200)(random); j > 0; j--)
+        {
+            const auto kind = percent(random);
+            if (kind < 70)
+                text.push_back(static_cast<wchar_t>(std::uniform_int_distribution<int>(0x20, 0x7E)(random)));
+            else if (kind < 80)
+                text.push_back(static_cast<wchar_t>(std::uniform_int_distribution<int>(0x80, 0x7FF)(random)));
+            else if (kind < 90)
+                text.push_back(static_cast<wchar_t>(std::uniform_int_distribution<int>(0xE000, 0xFFFF)(random)));
+            else
+                text += Utf8ToString("\xF0\x9F\x98\x80");
+        }
+        EXPECT_EQ(Utf8ToString(StringToUtf8(text)), text);
+    }
+}
+
+TEST(StringUtilTest, RejectsOverlongForms)
+{
+    // "/" and the null character in two, three and four bytes.
+    for (const auto text : { "\xC0\xAF", "\xC1\xBF", "\xC0\x80", "\xE0\x80\xAF", "\xE0\x9F\xBF", "\xF0\x80\x80\xAF", "\xF0\x8F\xBF\xBF" })
+        EXPECT_THROW(Utf8ToString(std::string(text)), std::invalid_argument) << text;
+}
+
+TEST(StringUtilTest, RejectsSurrogates)
+{
+    for (const auto text : { "\xED\xA0\x80", "\xED\xAF\xBF", "\xED\xB0\x80", "\xED\xBF\xBF", "\xED\xA0\xBD\xED\xB8\x80" })
+        EXPECT_THROW(Utf8ToString(std::string(text)), std::invalid_argument);
+    // the last code points before and after the surrogates are valid.
+    EXPECT_NO_THROW(Utf8ToString(std::string("\xED\x9F\xBF")));
+    EXPECT_NO_THROW(Utf8ToString(std::string("\xEE\x80\x80")));
+
+    EXPECT_THROW(StringToUtf8(String(1, static_cast<wchar_t>(0xD800))), std::invalid_argument);
+    EXPECT_THROW(StringToUtf8(String(1, static_cast<wchar_t>(0xDC00))), std::invalid_argument);
+    EXPECT_THROW(StringToUtf8(String(L"a") + static_cast<wchar_t>(0xDBFF) + L"b"), std::invalid_argument);
+}
+
+TEST(StringUtilTest, RejectsCodePointsAfterLast)
+{
+    EXPECT_NO_THROW(Utf8ToString(std::string("\xF4\x8F\xBF\xBF")));
+    EXPECT_THROW(Utf8ToString(std::string("\xF4\x90\x80\x80")), std::invalid_argument);
+    EXPECT_THROW(Utf8ToString(std::string("\xF5\x80\x80\x80")), std::invalid_argument);
+    if (sizeof(wchar_t) == 4)
+        EXPECT_THROW(StringToUtf8(String(1, static_cast<wchar_t>(0x110000))), std::invalid_argument);
+}
+
+TEST(StringUtilTest, RejectsTruncatedSequences)
+{
+    for (const auto text : { "\xC3", "\xE4\xB8", "\xF0\x9F\x98", "\xF0\x9F", "\xF0" })
+    {
+        // at the end, before ASCII and after a run of ASCII.
+        EXPECT_THROW(Utf8ToString(std::string(text)), std::invalid_argument);
+        EXPECT_THROW(Utf8ToString(std::string(text) + "a"), std::invalid_argument);
+        EXPECT_THROW(Utf8ToString(std::string(20, 'a') + text), std::invalid_argument);
+    }
+    // the size is given, so a sequence cut by it is truncated too.
+    const std::string text = "ab\xE4\xB8\x80";
+    EXPECT_THROW(Utf8ToString(text.data(), text.size() - 1), std::invalid_argument);
+}
+
+TEST(StringUtilTest, RejectsStrayBytes)
+{
+    for (const auto text : { "\x80", "\xBF", "a\x80" "b", "\xFE", "\xFF", "\xC3\xA9\xA9" })
+        EXPECT_THROW(Utf8ToString(std::string(text)), std::invalid_argument);
+}
+
+TEST(StringUtilTest, InternedStringsCompareByContent)
+{
+    const auto count = InternedString::GetCount();
+    const InternedString first(L"string_util_test key");
+    const InternedString second(String(L"string_util_test key"));
+    const InternedString other(L"string_util_test other key");
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(&first.Get(), &second.Get());
+    EXPECT_NE(first, other);
+    EXPECT_EQ(std::hash<InternedString>()(first), std::hash<InternedString>()(second));
+    EXPECT_EQ(InternedString::GetCount(), count + 2);
+
+    EXPECT_TRUE(InternedString().IsEmpty());
+    EXPECT_EQ(InternedString(), InternedString(L""));
+}
@@ -0,0 +1,101 @@
+#include <limits>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "ui/controls/text_box.h"
+
+using namespace cru;
+using namespace cru::ui;
+using namespace cru::ui::controls;
+
+const Size infinite_size(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+
+graph::TextFormat MakeFormatHelperFunc()
+{
+    graph::TextFormat format;
+    format.size = 16.0f;
+    return format;
+}
+
+float MeasureWidthHelperFunc(TextBox& text_box)
+{
+    text_box.Measure(infinite_size);
+    return text_box.GetDesiredSize().width;
+}
+
+class TextBoxTest : public testing::Test
+{
+protected:
+    TextBoxTest()
+        : text_box_(&shaper_, MakeFormatHelperFunc())
+    {
+        text_box_.text_changed_event.AddHandler([this](events::UiEventArgs&) {
+            text_changed_count_++;
+        });
+    }
+
+    graph::StubTextShaper shaper_;
+    TextBox text_box_;
+    int text_changed_count_ = 0;
+};
+
+TEST_F(TextBoxTest, EmptyReplaceChangesNothing)
+{
+    text_box_.SetText(L"abc\ndef");
+    text_box_.SetCaretPosition(5);
+    text_changed_count_ = 0;
+    text_box_.Replace(2, 0, String());
+    EXPECT_EQ(text_box_.GetCaretPosition(), 5);
+    EXPECT_EQ(text_changed_count_, 0);
+    EXPECT_FALSE(text_box_.Undo());
+    EXPECT_THROW(text_box_.Replace(8, 0, String()), std::invalid_argument);
+}
+
+TEST_F(TextBoxTest, WidthFollowsEdits)
+{
+    String text;
+    for (auto line = 0; line < 200; line++)
+        text += String(line % 37, L'x') + L"\n";
+    text_box_.SetText(text);
+    MeasureWidthHelperFunc(text_box_);
+
+    // the widest line is compared with measuring a text box of the same
+    // text from scratch after every edit, undo and redo.
+    std::mt19937 random(1);
+    const String insertions[] = { L"a", L"\n", L"wider than any line of the text", L"x\ny\n" };
+    for (auto i = 0; i < 300; i++)
+    {
+        const auto length = text_box_.GetBuffer().GetLength();
+        const auto begin = std::uniform_int_distribution<int>(0, length)(random);
+        const auto action = std::uniform_int_distribution<int>(0, 9)(random);
+        if (action < 4)
+            text_box_.Insert(begin, insertions[action]);
+        else if (action < 8)
+            text_box_.Remove(begin, std::uniform_int_distribution<int>(0, std::min(length - begin, 80))(random));
+        else if (action == 8)
+            text_box_.Undo();
+        else
+            text_box_.Redo();
+
+        TextBox expected(&shaper_, MakeFormatHelperFunc());
+        expected.SetText(text_box_.GetText());
+        ASSERT_EQ(MeasureWidthHelperFunc(text_box_), MeasureWidthHelperFunc(expected)) << "edit " << i;
+    }
+}
+
+TEST_F(TextBoxTest, EditLaysOutOnlyTouchedLines)
+{
+    String text;
+    for (auto line = 0; line < 1000; line++)
+        text += L"line " + std::to_wstring(line) + L"\n";
+    text_box_.SetText(text);
+    MeasureWidthHelperFunc(text_box_);
+
+    const auto before = text_box_.GetLayoutStatistics();
+    text_box_.Insert(text_box_.GetBuffer().GetOffset(TextPosition{ 500, 0 }), L"edited ");
+    MeasureWidthHelperFunc(text_box_);
+    const auto after = text_box_.GetLayoutStatistics();
+    EXPECT_LE(after.hit_count + after.relayout_count + after.miss_count
+        - before.hit_count - before.relayout_count - before.miss_count, 1);
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ui/text_buffer.h"
+
+using namespace cru;
+using namespace cru::ui;
+
+// The position of an offset in a plain string.
+TextPosition GetPositionHelperFunc(const String& text, const int offset)
+{
+    TextPosition position;
+    for (auto i = 0; i < offset; i++)
+        if (text[i] == L'\n')
+        {
+            position.line++;
+            position.column = 0;
+        }
+        else
+            position.column++;
+    return position;
+}
+
+// Offsets of line starts in a plain string.
+std::vector<int> GetLineStartsHelperFunc(const String& text)
+{
+    std::vector<int> line_starts{ 0 };
+    for (auto i = 0; i < static_cast<int>(text.size()); i++)
+        if (text[i] == L'\n')
+            line_starts.push_back(i + 1);
+    return line_starts;
+}
+
+void ExpectSameHelperFunc(const TextBuffer& buffer, const String& text, std::mt19937& random, const int step)
+{
+    ASSERT_EQ(buffer.GetLength(), static_cast<int>(text.size())) << "step " << step;
+    const auto line_starts = GetLineStartsHelperFunc(text);
+    ASSERT_EQ(buffer.GetLineCount(), static_cast<int>(line_starts.size())) << "step " << step;
+
+    // a few lookups each step, and the whole text now and then.
+    if (step % 64 == 0)
+        ASSERT_EQ(buffer.GetText(), text) << "step " << step;
+    for (auto i = 0; i < 3; i++)
+    {
+        const auto offset = std::uniform_int_distribution<int>(0, static_cast<int>(text.size()))(random);
+        const auto position = buffer.GetPosition(offset);
+        const auto expected = GetPositionHelperFunc(text, offset);
+        ASSERT_EQ(position.line, expected.line) << "step " << step << " offset " << offset;
+        ASSERT_EQ(position.column, expected.column) << "step " << step << " offset " << offset;
+        ASSERT_EQ(buffer.GetOffset(position), offset) << "step " << step;
+
+        const auto line = std::uniform_int_distribution<int>(0, static_cast<int>(line_starts.size()) - 1)(random);
+        const auto line_start = line_starts[line];
+        const auto line_end = line + 1 < static_cast<int>(line_starts.size()) ? line_starts[line + 1] - 1 : static_cast<int>(text.size());
+        ASSERT_EQ(buffer.GetLineStart(line), line_start) << "step " << step << " line " << line;
+        ASSERT_EQ(buffer.GetLine(line), text.substr(line_start, line_end - line_start)) << "step " << step << " line " << line;
+    }
+}
+
+// Edits, undos and redos at random offsets, compared with a plain string
+// and its own undo and redo stacks.
+TEST(TextBufferTest, MatchesPlainString)
+{
+    String text = L"first line\nsecond line\n\nlast";
+    TextBuffer buffer(text);
+    std::vector<String> undo_texts, redo_texts;
+    std::mt19937 random(1);
+    const String insertions[] = { L"a", L"\n", L"xyz", L"two\nlines\n", L"\n\n", L"long inserted text" };
+
+    for (auto step = 0; step < 20000; step++)
+    {
+        const auto action = std::uniform_int_distribution<int>(0, 9)(random);
+        if (action < 6)
+        {
+            const auto length = static_cast<int>(text.size());
+            const auto begin = std::uniform_int_distribution<int>(0, length)(random);
+            // removes less than it inserts on average, so the text grows slowly.
+            const auto count = action < 2 ? std::uniform_int_distribution<int>(0, std::min(length - begin, 12))(random) : 0;
+            const auto& insertion = insertions[std::uniform_int_distribution<int>(0, 5)(random)];
+            undo_texts.push_back(text);
+            redo_texts.clear();
+            text.replace(begin, count, insertion);
+            buffer.Replace(begin, count, insertion);
+        }
+        else if (action < 8)
+        {
+            ASSERT_EQ(buffer.CanUndo(), !undo_texts.empty());
+            if (undo_texts.empty())
+                continue;
+            redo_texts.push_back(text);
+            text = undo_texts.back();
+            undo_texts.pop_back();
+            const auto change = buffer.Undo();
+            ASSERT_LE(change.begin + change.inserted_count, static_cast<int>(text.size()));
+        }
+        else
+        {
+            ASSERT_EQ(buffer.CanRedo(), !redo_texts.empty());
+            if (redo_texts.empty())
+                continue;
+            undo_texts.push_back(text);
+            text = redo_texts.back();
+            redo_texts.pop_back();
+            buffer.Redo();
+        }
+        ExpectSameHelperFunc(buffer, text, random, step);
+        if (HasFatalFailure())
+            return;
+    }
+    EXPECT_EQ(buffer.GetText(), text);
+}
+
+TEST(TextBufferTest, ThrowsWithoutSteps)
+{
+    TextBuffer buffer(L"abc");
+    EXPECT_THROW(buffer.Undo(), std::logic_error);
+    buffer.Insert(3, L"d");
+    buffer.Insert(4, L"e");
+    // typing at the end extends the last piece instead of adding one.
+    EXPECT_EQ(buffer.GetPieceCount(), 2);
+    buffer.LimitUndoSteps(1);
+    EXPECT_EQ(buffer.Undo().begin, 4);
+    EXPECT_FALSE(buffer.CanUndo());
+    EXPECT_EQ(buffer.GetText(), L"abcd");
+    buffer.Redo();
+    EXPECT_THROW(buffer.Redo(), std::logic_error);
+    EXPECT_EQ(buffer.GetText(), L"abcde");
+}
@@ -0,0 +1,55 @@
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include "graph/text_layout.h"
+
+using namespace cru;
+using namespace cru::graph;
+
+constexpr auto infinity = std::numeric_limits<float>::infinity();
+
+TextFormat MakeFormatHelperFunc()
+{
+    TextFormat format;
+    format.size = 10.0f;
+    return format;
+}
+
+// A layout that breaks no line is valid for any width from its widest line
+// on, infinite width included.
+TEST(TextLayoutTest, UnbrokenLayoutIsValidForInfiniteWidth)
+{
+    StubTextShaper shaper;
+    TextLayoutCache cache(&shaper);
+    const auto layout = cache.GetLayout(L"one two three", MakeFormatHelperFunc(), infinity);
+    ASSERT_EQ(layout->GetLines().size(), 1u);
+    EXPECT_EQ(layout->GetMaxValidWidth(), infinity);
+    EXPECT_TRUE(layout->IsValidForWidth(infinity));
+    EXPECT_TRUE(layout->IsValidForWidth(layout->GetSize().width));
+    EXPECT_FALSE(layout->IsValidForWidth(layout->GetSize().width - 1.0f));
+
+    // so laying it out at infinite width again is a hit.
+    EXPECT_EQ(cache.GetLayout(L"one two three", MakeFormatHelperFunc(), infinity), layout);
+    EXPECT_EQ(cache.GetStatistics().hit_count, 1);
+    EXPECT_EQ(cache.GetStatistics().relayout_count, 0);
+}
+
+// A width that breaks the same lines reuses the layout, and another one only
+// breaks the shaped text again.
+TEST(TextLayoutTest, ReusesLayoutWithinValidWidths)
+{
+    StubTextShaper shaper;
+    TextLayoutCache cache(&shaper);
+    const auto whole_width = cache.GetLayout(L"one two three", MakeFormatHelperFunc(), infinity)->GetSize().width;
+
+    const auto broken = cache.GetLayout(L"one two three", MakeFormatHelperFunc(), whole_width - 1.0f);
+    EXPECT_GT(broken->GetLines().size(), 1u);
+    EXPECT_LE(broken->GetMaxValidWidth(), whole_width);
+    EXPECT_FALSE(broken->IsValidForWidth(infinity));
+    EXPECT_EQ(cache.GetStatistics().relayout_count, 1);
+
+    EXPECT_EQ(cache.GetLayout(L"one two three", MakeFormatHelperFunc(), broken->GetMinValidWidth()), broken);
+    EXPECT_EQ(cache.GetStatistics().hit_count, 1);
+    EXPECT_EQ(cache.GetStatistics().miss_count, 1);
+}
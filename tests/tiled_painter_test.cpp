@@ -0,0 +1,126 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "thread_pool.h"
+#include "graph/path.h"
+#include "graph/tiled_painter.h"
+
+using namespace cru;
+using namespace cru::graph;
+using cru::ui::Matrix;
+using cru::ui::Point;
+using cru::ui::Rect;
+
+constexpr int bitmap_width = 300;
+constexpr int bitmap_height = 200;
+// small tiles, so most shapes cross several.
+constexpr int tile_size = 32;
+
+// Paint shapes of every kind, translucent and overlapping, with transforms
+// and clips, all from "seed".
+void PaintSceneHelperFunc(Painter& painter, const unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(-20.0f, bitmap_width + 20.0f);
+    std::uniform_real_distribution<float> y(-20.0f, bitmap_height + 20.0f);
+    std::uniform_real_distribution<float> length(2.0f, 120.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const auto make_color = [&] {
+        return Color(unit(random), unit(random), unit(random), 0.2f + 0.8f * unit(random));
+    };
+
+    painter.Clear(Color(1.0f, 1.0f, 1.0f));
+    for (auto i = 0; i < 60; i++)
+    {
+        const Rect rect(x(random), y(random), length(random), length(random));
+        const Brush brush = i % 4 == 0
+            ? Brush::LinearGradient(rect.GetLeftTop(), rect.GetRightBottom(), { GradientStop{ 0.0f, make_color() }, GradientStop{ 1.0f, make_color() } })
+            : Brush(make_color());
+        const auto has_clip = i % 5 == 0;
+        if (has_clip)
+            painter.PushClip(Rect(x(random), y(random), length(random), length(random)));
+        painter.SetTransform(i % 3 == 0 ? Matrix::Rotation(unit(random) * 360.0f, rect.GetLeftTop()) : Matrix::Identity());
+        switch (i % 6)
+        {
+        case 0:
+            painter.FillRectangle(rect, brush);
+            break;
+        case 1:
+            painter.StrokeRectangle(rect, brush, 1.0f + 4.0f * unit(random));
+            break;
+        case 2:
+            painter.FillRoundedRectangle(rect, 8.0f, 6.0f, brush);
+            break;
+        case 3:
+            painter.StrokeRoundedRectangle(rect, 8.0f, 6.0f, brush, 2.5f);
+            break;
+        default:
+        {
+            Path path;
+            path.SetFillRule(i % 2 == 0 ? FillRule::EvenOdd : FillRule::NonZero);
+            path.MoveTo(Point(x(random), y(random)));
+            path.CubicTo(Point(x(random), y(random)), Point(x(random), y(random)), Point(x(random), y(random)));
+            path.QuadraticTo(Point(x(random), y(random)), Point(x(random), y(random)));
+            path.LineTo(Point(x(random), y(random)));
+            path.Close();
+            painter.FillPath(path, brush);
+            break;
+        }
+        }
+        if (has_clip)
+            painter.PopClip();
+    }
+}
+
+Bitmap PaintSoftwareHelperFunc(const unsigned seed)
+{
+    Bitmap bitmap(bitmap_width, bitmap_height);
+    SoftwarePainter painter(&bitmap);
+    PaintSceneHelperFunc(painter, seed);
+    return bitmap;
+}
+
+Bitmap PaintTiledHelperFunc(const unsigned seed, ThreadPool* thread_pool)
+{
+    Bitmap bitmap(bitmap_width, bitmap_height);
+    TiledPainter painter(&bitmap, thread_pool, tile_size);
+    PaintSceneHelperFunc(painter, seed);
+    painter.Flush();
+    return bitmap;
+}
+
+TEST(TiledPainterTest, CallingThreadEqualsSoftwarePainter)
+{
+    Bitmap blank(bitmap_width, bitmap_height);
+    SoftwarePainter(&blank).Clear(Color(1.0f, 1.0f, 1.0f));
+    ASSERT_FALSE(PaintSoftwareHelperFunc(1) == blank);
+    for (unsigned seed = 1; seed <= 4; seed++)
+        EXPECT_TRUE(PaintTiledHelperFunc(seed, nullptr) == PaintSoftwareHelperFunc(seed)) << "seed " << seed;
+}
+
+TEST(TiledPainterTest, OneThreadEqualsSoftwarePainter)
+{
+    ThreadPool thread_pool(1);
+    for (unsigned seed = 1; seed <= 4; seed++)
+        EXPECT_TRUE(PaintTiledHelperFunc(seed, &thread_pool) == PaintSoftwareHelperFunc(seed)) << "seed " << seed;
+}
+
+TEST(TiledPainterTest, EightThreadsEqualSoftwarePainter)
+{
+    ThreadPool thread_pool(8);
+    for (unsigned seed = 1; seed <= 4; seed++)
+        EXPECT_TRUE(PaintTiledHelperFunc(seed, &thread_pool) == PaintSoftwareHelperFunc(seed)) << "seed " << seed;
+}
+
+TEST(TiledPainterTest, OnlyTouchedTilesAreFilled)
+{
+    Bitmap bitmap(bitmap_width, bitmap_height);
+    TiledPainter painter(&bitmap, nullptr, tile_size);
+    painter.FillRectangle(Rect(40.0f, 40.0f, 10.0f, 10.0f), Color(1.0f, 0.0f, 0.0f));
+    painter.Flush();
+    const auto& statistics = painter.GetLastFlushStatistics();
+    EXPECT_EQ(statistics.tile_count, painter.GetTileColumnCount() * painter.GetTileRowCount());
+    EXPECT_EQ(statistics.rasterized_tile_count, 1);
+    EXPECT_EQ(statistics.command_count, 1);
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "graph/display_list.h"
+#include "graph/tiled_painter.h"
+#include "ui/window.h"
+#include "ui/controls/stack_panel.h"
+
+using namespace cru;
+using namespace cru::ui;
+
+class ColorControl : public Control
+{
+public:
+    ColorControl(const graph::Color& color, const Size& size)
+        : color_(color)
+    {
+        BasicLayoutParams layout_params;
+        layout_params.size.width = MeasureLength(size.width);
+        layout_params.size.height = MeasureLength(size.height);
+        SetLayoutParams(layout_params);
+    }
+
+    void SetColor(const graph::Color& color)
+    {
+        color_ = color;
+        Repaint();
+    }
+
+protected:
+    void OnDraw(graph::Painter& painter) override
+    {
+        painter.FillRectangle(Rect(Point::zero, GetSize()), graph::Brush(color_));
+    }
+
+private:
+    graph::Color color_;
+};
+
+// A column of two controls in a window larger than both.
+class WindowRenderTest : public testing::Test
+{
+protected:
+    WindowRenderTest()
+        : panel_(Orientation::Vertical),
+        top_(graph::Color(1.0f, 0.0f, 0.0f), Size(40.0f, 30.0f)),
+        bottom_(graph::Color(0.0f, 0.0f, 1.0f), Size(60.0f, 20.0f))
+    {
+        panel_.AddChild(&top_);
+        panel_.AddChild(&bottom_);
+        window_.SetClientSize(Size(128.0f, 96.0f));
+        window_.AddChild(&panel_);
+    }
+
+    Window window_;
+    controls::StackPanel panel_;
+    ColorControl top_;
+    ColorControl bottom_;
+};
+
+TEST_F(WindowRenderTest, RenderTakesDamage)
+{
+    graph::DisplayList painter;
+    EXPECT_TRUE(window_.Render(painter).is_full);
+
+    // nothing changed, so nothing is damaged.
+    auto frame = window_.Render(painter);
+    EXPECT_TRUE(frame.paint_region.IsEmpty());
+
+    top_.SetColor(graph::Color(0.0f, 1.0f, 0.0f));
+    frame = window_.Render(painter);
+    EXPECT_FALSE(frame.is_full);
+    EXPECT_EQ(frame.present_region, Region(top_.GetSubtreeBounds()));
+
+    // the control was listed in the frame before, but its new damage counts.
+    top_.SetColor(graph::Color(1.0f, 1.0f, 0.0f));
+    frame = window_.Render(painter);
+    EXPECT_EQ(frame.present_region, Region(top_.GetSubtreeBounds()));
+
+    // the damage of the frames before is not kept.
+    bottom_.SetColor(graph::Color(0.0f, 1.0f, 1.0f));
+    frame = window_.Render(painter);
+    EXPECT_EQ(frame.present_region, Region(bottom_.GetSubtreeBounds()));
+}
+
+// Drawing only the damage into a bitmap keeping the last frame gives the
+// pixels of drawing everything, and only the damaged tiles are filled.
+TEST_F(WindowRenderTest, DamageOnlyRenderMatchesFullRender)
+{
+    graph::Bitmap bitmap(128, 96);
+    graph::TiledPainter painter(&bitmap, nullptr, 16);
+    window_.Render(painter, true);
+    painter.Flush();
+
+    bottom_.SetColor(graph::Color(0.0f, 0.5f, 0.0f));
+    window_.Render(painter, true);
+    painter.Flush();
+    const auto& statistics = painter.GetLastFlushStatistics();
+    // the bottom control from (0, 30) to (60, 50) is on 4 by 3 of 8 by 6 tiles.
+    EXPECT_EQ(statistics.tile_count, 48);
+    EXPECT_EQ(statistics.rasterized_tile_count, 12);
+
+    graph::Bitmap full_bitmap(128, 96);
+    graph::SoftwarePainter full_painter(&full_bitmap);
+    window_.Render(full_painter);
+    EXPECT_TRUE(bitmap == full_bitmap);
+}
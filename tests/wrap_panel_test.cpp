@@ -0,0 +1,179 @@
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ui/window.h"
+#include "ui/controls/wrap_panel.h"
+
+using namespace cru::ui;
+
+BasicLayoutParams MakeLayoutParamsHelperFunc(const float width, const float height)
+{
+    BasicLayoutParams layout_params;
+    layout_params.size.width = MeasureLength(width);
+    layout_params.size.height = MeasureLength(height);
+    return layout_params;
+}
+
+class TestControl : public Control
+{
+public:
+    TestControl() = default;
+};
+
+// A control of a fixed size that measures its child in infinite room and
+// lays it out at a width set on it, as a scrolling or animating parent does.
+class HostControl : public Control
+{
+public:
+    HostControl()
+    {
+        SetLayoutParams(MakeLayoutParamsHelperFunc(400.0f, 400.0f));
+    }
+
+    void SetChildWidth(const float width)
+    {
+        child_width_ = width;
+        InvalidateLayout();
+    }
+
+protected:
+    Size OnMeasure(const Size& available_size) override
+    {
+        const auto infinity = std::numeric_limits<float>::infinity();
+        for (auto child : GetInternalChildren())
+            child->Measure(Size(infinity, infinity));
+        return CalculateDesiredSize(available_size, Size::zero);
+    }
+
+    void OnLayout(const Rect& rect) override
+    {
+        for (auto child : GetInternalChildren())
+            child->Layout(Rect(0.0f, 0.0f, child_width_, child->GetDesiredSize().height));
+    }
+
+private:
+    float child_width_ = 100.0f;
+};
+
+// Children of 30 by 10 in a window 100 wide, so 3 fit a line.
+class WrapPanelTest : public testing::Test
+{
+protected:
+    void AddChildren(controls::WrapPanel& panel, const int count)
+    {
+        for (auto i = 0; i < count; i++)
+        {
+            children_.push_back(std::make_unique<TestControl>());
+            children_.back()->SetLayoutParams(MakeLayoutParamsHelperFunc(30.0f, 10.0f));
+            panel.AddChild(children_.back().get());
+        }
+    }
+
+    void Refresh()
+    {
+        window_.GetLayoutManager()->RefreshInvalidControlLayout();
+    }
+
+    Window window_;
+    std::vector<std::unique_ptr<TestControl>> children_;
+};
+
+TEST_F(WrapPanelTest, BreaksLines)
+{
+    controls::WrapPanel panel;
+    AddChildren(panel, 10);
+    window_.SetClientSize(Size(100.0f, 100.0f));
+    window_.AddChild(&panel);
+    Refresh();
+
+    EXPECT_EQ(panel.GetLineCount(), 4);
+    EXPECT_EQ(panel.GetDesiredSize(), Size(90.0f, 40.0f));
+    for (auto i = 0; i < 10; i++)
+        EXPECT_EQ(children_[i]->GetPositionRelative(), Point((i % 3) * 30.0f, (i / 3) * 10.0f)) << "child " << i;
+}
+
+// A changed child reflows from its line until the breaks land where they
+// were, and the lines are the ones of breaking all of them again.
+TEST_F(WrapPanelTest, ReflowStopsWhereBreaksRealign)
+{
+    constexpr auto count = 300;
+    controls::WrapPanel panel;
+    AddChildren(panel, count);
+    window_.SetClientSize(Size(100.0f, 1000.0f));
+    window_.AddChild(&panel);
+    Refresh();
+    ASSERT_EQ(panel.GetLineCount(), count / 3);
+    EXPECT_EQ(panel.GetLastReflowedChildCount(), count);
+
+    // still fits its line, so the break after it is the same.
+    children_[151]->SetLayoutParams(MakeLayoutParamsHelperFunc(40.0f, 15.0f));
+    Refresh();
+    EXPECT_EQ(panel.GetLineCount(), count / 3);
+    EXPECT_LE(panel.GetLastReflowedChildCount(), 6);
+    EXPECT_EQ(children_[153]->GetPositionRelative(), Point(0.0f, 51.0f * 10.0f + 5.0f));
+
+    // pushed to the next line, it pushes every later child.
+    children_[2]->SetLayoutParams(MakeLayoutParamsHelperFunc(50.0f, 10.0f));
+    Refresh();
+    EXPECT_GE(panel.GetLastReflowedChildCount(), count - 3);
+
+    // the same children in a new panel break the same way.
+    Window other_window;
+    controls::WrapPanel other_panel;
+    std::vector<std::unique_ptr<TestControl>> other_children;
+    for (auto i = 0; i < count; i++)
+    {
+        other_children.push_back(std::make_unique<TestControl>());
+        other_children.back()->SetLayoutParams(*children_[i]->GetLayoutParams());
+        other_panel.AddChild(other_children.back().get());
+    }
+    other_window.SetClientSize(Size(100.0f, 1000.0f));
+    other_window.AddChild(&other_panel);
+    other_window.GetLayoutManager()->RefreshInvalidControlLayout();
+    EXPECT_EQ(panel.GetLineCount(), other_panel.GetLineCount());
+    EXPECT_EQ(panel.GetDesiredSize(), other_panel.GetDesiredSize());
+    for (auto i = 0; i < count; i++)
+        ASSERT_EQ(children_[i]->GetPositionRelative(), other_children[i]->GetPositionRelative()) << "child " << i;
+}
+
+// Measured in infinite room, the lines follow the width the panel is laid
+// out at, narrower and wider again, and the desired size follows them.
+TEST_F(WrapPanelTest, FollowsLayoutWidth)
+{
+    HostControl host;
+    controls::WrapPanel panel;
+    AddChildren(panel, 10);
+    host.AddChild(&panel);
+    window_.SetClientSize(Size(400.0f, 400.0f));
+    window_.AddChild(&host);
+    Refresh();
+    EXPECT_EQ(panel.GetLineCount(), 4);
+    EXPECT_EQ(panel.GetDesiredSize().height, 40.0f);
+    EXPECT_EQ(panel.GetSize().height, 40.0f);
+
+    host.SetChildWidth(300.0f);
+    Refresh();
+    EXPECT_EQ(panel.GetLineCount(), 1);
+    EXPECT_EQ(panel.GetDesiredSize().height, 10.0f);
+    EXPECT_EQ(children_[9]->GetPositionRelative(), Point(270.0f, 0.0f));
+
+    host.SetChildWidth(200.0f);
+    Refresh();
+    EXPECT_EQ(panel.GetLineCount(), 2);
+    EXPECT_EQ(panel.GetSize().height, 20.0f);
+
+    host.SetChildWidth(100.0f);
+    Refresh();
+    EXPECT_EQ(panel.GetLineCount(), 4);
+    EXPECT_EQ(panel.GetSize().height, 40.0f);
+    EXPECT_EQ(children_[9]->GetPositionRelative(), Point(0.0f, 30.0f));
+
+    // a width breaking the lines the same way doesn't measure again.
+    host.SetChildWidth(95.0f);
+    Refresh();
+    EXPECT_EQ(panel.GetLineCount(), 4);
+    EXPECT_EQ(window_.GetLayoutManager()->GetLastLayoutPassStatistics().measure_count, 0);
+}